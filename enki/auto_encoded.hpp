@@ -0,0 +1,485 @@
+#ifndef ENKI_AUTO_ENCODED_HPP
+#define ENKI_AUTO_ENCODED_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "enki/bit_packed.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/bit_stream.hpp"
+#include "enki/impl/bulk.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+#include "enki/impl/varint.hpp"
+
+namespace enki
+{
+  /// Encodings `enki::AutoEncoded` chooses from, written as a one byte tag after the range size
+  enum class RangeEncoding : uint8_t
+  {
+    raw,                ///< Elements as the writer stores them on their own
+    varint,             ///< Each element as a (zigzag for signed types) varint
+    delta,              ///< Differences between consecutive elements, as `enki::Delta`
+    frame_of_reference, ///< 128 element bit packed blocks, as `enki::BitPacked`
+    run_length          ///< Runs of equal elements: varint run length then varint element
+  };
+
+  /// Range of integers stored with whichever of the `RangeEncoding`s is the smallest for the
+  /// values being written. The choice is made again on every write from a sample of the range
+  /// (all of it up to 2048 elements, 8 windows of 256 elements spread over larger ranges), so
+  /// the encoding follows the data as its distribution drifts, and readers simply follow the tag.
+  /// Only binary formats are affected, JSON keeps writing plain arrays.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Feed, sizes, enki::AutoEncoded<std::vector<int32_t>>)>
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  class AutoEncoded : public Range
+  {
+  public:
+    using Range::Range;
+
+    AutoEncoded() = default;
+
+    AutoEncoded(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    inline constexpr size_t kNumRangeEncodings = 5;
+    inline constexpr size_t kEncodingSampleWindow = 2 * kBitPackBlockSize;
+    inline constexpr size_t kEncodingSampleWindows = 8;
+
+    /// Value stored by the varint and run length encodings
+    template <concepts::integer T>
+    constexpr uint64_t toVarintValue(T value)
+    {
+      if constexpr (std::is_signed_v<T>)
+      {
+        return zigzagEncode(value);
+      }
+      else
+      {
+        return static_cast<std::make_unsigned_t<T>>(value);
+      }
+    }
+
+    template <concepts::integer T>
+    constexpr bool fromVarintValue(uint64_t stored, T &value)
+    {
+      using U = std::make_unsigned_t<T>;
+      if (stored > std::numeric_limits<U>::max())
+      {
+        return false;
+      }
+      if constexpr (std::is_signed_v<T>)
+      {
+        value = zigzagDecode(static_cast<U>(stored));
+      }
+      else
+      {
+        value = static_cast<U>(stored);
+      }
+      return true;
+    }
+
+    /// Encoded sizes of a sample of a range, one per `RangeEncoding` but raw
+    struct EncodingCosts
+    {
+      std::array<size_t, kNumRangeEncodings> bytes{};
+      size_t numSampled = 0;
+
+      constexpr size_t &operator[](RangeEncoding encoding)
+      {
+        return bytes[static_cast<size_t>(encoding)];
+      }
+    };
+
+    /// Add the encoded sizes of the `numElements` values from `first` to `c`
+    /// `isStart` and `isEnd` tell whether the values begin and end the range. Runs are counted
+    /// where they end, so that windows cutting them do not bias the estimate.
+    template <typename It>
+    constexpr void
+    sampleEncodingCosts(It first, size_t numElements, bool isStart, bool isEnd, EncodingCosts &c)
+    {
+      using T = typename std::iterator_traits<It>::value_type;
+      using U = std::make_unsigned_t<T>;
+
+      U previous = isStart ? U{} : static_cast<U>(*first);
+      U blockMin = std::numeric_limits<U>::max();
+      U blockMax = 0;
+      size_t blockSize = 0;
+      uint64_t runValue = 0;
+      size_t runLength = 0;
+      for (size_t i = 0; i < numElements; ++i, ++first)
+      {
+        const T value = *first;
+        const uint64_t stored = toVarintValue(value);
+        c[RangeEncoding::varint] += varintSize(stored);
+
+        const auto current = static_cast<U>(value);
+        c[RangeEncoding::delta] +=
+          varintSize(toVarintValue(static_cast<std::make_signed_t<U>>(current - previous)));
+        previous = current;
+
+        const U key = toOrderedKey(value);
+        blockMin = std::min(blockMin, key);
+        blockMax = std::max(blockMax, key);
+        if (++blockSize == kBitPackBlockSize || i + 1 == numElements)
+        {
+          const auto width =
+            static_cast<size_t>(std::bit_width(static_cast<U>(blockMax - blockMin)));
+          c[RangeEncoding::frame_of_reference] +=
+            varintSize(blockMin) + 1 + bitsToBytes(blockSize * width);
+          blockMin = std::numeric_limits<U>::max();
+          blockMax = 0;
+          blockSize = 0;
+        }
+
+        if (runLength > 0 && stored == runValue)
+        {
+          ++runLength;
+        }
+        else
+        {
+          if (runLength > 0)
+          {
+            c[RangeEncoding::run_length] += varintSize(runLength) + varintSize(runValue);
+          }
+          runValue = stored;
+          runLength = 1;
+        }
+      }
+      if (runLength > 0 && isEnd)
+      {
+        c[RangeEncoding::run_length] += varintSize(runLength) + varintSize(runValue);
+      }
+      c.numSampled += numElements;
+    }
+
+    /// Smallest encoding of the `numElements` values from `first`, ties going to the encoding
+    /// listed first (the cheapest to decode)
+    template <typename It>
+    constexpr RangeEncoding chooseRangeEncoding(It first, size_t numElements)
+    {
+      using T = typename std::iterator_traits<It>::value_type;
+
+      EncodingCosts costs;
+      if (numElements == 0)
+      {
+        return RangeEncoding::raw;
+      }
+      if (numElements <= kEncodingSampleWindow * kEncodingSampleWindows)
+      {
+        sampleEncodingCosts(first, numElements, true, true, costs);
+      }
+      else
+      {
+        // Evenly spread windows, the first one at the start and the last one at the end
+        const size_t lastStart = numElements - kEncodingSampleWindow;
+        size_t position = 0;
+        for (size_t i = 0; i < kEncodingSampleWindows; ++i)
+        {
+          const bool isLast = i + 1 == kEncodingSampleWindows;
+          size_t start = lastStart * i / (kEncodingSampleWindows - 1);
+          start -= isLast ? 0 : start % kBitPackBlockSize;
+          std::advance(first, static_cast<ptrdiff_t>(start - position));
+          sampleEncodingCosts(first, kEncodingSampleWindow, start == 0, isLast, costs);
+          std::advance(first, static_cast<ptrdiff_t>(kEncodingSampleWindow));
+          position = start + kEncodingSampleWindow;
+        }
+      }
+
+      // Raw size is exact, the other ones are scaled from the sample
+      auto best = RangeEncoding::raw;
+      uint64_t bestSize = uint64_t{numElements} * sizeof(T);
+      for (size_t e = 1; e < kNumRangeEncodings; ++e)
+      {
+        const uint64_t size = uint64_t{costs.bytes[e]} * numElements / costs.numSampled;
+        if (size < bestSize)
+        {
+          best = static_cast<RangeEncoding>(e);
+          bestSize = size;
+        }
+      }
+      return best;
+    }
+
+    template <typename Range, typename Writer>
+    constexpr Success writeEncodedRange(
+      const Range &range,
+      size_t numElements,
+      RangeEncoding encoding,
+      Writer &&w)
+    {
+      using T = typename Range::value_type;
+      using U = std::make_unsigned_t<T>;
+
+      Success isGood;
+      auto it = std::begin(range);
+      switch (encoding)
+      {
+      case RangeEncoding::raw:
+        if constexpr (bulk_writable_range<Range, Writer>)
+        {
+          return writeBulk(range, w);
+        }
+        else
+        {
+          for (size_t i = 0; i < numElements && isGood; ++i, ++it)
+          {
+            isGood.update(w.write(*it));
+          }
+          return isGood;
+        }
+      case RangeEncoding::varint:
+        for (size_t i = 0; i < numElements && isGood; ++i, ++it)
+        {
+          isGood.update(w.writeVarint(toVarintValue(*it)));
+        }
+        return isGood;
+      case RangeEncoding::delta:
+        return writeDeltas<U>(it, numElements, [](T v) { return v; }, w);
+      case RangeEncoding::frame_of_reference:
+        for (size_t done = 0; done < numElements && isGood; done += kBitPackBlockSize)
+        {
+          isGood.update(writePackedBlock(it, std::min(kBitPackBlockSize, numElements - done), w));
+        }
+        return isGood;
+      case RangeEncoding::run_length:
+        for (size_t done = 0; done < numElements && isGood;)
+        {
+          const T value = *it;
+          size_t runLength = 1;
+          for (++it; done + runLength < numElements && *it == value; ++it)
+          {
+            ++runLength;
+          }
+          isGood.update(w.writeVarint(runLength));
+          isGood.update(w.writeVarint(toVarintValue(value)));
+          done += runLength;
+        }
+        return isGood;
+      }
+      return "Unknown range encoding";
+    }
+
+    /// Read `numElements` values stored with any `RangeEncoding` but raw and run length into `out`
+    template <concepts::integer T, typename Reader>
+    constexpr Success
+    readEncodedValues(T *out, size_t numElements, RangeEncoding encoding, Reader &&r)
+    {
+      using U = std::make_unsigned_t<T>;
+
+      Success isGood;
+      switch (encoding)
+      {
+      case RangeEncoding::varint:
+        for (size_t i = 0; i < numElements && isGood; ++i)
+        {
+          uint64_t stored = 0;
+          if (isGood.update(r.readVarint(stored)) && !fromVarintValue(stored, out[i]))
+          {
+            return isGood.update("Value does not fit in the element type");
+          }
+        }
+        return isGood;
+      case RangeEncoding::delta:
+        // Signed and unsigned integers of the same width may alias
+        return readDeltas(reinterpret_cast<U *>(out), numElements, r);
+      case RangeEncoding::frame_of_reference:
+        for (size_t done = 0; done < numElements && isGood; done += kBitPackBlockSize)
+        {
+          isGood.update(
+            readPackedBlock(out + done, std::min(kBitPackBlockSize, numElements - done), r));
+        }
+        return isGood;
+      default:
+        return "Unknown range encoding";
+      }
+    }
+
+    /// Append the `numElements` values of run length encoded runs to `out` one run at a time: a
+    /// few bytes can claim any number of elements, which are only allocated once their runs are
+    /// read
+    template <concepts::integer T, typename Reader>
+    constexpr Success readRuns(std::vector<T> &out, size_t numElements, Reader &&r)
+    {
+      Success isGood;
+      out.clear();
+      while (out.size() < numElements)
+      {
+        uint64_t runLength = 0;
+        uint64_t stored = 0;
+        T value{};
+        if (!isGood.update(r.readVarint(runLength)) || !isGood.update(r.readVarint(stored)))
+        {
+          return isGood;
+        }
+        if (
+          runLength == 0 || runLength > numElements - out.size() ||
+          !fromVarintValue(stored, value))
+        {
+          return isGood.update("Invalid run length encoded run");
+        }
+        out.insert(out.end(), runLength, value);
+      }
+      return isGood;
+    }
+
+    /// Fewest bytes an encoding can take for `numElements` values, to reject sizes the remaining
+    /// data cannot hold before allocating (run lengths can cover any number of values: their
+    /// output grows run by run instead)
+    template <concepts::integer T>
+    constexpr size_t minEncodedSize(size_t numElements, RangeEncoding encoding)
+    {
+      switch (encoding)
+      {
+      case RangeEncoding::raw:
+        return numElements > std::numeric_limits<size_t>::max() / sizeof(T)
+                 ? std::numeric_limits<size_t>::max()
+                 : numElements * sizeof(T);
+      case RangeEncoding::varint:
+      case RangeEncoding::delta:
+        return numElements;
+      case RangeEncoding::frame_of_reference:
+        return (numElements + kBitPackBlockSize - 1) / kBitPackBlockSize * 2;
+      default:
+        return numElements == 0 ? 0 : 2;
+      }
+    }
+  } // namespace detail
+
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  struct AutoEncoded<Range>::EnkiSerial
+  {
+    using value_type = typename Range::value_type; // NOLINT
+
+    template <typename Writer>
+    static constexpr Success serialize(const AutoEncoded &value, Writer &&w)
+    {
+      if constexpr (concepts::varint_writer<Writer> && concepts::byte_writer<Writer>)
+      {
+        const auto &range = static_cast<const Range &>(value);
+        const size_t numElements = detail::rangeSize(range);
+        const RangeEncoding encoding = detail::chooseRangeEncoding(std::begin(range), numElements);
+        Success isGood = w.rangeBegin(numElements);
+        if (isGood && isGood.update(w.write(static_cast<uint8_t>(encoding))))
+        {
+          isGood.update(detail::writeEncodedRange(range, numElements, encoding, w));
+        }
+        if (isGood)
+        {
+          isGood.update(w.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(AutoEncoded &value, Reader &&r)
+    {
+      if constexpr (concepts::varint_reader<Reader> && concepts::byte_reader<Reader>)
+      {
+        size_t numElements = 0;
+        uint8_t tag = 0;
+        Success isGood = r.rangeBegin(numElements);
+        if (!isGood || !isGood.update(r.read(tag)))
+        {
+          return isGood;
+        }
+        if (tag >= detail::kNumRangeEncodings)
+        {
+          return isGood.update("Unknown range encoding");
+        }
+        const auto encoding = static_cast<RangeEncoding>(tag);
+        if (!detail::fitsInRemainingBytes(
+              detail::minEncodedSize<value_type>(numElements, encoding), r))
+        {
+          return isGood.update("Range size exceeds remaining data");
+        }
+
+        auto &range = static_cast<Range &>(value);
+        if constexpr (detail::bulk_readable_range<Range, Reader>)
+        {
+          if (encoding == RangeEncoding::raw)
+          {
+            if (isGood.update(detail::readBulk(range, numElements, r)))
+            {
+              isGood.update(r.rangeEnd());
+            }
+            return isGood;
+          }
+        }
+
+        const auto readAll = [&](std::vector<value_type> &out) {
+          if (encoding == RangeEncoding::run_length)
+          {
+            isGood.update(detail::readRuns(out, numElements, r));
+            return;
+          }
+          out.resize(numElements);
+          if (encoding == RangeEncoding::raw)
+          {
+            for (size_t i = 0; i < numElements && isGood; ++i)
+            {
+              isGood.update(r.read(out[i]));
+            }
+          }
+          else
+          {
+            isGood.update(detail::readEncodedValues(out.data(), numElements, encoding, r));
+          }
+        };
+
+        if constexpr (std::same_as<Range, std::vector<value_type>>)
+        {
+          readAll(range);
+        }
+        else
+        {
+          std::vector<value_type> temp;
+          readAll(temp);
+          if (isGood)
+          {
+            range = Range(std::begin(temp), std::end(temp));
+          }
+        }
+
+        if (isGood)
+        {
+          isGood.update(r.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_AUTO_ENCODED_HPP
@@ -0,0 +1,563 @@
+#ifndef ENKI_BIN_COMPRESSED_HPP
+#define ENKI_BIN_COMPRESSED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/impl/lz_block.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/shared_objects.hpp"
+#include "enki/impl/string_dictionary.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/varint.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Uncompressed bytes gathered before a block is compressed
+    inline constexpr size_t kCompressionBlockSize = size_t{1} << 16;
+
+    /// Runs of elements shorter than this are not worth shuffling
+    inline constexpr size_t kMinShuffledBytes = 64;
+
+    /// Elements of `elementSize` bytes, shuffled at `offset` in a block
+    struct ShuffledRun
+    {
+      size_t offset;
+      size_t elementSize;
+      size_t numElements;
+    };
+
+    /// Uncompressed block starting at `begin` in the output, waiting for a size placeholder in
+    /// it or in a block before it to be patched. `bytes` holds the encoded block once its own
+    /// placeholders are patched.
+    struct PendingBlock
+    {
+      size_t begin;
+      std::vector<std::byte> bytes;
+      std::vector<ShuffledRun> runs;
+      bool isEncoded = false;
+    };
+
+    inline void appendVarint(std::vector<std::byte> &out, uint64_t value)
+    {
+      std::array<std::byte, kMaxVarintSize> bytes{};
+      const size_t numBytes = encodeVarint(value, bytes.data());
+      out.insert(out.end(), bytes.begin(), bytes.begin() + static_cast<ptrdiff_t>(numBytes));
+    }
+
+    /// Compressed frame: a sequence of independent blocks, each made of
+    ///   varint uncompressed size
+    ///   varint number of shuffled runs, then for each run: varint offset in the block,
+    ///   varint element size and varint number of elements
+    ///   varint (stored size << 1) | 1 if the block is LZ compressed, 0 if stored as it is
+    ///   stored bytes, as many as the uncompressed size when stored as they are
+    struct CompressedBlock
+    {
+      size_t uncompressedSize = 0;
+      size_t numRuns = 0;
+      std::span<const std::byte> runs;
+      bool isCompressed = false;
+      std::span<const std::byte> stored;
+    };
+
+    inline bool readFrameVarint(std::span<const std::byte> &frame, uint64_t &value)
+    {
+      size_t numBytes = 0;
+      if (decodeVarint(frame.data(), frame.size(), value, numBytes) != VarintStatus::ok)
+      {
+        return false;
+      }
+      frame = frame.subspan(numBytes);
+      return true;
+    }
+
+    /// Read the block at the start of `frame` and move past it
+    inline Success readCompressedBlock(std::span<const std::byte> &frame, CompressedBlock &block)
+    {
+      uint64_t uncompressedSize = 0;
+      uint64_t numRuns = 0;
+      if (
+        !readFrameVarint(frame, uncompressedSize) || !readFrameVarint(frame, numRuns) ||
+        numRuns > frame.size() / 3)
+      {
+        return "Malformed compressed block";
+      }
+      const std::span<const std::byte> runsBegin = frame;
+      for (uint64_t i = 0; i < numRuns * 3; ++i)
+      {
+        uint64_t unused = 0;
+        if (!readFrameVarint(frame, unused))
+        {
+          return "Malformed compressed block";
+        }
+      }
+      uint64_t storedTag = 0;
+      if (!readFrameVarint(frame, storedTag) || (storedTag >> 1) > frame.size())
+      {
+        return "Malformed compressed block";
+      }
+      const size_t storedSize = storedTag >> 1;
+      const bool isCompressed = (storedTag & 1) != 0;
+      // Checked before anything is allocated for the block
+      if (
+        isCompressed ? uncompressedSize > lzMaxDecompressedSize(storedSize)
+                     : uncompressedSize != storedSize)
+      {
+        return "Malformed compressed block";
+      }
+      block.uncompressedSize = uncompressedSize;
+      block.numRuns = numRuns;
+      block.runs = runsBegin.first(runsBegin.size() - frame.size());
+      block.isCompressed = isCompressed;
+      block.stored = frame.first(storedSize);
+      frame = frame.subspan(block.stored.size());
+      return {};
+    }
+
+    /// Undo the shuffling of the runs of a decompressed block
+    inline Success unshuffleRuns(
+      const CompressedBlock &block,
+      std::span<std::byte> data,
+      std::vector<std::byte> &scratch)
+    {
+      std::span<const std::byte> runs = block.runs;
+      for (size_t i = 0; i < block.numRuns; ++i)
+      {
+        uint64_t offset = 0;
+        uint64_t elementSize = 0;
+        uint64_t numElements = 0;
+        readFrameVarint(runs, offset);
+        readFrameVarint(runs, elementSize);
+        readFrameVarint(runs, numElements);
+        if (
+          offset > data.size() || elementSize == 0 ||
+          numElements > (data.size() - offset) / elementSize)
+        {
+          return "Malformed shuffled run in compressed block";
+        }
+        unshuffleBytes(data.subspan(offset, elementSize * numElements), elementSize, scratch);
+      }
+      return {};
+    }
+  } // namespace detail
+
+  /// Binary writer compressing its output block by block as it is written, with a fast LZ77
+  /// codec tuned for speed rather than ratio. Runs of arithmetic elements are byte shuffled
+  /// before compression. Blocks are kept in `data()` or handed to a sink as soon as they are
+  /// complete; `flush` compresses the last one. Blocks holding the size prefix of skippable
+  /// content still being written wait, with the ones after them, until the prefix is patched.
+  /// Read with `decompress` and a `BinSpanReader`.
+  /// Usage:
+  ///   enki::BinCompressedWriter writer;
+  ///   enki::serialize(value, writer).or_throw();
+  ///   writer.flush();
+  template <policy Policy = strict_t, typename SizeType = uint32_t>
+  class BinCompressedWriter :
+    public detail::BinWriterInterface<Policy, BinCompressedWriter<Policy, SizeType>>
+  {
+  public:
+    using policy_type = Policy;                           // NOLINT
+    using size_type = SizeType;                           // NOLINT
+    using probe_type = BinProbe<Policy, SizeType>;        // NOLINT
+    static constexpr bool serialize_custom_names = false; // NOLINT
+
+    /// Receives each compressed block, which is only valid during the call
+    using Sink = std::function<void(std::span<const std::byte>)>;
+
+    BinCompressedWriter() = default;
+
+    explicit BinCompressedWriter(Policy)
+    {
+    }
+
+    /// Writer handing its compressed blocks to `sink` instead of keeping them
+    BinCompressedWriter(Policy, Sink sink) :
+      mSink(std::move(sink))
+    {
+    }
+
+    /// Compressed blocks written so far, when there is no sink
+    const std::vector<std::byte> &data() const
+    {
+      return mOutput;
+    }
+
+    /// Compress the data written since the last block
+    void flush()
+    {
+      if (!mStaging.empty())
+      {
+        cutBlock();
+      }
+      releasePending();
+    }
+
+    /// Size of the data written, before compression
+    size_t uncompressedSize() const noexcept
+    {
+      return mFlushedSize + mStaging.size();
+    }
+
+    /// Clear the data, the shared objects and, with the dictionary policy, the strings already
+    /// written
+    void clear()
+    {
+      mOutput.clear();
+      mStaging.clear();
+      mRuns.clear();
+      mPending.clear();
+      mHeld.clear();
+      mFlushedSize = 0;
+      mObjectIds.clear();
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.clear();
+      }
+    }
+
+    /// Write raw bytes, split into blocks
+    Success writeBytes(std::span<const std::byte> bytes)
+    {
+      return writeChunks(bytes, 1);
+    }
+
+    /// Write runs of `elementSize` bytes elements, shuffled byte by byte before compression
+    Success writeElements(std::span<const std::byte> bytes, size_t elementSize)
+    {
+      return writeChunks(bytes, elementSize);
+    }
+
+  protected:
+    friend detail::BinWriterBase<BinCompressedWriter>;
+    friend detail::BinWriterInterface<Policy, BinCompressedWriter>;
+
+    std::byte *getBackInserter(size_t writeSize)
+    {
+      if (!mStaging.empty() && mStaging.size() + writeSize > detail::kCompressionBlockSize)
+      {
+        cutBlock();
+      }
+      const size_t offset = mStaging.size();
+      mStaging.resize(offset + writeSize);
+      return mStaging.data() + offset;
+    }
+
+    size_t writtenSize() const
+    {
+      return uncompressedSize();
+    }
+
+    /// Patch a held size placeholder, which is never split between blocks
+    void overwrite(size_t offset, std::span<const std::byte> bytes)
+    {
+      if (offset >= mFlushedSize)
+      {
+        std::copy(
+          std::begin(bytes),
+          std::end(bytes),
+          mStaging.begin() + static_cast<ptrdiff_t>(offset - mFlushedSize));
+        return;
+      }
+      const auto block = std::find_if(mPending.rbegin(), mPending.rend(), [&](const auto &b) {
+        return b.begin <= offset;
+      });
+      std::copy(
+        std::begin(bytes),
+        std::end(bytes),
+        block->bytes.begin() + static_cast<ptrdiff_t>(offset - block->begin));
+    }
+
+    /// Make room for `count` bytes right after a held placeholder ending at `offset`, in the
+    /// block holding it
+    void insertBytes(size_t offset, size_t count)
+    {
+      if (offset > mFlushedSize)
+      {
+        insertInBlock(mStaging, mRuns, offset - mFlushedSize, count);
+        return;
+      }
+      const auto block = std::find_if(mPending.rbegin(), mPending.rend(), [&](const auto &b) {
+        return b.begin < offset;
+      });
+      insertInBlock(block->bytes, block->runs, offset - block->begin, count);
+      for (auto next = block.base(); next != mPending.end(); ++next)
+      {
+        next->begin += count;
+      }
+      mFlushedSize += count;
+    }
+
+    /// Skippable content: the block holding its size placeholder at `offset` waits until the
+    /// placeholder is patched
+    void holdOutput(size_t offset)
+    {
+      mHeld.push_back(offset);
+    }
+
+    void releaseOutput() noexcept
+    {
+      mHeld.pop_back();
+    }
+
+    detail::string_ids_t<Policy> &stringIds()
+    {
+      return mStringIds;
+    }
+
+    detail::object_ids_t<Policy> &objectIds()
+    {
+      return mObjectIds;
+    }
+
+  private:
+    /// Large writes are cut into whole elements fitting in a block, so that each block is
+    /// compressed while it is still in cache
+    Success writeChunks(std::span<const std::byte> bytes, size_t elementSize)
+    {
+      using parent_type = detail::BinWriterBase<BinCompressedWriter>; // NOLINT
+      const size_t chunkSize =
+        std::max(detail::kCompressionBlockSize / elementSize, size_t{1}) * elementSize;
+      Success isGood;
+      while (!bytes.empty())
+      {
+        const auto chunk = bytes.first(std::min(bytes.size(), chunkSize));
+        isGood.update(parent_type::writeBytes(chunk));
+        if (elementSize > 1 && chunk.size() >= detail::kMinShuffledBytes)
+        {
+          mRuns.push_back(
+            {mStaging.size() - chunk.size(), elementSize, chunk.size() / elementSize});
+        }
+        bytes = bytes.subspan(chunk.size());
+      }
+      return isGood;
+    }
+
+    static void insertInBlock(
+      std::vector<std::byte> &block,
+      std::vector<detail::ShuffledRun> &runs,
+      size_t offset,
+      size_t count)
+    {
+      block.insert(block.begin() + static_cast<ptrdiff_t>(offset), count, std::byte{});
+      for (auto &run : runs)
+      {
+        if (run.offset >= offset)
+        {
+          run.offset += count;
+        }
+      }
+    }
+
+    /// Close the current block: it is compressed and handed out right away unless a size
+    /// placeholder still waits in it or in a block before it
+    void cutBlock()
+    {
+      const size_t blockSize = mStaging.size();
+      if (mHeld.empty() && mPending.empty())
+      {
+        encodeBlock(mStaging, mRuns, mOutput);
+        if (mSink)
+        {
+          mSink(mOutput);
+          mOutput.clear();
+        }
+      }
+      else
+      {
+        mPending.push_back({mFlushedSize, std::move(mStaging), std::move(mRuns)});
+      }
+      mFlushedSize += blockSize;
+      mStaging.clear();
+      mRuns.clear();
+      releasePending();
+    }
+
+    /// Encode the pending blocks whose placeholders are all patched, then hand out the encoded
+    /// ones at the front in order
+    void releasePending()
+    {
+      for (auto &block : mPending)
+      {
+        const auto held = std::lower_bound(mHeld.begin(), mHeld.end(), block.begin);
+        if (!block.isEncoded && (held == mHeld.end() || *held >= block.begin + block.bytes.size()))
+        {
+          std::vector<std::byte> encoded;
+          encodeBlock(block.bytes, block.runs, encoded);
+          block.bytes = std::move(encoded);
+          block.isEncoded = true;
+        }
+      }
+      while (!mPending.empty() && mPending.front().isEncoded)
+      {
+        const std::vector<std::byte> &encoded = mPending.front().bytes;
+        if (mSink)
+        {
+          mSink(encoded);
+        }
+        else
+        {
+          mOutput.insert(mOutput.end(), encoded.begin(), encoded.end());
+        }
+        mPending.pop_front();
+      }
+    }
+
+    /// Append `block`, whose `runs` are shuffled in place, to `out` in the frame format
+    void encodeBlock(
+      std::span<std::byte> block,
+      const std::vector<detail::ShuffledRun> &runs,
+      std::vector<std::byte> &out)
+    {
+      for (const auto &run : runs)
+      {
+        detail::shuffleBytes(
+          block.subspan(run.offset, run.elementSize * run.numElements), run.elementSize, mScratch);
+      }
+
+      detail::appendVarint(out, block.size());
+      detail::appendVarint(out, runs.size());
+      for (const auto &run : runs)
+      {
+        detail::appendVarint(out, run.offset);
+        detail::appendVarint(out, run.elementSize);
+        detail::appendVarint(out, run.numElements);
+      }
+
+      size_t compressedSize = std::numeric_limits<size_t>::max();
+      if (block.size() <= std::numeric_limits<uint32_t>::max())
+      {
+        mScratch.resize(detail::lzMaxCompressedSize(block.size()));
+        compressedSize = detail::compressLzBlock(block, mScratch.data(), mHashTable);
+      }
+      if (compressedSize < block.size())
+      {
+        detail::appendVarint(out, (uint64_t{compressedSize} << 1) | 1);
+        out.insert(
+          out.end(), mScratch.begin(), mScratch.begin() + static_cast<ptrdiff_t>(compressedSize));
+      }
+      else
+      {
+        // Incompressible data is stored as it is
+        detail::appendVarint(out, uint64_t{block.size()} << 1);
+        out.insert(out.end(), block.begin(), block.end());
+      }
+    }
+
+    std::vector<std::byte> mOutput;
+    std::vector<std::byte> mStaging;
+    std::vector<detail::ShuffledRun> mRuns;
+    std::vector<std::byte> mScratch;
+    std::vector<uint32_t> mHashTable;
+    std::deque<detail::PendingBlock> mPending;
+    std::vector<size_t> mHeld; // Offsets of the size placeholders waiting to be patched
+    size_t mFlushedSize = 0;
+    Sink mSink;
+    [[no_unique_address]] detail::string_ids_t<Policy> mStringIds;
+    detail::object_ids_t<Policy> mObjectIds;
+  };
+
+  /// Size of the data compressed in `frame` by a `BinCompressedWriter`
+  inline Success decompressedSize(std::span<const std::byte> frame, size_t &size)
+  {
+    const size_t frameSize = frame.size();
+    size = 0;
+    while (!frame.empty())
+    {
+      detail::CompressedBlock block;
+      Success isGood = detail::readCompressedBlock(frame, block);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (block.uncompressedSize > std::numeric_limits<size_t>::max() - size)
+      {
+        return "Malformed compressed block";
+      }
+      size += block.uncompressedSize;
+    }
+    return {frameSize};
+  }
+
+  /// Decompress `frame` block by block straight into `out`, which must hold exactly
+  /// `decompressedSize` bytes. A `BinSpanReader` can then read `out` in place.
+  inline Success decompress(std::span<const std::byte> frame, std::span<std::byte> out)
+  {
+    const size_t frameSize = frame.size();
+    std::vector<std::byte> scratch;
+    size_t offset = 0;
+    while (!frame.empty())
+    {
+      detail::CompressedBlock block;
+      Success isGood = detail::readCompressedBlock(frame, block);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (block.uncompressedSize > out.size() - offset)
+      {
+        return "Compressed data exceeds the output";
+      }
+      const std::span<std::byte> target = out.subspan(offset, block.uncompressedSize);
+      if (block.isCompressed)
+      {
+        if (!detail::decompressLzBlock(block.stored, target))
+        {
+          return "Malformed compressed block";
+        }
+      }
+      else
+      {
+        if (block.stored.size() != target.size())
+        {
+          return "Malformed compressed block";
+        }
+        std::memcpy(target.data(), block.stored.data(), target.size());
+      }
+      if (!isGood.update(detail::unshuffleRuns(block, target, scratch)))
+      {
+        return isGood;
+      }
+      offset += block.uncompressedSize;
+    }
+    if (offset != out.size())
+    {
+      return "Compressed data is smaller than the output";
+    }
+    return {frameSize};
+  }
+
+  /// Decompress `frame` into `out`, resized to the decompressed size
+  inline Success decompress(std::span<const std::byte> frame, std::vector<std::byte> &out)
+  {
+    size_t size = 0;
+    Success isGood = decompressedSize(frame, size);
+    if (!isGood)
+    {
+      return isGood;
+    }
+    out.resize(size);
+    return decompress(frame, std::span<std::byte>(out));
+  }
+
+  // Deduction guides for BinCompressedWriter
+  BinCompressedWriter() -> BinCompressedWriter<strict_t, uint32_t>;
+  template <policy Policy>
+  BinCompressedWriter(Policy) -> BinCompressedWriter<Policy, uint32_t>;
+  template <policy Policy, typename Sink>
+  BinCompressedWriter(Policy, Sink) -> BinCompressedWriter<Policy, uint32_t>;
+} // namespace enki
+
+#endif // ENKI_BIN_COMPRESSED_HPP
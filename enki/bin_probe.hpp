@@ -1,13 +1,23 @@
 #ifndef ENKI_BIN_PROBE_HPP
 #define ENKI_BIN_PROBE_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
 #include <string_view>
 #include <variant>
 
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
 #include "enki/impl/concepts.hpp"
 #include "enki/impl/policies.hpp"
+#include "enki/impl/shared_objects.hpp"
+#include "enki/impl/string_dictionary.hpp"
 #include "enki/impl/success.hpp"
+#include "enki/impl/varint.hpp"
 
 namespace enki
 {
@@ -28,9 +38,22 @@ namespace enki
     }
 
     template <concepts::arithmetic_or_enum T>
-    constexpr Success write(const T &)
+    constexpr Success write(const T &v)
     {
-      return {sizeof(T)};
+      if constexpr (detail::is_compact_enum_v<Policy, T>)
+      {
+        return write(detail::toCompactEnum(v));
+      }
+      else
+      {
+        Success result;
+        if constexpr (has_policy_v<Policy, aligned_t>)
+        {
+          result = alignTo(alignof(T));
+        }
+        mOffset += sizeof(T);
+        return result.update(sizeof(T));
+      }
     }
 
     constexpr Success write(const std::monostate &)
@@ -38,6 +61,70 @@ namespace enki
       return {}; // No bytes for monostate
     }
 
+    /// Dictionary policy: the probe tracks strings like a writer would to count references
+    template <concepts::string_like S>
+      requires has_policy_v<Policy, dictionary_t>
+    constexpr Success write(const S &str)
+    {
+      const std::string_view view(str);
+      uint64_t id = 0;
+      if (mStringIds.find(view, id))
+      {
+        return writeVarint(detail::dictionaryReferenceTag(id));
+      }
+      mStringIds.insert(view);
+      const size_t size =
+        detail::varintSize(detail::dictionaryLiteralTag(view.size(), true)) + view.size();
+      mOffset += size;
+      return {size};
+    }
+
+    /// Shared objects: the probe tracks objects like a writer would to count references
+    template <typename T, typename ValueFunc>
+    constexpr Success writeShared(const std::shared_ptr<T> &object, ValueFunc &&writeValue)
+    {
+      if (!object)
+      {
+        return writeVarint(detail::kNullObjectTag);
+      }
+      uint64_t id = 0;
+      if (mObjectIds.find(object, id))
+      {
+        return writeVarint(detail::objectReferenceTag(id));
+      }
+      const bool isInserted = mObjectIds.insert(object);
+      Success result = writeVarint(detail::objectLiteralTag(isInserted));
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
+      {
+        return result.update(writeSkippable(writeValue));
+      }
+      else
+      {
+        return result.update(writeValue(*this));
+      }
+    }
+
+    constexpr Success writeVarint(uint64_t v)
+    {
+      const size_t size = detail::varintSize(v);
+      mOffset += size;
+      return {size};
+    }
+
+    constexpr Success writeBytes(std::span<const std::byte> bytes)
+    {
+      mOffset += bytes.size();
+      return {bytes.size()};
+    }
+
+    /// Count the padding a writer adds to reach the next multiple of `alignment`
+    constexpr Success alignTo(size_t alignment)
+    {
+      const size_t padding = detail::alignmentPadding(mOffset, alignment);
+      mOffset += padding;
+      return {padding};
+    }
+
     constexpr Success arrayBegin() const
     {
       return {};
@@ -55,7 +142,31 @@ namespace enki
 
     constexpr Success rangeBegin(size_t numElements)
     {
-      return write(static_cast<SizeType>(numElements));
+      if constexpr (has_policy_v<Policy, chunked_t>)
+      {
+        if (!detail::fitsInRangeChunkHeader(numElements))
+        {
+          return "Range is too large for its size prefix";
+        }
+        return writeVarint(detail::rangeChunkHeader(numElements, false));
+      }
+      else
+      {
+        if constexpr (sizeof(SizeType) < sizeof(size_t))
+        {
+          if (numElements > std::numeric_limits<SizeType>::max())
+          {
+            return "Range is too large for its size prefix";
+          }
+        }
+        return write(static_cast<SizeType>(numElements));
+      }
+    }
+
+    constexpr Success rangeChunk(size_t numElements)
+      requires has_policy_v<Policy, chunked_t>
+    {
+      return writeVarint(detail::rangeChunkHeader(numElements, true));
     }
 
     constexpr Success rangeEnd() const
@@ -88,17 +199,66 @@ namespace enki
       return {};
     }
 
-    /// Write skippable content - probes content and adds size field overhead
+    /// Write skippable content - probes the size field and the content
     template <typename WriteFunc>
     constexpr Success writeSkippable(WriteFunc &&writeContent)
     {
+      Success result = write(size_type{});
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.beginSkippable();
+      }
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
+      {
+        mObjectIds.beginSkippable();
+      }
       Success probeResult = writeContent(*this);
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
+      {
+        mObjectIds.endSkippable();
+      }
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.endSkippable();
+      }
+      if (!probeResult)
+      {
+        return probeResult;
+      }
+      return result.update(probeResult);
+    }
+
+    /// Write skippable content preceded by its size as a varint - probes both
+    template <typename WriteFunc>
+    constexpr Success writeSized(WriteFunc &&writeContent)
+    {
+      const size_t sizeOffset = mOffset;
+      Success probeResult = writeSkippable(writeContent);
       if (!probeResult)
       {
         return probeResult;
       }
-      // Add size field overhead to total
-      return {sizeof(size_type) + probeResult.size()};
+      const size_t contentSize = probeResult.size() - sizeof(size_type);
+      mOffset = sizeOffset + detail::varintSize(contentSize) + contentSize;
+      return {mOffset - sizeOffset};
+    }
+
+    /// Write content decodable on its own - probes it with dictionary and object ids of its own
+    template <typename WriteFunc>
+    constexpr Success writeIsolated(WriteFunc &&writeContent)
+    {
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.beginIsolated();
+      }
+      mObjectIds.beginIsolated();
+      Success probeResult = writeContent(*this);
+      mObjectIds.endIsolated();
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.endIsolated();
+      }
+      return probeResult;
     }
 
     /// Probe a variant: index + value (with size prefix if forward_compatible)
@@ -111,7 +271,7 @@ namespace enki
         return indexResult;
       }
 
-      if constexpr (std::is_same_v<Policy, forward_compatible_t>)
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
       {
         // Forward compatible: add size prefix overhead
         Success valueResult = writeSkippable([&](auto &w) { return writeValue(w); });
@@ -141,12 +301,17 @@ namespace enki
       }
       return flagResult;
     }
+
+  private:
+    size_t mOffset = 0;
+    [[no_unique_address]] detail::string_ids_t<Policy> mStringIds;
+    detail::object_ids_t<Policy> mObjectIds;
   };
 
   // Deduction guides for BinProbe
   BinProbe() -> BinProbe<strict_t, uint32_t>;
-  BinProbe(strict_t) -> BinProbe<strict_t, uint32_t>;
-  BinProbe(forward_compatible_t) -> BinProbe<forward_compatible_t, uint32_t>;
+  template <policy Policy>
+  BinProbe(Policy) -> BinProbe<Policy, uint32_t>;
 } // namespace enki
 
 #endif // ENKI_BIN_PROBE_HPP
@@ -1,9 +1,15 @@
 #ifndef ENKI_BIN_READER_HPP
 #define ENKI_BIN_READER_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -13,9 +19,16 @@
 #include <cstdlib>
 #endif
 
+#include "enki/bin_session.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
 #include "enki/impl/concepts.hpp"
 #include "enki/impl/policies.hpp"
+#include "enki/impl/shared_objects.hpp"
+#include "enki/impl/string_dictionary.hpp"
 #include "enki/impl/success.hpp"
+#include "enki/impl/varint.hpp"
 
 namespace enki
 {
@@ -37,21 +50,46 @@ namespace enki
     {
     }
 
+    /// Reader sharing its dictionary and schemas with the other readers of `session`
+    BinSpanReader(Policy, std::span<const std::byte> data, BinReaderSession &session) :
+      mSpan(data),
+      mSession(&session)
+    {
+    }
+
     template <concepts::arithmetic_or_enum T>
     constexpr Success read(T &v)
     {
-      if (mCurrentIndex + sizeof(T) > mSpan.size())
+      if constexpr (detail::is_compact_enum_v<Policy, T>)
+      {
+        detail::compact_enum_t<T> stored{};
+        Success result = read(stored);
+        if (result && !detail::fromCompactEnum(stored, v))
+        {
+          return "Enum value is out of its declared range";
+        }
+        return result;
+      }
+      else
       {
+        Success result;
+        if constexpr (has_policy_v<Policy, aligned_t>)
+        {
+          result = alignTo(alignof(T));
+        }
+        if (mCurrentIndex + sizeof(T) > mSpan.size())
+        {
 #if __cpp_exceptions >= 199711
 
-        throw std::out_of_range("BinReader out of range read");
+          throw std::out_of_range("BinReader out of range read");
 #else
-        std::abort();
+          std::abort();
 #endif
+        }
+        std::memcpy(&v, mSpan.data() + mCurrentIndex, sizeof(T));
+        mCurrentIndex += sizeof(T);
+        return result.update(sizeof(T));
       }
-      std::memcpy(&v, mSpan.data() + mCurrentIndex, sizeof(T));
-      mCurrentIndex += sizeof(T);
-      return {sizeof(T)};
     }
 
     constexpr Success read(std::monostate &)
@@ -59,6 +97,259 @@ namespace enki
       return {}; // No bytes to read for monostate
     }
 
+    /// Dictionary policy: read a new string or a reference to one read before
+    /// A `std::string_view` is pointed at the string inside the input buffer, or inside the
+    /// session for strings shared across messages
+    template <concepts::string_like S>
+      requires has_policy_v<Policy, dictionary_t>
+    constexpr Success read(S &str)
+    {
+      uint64_t tag = 0;
+      Success result = readVarint(tag);
+      if (!result)
+      {
+        return result;
+      }
+      std::string_view view;
+      if (detail::isDictionaryReference(tag))
+      {
+        if (!stringTable().get(tag >> 1, view))
+        {
+          return "Unknown dictionary string reference";
+        }
+      }
+      else
+      {
+        if (!result.update(readStringView(tag >> 2, view)))
+        {
+          return result;
+        }
+        if (detail::isInsertedDictionaryLiteral(tag))
+        {
+          if (mSession != nullptr)
+          {
+            view = mSession->addString(view);
+          }
+          else
+          {
+            mStringTable.add(view);
+          }
+        }
+      }
+      str = S(view);
+      return result;
+    }
+
+    /// Point `str` at the string inside the input buffer, without copying it
+    constexpr Success read(std::string_view &str)
+      requires(!has_policy_v<Policy, dictionary_t>)
+    {
+      size_t size = 0;
+      Success result = rangeBegin(size);
+      if (!result)
+      {
+        return result;
+      }
+      return result.update(readStringView(size, str));
+    }
+
+    /// Aligned policy: point `values` at a range of raw elements or plain structs inside the
+    /// input buffer, without copying them. The buffer must be aligned like the elements.
+    template <typename T>
+      requires has_policy_v<Policy, aligned_t> && detail::aligned_value<T, Policy> &&
+               (!std::same_as<T, bool>)
+    Success read(std::span<const T> &values)
+    {
+      size_t numElements = 0;
+      Success result = rangeBegin(numElements);
+      if (!result || !result.update(alignTo(alignof(T))))
+      {
+        return result;
+      }
+      if (numElements > remainingBytes() / sizeof(T))
+      {
+        return "Range size exceeds remaining data";
+      }
+      std::span<const std::byte> bytes;
+      if (!result.update(viewAligned<T>(numElements * sizeof(T), bytes)))
+      {
+        return result;
+      }
+      values = {reinterpret_cast<const T *>(bytes.data()), numElements};
+      return result;
+    }
+
+    /// Aligned policy: point `value` at an arithmetic value or a plain struct inside the input
+    /// buffer, without copying it. The buffer must be aligned like the value.
+    template <typename T>
+      requires has_policy_v<Policy, aligned_t> && detail::aligned_value<T, Policy> &&
+               (!std::same_as<T, bool>)
+    Success viewValue(const T *&value)
+    {
+      Success result = alignTo(alignof(T));
+      std::span<const std::byte> bytes;
+      if (!result.update(viewAligned<T>(sizeof(T), bytes)))
+      {
+        return result;
+      }
+      value = reinterpret_cast<const T *>(bytes.data());
+      return result;
+    }
+
+    /// Read a shared object: null, a new object read by `readValue`, or a reference to an
+    /// object read before, which is shared again instead of being copied
+    template <typename T, typename ValueFunc>
+    Success readShared(std::shared_ptr<T> &object, ValueFunc &&readValue)
+    {
+      uint64_t tag = 0;
+      Success result = readVarint(tag);
+      if (!result)
+      {
+        return result;
+      }
+      if (detail::isObjectReference(tag))
+      {
+        if (!mObjectTable.get(tag >> 1, object))
+        {
+          return "Unknown shared object reference";
+        }
+        return result;
+      }
+      if (tag == detail::kNullObjectTag)
+      {
+        object.reset();
+        return result;
+      }
+      if (tag != detail::objectLiteralTag(true) && tag != detail::objectLiteralTag(false))
+      {
+        return "Malformed shared object tag";
+      }
+      auto created = std::make_shared<std::remove_cv_t<T>>();
+      if (tag == detail::objectLiteralTag(true))
+      {
+        // Added before its value is read: objects of a cycle refer to it
+        mObjectTable.add(created);
+      }
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
+      {
+        SizeType size{};
+        if (!result.update(read(size)))
+        {
+          return result;
+        }
+        if (size > remainingBytes())
+        {
+          return "Shared object size exceeds remaining data";
+        }
+        const size_t remainingBefore = remainingBytes();
+        if (!result.update(readScoped([&] { return readValue(*created); })))
+        {
+          return result;
+        }
+        if (remainingBefore - remainingBytes() != size)
+        {
+          return "Shared object size does not match its value";
+        }
+      }
+      else if (!result.update(readValue(*created)))
+      {
+        return result;
+      }
+      object = std::move(created);
+      return result;
+    }
+
+    /// Forward compatible formats: move past a shared object without reading its value
+    /// A new object keeps its id, but references to it cannot be read.
+    constexpr Success skipShared()
+      requires has_policy_v<Policy, forward_compatible_t>
+    {
+      uint64_t tag = 0;
+      Success result = readVarint(tag);
+      if (!result || detail::isObjectReference(tag) || tag == detail::kNullObjectTag)
+      {
+        return result;
+      }
+      if (tag != detail::objectLiteralTag(true) && tag != detail::objectLiteralTag(false))
+      {
+        return "Malformed shared object tag";
+      }
+      if (tag == detail::objectLiteralTag(true))
+      {
+        mObjectTable.addSkipped();
+      }
+      SizeType size{};
+      std::span<const std::byte> bytes;
+      if (result.update(read(size)))
+      {
+        result.update(viewBytes(size, bytes));
+      }
+      return result;
+    }
+
+    /// Read a LEB128 varint written by `writeVarint`
+    constexpr Success readVarint(uint64_t &v)
+    {
+      size_t numBytes = 0;
+      const auto status = detail::decodeVarint(
+        mSpan.data() + mCurrentIndex, mSpan.size() - mCurrentIndex, v, numBytes);
+      if (status == detail::VarintStatus::truncated)
+      {
+#if __cpp_exceptions >= 199711
+        throw std::out_of_range("BinReader out of range read");
+#else
+        std::abort();
+#endif
+      }
+      if (status == detail::VarintStatus::malformed)
+      {
+        return "Malformed varint";
+      }
+      mCurrentIndex += numBytes;
+      return {numBytes};
+    }
+
+    /// Copy the next `bytes.size()` bytes into `bytes`
+    constexpr Success readBytes(std::span<std::byte> bytes)
+    {
+      std::span<const std::byte> view;
+      Success result = viewBytes(bytes.size(), view);
+      std::copy(std::begin(view), std::end(view), std::begin(bytes));
+      return result;
+    }
+
+    /// Give access to the next `numBytes` bytes without copying them
+    constexpr Success viewBytes(size_t numBytes, std::span<const std::byte> &bytes)
+    {
+      if (numBytes > mSpan.size() - mCurrentIndex)
+      {
+#if __cpp_exceptions >= 199711
+        throw std::out_of_range("BinReader out of range read");
+#else
+        std::abort();
+#endif
+      }
+      bytes = mSpan.subspan(mCurrentIndex, numBytes);
+      mCurrentIndex += numBytes;
+      return {numBytes};
+    }
+
+    /// Skip the padding up to the next multiple of `alignment` from the start of the data
+    constexpr Success alignTo(size_t alignment)
+    {
+      const size_t padding = detail::alignmentPadding(mCurrentIndex, alignment);
+      if (padding > mSpan.size() - mCurrentIndex)
+      {
+#if __cpp_exceptions >= 199711
+        throw std::out_of_range("BinReader out of range read");
+#else
+        std::abort();
+#endif
+      }
+      mCurrentIndex += padding;
+      return {padding};
+    }
+
     /// Skip the size hint only - reads and discards the size prefix
     /// Used for forward compatibility when deserializing a known variant index
     constexpr Success skipHint()
@@ -90,6 +381,60 @@ namespace enki
       return {sizeof(SizeType) + size};
     }
 
+    /// Read skippable content with `readContent`: the dictionary strings and shared objects it
+    /// adds are dropped at its end, like the writer drops their ids, so that they are numbered
+    /// the same whether the content was skipped or read. Writers only scope shared objects
+    /// with the `forward_compatible` policy.
+    template <typename ReadFunc>
+    constexpr Success readScoped(ReadFunc &&readContent)
+    {
+      const size_t numObjects = mObjectTable.size();
+      const auto dropObjects = [&] {
+        if constexpr (has_policy_v<Policy, forward_compatible_t>)
+        {
+          mObjectTable.truncate(numObjects);
+        }
+      };
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        const size_t numStrings = stringTable().size();
+        const Success result = readContent();
+        stringTable().truncate(numStrings);
+        dropObjects();
+        return result;
+      }
+      else
+      {
+        const Success result = readContent();
+        dropObjects();
+        return result;
+      }
+    }
+
+    /// Read content written by `writeIsolated` with `readContent`: its dictionary strings and
+    /// shared objects are numbered from 0, apart from the ones read before
+    template <typename ReadFunc>
+    constexpr Success readIsolated(ReadFunc &&readContent)
+    {
+      detail::ObjectTable objects;
+      std::swap(objects, mObjectTable);
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        detail::StringTable strings;
+        std::swap(strings, stringTable());
+        const Success result = readContent();
+        std::swap(strings, stringTable());
+        std::swap(objects, mObjectTable);
+        return result;
+      }
+      else
+      {
+        const Success result = readContent();
+        std::swap(objects, mObjectTable);
+        return result;
+      }
+    }
+
     constexpr Success arrayBegin() const
     {
       return {};
@@ -107,9 +452,36 @@ namespace enki
 
     constexpr Success rangeBegin(size_t &numElements)
     {
-      SizeType temp{};
-      auto ret = read(temp);
-      numElements = temp;
+      if constexpr (has_policy_v<Policy, chunked_t>)
+      {
+        bool isLast = true;
+        Success ret = rangeChunk(numElements, isLast);
+        if (ret && !isLast)
+        {
+          return "Range is split in chunks where a single length is expected";
+        }
+        return ret;
+      }
+      else
+      {
+        SizeType temp{};
+        auto ret = read(temp);
+        numElements = temp;
+        return ret;
+      }
+    }
+
+    /// Chunked policy: read the header of the next chunk of a range
+    constexpr Success rangeChunk(size_t &numElements, bool &isLast)
+      requires has_policy_v<Policy, chunked_t>
+    {
+      uint64_t header = 0;
+      Success ret = readVarint(header);
+      if (ret)
+      {
+        numElements = detail::rangeChunkSize(header);
+        isLast = !detail::rangeChunkHasMore(header);
+      }
       return ret;
     }
 
@@ -153,8 +525,23 @@ namespace enki
       return mSpan.size() - mCurrentIndex;
     }
 
+    /// Strings read so far with the dictionary policy, by id
+    /// The views point into the input buffer, or into the session if any
+    std::span<const std::string_view> dictionary() const noexcept
+      requires has_policy_v<Policy, dictionary_t>
+    {
+      return mSession != nullptr ? mSession->stringTable().entries() : mStringTable.entries();
+    }
+
+    /// Session shared with other readers, if any
+    BinReaderSession *session() const noexcept
+    {
+      return mSession;
+    }
+
     /// Read variant index from binary format
-    constexpr Success readVariantIndex(SizeType &index)
+    template <std::unsigned_integral IndexType>
+    constexpr Success readVariantIndex(IndexType &index)
     {
       return read(index);
     }
@@ -178,8 +565,41 @@ namespace enki
     }
 
   private:
+    template <typename T>
+    Success viewAligned(size_t numBytes, std::span<const std::byte> &bytes)
+    {
+      if constexpr (concepts::custom_static_serializable<T>)
+      {
+        if (!detail::hasMatchingLayout<T>())
+        {
+          return "Struct members are not laid out in their registration order";
+        }
+      }
+      if (reinterpret_cast<std::uintptr_t>(mSpan.data() + mCurrentIndex) % alignof(T) != 0)
+      {
+        return "Aligned data is misaligned in memory";
+      }
+      return viewBytes(numBytes, bytes);
+    }
+
+    detail::StringTable &stringTable() noexcept
+    {
+      return mSession != nullptr ? mSession->stringTable() : mStringTable;
+    }
+
+    constexpr Success readStringView(uint64_t size, std::string_view &str)
+    {
+      std::span<const std::byte> bytes;
+      Success result = viewBytes(size, bytes);
+      str = {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+      return result;
+    }
+
     std::span<const std::byte> mSpan;
     size_t mCurrentIndex{};
+    [[no_unique_address]] detail::string_table_t<Policy> mStringTable;
+    detail::ObjectTable mObjectTable;
+    BinReaderSession *mSession = nullptr;
   };
 
   template <policy Policy = strict_t, typename SizeType = uint32_t>
@@ -203,7 +623,21 @@ namespace enki
       static_cast<BinSpanReader<Policy, SizeType> &>(*this) = {mData};
     }
 
+    /// Reader sharing its dictionary and schemas with the other readers of `session`
+    BinReader(Policy policy, std::span<const std::byte> data, BinReaderSession &session) :
+      BinSpanReader<Policy, SizeType>({}),
+      mData(std::begin(data), std::end(data))
+    {
+      static_cast<BinSpanReader<Policy, SizeType> &>(*this) = {policy, mData, session};
+    }
+
     using BinSpanReader<Policy, SizeType>::read;
+    using BinSpanReader<Policy, SizeType>::readShared;
+    using BinSpanReader<Policy, SizeType>::readVarint;
+    using BinSpanReader<Policy, SizeType>::readBytes;
+    using BinSpanReader<Policy, SizeType>::viewBytes;
+    using BinSpanReader<Policy, SizeType>::alignTo;
+    using BinSpanReader<Policy, SizeType>::viewValue;
     using BinSpanReader<Policy, SizeType>::skipHint;
     using BinSpanReader<Policy, SizeType>::skipHintAndValue;
     using BinSpanReader<Policy, SizeType>::readVariantIndex;
@@ -211,21 +645,41 @@ namespace enki
     using BinSpanReader<Policy, SizeType>::readOptionalHasValue;
     using BinSpanReader<Policy, SizeType>::finishOptional;
 
+    /// Views would point into the copy of the data owned by this reader and dangle with it:
+    /// read them with a `BinSpanReader` viewing data which outlives them
+    Success read(std::string_view &)
+      requires(!has_policy_v<Policy, dictionary_t>)
+    = delete;
+    Success read(std::string_view &)
+      requires has_policy_v<Policy, dictionary_t>
+    = delete;
+    template <typename T>
+      requires has_policy_v<Policy, aligned_t> && detail::aligned_value<T, Policy> &&
+               (!std::same_as<T, bool>)
+    Success read(std::span<const T> &) = delete;
+    template <typename T>
+      requires has_policy_v<Policy, aligned_t> && detail::aligned_value<T, Policy> &&
+               (!std::same_as<T, bool>)
+    Success viewValue(const T *&) = delete;
+
   private:
     std::vector<std::byte> mData;
   };
 
   // Deduction guides for BinSpanReader
   BinSpanReader(std::span<const std::byte>) -> BinSpanReader<strict_t, uint32_t>;
-  BinSpanReader(strict_t, std::span<const std::byte>) -> BinSpanReader<strict_t, uint32_t>;
-  BinSpanReader(forward_compatible_t, std::span<const std::byte>)
-    -> BinSpanReader<forward_compatible_t, uint32_t>;
+  template <policy Policy>
+  BinSpanReader(Policy, std::span<const std::byte>) -> BinSpanReader<Policy, uint32_t>;
+  template <policy Policy>
+  BinSpanReader(Policy, std::span<const std::byte>, BinReaderSession &)
+    -> BinSpanReader<Policy, uint32_t>;
 
   // Deduction guides for BinReader
   BinReader(std::span<const std::byte>) -> BinReader<strict_t, uint32_t>;
-  BinReader(strict_t, std::span<const std::byte>) -> BinReader<strict_t, uint32_t>;
-  BinReader(forward_compatible_t, std::span<const std::byte>)
-    -> BinReader<forward_compatible_t, uint32_t>;
+  template <policy Policy>
+  BinReader(Policy, std::span<const std::byte>) -> BinReader<Policy, uint32_t>;
+  template <policy Policy>
+  BinReader(Policy, std::span<const std::byte>, BinReaderSession &) -> BinReader<Policy, uint32_t>;
 } // namespace enki
 
 #endif // ENKI_BIN_READER_HPP
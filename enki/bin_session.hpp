@@ -0,0 +1,121 @@
+#ifndef ENKI_BIN_SESSION_HPP
+#define ENKI_BIN_SESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "enki/impl/string_dictionary.hpp"
+
+namespace enki
+{
+  /// State shared by the binary writers of a batch of messages: with the dictionary policy,
+  /// strings written by one message are referred to by id in the following ones, and
+  /// `writeSchema` writes each descriptor once per session.
+  /// Each message keeps its own buffer, but they must be read in order, with one
+  /// `BinReaderSession`. Writers using a session must not be used concurrently.
+  /// Usage:
+  ///   enki::BinWriterSession session;
+  ///   enki::BinWriter writer(enki::dictionary, session);
+  class BinWriterSession
+  {
+  public:
+    /// Strings written so far by the writers of the session
+    detail::StringIds &stringIds() noexcept
+    {
+      return mStringIds;
+    }
+
+    /// Returns true and sets `id` if `descriptor` was already written in the session.
+    /// Descriptors are compile-time constants (`schema_v`), identified by their address.
+    bool findSchema(std::span<const std::byte> descriptor, uint64_t &id) const
+    {
+      const auto it = mSchemaIds.find(descriptor.data());
+      if (it == mSchemaIds.end())
+      {
+        return false;
+      }
+      id = it->second;
+      return true;
+    }
+
+    /// Give `descriptor` the next schema id
+    void addSchema(std::span<const std::byte> descriptor)
+    {
+      mSchemaIds.emplace(descriptor.data(), mSchemaIds.size());
+    }
+
+    /// Forget all the strings and schemas, for instance when starting a new stream
+    void clear() noexcept
+    {
+      mStringIds.clear();
+      mSchemaIds.clear();
+    }
+
+  private:
+    detail::StringIds mStringIds;
+    std::unordered_map<const std::byte *, uint64_t> mSchemaIds;
+  };
+
+  /// State shared by the binary readers of a batch of messages written with a
+  /// `BinWriterSession`. Strings and schemas are copied into the session so that they outlive
+  /// the buffer of the message that introduced them.
+  /// Usage:
+  ///   enki::BinReaderSession session;
+  ///   enki::BinSpanReader reader(enki::dictionary, message, session);
+  class BinReaderSession
+  {
+  public:
+    /// Strings read so far by the readers of the session, viewing the session storage
+    detail::StringTable &stringTable() noexcept
+    {
+      return mStringTable;
+    }
+
+    /// Copy `str` into the session and give it the next string id
+    /// Returns a view of the copy
+    std::string_view addString(std::string_view str)
+    {
+      const std::string_view stored = mStrings.emplace_back(str);
+      mStringTable.add(stored);
+      return stored;
+    }
+
+    /// Returns false if no schema was added with `id`
+    bool getSchema(uint64_t id, std::span<const std::byte> &descriptor) const noexcept
+    {
+      if (id >= mSchemas.size())
+      {
+        return false;
+      }
+      descriptor = mSchemas[id];
+      return true;
+    }
+
+    /// Copy `descriptor` into the session and give it the next schema id
+    void addSchema(std::span<const std::byte> descriptor)
+    {
+      mSchemas.emplace_back(descriptor.begin(), descriptor.end());
+    }
+
+    /// Forget all the strings and schemas, invalidating the views handed out
+    void clear() noexcept
+    {
+      mStringTable.clear();
+      mStrings.clear();
+      mSchemas.clear();
+    }
+
+  private:
+    detail::StringTable mStringTable;
+    std::deque<std::string> mStrings; // Stable addresses for the views of `mStringTable`
+    std::vector<std::vector<std::byte>> mSchemas;
+  };
+} // namespace enki
+
+#endif // ENKI_BIN_SESSION_HPP
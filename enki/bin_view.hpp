@@ -0,0 +1,225 @@
+#ifndef ENKI_BIN_VIEW_HPP
+#define ENKI_BIN_VIEW_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "enki/bin_reader.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/fixed_size.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/presence_bitmap.hpp"
+#include "enki/impl/skip.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Member offsets known at compile time: the ones of the first member and of each member
+    /// following only members of fixed size
+    template <size_t NumMembers>
+    struct FixedOffsets
+    {
+      std::array<size_t, NumMembers + 1> offsets{};
+      size_t count = 1;
+    };
+
+    template <typename T, typename Policy, size_t... idx>
+    constexpr auto fixedMemberOffsets(std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      FixedOffsets<sizeof...(idx)> fixed;
+      const auto placeOne = [&fixed]<typename M>() {
+        constexpr size_t size = fixedSize<std::remove_cvref_t<M>, Policy>();
+        if (size == kVariableSize)
+        {
+          return false;
+        }
+        fixed.offsets[fixed.count] = fixed.offsets[fixed.count - 1] + size;
+        ++fixed.count;
+        return true;
+      };
+      static_cast<void>(
+        (placeOne.template operator()<typename get_nth_register_t<idx, Members>::value_type>() &&
+         ...));
+      return fixed;
+    }
+
+    /// Registered structs written member after member, with no leading tag or bitmap
+    template <typename T, typename Policy>
+    concept viewable_struct =
+      concepts::custom_static_serializable<T> && !has_policy_v<Policy, forward_compatible_t> &&
+      !has_policy_v<Policy, dictionary_t> &&
+      !(has_policy_v<Policy, presence_bitmap_t> && optional_member_count_v<T> > 0) &&
+      !(has_policy_v<Policy, aligned_t> && aligned_struct<T, Policy>);
+  } // namespace detail
+
+  /// Read-only view of a registered struct serialized in `data`, decoding each member only
+  /// when it is accessed. Members following only members of fixed size are found at offsets
+  /// computed at compile time. The offsets of the other ones are found by skipping the members
+  /// before them once, reading only their lengths, and are then cached in the view.
+  ///
+  /// Views are cheap to copy but not thread safe. Dictionary strings and tagged structs are not
+  /// supported, and shared objects only when they are not references to earlier ones:
+  ///   enki::BinView<Order> view(bytes);
+  ///   const auto price = view.get<&Order::price>();
+  template <typename T, policy Policy = strict_t, typename SizeType = uint32_t>
+    requires detail::viewable_struct<T, Policy>
+  class BinView
+  {
+    using Members = typename T::EnkiSerial::Members;
+    using Reader = BinSpanReader<Policy, SizeType>;
+
+    static constexpr auto kFixedOffsets =
+      detail::fixedMemberOffsets<T, Policy>(std::make_index_sequence<Members::count>());
+
+  public:
+    using policy_type = Policy; // NOLINT
+    using size_type = SizeType; // NOLINT
+
+    /// Type of the member registered as `member`
+    template <auto member>
+    using member_type = std::remove_cvref_t< // NOLINT
+      typename detail::get_nth_register_t<detail::registered_index_v<T, member>, Members>::
+        value_type>;
+
+    BinView(std::span<const std::byte> data) :
+      mData(data)
+    {
+    }
+
+    explicit BinView(Policy, std::span<const std::byte> data) :
+      mData(data)
+    {
+    }
+
+    /// Decode the member registered as `member` (`&T::field`) into `value`
+    template <auto member>
+    Success get(member_type<member> &value) const
+    {
+      Reader reader(mData);
+      Success isGood = moveTo<detail::registered_index_v<T, member>>(reader);
+      return isGood ? deserialize(value, reader) : isGood;
+    }
+
+#if __cpp_exceptions >= 199711
+    /// Decode the member registered as `member` (`&T::field`), throwing on malformed data
+    template <auto member>
+    member_type<member> get() const
+    {
+      member_type<member> value{};
+      get<member>(value).or_throw();
+      return value;
+    }
+#endif
+
+    /// View of the registered struct member registered as `member`, decoded on demand as well
+    template <auto member>
+    Success view(BinView<member_type<member>, Policy, SizeType> &memberView) const
+    {
+      Reader reader(mData);
+      Success isGood = moveTo<detail::registered_index_v<T, member>>(reader);
+      if (isGood)
+      {
+        memberView = BinView<member_type<member>, Policy, SizeType>(
+          mData, mData.size() - reader.remainingBytes());
+      }
+      return isGood;
+    }
+
+#if __cpp_exceptions >= 199711
+    /// View of the registered struct member registered as `member`, throwing on malformed data
+    template <auto member>
+    BinView<member_type<member>, Policy, SizeType> view() const
+    {
+      BinView<member_type<member>, Policy, SizeType> memberView(mData, 0);
+      view<member>(memberView).or_throw();
+      return memberView;
+    }
+#endif
+
+  private:
+    template <typename U, policy P, typename S>
+      requires detail::viewable_struct<U, P>
+    friend class BinView;
+
+    /// View of the struct starting at `base` in `data`: padding still follows the position in
+    /// the whole buffer
+    BinView(std::span<const std::byte> data, size_t base) :
+      mData(data),
+      mBase(base)
+    {
+    }
+
+    template <size_t index>
+    Success moveTo(Reader &reader) const
+    {
+      static_assert(index < Members::count, "Member is not registered in T::EnkiSerial::Members");
+      if constexpr (index < kFixedOffsets.count)
+      {
+        return detail::skipBytes(mBase + kFixedOffsets.offsets[index], reader);
+      }
+      else
+      {
+        size_t offset = 0;
+        Success isGood = findOffset(index, offset);
+        return isGood ? detail::skipBytes(mBase + offset, reader) : isGood;
+      }
+    }
+
+    /// Skip the members whose offset is not known yet, up to member `index`
+    Success findOffset(size_t index, size_t &offset) const
+    {
+      if (mNumOffsets <= index)
+      {
+        Reader reader(mData);
+        Success isGood = detail::skipBytes(mBase + mOffsets[mNumOffsets - 1], reader);
+        while (isGood && mNumOffsets <= index)
+        {
+          if (isGood.update(
+                skipMember(mNumOffsets - 1, reader, std::make_index_sequence<Members::count>())))
+          {
+            mOffsets[mNumOffsets++] = mData.size() - reader.remainingBytes() - mBase;
+          }
+        }
+        if (!isGood)
+        {
+          return isGood;
+        }
+      }
+      offset = mOffsets[index];
+      return {};
+    }
+
+    template <size_t... idx>
+    static Success skipMember(size_t index, Reader &reader, std::index_sequence<idx...>)
+    {
+      Success isGood;
+      const auto skipOne = [&]<typename Reg>() {
+        isGood = detail::skipTyped<std::remove_cvref_t<typename Reg::value_type>>(reader);
+        return true;
+      };
+      static_cast<void>(
+        ((idx == index &&
+          skipOne.template operator()<detail::get_nth_register_t<idx, Members>>()) ||
+         ...));
+      return isGood;
+    }
+
+    std::span<const std::byte> mData;
+    size_t mBase = 0;
+    mutable std::array<size_t, Members::count + 1> mOffsets = kFixedOffsets.offsets;
+    mutable size_t mNumOffsets = kFixedOffsets.count;
+  };
+} // namespace enki
+
+#endif // ENKI_BIN_VIEW_HPP
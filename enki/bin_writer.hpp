@@ -2,10 +2,15 @@
 #define ENKI_BIN_WRITER_HPP
 
 #include <algorithm>
+#include <array>
 #include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <span>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -16,9 +21,16 @@
 #endif
 
 #include "enki/bin_probe.hpp"
+#include "enki/bin_session.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
 #include "enki/impl/concepts.hpp"
 #include "enki/impl/policies.hpp"
+#include "enki/impl/shared_objects.hpp"
+#include "enki/impl/string_dictionary.hpp"
 #include "enki/impl/success.hpp"
+#include "enki/impl/varint.hpp"
 
 namespace enki
 {
@@ -33,17 +45,102 @@ namespace enki
       template <concepts::arithmetic_or_enum T>
       constexpr Success write(const T &v)
       {
-        const auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(v);
+        if constexpr (detail::is_compact_enum_v<typename Child::policy_type, T>)
+        {
+          return write(detail::toCompactEnum(v));
+        }
+        else
+        {
+          Success result;
+          if constexpr (has_policy_v<typename Child::policy_type, aligned_t>)
+          {
+            result = alignTo(alignof(T));
+          }
+          const auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(v);
+          std::copy(
+            std::begin(bytes),
+            std::end(bytes),
+            static_cast<Child *>(this)->getBackInserter(sizeof(T)));
+          return result.update(sizeof(T));
+        }
+      }
+
+      constexpr Success write(const std::monostate &)
+      {
+        return {}; // No bytes written for monostate in binary format
+      }
+
+      /// Dictionary policy: new strings are written once, repeats as a reference to their id
+      template <concepts::string_like S>
+        requires has_policy_v<typename Child::policy_type, dictionary_t>
+      constexpr Success write(const S &str)
+      {
+        auto &ids = static_cast<Child *>(this)->stringIds();
+        const std::string_view view(str);
+        uint64_t id = 0;
+        if (ids.find(view, id))
+        {
+          return writeVarint(detail::dictionaryReferenceTag(id));
+        }
+        ids.insert(view);
+        Success result = writeVarint(detail::dictionaryLiteralTag(view.size(), true));
+        return result.update(writeBytes(std::as_bytes(std::span(view))));
+      }
+
+      /// Shared objects: the first pointer to an object writes it, the next ones its id
+      /// With `forward_compatible` the value is preceded by its size, for readers skipping it
+      template <typename T, typename ValueFunc>
+      constexpr Success writeShared(const std::shared_ptr<T> &object, ValueFunc &&writeValue)
+      {
+        if (!object)
+        {
+          return writeVarint(detail::kNullObjectTag);
+        }
+        auto &ids = static_cast<Child *>(this)->objectIds();
+        uint64_t id = 0;
+        if (ids.find(object, id))
+        {
+          return writeVarint(detail::objectReferenceTag(id));
+        }
+        const bool isInserted = ids.insert(object);
+        Success result = writeVarint(detail::objectLiteralTag(isInserted));
+        if constexpr (has_policy_v<typename Child::policy_type, forward_compatible_t>)
+        {
+          return result.update(writeSkippable(writeValue));
+        }
+        else
+        {
+          return result.update(writeValue(*static_cast<Child *>(this)));
+        }
+      }
+
+      /// Write an unsigned integer as a LEB128 varint (1 byte below 128, up to 10 bytes)
+      constexpr Success writeVarint(uint64_t v)
+      {
+        std::array<std::byte, detail::kMaxVarintSize> bytes{};
+        const size_t numBytes = detail::encodeVarint(v, bytes.data());
+        std::copy_n(
+          std::begin(bytes), numBytes, static_cast<Child *>(this)->getBackInserter(numBytes));
+        return {numBytes};
+      }
+
+      /// Write raw bytes as they are
+      constexpr Success writeBytes(std::span<const std::byte> bytes)
+      {
         std::copy(
           std::begin(bytes),
           std::end(bytes),
-          static_cast<Child *>(this)->getBackInserter(sizeof(T)));
-        return {sizeof(T)};
+          static_cast<Child *>(this)->getBackInserter(bytes.size()));
+        return {bytes.size()};
       }
 
-      constexpr Success write(const std::monostate &)
+      /// Write zeros up to the next multiple of `alignment` from the start of the data
+      constexpr Success alignTo(size_t alignment)
       {
-        return {}; // No bytes written for monostate in binary format
+        auto &child = *static_cast<Child *>(this);
+        const size_t padding = detail::alignmentPadding(child.writtenSize(), alignment);
+        std::fill_n(child.getBackInserter(padding), padding, std::byte{});
+        return {padding};
       }
 
       constexpr Success arrayBegin() const
@@ -61,9 +158,36 @@ namespace enki
         return {};
       }
 
+      /// Write the length prefix of a range (of its last chunk with the chunked policy)
       constexpr Success rangeBegin(size_t numElements)
       {
-        return write(static_cast<typename Child::size_type>(numElements));
+        using size_type = typename Child::size_type; // NOLINT
+        if constexpr (has_policy_v<typename Child::policy_type, chunked_t>)
+        {
+          if (!detail::fitsInRangeChunkHeader(numElements))
+          {
+            return "Range is too large for its size prefix";
+          }
+          return writeVarint(detail::rangeChunkHeader(numElements, false));
+        }
+        else
+        {
+          if constexpr (sizeof(size_type) < sizeof(size_t))
+          {
+            if (numElements > std::numeric_limits<size_type>::max())
+            {
+              return "Range is too large for its size prefix";
+            }
+          }
+          return write(static_cast<size_type>(numElements));
+        }
+      }
+
+      /// Chunked policy: start a chunk of `numElements` elements that more chunks follow
+      constexpr Success rangeChunk(size_t numElements)
+        requires has_policy_v<typename Child::policy_type, chunked_t>
+      {
+        return writeVarint(detail::rangeChunkHeader(numElements, true));
       }
 
       constexpr Success rangeEnd() const
@@ -112,13 +236,150 @@ namespace enki
         }
         return flagResult;
       }
+
+      /// Write skippable content with size prefix, for forward compatibility and indexed ranges
+      /// The content is written once, after a placeholder size patched afterwards. This keeps
+      /// stateful encodings (such as the string dictionary) consistent with the size written.
+      template <typename WriteFunc>
+      constexpr Success writeSkippable(WriteFunc &&writeContent)
+      {
+        using size_type = typename Child::size_type; // NOLINT
+
+        auto &child = *static_cast<Child *>(this);
+
+        // Write size placeholder
+        Success result = write(size_type{});
+        if (!result)
+        {
+          return result;
+        }
+        const size_t sizeOffset = child.writtenSize() - sizeof(size_type);
+
+        // Write actual data
+        const Success content = writeSkippableContent(sizeOffset, writeContent);
+        if (!content)
+        {
+          return content;
+        }
+        if constexpr (sizeof(size_type) < sizeof(size_t))
+        {
+          if (content.size() > std::numeric_limits<size_type>::max())
+          {
+            return "Skippable content is too large for its size prefix";
+          }
+        }
+
+        // Patch size prefix
+        const auto sizeBytes =
+          std::bit_cast<std::array<std::byte, sizeof(size_type)>>(
+            static_cast<size_type>(content.size()));
+        child.overwrite(sizeOffset, sizeBytes);
+        return result.update(content);
+      }
+
+      /// Write skippable content preceded by its size as a varint, for the sized fields of
+      /// tagged structs. The placeholder is a single byte: once the size is known, the bytes it
+      /// needs beyond that are inserted after it. Tagged structs are not used with the `aligned`
+      /// policy, whose alignment padding in the content would be moved by the insertion.
+      template <typename WriteFunc>
+      constexpr Success writeSized(WriteFunc &&writeContent)
+      {
+        using size_type = typename Child::size_type; // NOLINT
+
+        auto &child = *static_cast<Child *>(this);
+        writeVarint(0); // Size placeholder
+        const size_t sizeOffset = child.writtenSize() - 1;
+        const Success content = writeSkippableContent(sizeOffset, writeContent);
+        if (!content)
+        {
+          return content;
+        }
+        if constexpr (sizeof(size_type) < sizeof(size_t))
+        {
+          if (content.size() > std::numeric_limits<size_type>::max())
+          {
+            return "Skippable content is too large for its size prefix";
+          }
+        }
+
+        std::array<std::byte, detail::kMaxVarintSize> sizeBytes{};
+        const size_t numBytes = detail::encodeVarint(content.size(), sizeBytes.data());
+        if (numBytes > 1)
+        {
+          child.insertBytes(sizeOffset + 1, numBytes - 1);
+        }
+        child.overwrite(sizeOffset, std::span(sizeBytes).first(numBytes));
+        return {numBytes + content.size()};
+      }
+
+      /// Write content decodable on its own, such as the elements of indexed ranges: its
+      /// dictionary strings and shared objects are numbered from 0 and do not refer to the ones
+      /// written before
+      template <typename WriteFunc>
+      constexpr Success writeIsolated(WriteFunc &&writeContent)
+      {
+        using Policy = typename Child::policy_type; // NOLINT
+
+        auto &child = *static_cast<Child *>(this);
+        if constexpr (has_policy_v<Policy, dictionary_t>)
+        {
+          child.stringIds().beginIsolated();
+        }
+        child.objectIds().beginIsolated();
+        const Success content = writeContent(child);
+        child.objectIds().endIsolated();
+        if constexpr (has_policy_v<Policy, dictionary_t>)
+        {
+          child.stringIds().endIsolated();
+        }
+        return content;
+      }
+
+    private:
+      /// Write the content of a size placeholder at `sizeOffset`, with the dictionary strings
+      /// and shared objects it adds forgotten by readers skipping it
+      template <typename WriteFunc>
+      constexpr Success writeSkippableContent(size_t sizeOffset, WriteFunc &&writeContent)
+      {
+        using Policy = typename Child::policy_type; // NOLINT
+
+        auto &child = *static_cast<Child *>(this);
+        if constexpr (has_policy_v<Policy, dictionary_t>)
+        {
+          child.stringIds().beginSkippable();
+        }
+        if constexpr (has_policy_v<Policy, forward_compatible_t>)
+        {
+          child.objectIds().beginSkippable();
+        }
+        if constexpr (requires { child.holdOutput(sizeOffset); })
+        {
+          // Writers streaming their output keep the placeholder until it is patched
+          child.holdOutput(sizeOffset);
+        }
+        const Success content = writeContent(child);
+        if constexpr (requires { child.releaseOutput(); })
+        {
+          child.releaseOutput();
+        }
+        if constexpr (has_policy_v<Policy, forward_compatible_t>)
+        {
+          child.objectIds().endSkippable();
+        }
+        if constexpr (has_policy_v<Policy, dictionary_t>)
+        {
+          child.stringIds().endSkippable();
+        }
+        return content;
+      }
     };
 
     template <typename Policy, typename Child>
     class BinWriterInterface;
 
-    template <typename Child>
-    class BinWriterInterface<strict_t, Child> : public BinWriterBase<Child>
+    template <typename Policy, typename Child>
+      requires(!has_policy_v<Policy, forward_compatible_t>)
+    class BinWriterInterface<Policy, Child> : public BinWriterBase<Child>
     {
     public:
       /// Write a variant: index + value (with size prefix if forward_compatible)
@@ -137,36 +398,11 @@ namespace enki
       }
     };
 
-    template <typename Child>
-    class BinWriterInterface<forward_compatible_t, Child> : public BinWriterBase<Child>
+    template <typename Policy, typename Child>
+      requires has_policy_v<Policy, forward_compatible_t>
+    class BinWriterInterface<Policy, Child> : public BinWriterBase<Child>
     {
     public:
-      /// Write skippable content with size prefix for forward compatibility
-      template <typename WriteFunc>
-      constexpr Success writeSkippable(WriteFunc &&writeContent)
-      {
-        // Probe phase to calculate size
-        typename Child::probe_type probe;
-        Success probeResult = writeContent(probe);
-        if (!probeResult)
-        {
-          return probeResult;
-        }
-
-        using size_type = typename Child::size_type; // NOLINT
-        using parent_type = BinWriterBase<Child>;    // NOLINT
-
-        // Write size prefix
-        Success result = parent_type::write(static_cast<size_type>(probeResult.size()));
-        if (!result)
-        {
-          return result;
-        }
-
-        // Write actual data
-        return result.update(writeContent(*static_cast<Child *>(this)));
-      }
-
       /// Write a variant: index + value (with size prefix if forward_compatible)
       template <typename IndexFunc, typename ValueFunc>
       constexpr Success writeVariant(IndexFunc &&writeIndex, ValueFunc &&writeValue)
@@ -178,7 +414,7 @@ namespace enki
         }
 
         // Forward compatible: wrap value with size prefix
-        Success valueResult = writeSkippable([&](auto &w) { return writeValue(w); });
+        Success valueResult = this->writeSkippable([&](auto &w) { return writeValue(w); });
         return {indexResult.size() + valueResult.size()};
       }
     };
@@ -206,6 +442,12 @@ namespace enki
     {
     }
 
+    /// Writer sharing its dictionary and schemas with the other writers of `session`
+    BinWriter(Policy, BinWriterSession &session) :
+      mSession(&session)
+    {
+    }
+
     const std::vector<std::byte> &data() const
     {
       return mData;
@@ -221,21 +463,70 @@ namespace enki
       mData.reserve(capacity);
     }
 
+    /// Clear the data, the shared objects and, with the dictionary policy, the strings already
+    /// written. Strings shared through a session are kept: clear the session to forget them.
     void clear()
     {
       mData.clear();
+      mObjectIds.clear();
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        mStringIds.clear();
+      }
+    }
+
+    /// Session shared with other writers, if any
+    BinWriterSession *session() const noexcept
+    {
+      return mSession;
     }
 
   protected:
     friend detail::BinWriterBase<BinWriter<Policy, SizeType, Probe>>;
+    friend detail::BinWriterInterface<Policy, BinWriter<Policy, SizeType, Probe>>;
 
     auto getBackInserter(size_t)
     {
       return std::back_inserter(mData);
     }
 
+    size_t writtenSize() const
+    {
+      return mData.size();
+    }
+
+    void overwrite(size_t offset, std::span<const std::byte> bytes)
+    {
+      std::copy(std::begin(bytes), std::end(bytes), mData.begin() + static_cast<ptrdiff_t>(offset));
+    }
+
+    void insertBytes(size_t offset, size_t count)
+    {
+      mData.insert(mData.begin() + static_cast<ptrdiff_t>(offset), count, std::byte{});
+    }
+
+    detail::string_ids_t<Policy> &stringIds()
+    {
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        if (mSession != nullptr)
+        {
+          return mSession->stringIds();
+        }
+      }
+      return mStringIds;
+    }
+
+    detail::object_ids_t<Policy> &objectIds()
+    {
+      return mObjectIds;
+    }
+
   private:
     std::vector<std::byte> mData;
+    [[no_unique_address]] detail::string_ids_t<Policy> mStringIds;
+    detail::object_ids_t<Policy> mObjectIds;
+    BinWriterSession *mSession = nullptr;
   };
 
   template <
@@ -264,13 +555,27 @@ namespace enki
     {
     }
 
+    /// Writer sharing its dictionary and schemas with the other writers of `session`
+    BinSpanWriter(Policy, std::span<std::byte> byteSpan, BinWriterSession &session) :
+      mDataSpan(byteSpan),
+      mSession(&session)
+    {
+    }
+
     std::span<const std::byte> data() const
     {
       return mDataSpan.subspan(0, mCurrentSize);
     }
 
+    /// Session shared with other writers, if any
+    BinWriterSession *session() const noexcept
+    {
+      return mSession;
+    }
+
   protected:
     friend detail::BinWriterBase<BinSpanWriter<Policy, SizeType, Probe>>;
+    friend detail::BinWriterInterface<Policy, BinSpanWriter<Policy, SizeType, Probe>>;
 
     auto getBackInserter(size_t writeSize)
     {
@@ -290,21 +595,66 @@ namespace enki
       return ret;
     }
 
+    size_t writtenSize() const
+    {
+      return mCurrentSize;
+    }
+
+    void overwrite(size_t offset, std::span<const std::byte> bytes)
+    {
+      std::copy(
+        std::begin(bytes), std::end(bytes), mDataSpan.begin() + static_cast<ptrdiff_t>(offset));
+    }
+
+    void insertBytes(size_t offset, size_t count)
+    {
+      const size_t end = mCurrentSize;
+      getBackInserter(count);
+      std::copy_backward(
+        mDataSpan.begin() + static_cast<ptrdiff_t>(offset),
+        mDataSpan.begin() + static_cast<ptrdiff_t>(end),
+        mDataSpan.begin() + static_cast<ptrdiff_t>(end + count));
+    }
+
+    detail::string_ids_t<Policy> &stringIds()
+    {
+      if constexpr (has_policy_v<Policy, dictionary_t>)
+      {
+        if (mSession != nullptr)
+        {
+          return mSession->stringIds();
+        }
+      }
+      return mStringIds;
+    }
+
+    detail::object_ids_t<Policy> &objectIds()
+    {
+      return mObjectIds;
+    }
+
   private:
     std::span<std::byte> mDataSpan;
     size_t mCurrentSize = 0;
+    [[no_unique_address]] detail::string_ids_t<Policy> mStringIds;
+    detail::object_ids_t<Policy> mObjectIds;
+    BinWriterSession *mSession = nullptr;
   };
 
   // Deduction guides for BinWriter
   BinWriter() -> BinWriter<strict_t, uint32_t>;
-  BinWriter(strict_t) -> BinWriter<strict_t, uint32_t>;
-  BinWriter(forward_compatible_t) -> BinWriter<forward_compatible_t, uint32_t>;
+  template <policy Policy>
+  BinWriter(Policy) -> BinWriter<Policy, uint32_t>;
+  template <policy Policy>
+  BinWriter(Policy, BinWriterSession &) -> BinWriter<Policy, uint32_t>;
 
   // Deduction guides for BinSpanWriter
   BinSpanWriter(std::span<std::byte>) -> BinSpanWriter<strict_t, uint32_t>;
-  BinSpanWriter(strict_t, std::span<std::byte>) -> BinSpanWriter<strict_t, uint32_t>;
-  BinSpanWriter(forward_compatible_t, std::span<std::byte>)
-    -> BinSpanWriter<forward_compatible_t, uint32_t>;
+  template <policy Policy>
+  BinSpanWriter(Policy, std::span<std::byte>) -> BinSpanWriter<Policy, uint32_t>;
+  template <policy Policy>
+  BinSpanWriter(Policy, std::span<std::byte>, BinWriterSession &)
+    -> BinSpanWriter<Policy, uint32_t>;
 } // namespace enki
 
 #endif // ENKI_BIN_WRITER_HPP
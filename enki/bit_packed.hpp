@@ -0,0 +1,264 @@
+#ifndef ENKI_BIT_PACKED_HPP
+#define ENKI_BIT_PACKED_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/bit_stream.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  /// Range of integers stored with frame-of-reference bit packing.
+  /// Values are split in blocks of 128, each block stores its minimum, a bit width and then every
+  /// value minus the minimum on that many bits. Columns of bounded values (identifiers, counters,
+  /// small categories...) shrink to a few bits per element. Only binary formats are affected, JSON
+  /// keeps writing plain arrays. Blocks are unpacked by kernels specialized for their bit width,
+  /// vectorized for 32 bit values on targets with AVX2 or SSE4.1.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Export, ids, enki::BitPacked<std::vector<uint32_t>>)>
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  class BitPacked : public Range
+  {
+  public:
+    using Range::Range;
+
+    BitPacked() = default;
+
+    BitPacked(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    inline constexpr size_t kBitPackBlockSize = 128; // NOLINT
+
+    /// Order preserving mapping of integers to unsigned keys: signed values get their sign bit
+    /// flipped so that the minimum of the keys is the key of the minimum
+    template <concepts::integer T>
+    constexpr std::make_unsigned_t<T> toOrderedKey(T value)
+    {
+      using U = std::make_unsigned_t<T>;
+      if constexpr (std::is_signed_v<T>)
+      {
+        return static_cast<U>(static_cast<U>(value) ^ (U{1} << (sizeof(T) * 8 - 1)));
+      }
+      else
+      {
+        return value;
+      }
+    }
+
+    template <concepts::integer T>
+    constexpr T fromOrderedKey(std::make_unsigned_t<T> key)
+    {
+      if constexpr (std::is_signed_v<T>)
+      {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(key ^ (U{1} << (sizeof(T) * 8 - 1))));
+      }
+      else
+      {
+        return key;
+      }
+    }
+
+    template <std::unsigned_integral U>
+    struct PackedBlock
+    {
+      std::array<U, kBitPackBlockSize> keys;
+      size_t size;
+      U reference;
+      unsigned width;
+    };
+
+    /// Store `block.keys` minus the block reference on `block.width` bits each
+    template <std::unsigned_integral U>
+    constexpr size_t packBlock(const PackedBlock<U> &block, std::byte *out)
+    {
+      BitWriter bits(out);
+      for (size_t i = 0; i < block.size; ++i)
+      {
+        bits.write(static_cast<U>(block.keys[i] - block.reference), block.width);
+      }
+      return bits.finish();
+    }
+
+    /// Size of `packed` and `block.width` are checked by the caller
+    template <std::unsigned_integral U>
+    constexpr void unpackBlock(std::span<const std::byte> packed, PackedBlock<U> &block)
+    {
+      unpackFields(
+        packed.data(), packed.size(), block.width, block.reference, block.keys.data(), block.size);
+    }
+
+    template <typename It, typename Writer>
+    constexpr Success writePackedBlock(It &first, size_t blockSize, Writer &&w)
+    {
+      using T = typename std::iterator_traits<It>::value_type;
+      using U = std::make_unsigned_t<T>;
+
+      PackedBlock<U> block{};
+      block.size = blockSize;
+      for (size_t i = 0; i < blockSize; ++i, ++first)
+      {
+        block.keys[i] = toOrderedKey<T>(*first);
+      }
+      const auto [minIt, maxIt] = std::minmax_element(
+        std::begin(block.keys), std::begin(block.keys) + static_cast<ptrdiff_t>(blockSize));
+      block.reference = *minIt;
+      block.width = static_cast<unsigned>(std::bit_width(static_cast<U>(*maxIt - *minIt)));
+
+      Success isGood = w.writeVarint(block.reference);
+      if (!isGood.update(w.write(static_cast<uint8_t>(block.width))))
+      {
+        return isGood;
+      }
+      std::array<std::byte, kBitPackBlockSize * sizeof(U)> packed{};
+      const size_t packedSize = packBlock(block, packed.data());
+      return isGood.update(w.writeBytes(std::span<const std::byte>(packed.data(), packedSize)));
+    }
+
+    template <concepts::integer T, typename Reader>
+    constexpr Success readPackedBlock(T *out, size_t blockSize, Reader &&r)
+    {
+      using U = std::make_unsigned_t<T>;
+
+      PackedBlock<U> block{};
+      block.size = blockSize;
+      uint64_t reference = 0;
+      uint8_t width = 0;
+      Success isGood = r.readVarint(reference);
+      if (!isGood || !isGood.update(r.read(width)))
+      {
+        return isGood;
+      }
+      if (reference > std::numeric_limits<U>::max() || width > sizeof(U) * 8)
+      {
+        return isGood.update("Invalid bit packed block header");
+      }
+      block.reference = static_cast<U>(reference);
+      block.width = width;
+
+      std::span<const std::byte> packed;
+      if (!isGood.update(r.viewBytes(bitsToBytes(blockSize * width), packed)))
+      {
+        return isGood;
+      }
+      unpackBlock(packed, block);
+      std::transform(
+        std::begin(block.keys),
+        std::begin(block.keys) + static_cast<ptrdiff_t>(blockSize),
+        out,
+        [](U key) { return fromOrderedKey<T>(key); });
+      return isGood;
+    }
+  } // namespace detail
+
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  struct BitPacked<Range>::EnkiSerial
+  {
+    using value_type = typename Range::value_type; // NOLINT
+
+    template <typename Writer>
+    static constexpr Success serialize(const BitPacked &value, Writer &&w)
+    {
+      if constexpr (concepts::varint_writer<Writer> && concepts::byte_writer<Writer>)
+      {
+        const size_t numElements = detail::rangeSize(value);
+        Success isGood = w.rangeBegin(numElements);
+        auto it = std::begin(value);
+        for (size_t done = 0; done < numElements && isGood; done += detail::kBitPackBlockSize)
+        {
+          isGood.update(detail::writePackedBlock(
+            it, std::min(detail::kBitPackBlockSize, numElements - done), w));
+        }
+        if (isGood)
+        {
+          isGood.update(w.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(BitPacked &value, Reader &&r)
+    {
+      if constexpr (concepts::varint_reader<Reader> && concepts::byte_reader<Reader>)
+      {
+        size_t numElements = 0;
+        Success isGood = r.rangeBegin(numElements);
+        if (!isGood)
+        {
+          return isGood;
+        }
+        // Each block header takes at least 2 bytes
+        const size_t numBlocks =
+          (numElements + detail::kBitPackBlockSize - 1) / detail::kBitPackBlockSize;
+        if (!detail::fitsInRemainingBytes(numBlocks * 2, r))
+        {
+          return isGood.update("Range size exceeds remaining data");
+        }
+
+        const auto readAll = [&](value_type *out) {
+          for (size_t done = 0; done < numElements && isGood; done += detail::kBitPackBlockSize)
+          {
+            isGood.update(detail::readPackedBlock(
+              out + done, std::min(detail::kBitPackBlockSize, numElements - done), r));
+          }
+        };
+
+        if constexpr (std::same_as<Range, std::vector<value_type>>)
+        {
+          value.resize(numElements);
+          readAll(value.data());
+        }
+        else
+        {
+          std::vector<value_type> temp(numElements);
+          readAll(temp.data());
+          if (isGood)
+          {
+            static_cast<Range &>(value) = Range(std::begin(temp), std::end(temp));
+          }
+        }
+
+        if (isGood)
+        {
+          isGood.update(r.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_BIT_PACKED_HPP
@@ -0,0 +1,380 @@
+#ifndef ENKI_COLUMNAR_HPP
+#define ENKI_COLUMNAR_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/bulk.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Ranges of structs registering their members with `enki::Register`
+    template <typename T>
+    concept row_range = concepts::range_constructible_container<T> &&
+                        concepts::custom_static_serializable<typename T::value_type>;
+
+    template <typename T, size_t... idx>
+    constexpr bool hasOnlyRangeMembers(std::index_sequence<idx...>)
+    {
+      return (
+        concepts::range_constructible_container<std::remove_cvref_t<
+          typename get_nth_register_t<idx, typename T::EnkiSerial::Members>::value_type>> &&
+        ...);
+    }
+
+    /// Structs registering only range members, one per column
+    template <typename T>
+    concept column_struct =
+      concepts::custom_static_serializable<T> &&
+      hasOnlyRangeMembers<T>(std::make_index_sequence<T::EnkiSerial::Members::count>());
+  } // namespace detail
+
+  /// Structs stored column by column instead of row by row.
+  /// `Container` is either a range of structs registering their members (array of structs), or
+  /// a struct registering one range member per field (struct of arrays). Both write the number
+  /// of rows followed by each registered member as a contiguous column, so data written from one
+  /// form can be read into the other. Arithmetic and enum columns are copied as a single block of
+  /// bytes, grouping similar values together also helps any compression applied on top.
+  /// Only binary formats are affected, JSON keeps writing the plain container.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Book, trades, enki::Columnar<std::vector<Trade>>)>
+  template <typename Container>
+    requires detail::row_range<Container> || detail::column_struct<Container>
+  class Columnar : public Container
+  {
+  public:
+    using Container::Container;
+
+    Columnar() = default;
+
+    Columnar(Container container) :
+      Container(std::move(container))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    inline constexpr size_t kColumnChunkSize = 256;
+
+    template <typename Reg>
+    using column_value_t = std::remove_cvref_t<typename Reg::value_type>; // NOLINT
+
+    /// Array of structs: write one member of every row, gathering raw values into chunks
+    template <typename Reg, typename Rows, typename Writer>
+    constexpr Success writeRowColumn(const Rows &rows, Writer &&w)
+    {
+      using M = column_value_t<Reg>;
+      Success isGood;
+      if constexpr (bulk_element<M, typename std::remove_cvref_t<Writer>::policy_type>)
+      {
+        if (!isGood.update(alignFor<M>(w)))
+        {
+          return isGood;
+        }
+        std::array<M, kColumnChunkSize> chunk{};
+        size_t numFilled = 0;
+        for (const auto &row : rows)
+        {
+          chunk[numFilled++] = Reg::getter(row);
+          if (numFilled == chunk.size())
+          {
+            if (!isGood.update(w.writeBytes(std::as_bytes(std::span(chunk)))))
+            {
+              return isGood;
+            }
+            numFilled = 0;
+          }
+        }
+        isGood.update(w.writeBytes(std::as_bytes(std::span(chunk).first(numFilled))));
+      }
+      else
+      {
+        for (const auto &row : rows)
+        {
+          if (!isGood.update(::enki::serialize(Reg::getter(row), w)))
+          {
+            break;
+          }
+        }
+      }
+      return isGood;
+    }
+
+    /// Array of structs: read one member of every row
+    template <typename Reg, typename T, typename Reader>
+    constexpr Success readRowColumn(std::span<T> rows, Reader &&r)
+    {
+      using M = column_value_t<Reg>;
+      Success isGood;
+      if constexpr (bulk_element<M, typename std::remove_cvref_t<Reader>::policy_type>)
+      {
+        if (rows.size() > std::numeric_limits<size_t>::max() / sizeof(M))
+        {
+          return "Range size exceeds remaining data";
+        }
+        std::span<const std::byte> bytes;
+        if (!isGood.update(alignFor<M>(r)) ||
+            !isGood.update(r.viewBytes(rows.size() * sizeof(M), bytes)))
+        {
+          return isGood;
+        }
+        for (size_t i = 0; i < rows.size(); ++i)
+        {
+          M v;
+          std::memcpy(&v, bytes.data() + i * sizeof(M), sizeof(M));
+          Reg::setter(rows[i], v);
+        }
+      }
+      else
+      {
+        for (auto &row : rows)
+        {
+          M v{};
+          if (!isGood.update(::enki::deserialize(v, r)))
+          {
+            break;
+          }
+          Reg::setter(row, v);
+        }
+      }
+      return isGood;
+    }
+
+    /// Struct of arrays: write one column, the first one also gives the number of rows
+    template <typename Reg, typename S, typename Writer>
+    constexpr Success writeStructColumn(const S &value, bool isFirst, size_t &numRows, Writer &&w)
+    {
+      using C = column_value_t<Reg>;
+      const auto &column = Reg::getter(value);
+      const size_t numElements = rangeSize(column);
+      Success isGood;
+      if (isFirst)
+      {
+        numRows = numElements;
+        if (!isGood.update(w.rangeBegin(numRows)))
+        {
+          return isGood;
+        }
+      }
+      else if (numElements != numRows)
+      {
+        return "Columns have different sizes";
+      }
+
+      if constexpr (bulk_writable_range<C, Writer>)
+      {
+        isGood.update(writeBulk(column, w));
+      }
+      else
+      {
+        for (const auto &el : column)
+        {
+          if (!isGood.update(::enki::serialize(el, w)))
+          {
+            break;
+          }
+        }
+      }
+      return isGood;
+    }
+
+    /// Struct of arrays: read one column of `numRows` elements
+    template <typename Reg, typename S, typename Reader>
+    constexpr Success readStructColumn(S &value, size_t numRows, Reader &&r)
+    {
+      using C = column_value_t<Reg>;
+      C column;
+      Success isGood;
+      if constexpr (bulk_readable_range<C, Reader>)
+      {
+        isGood.update(readBulk(column, numRows, r));
+      }
+      else
+      {
+        std::vector<assignable_value_t<C>> temp(numRows);
+        for (auto &el : temp)
+        {
+          if (!isGood.update(::enki::deserialize(el, r)))
+          {
+            return isGood;
+          }
+        }
+        column = {std::begin(temp), std::end(temp)};
+      }
+      if (isGood)
+      {
+        Reg::setter(value, column);
+      }
+      return isGood;
+    }
+
+    template <typename Rows, typename Writer, size_t... idx>
+    constexpr Success serializeRowColumns(const Rows &rows, Writer &&w, std::index_sequence<idx...>)
+    {
+      using Members = typename Rows::value_type::EnkiSerial::Members;
+      Success isGood = w.rangeBegin(rangeSize(rows));
+      if (!isGood)
+      {
+        return isGood;
+      }
+      static_cast<void>(
+        (isGood.update(writeRowColumn<get_nth_register_t<idx, Members>>(rows, w)) && ...));
+      if (isGood)
+      {
+        isGood.update(w.rangeEnd());
+      }
+      return isGood;
+    }
+
+    template <typename Rows, typename Reader, size_t... idx>
+    constexpr Success deserializeRowColumns(Rows &rows, Reader &&r, std::index_sequence<idx...>)
+    {
+      using T = typename Rows::value_type;
+      using Members = typename T::EnkiSerial::Members;
+      size_t numRows = 0;
+      Success isGood = r.rangeBegin(numRows);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      // Every row takes at least one byte
+      if (!fitsInRemainingBytes(numRows, r))
+      {
+        return isGood.update("Range size exceeds remaining data");
+      }
+
+      std::vector<T> temp(numRows);
+      static_cast<void>(
+        (isGood.update(readRowColumn<get_nth_register_t<idx, Members>>(std::span(temp), r)) &&
+         ...));
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if constexpr (std::same_as<Rows, std::vector<T>>)
+      {
+        rows = std::move(temp);
+      }
+      else
+      {
+        rows = {std::begin(temp), std::end(temp)};
+      }
+      return isGood.update(r.rangeEnd());
+    }
+
+    template <typename S, typename Writer, size_t... idx>
+    constexpr Success
+    serializeStructColumns(const S &value, Writer &&w, std::index_sequence<idx...>)
+    {
+      using Members = typename S::EnkiSerial::Members;
+      size_t numRows = 0;
+      Success isGood;
+      static_cast<void>(
+        (isGood.update(
+           writeStructColumn<get_nth_register_t<idx, Members>>(value, idx == 0, numRows, w)) &&
+         ...));
+      if (isGood)
+      {
+        isGood.update(w.rangeEnd());
+      }
+      return isGood;
+    }
+
+    template <typename S, typename Reader, size_t... idx>
+    constexpr Success deserializeStructColumns(S &value, Reader &&r, std::index_sequence<idx...>)
+    {
+      using Members = typename S::EnkiSerial::Members;
+      size_t numRows = 0;
+      Success isGood = r.rangeBegin(numRows);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      // Every row takes at least one byte
+      if (!fitsInRemainingBytes(numRows, r))
+      {
+        return isGood.update("Range size exceeds remaining data");
+      }
+
+      static_cast<void>(
+        (isGood.update(readStructColumn<get_nth_register_t<idx, Members>>(value, numRows, r)) &&
+         ...));
+      if (isGood)
+      {
+        isGood.update(r.rangeEnd());
+      }
+      return isGood;
+    }
+  } // namespace detail
+
+  template <typename Container>
+    requires detail::row_range<Container> || detail::column_struct<Container>
+  struct Columnar<Container>::EnkiSerial
+  {
+    template <typename Writer>
+    static constexpr Success serialize(const Columnar &value, Writer &&w)
+    {
+      const auto &container = static_cast<const Container &>(value);
+      if constexpr (!concepts::byte_writer<Writer>)
+      {
+        return ::enki::serialize(container, w);
+      }
+      else if constexpr (detail::row_range<Container>)
+      {
+        return detail::serializeRowColumns(
+          container,
+          w,
+          std::make_index_sequence<Container::value_type::EnkiSerial::Members::count>());
+      }
+      else
+      {
+        return detail::serializeStructColumns(
+          container, w, std::make_index_sequence<Container::EnkiSerial::Members::count>());
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Columnar &value, Reader &&r)
+    {
+      auto &container = static_cast<Container &>(value);
+      if constexpr (!concepts::byte_reader<Reader>)
+      {
+        return ::enki::deserialize(container, r);
+      }
+      else if constexpr (detail::row_range<Container>)
+      {
+        return detail::deserializeRowColumns(
+          container,
+          r,
+          std::make_index_sequence<Container::value_type::EnkiSerial::Members::count>());
+      }
+      else
+      {
+        return detail::deserializeStructColumns(
+          container, r, std::make_index_sequence<Container::EnkiSerial::Members::count>());
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_COLUMNAR_HPP
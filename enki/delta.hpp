@@ -0,0 +1,125 @@
+#ifndef ENKI_DELTA_HPP
+#define ENKI_DELTA_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  /// Range of integers stored as its first value followed by the differences between
+  /// consecutive values, each one as a zigzag varint.
+  /// Sorted or slowly varying sequences (timestamps, sequence numbers...) shrink to one or two
+  /// bytes per element. Only binary formats are affected, JSON keeps writing plain arrays.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Log, stamps, enki::Delta<std::vector<int64_t>>)>
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  class Delta : public Range
+  {
+  public:
+    using Range::Range;
+
+    Delta() = default;
+
+    Delta(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  template <concepts::range_constructible_container Range>
+    requires concepts::integer<typename Range::value_type>
+  struct Delta<Range>::EnkiSerial
+  {
+    using value_type = typename Range::value_type;          // NOLINT
+    using unsigned_type = std::make_unsigned_t<value_type>; // NOLINT
+
+    template <typename Writer>
+    static constexpr Success serialize(const Delta &value, Writer &&w)
+    {
+      if constexpr (concepts::varint_writer<Writer>)
+      {
+        const size_t numElements = detail::rangeSize(value);
+        Success isGood = w.rangeBegin(numElements);
+        if (!isGood)
+        {
+          return isGood;
+        }
+        isGood.update(detail::writeDeltas<unsigned_type>(
+          std::begin(value), numElements, [](value_type v) { return v; }, w));
+        if (isGood)
+        {
+          isGood.update(w.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Delta &value, Reader &&r)
+    {
+      if constexpr (concepts::varint_reader<Reader>)
+      {
+        size_t numElements = 0;
+        Success isGood = r.rangeBegin(numElements);
+        if (!isGood)
+        {
+          return isGood;
+        }
+        // Every element takes at least one byte
+        if (!detail::fitsInRemainingBytes(numElements, r))
+        {
+          return isGood.update("Range size exceeds remaining data");
+        }
+
+        if constexpr (
+          std::same_as<Range, std::vector<value_type>> ||
+          std::same_as<Range, std::vector<unsigned_type>>)
+        {
+          // Signed and unsigned integers of the same width may alias: decode in place
+          value.resize(numElements);
+          isGood.update(detail::readDeltas(
+            reinterpret_cast<unsigned_type *>(value.data()), numElements, r));
+        }
+        else
+        {
+          std::vector<unsigned_type> temp(numElements);
+          if (isGood.update(detail::readDeltas(temp.data(), numElements, r)))
+          {
+            static_cast<Range &>(value) = Range(std::begin(temp), std::end(temp));
+          }
+        }
+
+        if (isGood)
+        {
+          isGood.update(r.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_DELTA_HPP
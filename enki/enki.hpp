@@ -1,12 +1,29 @@
 #ifndef ENKI_ENKI_HPP
 #define ENKI_ENKI_HPP
 
+#include "enki/auto_encoded.hpp"
+#include "enki/bin_compressed.hpp"
 #include "enki/bin_reader.hpp"
+#include "enki/bin_session.hpp"
+#include "enki/bin_view.hpp"
 #include "enki/bin_writer.hpp"
+#include "enki/bit_packed.hpp"
+#include "enki/columnar.hpp"
+#include "enki/delta.hpp"
 #include "enki/enki_deserialize.hpp"
 #include "enki/enki_serialize.hpp"
+#include "enki/float_series.hpp"
+#include "enki/half.hpp"
+#include "enki/indexed.hpp"
 #include "enki/impl/policies.hpp"
 #include "enki/json_reader.hpp"
 #include "enki/json_writer.hpp"
+#include "enki/patch.hpp"
+#include "enki/projection.hpp"
+#include "enki/quantized.hpp"
+#include "enki/schema.hpp"
+#include "enki/skip.hpp"
+#include "enki/sparse.hpp"
+#include "enki/validate.hpp"
 
 #endif // ENKI_ENKI_HPP
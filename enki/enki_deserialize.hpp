@@ -2,12 +2,29 @@
 #define ENKI_ENKI_DESERIALIZE_HPP
 
 #include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/bulk.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
 #include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
+#include "enki/impl/fixed_size.hpp"
 #include "enki/impl/policies.hpp"
+#include "enki/impl/presence_bitmap.hpp"
 #include "enki/impl/success.hpp"
+#include "enki/impl/tagged_struct.hpp"
 #include "enki/impl/utilities.hpp"
 
 namespace enki
@@ -19,6 +36,26 @@ namespace enki
       { r.read(v) } -> std::same_as<enki::Success>;
     };
 
+    /// Types viewing the data of the reader instead of holding their own copy
+    template <typename T>
+    concept data_view =
+      std::same_as<T, std::string_view> ||
+      (requires { typename T::element_type; } &&
+       std::same_as<T, std::span<typename T::element_type, T::extent>> &&
+       std::is_const_v<typename T::element_type>);
+
+    /// Types whose `EnkiSerial` provides its own `deserialize(value, reader)` decoding
+    template <typename T, typename Reader>
+    concept custom_deserializable = requires(Reader r, T &v) {
+      { T::EnkiSerial::deserialize(v, r) } -> std::same_as<enki::Success>;
+    };
+
+    /// Readers rebuilding the sharing of objects written once (binary formats)
+    template <typename Reader>
+    concept shared_object_reader = requires(Reader r, std::shared_ptr<int> &object) {
+      r.readShared(object, [](int &) { return Success(); });
+    };
+
     /// Find the index of std::monostate in a variant, if present
     template <typename T, size_t I = 0>
     constexpr std::optional<size_t> monostate_index()
@@ -43,15 +80,40 @@ namespace enki
     template <typename T, typename Reader, size_t... idx>
     constexpr Success deserializeTupleLike(T &value, Reader &&reader, std::index_sequence<idx...>);
 
-    template <typename T, typename Reader, size_t... idx>
+    /// Registered members decoded by a deserialization: all of them
+    struct AllMembers
+    {
+      template <typename T, size_t idx>
+      static constexpr bool selects = true; // NOLINT
+    };
+
+    /// Registered members decoded by a projection: the ones registered as `members`
+    template <auto... members>
+    struct SelectedMembers
+    {
+      template <typename T, size_t idx>
+      static constexpr bool selects = ((registered_index_v<T, members> == idx) || ...); // NOLINT
+    };
+
+    template <typename Selection = AllMembers, typename T, typename Reader, size_t... idx>
     constexpr Success deserializeCustom(T &value, Reader &&r, std::index_sequence<idx...>);
 
+    /// Move reader `r` past a value of type `T`, defined in "enki/impl/skip.hpp"
+    template <typename T, typename Reader>
+    constexpr Success skipTyped(Reader &r);
+
     template <typename T, typename Reader, size_t... idx>
     constexpr Success deserializeVariantLike(
       T &value,
       Reader &&r,
       size_t alternativeIndex,
       std::index_sequence<idx...>);
+
+    template <typename T, typename Reader>
+    constexpr Success deserializeRangeChunks(T &value, size_t firstChunkSize, Reader &&r);
+
+    template <typename T, typename Reader>
+    constexpr Success deserializeTimePoints(T &value, Reader &&r);
   } // namespace detail
 
   template <typename T, typename Reader>
@@ -66,6 +128,67 @@ namespace enki
     {
       return r.read(value);
     }
+    else if constexpr (detail::data_view<T>)
+    {
+      static_assert(
+        !sizeof(T), "Views are only read by readers viewing data outliving them (BinSpanReader)");
+      return "Cannot deserialize value";
+    }
+    else if constexpr (detail::custom_deserializable<T, Reader>)
+    {
+      return T::EnkiSerial::deserialize(value, r);
+    }
+    else if constexpr (concepts::duration<T>)
+    {
+      typename T::rep count{};
+      Success isGood = deserialize(count, r);
+      if (isGood)
+      {
+        value = T(count);
+      }
+      return isGood;
+    }
+    else if constexpr (concepts::time_point<T>)
+    {
+      typename T::duration sinceEpoch{};
+      Success isGood = deserialize(sinceEpoch, r);
+      if (isGood)
+      {
+        value = T(sinceEpoch);
+      }
+      return isGood;
+    }
+    else if constexpr (concepts::shared_pointer<T> && detail::shared_object_reader<Reader>)
+    {
+      return r.readShared(value, [&](auto &object) { return deserialize(object, r); });
+    }
+    else if constexpr (concepts::unique_pointer<T> || concepts::shared_pointer<T>)
+    {
+      using E = std::remove_cv_t<typename T::element_type>;
+      bool hasValue = false;
+      Success isGood = r.readOptionalHasValue(hasValue);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (hasValue)
+      {
+        auto object = std::make_unique<E>();
+        if (isGood.update(deserialize(*object, r)))
+        {
+          value = std::move(object);
+        }
+        if (isGood)
+        {
+          isGood.update(r.finishOptional());
+        }
+      }
+      else
+      {
+        value.reset();
+      }
+      return isGood;
+    }
     else if constexpr (concepts::array_like<T>)
     {
       const size_t numElements = std::size(value);
@@ -93,21 +216,63 @@ namespace enki
       }
       return isGood;
     }
+    else if constexpr (detail::delta_coded_range<T, Reader>)
+    {
+      return detail::deserializeTimePoints(value, r);
+    }
     else if constexpr (concepts::range_constructible_container<T>)
     {
       Success isGood;
       size_t numElements = 0;
-      isGood = r.rangeBegin(numElements);
-      if (!isGood)
+      if constexpr (detail::chunked_range_reader<Reader>)
       {
+        bool isLast = true;
+        isGood = r.rangeChunk(numElements, isLast);
+        if (isGood && !isLast)
+        {
+          return detail::deserializeRangeChunks(value, numElements, r);
+        }
+      }
+      else
+      {
+        isGood = r.rangeBegin(numElements);
+      }
+      if (!isGood || !isGood.update(detail::alignFor<typename T::value_type>(r)))
+      {
+        return isGood;
+      }
+      if constexpr (detail::bulk_readable_range<T, Reader>)
+      {
+        if (isGood.update(detail::readBulk(value, numElements, r)))
+        {
+          r.rangeEnd();
+        }
         return isGood;
       }
       using value_type = detail::assignable_value_t<T>; // NOLINT
+      using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+
+      // Untrusted counts are bounded before anything is allocated for them
+      if constexpr (detail::chunked_range_reader<Reader>)
+      {
+        if (numElements > detail::kRangeChunkSize)
+        {
+          return isGood.update("Range chunk exceeds the chunk size");
+        }
+      }
+      if (
+        detail::fixedSize<typename T::value_type, Policy>() > 0 &&
+        !detail::fitsInRemainingBytes(numElements, r))
+      {
+        return isGood.update("Range size exceeds remaining data");
+      }
 
-      std::vector<value_type> temp(numElements);
+      // Elements of variable size are grown one by one past a chunk
+      std::vector<value_type> temp;
+      temp.reserve(std::min(numElements, detail::kRangeChunkSize));
       for (size_t i = 0; (i < numElements) && isGood; ++i)
       {
-        if (isGood.update(deserialize(temp[i], r)) && i != (numElements - 1))
+        if (isGood.update(deserialize(temp.emplace_back(), r)) && i != (numElements - 1))
         {
           if (!isGood.update(r.nextRangeElement()))
           {
@@ -115,7 +280,7 @@ namespace enki
           }
         }
       }
-      value = {std::begin(temp), std::end(temp)};
+      value = {std::make_move_iterator(std::begin(temp)), std::make_move_iterator(std::end(temp))};
       if (isGood)
       {
         r.rangeEnd();
@@ -156,9 +321,10 @@ namespace enki
     else if constexpr (concepts::variant_like<T>)
     {
       using Policy = typename std::remove_cvref_t<Reader>::policy_type;
-      using SizeType = typename std::remove_cvref_t<Reader>::size_type;
+      using IndexType =
+        detail::variant_index_t<T, Policy, typename std::remove_cvref_t<Reader>::size_type>;
 
-      SizeType index = static_cast<SizeType>(-1);
+      IndexType index = static_cast<IndexType>(-1);
 
       Success isGood = r.readVariantIndex(index);
       if (!isGood)
@@ -169,7 +335,7 @@ namespace enki
       if (index >= std::variant_size_v<T>)
       {
         // Unknown variant index
-        if constexpr (std::is_same_v<Policy, forward_compatible_t>)
+        if constexpr (has_policy_v<Policy, forward_compatible_t>)
         {
           // Skip the size hint and the unknown data
           isGood.update(r.skipHintAndValue());
@@ -203,17 +369,23 @@ namespace enki
       }
 
       // Known index - for forward_compatible, skip the size hint first
-      if constexpr (std::is_same_v<Policy, forward_compatible_t>)
+      if constexpr (has_policy_v<Policy, forward_compatible_t>)
       {
         isGood.update(r.skipHint());
         if (!isGood)
         {
           return isGood;
         }
+        isGood.update(detail::readScoped(r, [&] {
+          return detail::deserializeVariantLike(
+            value, r, index, std::make_index_sequence<std::variant_size_v<T>>());
+        }));
+      }
+      else
+      {
+        isGood.update(detail::deserializeVariantLike(
+          value, r, index, std::make_index_sequence<std::variant_size_v<T>>()));
       }
-
-      isGood.update(detail::deserializeVariantLike(
-        value, r, index, std::make_index_sequence<std::variant_size_v<T>>()));
 
       if (isGood)
       {
@@ -242,6 +414,123 @@ namespace enki
 
   namespace detail
   {
+    /// Chunked policy: read a range chunk by chunk, appending each one to what was read so far.
+    /// Vectors of raw elements are filled in place, without any intermediate copy.
+    template <typename T, typename Reader>
+    constexpr Success deserializeRangeChunks(T &value, size_t firstChunkSize, Reader &&r)
+    {
+      using E = typename T::value_type;
+      using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+      constexpr bool isBulk = bulk_readable_range<T, Reader>;
+      constexpr bool isInPlace = std::same_as<T, std::vector<E>>;
+      using value_type = std::conditional_t<isBulk, E, assignable_value_t<T>>; // NOLINT
+
+      std::vector<value_type> temp;
+      auto &elements = [&]() -> auto & {
+        if constexpr (isBulk && isInPlace)
+        {
+          value.clear();
+          return value;
+        }
+        else
+        {
+          return temp;
+        }
+      }();
+
+      Success isGood;
+      size_t chunkSize = firstChunkSize;
+      bool isLast = false;
+      while (isGood.update(alignFor<E>(r)))
+      {
+        // Writers never make longer chunks, so an untrusted header cannot allocate more than one
+        if (chunkSize > kRangeChunkSize)
+        {
+          return isGood.update("Range chunk exceeds the chunk size");
+        }
+        const size_t done = elements.size();
+        if constexpr (isBulk)
+        {
+          std::span<const std::byte> bytes;
+          if (chunkSize > std::numeric_limits<size_t>::max() / sizeof(E) ||
+              !isGood.update(r.viewBytes(chunkSize * sizeof(E), bytes)))
+          {
+            return isGood.update("Range size exceeds remaining data");
+          }
+          elements.resize(done + chunkSize);
+          std::memcpy(elements.data() + done, bytes.data(), bytes.size());
+        }
+        else
+        {
+          if (fixedSize<E, Policy>() > 0 && !fitsInRemainingBytes(chunkSize, r))
+          {
+            return isGood.update("Range size exceeds remaining data");
+          }
+          elements.resize(done + chunkSize);
+          for (size_t i = 0; i < chunkSize && isGood; ++i)
+          {
+            isGood.update(deserialize(elements[done + i], r));
+          }
+        }
+        if (!isGood || isLast || !isGood.update(r.rangeChunk(chunkSize, isLast)))
+        {
+          break;
+        }
+      }
+      if (isGood)
+      {
+        if constexpr (!(isBulk && isInPlace))
+        {
+          value = {std::make_move_iterator(std::begin(temp)),
+                   std::make_move_iterator(std::end(temp))};
+        }
+        r.rangeEnd();
+      }
+      return isGood;
+    }
+
+    /// Read a range of time points written as delta coded ticks: the deltas are decoded and
+    /// summed in a buffer of integers, then converted in a separate pass, both vectorizable
+    template <typename T, typename Reader>
+    constexpr Success deserializeTimePoints(T &value, Reader &&r)
+    {
+      using E = typename T::value_type;
+      using Rep = typename E::rep;
+      size_t numElements = 0;
+      Success isGood = r.rangeBegin(numElements);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      // Every delta takes at least one byte
+      if (!fitsInRemainingBytes(numElements, r))
+      {
+        return isGood.update("Range size exceeds remaining data");
+      }
+
+      std::vector<std::make_unsigned_t<Rep>> ticks(numElements);
+      if (!isGood.update(readDeltas(ticks.data(), numElements, r)))
+      {
+        return isGood;
+      }
+      const auto toTimePoint = [](auto t) {
+        return E(typename E::duration(static_cast<Rep>(t)));
+      };
+      if constexpr (std::same_as<T, std::vector<E>>)
+      {
+        value.resize(numElements);
+        std::transform(ticks.begin(), ticks.end(), value.begin(), toTimePoint);
+      }
+      else
+      {
+        std::vector<E> temp(numElements);
+        std::transform(ticks.begin(), ticks.end(), temp.begin(), toTimePoint);
+        value = {std::begin(temp), std::end(temp)};
+      }
+      r.rangeEnd();
+      return isGood;
+    }
+
     template <typename T, typename Reader, size_t... idx>
     constexpr Success deserializeTupleLike(T &value, Reader &&reader, std::index_sequence<idx...>)
     {
@@ -274,11 +563,39 @@ namespace enki
       return ret;
     }
 
+    /// Skip a member left out of a projection: by structure in JSON, by length or by its fixed
+    /// size in binary formats
+    template <
+      std::derived_from<detail::RegisterBase> Reg,
+      size_t presenceBit,
+      typename Reader,
+      typename Presence>
+    constexpr Success skipOneCustom(Reader &&reader, const Presence &presence)
+    {
+      using M = std::remove_cvref_t<typename Reg::value_type>;
+      if constexpr (!std::same_as<Presence, NoPresenceBitmap> && optional_member<Reg>)
+      {
+        return presence.test(presenceBit) ? skipTyped<typename M::value_type>(reader) : Success();
+      }
+      else
+      {
+        return skipTyped<M>(reader);
+      }
+    }
+
     template <
       std::derived_from<detail::RegisterBase> Reg,
+      size_t presenceBit,
+      bool isSelected,
       concepts::custom_static_serializable T,
-      typename Reader>
-    constexpr bool deserializeOneCustom(T &inst, Reader &&reader, Success &isGood, bool isLast)
+      typename Reader,
+      typename Presence>
+    constexpr bool deserializeOneCustom(
+      T &inst,
+      Reader &&reader,
+      const Presence &presence,
+      Success &isGood,
+      bool isLast)
     {
       if constexpr (std::remove_cvref_t<Reader>::serialize_custom_names)
       {
@@ -287,12 +604,36 @@ namespace enki
           return false;
         }
       }
-      typename Reg::value_type temp = typename Reg::value_type();
-      if (!isGood.update(deserialize(temp, reader)))
+      if constexpr (!isSelected)
       {
-        return false;
+        if (!isGood.update(skipOneCustom<Reg, presenceBit>(reader, presence)))
+        {
+          return false;
+        }
+      }
+      else
+      {
+        typename Reg::value_type temp = typename Reg::value_type();
+        if constexpr (!std::same_as<Presence, NoPresenceBitmap> && optional_member<Reg>)
+        {
+          // Absent members are not in the data: only read the value of present ones
+          if (presence.test(presenceBit))
+          {
+            typename std::remove_cvref_t<typename Reg::value_type>::value_type
+              deserializedValue{};
+            if (!isGood.update(deserialize(deserializedValue, reader)))
+            {
+              return false;
+            }
+            temp = std::move(deserializedValue);
+          }
+        }
+        else if (!isGood.update(deserialize(temp, reader)))
+        {
+          return false;
+        }
+        Reg::setter(inst, std::move(temp));
       }
-      Reg::setter(inst, temp);
 
       if (!isLast)
       {
@@ -305,22 +646,209 @@ namespace enki
       return static_cast<bool>(isGood);
     }
 
-    template <typename T, typename Reader, size_t... idx>
+    /// Forward compatible binary formats: skip a field unknown to this reader
+    template <typename Reader>
+    constexpr Success skipTaggedField(uint64_t tag, Reader &&reader)
+    {
+      std::span<const std::byte> bytes;
+      const WireType wireType = taggedWireType(tag);
+      if (wireType == WireType::sized)
+      {
+        uint64_t size = 0;
+        Success isGood = reader.readVarint(size);
+        if (isGood)
+        {
+          isGood.update(reader.viewBytes(size, bytes));
+        }
+        return isGood;
+      }
+      if (wireType == WireType::string)
+      {
+        if constexpr (has_policy_v<
+                        typename std::remove_cvref_t<Reader>::policy_type,
+                        dictionary_t>)
+        {
+          // Read to number the strings like the writer did
+          std::string str;
+          return reader.read(str);
+        }
+        else
+        {
+          return "Dictionary string field without the dictionary policy";
+        }
+      }
+      if (wireType == WireType::object)
+      {
+        return reader.skipShared();
+      }
+      const size_t size = fixedWireSize(wireType);
+      if (size == 0)
+      {
+        return "Unknown tagged struct field type";
+      }
+      return reader.viewBytes(size, bytes);
+    }
+
+    /// Value given to members missing from the data (written before they were added)
+    template <std::derived_from<RegisterBase> Reg, typename T>
+    constexpr std::remove_cvref_t<typename Reg::value_type> missingTaggedMember()
+    {
+      if constexpr (std::default_initializable<T> &&
+                    std::copy_constructible<std::remove_cvref_t<typename Reg::value_type>>)
+      {
+        return Reg::getter(T());
+      }
+      else
+      {
+        return std::remove_cvref_t<typename Reg::value_type>();
+      }
+    }
+
+    template <std::derived_from<RegisterBase> Reg, typename T, typename Reader>
+    constexpr Success deserializeOneTagged(T &inst, uint64_t tag, Reader &&reader)
+    {
+      using M = std::remove_cvref_t<typename Reg::value_type>;
+      using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+      constexpr WireType wireType = wireTypeOf<M, Policy>();
+      if (taggedWireType(tag) != wireType)
+      {
+        return "Tagged struct field has an unexpected type";
+      }
+
+      M temp = M();
+      Success isGood;
+      if constexpr (wireType == WireType::sized)
+      {
+        uint64_t size = 0;
+        if (!isGood.update(reader.readVarint(size)))
+        {
+          return isGood;
+        }
+        const size_t remainingBefore = reader.remainingBytes();
+        if (!isGood.update(detail::readScoped(reader, [&] { return deserialize(temp, reader); })))
+        {
+          return isGood;
+        }
+        if (remainingBefore - reader.remainingBytes() != size)
+        {
+          return "Tagged struct field size does not match its content";
+        }
+      }
+      else if (!isGood.update(deserialize(temp, reader)))
+      {
+        return isGood;
+      }
+      Reg::setter(inst, std::move(temp));
+      return isGood;
+    }
+
+    template <typename Selection, typename T, typename Reader, size_t... idx>
+    constexpr Success deserializeTagged(T &value, Reader &&reader, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      uint64_t numFields = 0;
+      Success ret = reader.readVarint(numFields);
+      uint64_t tag = 0;
+      bool hasTag = false;
+      const auto nextTag = [&] {
+        if (!hasTag && numFields > 0 && ret.update(reader.readVarint(tag)))
+        {
+          --numFields;
+          hasTag = true;
+        }
+        return hasTag;
+      };
+
+      const auto readOne = [&]<typename Reg, size_t fieldNumber, bool isSelected>() {
+        // Fields are written in order: in the common case the next one is this member
+        if (nextTag() && taggedFieldNumber(tag) <= fieldNumber)
+        {
+          hasTag = false;
+          if (taggedFieldNumber(tag) != fieldNumber)
+          {
+            return static_cast<bool>(ret.update("Tagged struct fields are out of order"));
+          }
+          if constexpr (isSelected)
+          {
+            return static_cast<bool>(ret.update(deserializeOneTagged<Reg>(value, tag, reader)));
+          }
+          else
+          {
+            return static_cast<bool>(ret.update(skipTaggedField(tag, reader)));
+          }
+        }
+        if (ret && isSelected)
+        {
+          Reg::setter(value, missingTaggedMember<Reg, T>());
+        }
+        return static_cast<bool>(ret);
+      };
+      if (ret)
+      {
+        static_cast<void>(
+          (readOne.template operator()<
+             get_nth_register_t<idx, Members>,
+             idx,
+             Selection::template selects<T, idx>>() &&
+           ...));
+      }
+
+      // Fields appended by newer writers
+      while (ret && nextTag())
+      {
+        hasTag = false;
+        if (taggedFieldNumber(tag) < sizeof...(idx))
+        {
+          return ret.update("Tagged struct fields are out of order");
+        }
+        ret.update(skipTaggedField(tag, reader));
+      }
+      return ret;
+    }
+
+    template <typename Selection, typename T, typename Reader, size_t... idx>
     constexpr Success deserializeCustom(T &value, Reader &&reader, std::index_sequence<idx...>)
     {
+      using Members = typename T::EnkiSerial::Members;
+      if constexpr (tagged_struct_reader<Reader>)
+      {
+        return deserializeTagged<Selection>(value, reader, std::index_sequence<idx...>());
+      }
+
       Success ret = reader.objectBegin();
-      if (!ret)
+      if (!ret || !ret.update(alignFor<T>(reader)))
       {
         return ret;
       }
-      size_t i = 0;
 
+      auto presence = [] {
+        if constexpr (presence_bitmap_reader<T, Reader>)
+        {
+          return PresenceBitmap<optional_member_count_v<T>>();
+        }
+        else
+        {
+          return NoPresenceBitmap{};
+        }
+      }();
+      if constexpr (presence_bitmap_reader<T, Reader>)
+      {
+        if (!ret.update(readPresenceBitmap(presence, reader)))
+        {
+          return ret;
+        }
+      }
+
+      size_t i = 0;
       static_cast<void>(
-        (deserializeOneCustom<detail::get_nth_register_t<idx, typename T::EnkiSerial::Members>>(
-           value, reader, ret, (++i) == sizeof...(idx)) &&
+        (deserializeOneCustom<
+           get_nth_register_t<idx, Members>,
+           presence_bit_v<T, idx>,
+           Selection::template selects<T, idx>>(
+           value, reader, presence, ret, (++i) == sizeof...(idx)) &&
          ...));
 
-      if (ret)
+      if (ret && ret.update(alignFor<T>(reader)))
       {
         ret.update(reader.objectEnd());
       }
@@ -362,6 +890,75 @@ namespace enki
       return isGood;
     }
   } // namespace detail
+
+  /// Read a range of `T` written from any container of `T`, handing it to `onChunk` as
+  /// `std::span<const T>` pieces of at most 2^20 elements decoded into a reused buffer.
+  /// Multi-gigabyte ranges can be processed without ever holding them in memory as a whole,
+  /// whether or not the chunked policy split them when writing.
+  /// Ranges of time points are delta coded as a whole and cannot be read this way.
+  template <typename T, typename Reader, typename OnChunk>
+    requires concepts::byte_reader<Reader> && (!detail::delta_coded_element<T>)
+  constexpr Success deserializeChunks(Reader &&r, OnChunk &&onChunk)
+  {
+    using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+
+    Success isGood;
+    size_t remaining = 0;
+    bool isLast = true;
+    if constexpr (detail::chunked_range_reader<Reader>)
+    {
+      isGood = r.rangeChunk(remaining, isLast);
+    }
+    else
+    {
+      isGood = r.rangeBegin(remaining);
+    }
+
+    std::vector<T> buffer;
+    while (isGood && isGood.update(detail::alignFor<T>(r)))
+    {
+      while (remaining > 0 && isGood)
+      {
+        const size_t pieceSize = std::min(remaining, detail::kRangeChunkSize);
+        buffer.resize(pieceSize);
+        if constexpr (detail::bulk_element<T, Policy>)
+        {
+          std::span<const std::byte> bytes;
+          if (!isGood.update(r.viewBytes(pieceSize * sizeof(T), bytes)))
+          {
+            return isGood;
+          }
+          std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        }
+        else
+        {
+          for (size_t i = 0; i < pieceSize && isGood; ++i)
+          {
+            isGood.update(deserialize(buffer[i], r));
+          }
+        }
+        if (isGood)
+        {
+          onChunk(std::span<const T>(buffer));
+          remaining -= pieceSize;
+        }
+      }
+      if constexpr (detail::chunked_range_reader<Reader>)
+      {
+        if (isGood && !isLast)
+        {
+          isGood.update(r.rangeChunk(remaining, isLast));
+          continue;
+        }
+      }
+      break;
+    }
+    if (isGood)
+    {
+      r.rangeEnd();
+    }
+    return isGood;
+  }
 } // namespace enki
 
 #endif // ENKI_ENKI_DESERIALIZE_HPP
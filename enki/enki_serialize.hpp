@@ -2,11 +2,23 @@
 #define ENKI_ENKI_SERIALIZE_HPP
 
 #include <algorithm>
+#include <concepts>
 #include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
 
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/bulk.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
 #include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
 #include "enki/impl/policies.hpp"
+#include "enki/impl/presence_bitmap.hpp"
 #include "enki/impl/success.hpp"
+#include "enki/impl/tagged_struct.hpp"
 #include "enki/impl/utilities.hpp"
 
 namespace enki
@@ -18,17 +30,44 @@ namespace enki
       { w.write(v) } -> std::same_as<enki::Success>;
     };
 
+    /// Types whose `EnkiSerial` provides its own `serialize(value, writer)` encoding
+    template <typename T, typename Writer>
+    concept custom_serializable = requires(Writer w, const T &v) {
+      { T::EnkiSerial::serialize(v, w) } -> std::same_as<enki::Success>;
+    };
+
+    /// Writers tracking shared objects to write each one once (binary formats)
+    template <typename Writer>
+    concept shared_object_writer = requires(Writer w, const std::shared_ptr<int> &object) {
+      w.writeShared(object, [](auto &) { return Success(); });
+    };
+
     template <typename T, typename Writer, size_t... idx>
     constexpr Success serializeTupleLike(const T &value, Writer &&w, std::index_sequence<idx...>);
 
     template <typename T, typename Writer, size_t... idx>
     constexpr Success serializeCustom(const T &value, Writer &&w, std::index_sequence<idx...>);
 
-    template <typename SizeType, typename Writer>
+    template <typename IndexType, typename Writer>
     constexpr Success serializeVariantIndex(size_t index, Writer &&w);
 
     template <typename T, typename Writer>
     constexpr Success serializeVariantValue(const T &value, Writer &&w);
+
+    template <typename T, typename Writer>
+    constexpr Success serializeRangeChunks(const T &value, size_t numElements, Writer &&w);
+
+    template <typename T, typename Writer>
+    constexpr Success serializeTimePoints(const T &value, Writer &&w);
+
+    /// Canonical policy: unordered containers are written in sorted order
+    template <typename T, typename Writer>
+    concept canonical_range =
+      concepts::unordered_container<T> &&
+      has_policy_v<typename std::remove_cvref_t<Writer>::policy_type, canonical_t>;
+
+    template <typename T, typename Writer>
+    constexpr Success serializeSorted(const T &value, Writer &&w);
   } // namespace detail
 
   template <typename T, typename Writer>
@@ -43,6 +82,27 @@ namespace enki
     {
       return w.write(value);
     }
+    else if constexpr (detail::custom_serializable<T, Writer>)
+    {
+      return T::EnkiSerial::serialize(value, w);
+    }
+    else if constexpr (concepts::duration<T>)
+    {
+      return serialize(value.count(), w);
+    }
+    else if constexpr (concepts::time_point<T>)
+    {
+      return serialize(value.time_since_epoch(), w);
+    }
+    else if constexpr (concepts::shared_pointer<T> && detail::shared_object_writer<Writer>)
+    {
+      return w.writeShared(value, [&](auto &writer) { return serialize(*value, writer); });
+    }
+    else if constexpr (concepts::unique_pointer<T> || concepts::shared_pointer<T>)
+    {
+      return w.writeOptional(
+        static_cast<bool>(value), [&](auto &writer) { return serialize(*value, writer); });
+    }
     else if constexpr (concepts::array_like<T>)
     {
       const size_t numElements = std::size(value);
@@ -70,22 +130,37 @@ namespace enki
       }
       return isGood;
     }
+    else if constexpr (detail::delta_coded_range<T, Writer>)
+    {
+      return detail::serializeTimePoints(value, w);
+    }
+    else if constexpr (detail::canonical_range<T, Writer>)
+    {
+      return detail::serializeSorted(value, w);
+    }
     else if constexpr (concepts::range_constructible_container<T>)
     {
       Success isGood;
-      const size_t numElements = [](const T &v) {
-        if constexpr (requires { std::size(v); })
-        {
-          return std::size(v);
-        }
-        else
+      const size_t numElements = detail::rangeSize(value);
+      if constexpr (detail::chunked_range_writer<Writer>)
+      {
+        if (numElements > detail::kRangeChunkSize)
         {
-          return std::distance(std::begin(v), std::end(v));
+          return detail::serializeRangeChunks(value, numElements, w);
         }
-      }(value);
+      }
       isGood = w.rangeBegin(numElements);
-      if (!isGood)
+      if (!isGood || !isGood.update(detail::alignFor<std::ranges::range_value_t<const T>>(w)))
+      {
+        return isGood;
+      }
+      if constexpr (detail::bulk_writable_range<T, Writer>)
       {
+        // Raw elements are written back to back: copy them all at once
+        if (isGood.update(detail::writeBulk(value, w)))
+        {
+          w.rangeEnd();
+        }
         return isGood;
       }
       size_t i = 0;
@@ -118,9 +193,12 @@ namespace enki
     }
     else if constexpr (concepts::variant_like<T>)
     {
-      using SizeType = typename std::remove_cvref_t<Writer>::size_type;
+      using IndexType = detail::variant_index_t<
+        T,
+        typename std::remove_cvref_t<Writer>::policy_type,
+        typename std::remove_cvref_t<Writer>::size_type>;
 
-      if (value.index() > std::numeric_limits<SizeType>::max())
+      if (value.index() > std::numeric_limits<IndexType>::max())
       {
         return "Variant index is too large to be serialized";
       }
@@ -132,7 +210,7 @@ namespace enki
 
       return w.writeVariant(
         [&](auto &writer) {
-          return detail::serializeVariantIndex<SizeType>(value.index(), writer);
+          return detail::serializeVariantIndex<IndexType>(value.index(), writer);
         },
         [&](auto &writer) { return detail::serializeVariantValue(value, writer); });
     }
@@ -156,6 +234,130 @@ namespace enki
 
   namespace detail
   {
+    /// Chunked policy: write a range longer than one chunk as a sequence of chunks, each one
+    /// started by its own header
+    template <typename T, typename Writer>
+    constexpr Success serializeRangeChunks(const T &value, size_t numElements, Writer &&w)
+    {
+      using E = std::ranges::range_value_t<const T>;
+      Success isGood;
+      auto it = std::begin(value);
+      for (size_t done = 0; done < numElements && isGood;)
+      {
+        const size_t chunkSize = std::min(kRangeChunkSize, numElements - done);
+        const bool isLast = done + chunkSize == numElements;
+        if (!isGood.update(isLast ? w.rangeBegin(chunkSize) : w.rangeChunk(chunkSize)) ||
+            !isGood.update(alignFor<E>(w)))
+        {
+          return isGood;
+        }
+        if constexpr (bulk_writable_range<T, Writer>)
+        {
+          isGood.update(
+            writeBulk(std::span<const E>(std::ranges::data(value) + done, chunkSize), w));
+        }
+        else
+        {
+          for (size_t i = 0; i < chunkSize && isGood; ++i, ++it)
+          {
+            isGood.update(serialize(*it, w));
+          }
+        }
+        done += chunkSize;
+      }
+      if (isGood)
+      {
+        w.rangeEnd();
+      }
+      return isGood;
+    }
+
+    /// Write a range of time points as delta coded ticks, in a single piece even with the
+    /// chunked policy
+    template <typename T, typename Writer>
+    constexpr Success serializeTimePoints(const T &value, Writer &&w)
+    {
+      using Rep = typename T::value_type::rep;
+      const size_t numElements = rangeSize(value);
+      Success isGood = w.rangeBegin(numElements);
+      if (
+        isGood && isGood.update(writeDeltas<std::make_unsigned_t<Rep>>(
+                    std::begin(value),
+                    numElements,
+                    [](const auto &t) { return t.time_since_epoch().count(); },
+                    w)))
+      {
+        w.rangeEnd();
+      }
+      return isGood;
+    }
+
+    /// Order of the elements of an unordered container in canonical encodings: by value, or by
+    /// key when the mapped values cannot be compared, which needs unique keys
+    template <typename E>
+    constexpr bool canonicalLess(const E &lhs, const E &rhs)
+    {
+      if constexpr (std::totally_ordered<E>)
+      {
+        return lhs < rhs;
+      }
+      else
+      {
+        return lhs.first < rhs.first;
+      }
+    }
+
+    /// Write the elements of an unordered container sorted: pointers to them are gathered and
+    /// sorted, the elements themselves are neither copied nor moved
+    template <typename T, typename Writer>
+    constexpr Success serializeSorted(const T &value, Writer &&w)
+    {
+      using E = std::ranges::range_value_t<const T>;
+      static_assert(
+        std::totally_ordered<typename T::key_type>,
+        "Canonical encoding needs keys that can be compared");
+      static_assert(
+        std::totally_ordered<E> || requires(T &container, const E &el) {
+          { container.insert(el).second } -> std::convertible_to<bool>;
+        },
+        "Canonical encoding of multimaps needs mapped values that can be compared");
+
+      std::vector<const E *> sorted;
+      sorted.reserve(rangeSize(value));
+      for (const E &el : value)
+      {
+        sorted.push_back(&el);
+      }
+      std::sort(sorted.begin(), sorted.end(), [](const E *lhs, const E *rhs) {
+        return canonicalLess(*lhs, *rhs);
+      });
+      const auto elements = sorted | std::views::transform([](const E *el) -> const E & {
+                              return *el;
+                            });
+
+      const size_t numElements = sorted.size();
+      if constexpr (chunked_range_writer<Writer>)
+      {
+        if (numElements > kRangeChunkSize)
+        {
+          return serializeRangeChunks(elements, numElements, w);
+        }
+      }
+      Success isGood = w.rangeBegin(numElements);
+      for (size_t i = 0; i < numElements && isGood; ++i)
+      {
+        if (isGood.update(serialize(*sorted[i], w)) && i + 1 != numElements)
+        {
+          isGood.update(w.nextArrayElement());
+        }
+      }
+      if (isGood)
+      {
+        w.rangeEnd();
+      }
+      return isGood;
+    }
+
     template <typename T, typename Writer, size_t... idx>
     constexpr Success
     serializeTupleLike(const T &value, Writer &&writer, std::index_sequence<idx...>)
@@ -191,9 +393,16 @@ namespace enki
 
     template <
       std::derived_from<RegisterBase> Reg,
+      size_t presenceBit,
       concepts::custom_static_serializable T,
-      typename Writer>
-    constexpr bool serializeOneCustom(const T &inst, Writer &&writer, Success &isGood, bool isLast)
+      typename Writer,
+      typename Presence>
+    constexpr bool serializeOneCustom(
+      const T &inst,
+      Writer &&writer,
+      const Presence &presence,
+      Success &isGood,
+      bool isLast)
     {
       if constexpr (std::remove_cvref_t<Writer>::serialize_custom_names)
       {
@@ -202,7 +411,19 @@ namespace enki
           return false;
         }
       }
-      if (isGood.update(serialize(Reg::getter(inst), writer)) && !isLast)
+      if constexpr (!std::same_as<Presence, NoPresenceBitmap> && optional_member<Reg>)
+      {
+        // The flag is in the bitmap, absent members take no bytes
+        if (presence.test(presenceBit))
+        {
+          isGood.update(serialize(*Reg::getter(inst), writer));
+        }
+      }
+      else
+      {
+        isGood.update(serialize(Reg::getter(inst), writer));
+      }
+      if (isGood && !isLast)
       {
         if (!isGood.update(writer.nextObjectElement()))
         {
@@ -213,22 +434,93 @@ namespace enki
       return static_cast<bool>(isGood);
     }
 
+    template <typename T, size_t... idx>
+    constexpr auto gatherPresence(const T &value, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      PresenceBitmap<optional_member_count_v<T>> presence;
+      const auto markOne = [&]<typename Reg, size_t bit>() {
+        if constexpr (optional_member<Reg>)
+        {
+          if (Reg::getter(value))
+          {
+            presence.set(bit);
+          }
+        }
+      };
+      (markOne.template operator()<get_nth_register_t<idx, Members>, presence_bit_v<T, idx>>(),
+       ...);
+      return presence;
+    }
+
+    /// Forward compatible binary formats: write the member as field number `idx`
+    template <std::derived_from<RegisterBase> Reg, size_t idx, typename T, typename Writer>
+    constexpr bool serializeOneTagged(const T &inst, Writer &&writer, Success &isGood)
+    {
+      using Policy = typename std::remove_cvref_t<Writer>::policy_type;
+      constexpr WireType wireType =
+        wireTypeOf<std::remove_cvref_t<typename Reg::value_type>, Policy>();
+      if (!isGood.update(writer.writeVarint(taggedFieldTag(idx, wireType))))
+      {
+        return false;
+      }
+      if constexpr (wireType == WireType::sized)
+      {
+        return static_cast<bool>(isGood.update(writer.writeSized(
+          [&](auto &contentWriter) { return serialize(Reg::getter(inst), contentWriter); })));
+      }
+      else
+      {
+        return static_cast<bool>(isGood.update(serialize(Reg::getter(inst), writer)));
+      }
+    }
+
     template <typename T, typename Writer, size_t... idx>
     constexpr Success serializeCustom(const T &value, Writer &&writer, std::index_sequence<idx...>)
     {
+      using Members = typename T::EnkiSerial::Members;
+      if constexpr (tagged_struct_writer<Writer>)
+      {
+        Success ret = writer.writeVarint(sizeof...(idx));
+        if (ret)
+        {
+          static_cast<void>(
+            (serializeOneTagged<get_nth_register_t<idx, Members>, idx>(value, writer, ret) && ...));
+        }
+        return ret;
+      }
+
       Success ret = writer.objectBegin();
-      if (!ret)
+      if (!ret || !ret.update(alignFor<T>(writer)))
       {
         return ret;
       }
-      size_t i = 0;
 
+      const auto presence = [&] {
+        if constexpr (presence_bitmap_writer<T, Writer>)
+        {
+          return gatherPresence(value, std::index_sequence<idx...>());
+        }
+        else
+        {
+          return NoPresenceBitmap{};
+        }
+      }();
+      if constexpr (presence_bitmap_writer<T, Writer>)
+      {
+        if (!ret.update(writer.writeBytes(presence.bytes())))
+        {
+          return ret;
+        }
+      }
+
+      size_t i = 0;
       static_cast<void>(
-        (serializeOneCustom<detail::get_nth_register_t<idx, typename T::EnkiSerial::Members>>(
-           value, writer, ret, (++i) == sizeof...(idx)) &&
+        (serializeOneCustom<get_nth_register_t<idx, Members>, presence_bit_v<T, idx>>(
+           value, writer, presence, ret, (++i) == sizeof...(idx)) &&
          ...));
 
-      if (ret)
+      if (ret && ret.update(alignFor<T>(writer)))
       {
         ret.update(writer.objectEnd());
       }
@@ -236,10 +528,10 @@ namespace enki
       return ret;
     }
 
-    template <typename SizeType, typename Writer>
+    template <typename IndexType, typename Writer>
     constexpr Success serializeVariantIndex(size_t index, Writer &&w)
     {
-      return serialize(static_cast<SizeType>(index), w);
+      return serialize(static_cast<IndexType>(index), w);
     }
 
     template <typename T, typename Writer>
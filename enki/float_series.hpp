@@ -0,0 +1,338 @@
+#ifndef ENKI_FLOAT_SERIES_HPP
+#define ENKI_FLOAT_SERIES_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/bit_stream.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace concepts
+  {
+    template <typename T>
+    concept xor_compressible_float =
+      std::floating_point<T> && std::numeric_limits<T>::is_iec559 &&
+      (sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t));
+  } // namespace concepts
+
+  /// Range of floating point values stored with XOR compression (as in Facebook's Gorilla).
+  /// Every value is XORed with its predecessor: repeated values take a single bit and values
+  /// sharing sign, exponent and leading mantissa bits only store the bits that changed.
+  /// Slowly moving gauges typically shrink 5 to 10 times. Only binary formats are affected, JSON
+  /// keeps writing plain arrays.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Metric, samples, enki::FloatSeries<std::vector<double>>)>
+  template <concepts::range_constructible_container Range>
+    requires concepts::xor_compressible_float<typename Range::value_type>
+  class FloatSeries : public Range
+  {
+  public:
+    using Range::Range;
+
+    FloatSeries() = default;
+
+    FloatSeries(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    template <concepts::xor_compressible_float T>
+    struct XorFloatLayout
+    {
+      using bits_type = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+
+      static constexpr unsigned kNumBits = sizeof(T) * 8;
+      static constexpr unsigned kLeadingBits = 5;
+      static constexpr unsigned kMaxLeading = (1U << kLeadingBits) - 1;
+      /// Lengths 1 to kNumBits are stored minus one
+      static constexpr unsigned kLengthBits = std::bit_width(kNumBits - 1);
+      /// Worst case: two control bits, a new window and every bit meaningful
+      static constexpr size_t kMaxEncodedBits = 2 + kLeadingBits + kLengthBits + kNumBits;
+    };
+
+    /// Control bits, after the first value which is stored verbatim:
+    ///   0                                    same value as the previous one
+    ///   1 0 <bits>                           XOR fits in the previous meaningful bits window
+    ///   1 1 <leading> <length - 1> <bits>    new window
+    template <concepts::xor_compressible_float T>
+    class XorFloatEncoder
+    {
+    public:
+      using Layout = XorFloatLayout<T>;
+      using bits_type = typename Layout::bits_type; // NOLINT
+
+      constexpr explicit XorFloatEncoder(BitWriter &bits) :
+        mBits(bits)
+      {
+      }
+
+      constexpr void encode(T value)
+      {
+        const auto current = std::bit_cast<bits_type>(value);
+        if (mIsFirst)
+        {
+          mBits.write(current, Layout::kNumBits);
+          mIsFirst = false;
+        }
+        else
+        {
+          encodeXor(static_cast<bits_type>(current ^ mPrevious));
+        }
+        mPrevious = current;
+      }
+
+    private:
+      constexpr void encodeXor(bits_type xored)
+      {
+        if (xored == 0)
+        {
+          mBits.write(0, 1);
+          return;
+        }
+        const auto leading =
+          std::min(static_cast<unsigned>(std::countl_zero(xored)), Layout::kMaxLeading);
+        const auto trailing = static_cast<unsigned>(std::countr_zero(xored));
+        if (mHasWindow && leading >= mLeading && trailing >= mTrailing)
+        {
+          mBits.write(0b01, 2);
+          mBits.write(xored >> mTrailing, Layout::kNumBits - mLeading - mTrailing);
+          return;
+        }
+        const unsigned length = Layout::kNumBits - leading - trailing;
+        mBits.write(0b11, 2);
+        mBits.write(leading, Layout::kLeadingBits);
+        mBits.write(length - 1, Layout::kLengthBits);
+        mBits.write(xored >> trailing, length);
+        mHasWindow = true;
+        mLeading = leading;
+        mTrailing = trailing;
+      }
+
+      BitWriter &mBits;
+      bits_type mPrevious = 0;
+      bool mIsFirst = true;
+      bool mHasWindow = false;
+      unsigned mLeading = 0;
+      unsigned mTrailing = 0;
+    };
+
+    /// Streaming counterpart of `XorFloatEncoder`, decoding one value at a time from a bounded
+    /// buffer. `next` returns false on truncated or malformed input.
+    template <concepts::xor_compressible_float T>
+    class XorFloatDecoder
+    {
+    public:
+      using Layout = XorFloatLayout<T>;
+      using bits_type = typename Layout::bits_type; // NOLINT
+
+      constexpr explicit XorFloatDecoder(std::span<const std::byte> data) :
+        mBits(data.data(), data.size())
+      {
+      }
+
+      constexpr bool next(T &value)
+      {
+        uint64_t bits = 0;
+        if (mIsFirst)
+        {
+          if (!mBits.read(Layout::kNumBits, bits))
+          {
+            return false;
+          }
+          mIsFirst = false;
+          mPrevious = static_cast<bits_type>(bits);
+        }
+        else if (!decodeXor())
+        {
+          return false;
+        }
+        value = std::bit_cast<T>(mPrevious);
+        return true;
+      }
+
+    private:
+      constexpr bool decodeXor()
+      {
+        uint64_t control = 0;
+        if (!mBits.read(1, control))
+        {
+          return false;
+        }
+        if (control == 0)
+        {
+          return true;
+        }
+        if (!mBits.read(1, control))
+        {
+          return false;
+        }
+        if (control == 1)
+        {
+          uint64_t leading = 0;
+          uint64_t length = 0;
+          if (
+            !mBits.read(Layout::kLeadingBits, leading) ||
+            !mBits.read(Layout::kLengthBits, length))
+          {
+            return false;
+          }
+          ++length;
+          if (leading + length > Layout::kNumBits)
+          {
+            return false;
+          }
+          mHasWindow = true;
+          mLeading = static_cast<unsigned>(leading);
+          mTrailing = static_cast<unsigned>(Layout::kNumBits - leading - length);
+        }
+        else if (!mHasWindow)
+        {
+          return false;
+        }
+        uint64_t meaningful = 0;
+        if (!mBits.read(Layout::kNumBits - mLeading - mTrailing, meaningful))
+        {
+          return false;
+        }
+        mPrevious ^= static_cast<bits_type>(meaningful << mTrailing);
+        return true;
+      }
+
+      BitReader mBits;
+      bits_type mPrevious = 0;
+      bool mIsFirst = true;
+      bool mHasWindow = false;
+      unsigned mLeading = 0;
+      unsigned mTrailing = 0;
+    };
+  } // namespace detail
+
+  template <concepts::range_constructible_container Range>
+    requires concepts::xor_compressible_float<typename Range::value_type>
+  struct FloatSeries<Range>::EnkiSerial
+  {
+    using value_type = typename Range::value_type; // NOLINT
+    using Layout = detail::XorFloatLayout<value_type>;
+
+    /// Format: element count, byte size of the bit stream as a varint, then the bit stream
+    template <typename Writer>
+    static constexpr Success serialize(const FloatSeries &value, Writer &&w)
+    {
+      if constexpr (concepts::varint_writer<Writer> && concepts::byte_writer<Writer>)
+      {
+        const size_t numElements = detail::rangeSize(value);
+        Success isGood = w.rangeBegin(numElements);
+        if (!isGood)
+        {
+          return isGood;
+        }
+
+        std::vector<std::byte> stream(detail::bitsToBytes(numElements * Layout::kMaxEncodedBits));
+        detail::BitWriter bits(stream.data());
+        detail::XorFloatEncoder<value_type> encoder(bits);
+        for (const value_type &element : value)
+        {
+          encoder.encode(element);
+        }
+        const size_t streamSize = bits.finish();
+
+        if (isGood.update(w.writeVarint(streamSize)) &&
+            isGood.update(w.writeBytes(std::span<const std::byte>(stream.data(), streamSize))))
+        {
+          isGood.update(w.rangeEnd());
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    /// Values are decoded straight from the reader's buffer, without copying the bit stream
+    template <typename Reader>
+    static constexpr Success deserialize(FloatSeries &value, Reader &&r)
+    {
+      if constexpr (concepts::varint_reader<Reader> && concepts::byte_reader<Reader>)
+      {
+        size_t numElements = 0;
+        uint64_t streamSize = 0;
+        Success isGood = r.rangeBegin(numElements);
+        if (!isGood || !isGood.update(r.readVarint(streamSize)))
+        {
+          return isGood;
+        }
+        // Every element takes at least one bit
+        if (!detail::fitsInRemainingBytes(streamSize, r) || numElements > streamSize * 8)
+        {
+          return isGood.update("Range size exceeds remaining data");
+        }
+        std::span<const std::byte> stream;
+        if (!isGood.update(r.viewBytes(streamSize, stream)))
+        {
+          return isGood;
+        }
+
+        detail::XorFloatDecoder<value_type> decoder(stream);
+        const auto decodeAll = [&](auto out) {
+          for (size_t i = 0; i < numElements; ++i, ++out)
+          {
+            if (!decoder.next(*out))
+            {
+              return false;
+            }
+          }
+          return true;
+        };
+
+        bool isDecoded = false;
+        if constexpr (std::same_as<Range, std::vector<value_type>>)
+        {
+          value.resize(numElements);
+          isDecoded = decodeAll(value.data());
+        }
+        else
+        {
+          std::vector<value_type> temp(numElements);
+          isDecoded = decodeAll(temp.data());
+          if (isDecoded)
+          {
+            static_cast<Range &>(value) = Range(std::begin(temp), std::end(temp));
+          }
+        }
+        if (!isDecoded)
+        {
+          return isGood.update("Malformed float series");
+        }
+        return isGood.update(r.rangeEnd());
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_FLOAT_SERIES_HPP
@@ -0,0 +1,176 @@
+#ifndef ENKI_HALF_HPP
+#define ENKI_HALF_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/converted_range.hpp"
+#include "enki/impl/float16.hpp"
+#include "enki/impl/success.hpp"
+
+namespace enki
+{
+  /// Floating point value stored as an IEEE 754 binary16 (11 significant bits, up to 65504).
+  /// Doubles are rounded to float first. Only binary formats are affected, JSON keeps writing the
+  /// full precision value.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Feature, weight, enki::Half<float>)>
+  template <std::floating_point T = float>
+  class Half
+  {
+  public:
+    constexpr Half() = default;
+
+    constexpr Half(T value) :
+      mValue(value)
+    {
+    }
+
+    /// Explicit so that writers never pick an arithmetic overload through an implicit conversion
+    constexpr explicit operator T() const
+    {
+      return mValue;
+    }
+
+    constexpr T value() const
+    {
+      return mValue;
+    }
+
+    constexpr bool operator==(const Half &) const = default;
+
+    struct EnkiSerial;
+
+  private:
+    T mValue{};
+  };
+
+  /// Range of floating point values stored as IEEE 754 binary16, converted by blocks (with F16C
+  /// instructions when the target supports them). JSON keeps writing plain arrays.
+  template <concepts::range_constructible_container Range>
+    requires std::floating_point<typename Range::value_type>
+  class HalfRange : public Range
+  {
+  public:
+    using Range::Range;
+
+    HalfRange() = default;
+
+    HalfRange(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    template <std::floating_point T>
+    constexpr void toHalves(const T *in, uint16_t *out, size_t size)
+    {
+      if constexpr (std::same_as<T, float>)
+      {
+        floatsToHalves(in, out, size);
+      }
+      else
+      {
+        std::transform(in, in + size, out, [](T v) { return floatToHalf(static_cast<float>(v)); });
+      }
+    }
+
+    template <std::floating_point T>
+    constexpr void fromHalves(const uint16_t *in, T *out, size_t size)
+    {
+      if constexpr (std::same_as<T, float>)
+      {
+        halvesToFloats(in, out, size);
+      }
+      else
+      {
+        std::transform(
+          in, in + size, out, [](uint16_t h) { return static_cast<T>(halfToFloat(h)); });
+      }
+    }
+  } // namespace detail
+
+  template <std::floating_point T>
+  struct Half<T>::EnkiSerial
+  {
+    template <typename Writer>
+    static constexpr Success serialize(const Half &value, Writer &&w)
+    {
+      if constexpr (concepts::byte_writer<Writer>)
+      {
+        return ::enki::serialize(detail::floatToHalf(static_cast<float>(value.mValue)), w);
+      }
+      else
+      {
+        return ::enki::serialize(value.mValue, w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Half &value, Reader &&r)
+    {
+      if constexpr (concepts::byte_reader<Reader>)
+      {
+        uint16_t half = 0;
+        Success isGood = ::enki::deserialize(half, r);
+        if (isGood)
+        {
+          value.mValue = static_cast<T>(detail::halfToFloat(half));
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::deserialize(value.mValue, r);
+      }
+    }
+  };
+
+  template <concepts::range_constructible_container Range>
+    requires std::floating_point<typename Range::value_type>
+  struct HalfRange<Range>::EnkiSerial
+  {
+    using value_type = typename Range::value_type; // NOLINT
+
+    template <typename Writer>
+    static constexpr Success serialize(const HalfRange &value, Writer &&w)
+    {
+      if constexpr (concepts::byte_writer<Writer>)
+      {
+        return detail::writeConvertedRange<uint16_t>(
+          static_cast<const Range &>(value), detail::toHalves<value_type>, w);
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(HalfRange &value, Reader &&r)
+    {
+      if constexpr (concepts::byte_reader<Reader>)
+      {
+        return detail::readConvertedRange<uint16_t>(
+          static_cast<Range &>(value), detail::fromHalves<value_type>, r);
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_HALF_HPP
@@ -0,0 +1,171 @@
+#ifndef ENKI_IMPL_ALIGNED_HPP
+#define ENKI_IMPL_ALIGNED_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki::detail
+{
+  /// Bytes to add at `offset` to reach a multiple of `alignment`
+  constexpr size_t alignmentPadding(size_t offset, size_t alignment)
+  {
+    return (alignment - offset % alignment) % alignment;
+  }
+
+  template <typename T, typename Policy>
+  constexpr bool hasNaturalLayout();
+
+  template <typename Reg, typename Policy>
+  constexpr bool isAlignedMember()
+  {
+    using M = std::remove_cvref_t<typename Reg::value_type>;
+    if constexpr (!requires { Reg::member_pointer; })
+    {
+      return false; // Wrapped members are converted, their storage is unknown
+    }
+    else if constexpr (concepts::arithmetic_or_enum<M>)
+    {
+      return !is_compact_enum_v<Policy, M>;
+    }
+    else if constexpr (concepts::custom_static_serializable<M>)
+    {
+      return hasNaturalLayout<M, Policy>();
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  template <typename T, typename Policy, size_t... idx>
+  constexpr bool hasNaturalLayout(std::index_sequence<idx...>)
+  {
+    using Members = typename T::EnkiSerial::Members;
+    if constexpr ((isAlignedMember<get_nth_register_t<idx, Members>, Policy>() && ...))
+    {
+      // Lay the members out one after the other at their natural alignment, like compilers do
+      size_t offset = 0;
+      const auto placeOne = [&offset]<typename M>() {
+        offset += alignmentPadding(offset, alignof(M)) + sizeof(M);
+      };
+      (placeOne.template operator()<
+         std::remove_cvref_t<typename get_nth_register_t<idx, Members>::value_type>>(),
+       ...);
+      return offset + alignmentPadding(offset, alignof(T)) == sizeof(T);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  /// True if the registered members of `T`, placed at their natural alignment, fill exactly
+  /// `sizeof(T)` bytes. They must be plain data members of arithmetic, enum or such struct types.
+  template <typename T, typename Policy>
+  constexpr bool hasNaturalLayout()
+  {
+    if constexpr (
+      std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T> &&
+      std::default_initializable<T>)
+    {
+      return hasNaturalLayout<T, Policy>(
+        std::make_index_sequence<T::EnkiSerial::Members::count>());
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  /// Registered structs the `aligned` policy writes with the padding of their natural layout
+  template <typename T, typename Policy>
+  concept aligned_struct =
+    concepts::custom_static_serializable<T> && hasNaturalLayout<T, Policy>();
+
+  /// Values the `aligned` policy places at their natural alignment
+  template <typename T, typename Policy>
+  concept aligned_value =
+    (concepts::arithmetic_or_enum<T> && !is_compact_enum_v<Policy, T>) ||
+    aligned_struct<T, Policy>;
+
+  template <typename Codec>
+  concept aligned_codec =
+    has_policy_v<typename std::remove_cvref_t<Codec>::policy_type, aligned_t> &&
+    requires(Codec c, size_t alignment) { c.alignTo(alignment); };
+
+  /// With the `aligned` policy, write or skip the padding placing a `T` at its natural alignment
+  template <typename T, typename Codec>
+  constexpr Success alignFor(Codec &&codec)
+  {
+    if constexpr (
+      aligned_codec<Codec> && aligned_value<T, typename std::remove_cvref_t<Codec>::policy_type>)
+    {
+      return codec.alignTo(alignof(T));
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  template <typename T, size_t... idx>
+  bool matchesNaturalLayout(
+    const T &inst,
+    const std::byte *base,
+    size_t &offset,
+    std::index_sequence<idx...>)
+  {
+    using Members = typename T::EnkiSerial::Members;
+    const auto matchOne = [&]<typename Reg>() {
+      using M = std::remove_cvref_t<typename Reg::value_type>;
+      const M &member = inst.*Reg::member_pointer;
+      offset += alignmentPadding(offset, alignof(M));
+      if (reinterpret_cast<const std::byte *>(&member) != base + offset)
+      {
+        return false;
+      }
+      if constexpr (concepts::arithmetic_or_enum<M>)
+      {
+        offset += sizeof(M);
+        return true;
+      }
+      else
+      {
+        return matchesNaturalLayout(
+          member, base, offset, std::make_index_sequence<M::EnkiSerial::Members::count>());
+      }
+    };
+    const bool isMatching =
+      (matchOne.template operator()<get_nth_register_t<idx, Members>>() && ...);
+    offset += alignmentPadding(offset, alignof(T));
+    return isMatching;
+  }
+
+  /// True if the members of `T` really are where the aligned layout puts them, which readers
+  /// check before handing out views of structs. It fails when members are registered out of
+  /// declaration order or when unregistered members take some of their place.
+  template <typename T>
+  bool hasMatchingLayout()
+  {
+    static const bool isMatching = [] {
+      const T inst{};
+      size_t offset = 0;
+      return matchesNaturalLayout(
+        inst,
+        reinterpret_cast<const std::byte *>(&inst),
+        offset,
+        std::make_index_sequence<T::EnkiSerial::Members::count>());
+    }();
+    return isMatching;
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_ALIGNED_HPP
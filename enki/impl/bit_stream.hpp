@@ -0,0 +1,309 @@
+#ifndef ENKI_IMPL_BIT_STREAM_HPP
+#define ENKI_IMPL_BIT_STREAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace enki::detail
+{
+  constexpr uint64_t lowBitsMask(unsigned width)
+  {
+    return width >= 64 ? ~uint64_t{} : (uint64_t{1} << width) - 1;
+  }
+
+  /// Number of bytes needed to hold `numBits` bits
+  constexpr size_t bitsToBytes(size_t numBits)
+  {
+    return (numBits + 7) / 8;
+  }
+
+  /// Appends bit fields of 0 to 64 bits, least significant bit first, to a caller provided buffer
+  /// The buffer must be large enough to hold every field written
+  class BitWriter
+  {
+  public:
+    constexpr explicit BitWriter(std::byte *out) :
+      mOut(out)
+    {
+    }
+
+    constexpr void write(uint64_t value, unsigned width)
+    {
+      if (width > 32)
+      {
+        write(value, 32);
+        write(value >> 32, width - 32);
+        return;
+      }
+      // mPendingBits < 8 and width <= 32: everything fits in the 64 bit accumulator
+      mPending |= (value & lowBitsMask(width)) << mPendingBits;
+      mPendingBits += width;
+      while (mPendingBits >= 8)
+      {
+        mOut[mSize++] = static_cast<std::byte>(mPending);
+        mPending >>= 8;
+        mPendingBits -= 8;
+      }
+    }
+
+    /// Flush the last partial byte and return the number of bytes written
+    constexpr size_t finish()
+    {
+      if (mPendingBits > 0)
+      {
+        mOut[mSize++] = static_cast<std::byte>(mPending);
+        mPending = 0;
+        mPendingBits = 0;
+      }
+      return mSize;
+    }
+
+  private:
+    std::byte *mOut;
+    size_t mSize = 0;
+    uint64_t mPending = 0;
+    unsigned mPendingBits = 0;
+  };
+
+  /// Reads bit fields written by `BitWriter` from a bounded buffer
+  class BitReader
+  {
+  public:
+    constexpr BitReader(const std::byte *data, size_t size) :
+      mData(data),
+      mNumBits(size * 8)
+    {
+    }
+
+    /// Returns false, leaving `value` untouched, if fewer than `width` bits remain
+    constexpr bool read(unsigned width, uint64_t &value)
+    {
+      if (width > mNumBits - mBitPos)
+      {
+        return false;
+      }
+      if (width == 0)
+      {
+        value = 0;
+        return true;
+      }
+      if (width > 32)
+      {
+        uint64_t low = 0;
+        uint64_t high = 0;
+        read(32, low);
+        read(width - 32, high);
+        value = low | (high << 32);
+        return true;
+      }
+
+      const size_t firstByte = mBitPos / 8;
+      const unsigned shift = mBitPos % 8;
+      const size_t numBytes = bitsToBytes(shift + width);
+      uint64_t window = 0;
+      for (size_t i = 0; i < numBytes; ++i)
+      {
+        window |= static_cast<uint64_t>(mData[firstByte + i]) << (8 * i);
+      }
+      value = (window >> shift) & lowBitsMask(width);
+      mBitPos += width;
+      return true;
+    }
+
+    /// Move past `numBits` bits, which must remain
+    constexpr void skip(size_t numBits)
+    {
+      mBitPos += numBits;
+    }
+
+    constexpr size_t remainingBits() const
+    {
+      return mNumBits - mBitPos;
+    }
+
+  private:
+    const std::byte *mData;
+    size_t mNumBits;
+    size_t mBitPos = 0;
+  };
+
+  /// Little endian 64 bit load, which compilers turn into a single load
+  constexpr uint64_t loadLittleEndian64(const std::byte *in)
+  {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i)
+    {
+      value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  /// Byte layout of a group of 8 fields of `Width` bits, which always starts on a byte boundary:
+  /// the 32 bit word holding each field in two 16 byte windows, the second starting at
+  /// `kHighBase`, and the shift of the field in its word. Fields of up to 25 bits fit.
+  template <unsigned Width>
+  struct PackedGroupLayout
+  {
+    static constexpr size_t kHighBase = 4 * Width / 8;
+
+    static constexpr std::array<uint8_t, 32> kShuffle = [] {
+      std::array<uint8_t, 32> shuffle{};
+      for (size_t i = 0; i < 8; ++i)
+      {
+        const size_t firstByte = i * Width / 8 - (i < 4 ? 0 : kHighBase);
+        for (size_t j = 0; j < 4; ++j)
+        {
+          shuffle[4 * i + j] = static_cast<uint8_t>(firstByte + j);
+        }
+      }
+      return shuffle;
+    }();
+
+    static constexpr std::array<uint32_t, 8> kShifts = [] {
+      std::array<uint32_t, 8> shifts{};
+      for (size_t i = 0; i < 8; ++i)
+      {
+        shifts[i] = static_cast<uint32_t>(i * Width % 8);
+      }
+      return shifts;
+    }();
+
+    /// Multiplying by these moves every field to bit 7, for targets without variable shifts
+    static constexpr std::array<uint32_t, 8> kMultipliers = [] {
+      std::array<uint32_t, 8> multipliers{};
+      for (size_t i = 0; i < 8; ++i)
+      {
+        multipliers[i] = uint32_t{1} << (7 - kShifts[i]);
+      }
+      return multipliers;
+    }();
+  };
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  /// Unpack groups of 8 fields of 32 bit keys while 16 bytes can be loaded past each half group,
+  /// returns the number of fields unpacked
+  template <unsigned Width>
+  inline size_t unpackGroups(
+    const std::byte *in,
+    size_t inSize,
+    uint32_t reference,
+    uint32_t *out,
+    size_t count)
+  {
+    using Layout = PackedGroupLayout<Width>;
+    size_t i = 0;
+    for (; i + 8 <= count && (i / 8 * Width) + Layout::kHighBase + 16 <= inSize; i += 8)
+    {
+      const std::byte *group = in + (i / 8 * Width);
+      const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+      const __m128i high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(group + Layout::kHighBase));
+#if defined(__AVX2__)
+      const __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+      __m256i fields = _mm256_shuffle_epi8(
+        bytes, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Layout::kShuffle.data())));
+      fields = _mm256_srlv_epi32(
+        fields, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Layout::kShifts.data())));
+      fields = _mm256_and_si256(
+        fields, _mm256_set1_epi32(static_cast<int32_t>(lowBitsMask(Width))));
+      fields = _mm256_add_epi32(fields, _mm256_set1_epi32(static_cast<int32_t>(reference)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), fields);
+#else
+      const auto unpackHalf = [&](__m128i bytes, size_t offset) {
+        __m128i fields = _mm_shuffle_epi8(
+          bytes,
+          _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(Layout::kShuffle.data() + 4 * offset)));
+        fields = _mm_mullo_epi32(
+          fields,
+          _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(Layout::kMultipliers.data() + offset)));
+        fields = _mm_and_si128(
+          _mm_srli_epi32(fields, 7), _mm_set1_epi32(static_cast<int32_t>(lowBitsMask(Width))));
+        fields = _mm_add_epi32(fields, _mm_set1_epi32(static_cast<int32_t>(reference)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + offset), fields);
+      };
+      unpackHalf(low, 0);
+      unpackHalf(high, 4);
+#endif
+    }
+    return i;
+  }
+#endif
+
+  /// Unpack `count` fields of `Width` bits written by `BitWriter` from `in`, adding `reference`
+  /// to each of them. `in` must hold them all.
+  template <unsigned Width, std::unsigned_integral U>
+  constexpr void
+  unpackFixedWidth(const std::byte *in, size_t inSize, U reference, U *out, size_t count)
+  {
+    if constexpr (Width == 0)
+    {
+      std::fill(out, out + count, reference);
+    }
+    else
+    {
+      size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE4_1__)
+      if constexpr (std::same_as<U, uint32_t> && Width <= 25)
+      {
+        if (!std::is_constant_evaluated())
+        {
+          i = unpackGroups<Width>(in, inSize, reference, out, count);
+        }
+      }
+#endif
+      if constexpr (Width <= 56)
+      {
+        // Fields start less than a byte into their first byte, so one load holds each of them
+        for (; i < count && (i * Width / 8) + sizeof(uint64_t) <= inSize; ++i)
+        {
+          const size_t bitPos = i * Width;
+          const uint64_t window = loadLittleEndian64(in + bitPos / 8);
+          out[i] = static_cast<U>(reference + ((window >> (bitPos % 8)) & lowBitsMask(Width)));
+        }
+      }
+      BitReader bits(in, inSize);
+      bits.skip(i * Width);
+      for (; i < count; ++i)
+      {
+        uint64_t field = 0;
+        bits.read(Width, field);
+        out[i] = static_cast<U>(reference + field);
+      }
+    }
+  }
+
+  template <std::unsigned_integral U, unsigned... Widths>
+  constexpr auto makeUnpackKernels(std::integer_sequence<unsigned, Widths...>)
+  {
+    return std::array{&unpackFixedWidth<Widths, U>...};
+  }
+
+  /// Unpack `count` fields of `width` bits, at most the bit size of `U`, with a kernel
+  /// specialized for that width
+  template <std::unsigned_integral U>
+  constexpr void unpackFields(
+    const std::byte *in,
+    size_t inSize,
+    unsigned width,
+    U reference,
+    U *out,
+    size_t count)
+  {
+    constexpr auto kernels =
+      makeUnpackKernels<U>(std::make_integer_sequence<unsigned, sizeof(U) * 8 + 1>());
+    kernels[width](in, inSize, reference, out, count);
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_BIT_STREAM_HPP
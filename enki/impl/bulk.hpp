@@ -0,0 +1,100 @@
+#ifndef ENKI_IMPL_BULK_HPP
+#define ENKI_IMPL_BULK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+
+namespace enki::detail
+{
+  /// Elements binary formats store as their raw bytes: a contiguous run of them can be copied
+  /// at once instead of being written one by one
+  template <typename T, typename Policy>
+  concept bulk_element = concepts::arithmetic_or_enum<T> && !std::same_as<T, bool> &&
+                         !is_compact_enum_v<Policy, T>;
+
+  template <typename T, typename Writer>
+  concept bulk_writable_range =
+    concepts::byte_writer<Writer> && std::ranges::contiguous_range<const T> &&
+    std::ranges::sized_range<const T> &&
+    bulk_element<
+      std::ranges::range_value_t<const T>,
+      typename std::remove_cvref_t<Writer>::policy_type>;
+
+  template <typename T, typename Reader>
+  concept bulk_readable_range =
+    concepts::byte_reader<Reader> && concepts::range_constructible_container<T> &&
+    bulk_element<typename T::value_type, typename std::remove_cvref_t<Reader>::policy_type> &&
+    std::constructible_from<T, const typename T::value_type *, const typename T::value_type *>;
+
+  template <typename T, typename Writer>
+    requires bulk_writable_range<T, Writer>
+  constexpr Success writeBulk(const T &range, Writer &&w)
+  {
+    using E = std::ranges::range_value_t<const T>;
+    Success isGood = alignFor<E>(w);
+    const auto bytes =
+      std::as_bytes(std::span<const E>(std::ranges::data(range), std::ranges::size(range)));
+    if constexpr (requires { w.writeElements(bytes, sizeof(E)); })
+    {
+      // Writers compressing their output can prefilter runs of same size elements
+      return isGood.update(w.writeElements(bytes, sizeof(E)));
+    }
+    else
+    {
+      return isGood.update(w.writeBytes(bytes));
+    }
+  }
+
+  /// Read `numElements` raw elements into `range`, with a single copy when possible
+  template <typename T, typename Reader>
+    requires bulk_readable_range<T, Reader>
+  constexpr Success readBulk(T &range, size_t numElements, Reader &&r)
+  {
+    using E = typename T::value_type;
+    if (numElements > std::numeric_limits<size_t>::max() / sizeof(E))
+    {
+      return "Range size exceeds remaining data";
+    }
+
+    std::span<const std::byte> bytes;
+    Success isGood = alignFor<E>(r);
+    if (!isGood || !isGood.update(r.viewBytes(numElements * sizeof(E), bytes)) ||
+        numElements == 0)
+    {
+      range = {};
+      return isGood;
+    }
+
+    if constexpr (std::same_as<T, std::vector<E>>)
+    {
+      range.resize(numElements);
+      std::memcpy(range.data(), bytes.data(), bytes.size());
+    }
+    else if constexpr (alignof(E) == 1)
+    {
+      // Single byte elements (characters...) have no alignment to honor
+      const auto *first = reinterpret_cast<const E *>(bytes.data());
+      range = T(first, first + numElements);
+    }
+    else
+    {
+      std::vector<E> temp(numElements);
+      std::memcpy(temp.data(), bytes.data(), bytes.size());
+      range = T(temp.data(), temp.data() + numElements);
+    }
+    return isGood;
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_BULK_HPP
@@ -0,0 +1,47 @@
+#ifndef ENKI_IMPL_CHUNKED_HPP
+#define ENKI_IMPL_CHUNKED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace enki::detail
+{
+  /// Chunked policy: ranges longer than this are written as several chunks
+  inline constexpr size_t kRangeChunkSize = size_t{1} << 20;
+
+  /// Each chunk of a range starts with a varint of its number of elements shifted left once,
+  /// the low bit set when more chunks follow. Ranges of at most `kRangeChunkSize` elements are a
+  /// single chunk, whose header is the whole length prefix.
+  constexpr uint64_t rangeChunkHeader(size_t numElements, bool hasMore)
+  {
+    return (uint64_t{numElements} << 1) | uint64_t{hasMore};
+  }
+
+  constexpr bool fitsInRangeChunkHeader(size_t numElements)
+  {
+    return uint64_t{numElements} <= std::numeric_limits<uint64_t>::max() >> 1;
+  }
+
+  constexpr size_t rangeChunkSize(uint64_t header)
+  {
+    return header >> 1;
+  }
+
+  constexpr bool rangeChunkHasMore(uint64_t header)
+  {
+    return (header & 1) != 0;
+  }
+
+  /// Binary writers splitting long ranges in chunks
+  template <typename Writer>
+  concept chunked_range_writer = requires(Writer w, size_t n) { w.rangeChunk(n); };
+
+  /// Binary readers reading ranges chunk by chunk
+  template <typename Reader>
+  concept chunked_range_reader = requires(Reader r, size_t &n, bool &isLast) {
+    r.rangeChunk(n, isLast);
+  };
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_CHUNKED_HPP
@@ -0,0 +1,111 @@
+#ifndef ENKI_IMPL_COMPACT_HPP
+#define ENKI_IMPL_COMPACT_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <variant>
+
+#include "enki/impl/policies.hpp"
+
+namespace enki
+{
+  /// Specialize to declare the range of values an enum can take:
+  ///
+  ///   template <>
+  ///   struct enki::EnumTraits<Side>
+  ///   {
+  ///     static constexpr Side max = Side::Sell;
+  ///   };
+  ///
+  /// An optional `min` member (defaults to 0) supports negative enumerators.
+  /// With the `compact` policy such enums use the fewest bytes able to hold `max - min`.
+  template <typename T>
+  struct EnumTraits
+  {
+  };
+
+  namespace concepts
+  {
+    template <typename T>
+    concept bounded_enum = std::is_enum_v<T> && requires {
+      { EnumTraits<T>::max } -> std::convertible_to<T>;
+    };
+  } // namespace concepts
+
+  namespace detail
+  {
+    template <uint64_t maxValue>
+    using compact_uint_t = // NOLINT
+      std::conditional_t<
+        maxValue <= std::numeric_limits<uint8_t>::max(),
+        uint8_t,
+        std::conditional_t<
+          maxValue <= std::numeric_limits<uint16_t>::max(),
+          uint16_t,
+          std::conditional_t<maxValue <= std::numeric_limits<uint32_t>::max(), uint32_t, uint64_t>>>;
+
+    template <concepts::bounded_enum T>
+    constexpr std::underlying_type_t<T> enumMin()
+    {
+      if constexpr (requires { EnumTraits<T>::min; })
+      {
+        return static_cast<std::underlying_type_t<T>>(EnumTraits<T>::min);
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    template <concepts::bounded_enum T>
+    constexpr uint64_t enumSpan()
+    {
+      constexpr auto max = static_cast<std::underlying_type_t<T>>(EnumTraits<T>::max);
+      static_assert(max >= enumMin<T>(), "EnumTraits max must not be lower than min");
+      return static_cast<uint64_t>(max) - static_cast<uint64_t>(enumMin<T>());
+    }
+
+    /// Storage type of a bounded enum under the compact policy
+    template <concepts::bounded_enum T>
+    using compact_enum_t = compact_uint_t<enumSpan<T>()>; // NOLINT
+
+    template <typename Policy, typename T>
+    inline constexpr bool is_compact_enum_v = // NOLINT
+      has_policy_v<Policy, compact_t> && concepts::bounded_enum<T>;
+
+    template <concepts::bounded_enum T>
+    constexpr compact_enum_t<T> toCompactEnum(T value)
+    {
+      using U = std::underlying_type_t<T>;
+      return static_cast<compact_enum_t<T>>(
+        static_cast<uint64_t>(static_cast<U>(value)) - static_cast<uint64_t>(enumMin<T>()));
+    }
+
+    /// Returns false if the stored value lies outside of the declared range
+    template <concepts::bounded_enum T>
+    constexpr bool fromCompactEnum(compact_enum_t<T> stored, T &value)
+    {
+      if (stored > enumSpan<T>())
+      {
+        return false;
+      }
+      using U = std::underlying_type_t<T>;
+      value = static_cast<T>(
+        static_cast<U>(static_cast<uint64_t>(stored) + static_cast<uint64_t>(enumMin<T>())));
+      return true;
+    }
+
+    /// Type used to store the index of variant `T`:
+    /// `SizeType` by default, the smallest type able to index all alternatives under `compact`
+    template <typename T, typename Policy, typename SizeType>
+    using variant_index_t = std::conditional_t< // NOLINT
+      has_policy_v<Policy, compact_t>,
+      compact_uint_t<std::variant_size_v<T> - 1>,
+      SizeType>;
+  } // namespace detail
+} // namespace enki
+
+#endif // ENKI_IMPL_COMPACT_HPP
@@ -2,8 +2,14 @@
 #define ENKI_CONCEPTS_HPP
 
 #include <array>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -27,11 +33,57 @@ namespace enki::concepts
     struct is_array_like<T[cty]> : std::true_type
     {
     };
+
+    template <typename T>
+    struct is_duration : std::false_type // NOLINT
+    {
+    };
+
+    template <typename Rep, typename Period>
+    struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_time_point : std::false_type // NOLINT
+    {
+    };
+
+    template <typename Clock, typename Duration>
+    struct is_time_point<std::chrono::time_point<Clock, Duration>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_unique_ptr : std::false_type // NOLINT
+    {
+    };
+
+    template <typename T>
+    struct is_unique_ptr<std::unique_ptr<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_shared_ptr : std::false_type // NOLINT
+    {
+    };
+
+    template <typename T>
+    struct is_shared_ptr<std::shared_ptr<T>> : std::true_type
+    {
+    };
   } // namespace detail
 
   template <typename T>
   concept arithmetic_or_enum = std::integral<T> || std::floating_point<T> || std::is_enum_v<T>;
 
+  template <typename T>
+  concept integer = std::integral<T> && !std::same_as<T, bool>;
+
+  template <typename T>
+  concept string_like = std::same_as<T, std::string> || std::same_as<T, std::string_view>;
+
   template <typename T>
   concept tuple_like = requires { typename std::tuple_size<T>::type; };
 
@@ -54,9 +106,34 @@ namespace enki::concepts
       std::pair<typename T::key_type, typename T::mapped_type>,
       typename T::value_type>;
 
+  /// Hashed containers (`std::unordered_map`...), iterated in an order depending on their history
+  template <typename T>
+  concept unordered_container = range_constructible_container<T> && requires {
+    typename T::hasher;
+    typename T::key_equal;
+  };
+
   template <typename T>
   concept array_like = detail::is_array_like<T>::value;
 
+  /// `std::chrono::duration`, stored as its number of ticks
+  template <typename T>
+  concept duration = detail::is_duration<T>::value;
+
+  /// `std::chrono::time_point`, stored as its duration since the epoch of its clock
+  template <typename T>
+  concept time_point = detail::is_time_point<T>::value;
+
+  /// `std::unique_ptr` of a single object, stored like an optional value
+  template <typename T>
+  concept unique_pointer =
+    detail::is_unique_ptr<T>::value && !std::is_array_v<typename T::element_type>;
+
+  /// `std::shared_ptr` of a single object: binary formats write each object once
+  template <typename T>
+  concept shared_pointer =
+    detail::is_shared_ptr<T>::value && !std::is_array_v<typename T::element_type>;
+
   template <typename T>
   concept optional_like = std::convertible_to<typename T::value_type, T> &&
                           std::default_initializable<T> && requires(T t) {
@@ -130,6 +207,26 @@ namespace enki::concepts
     }
   } // namespace detail
 
+  /// Writers able to emit LEB128 varints (binary formats)
+  template <typename Writer>
+  concept varint_writer = requires(Writer w, uint64_t v) { w.writeVarint(v); };
+
+  /// Readers able to decode LEB128 varints (binary formats)
+  template <typename Reader>
+  concept varint_reader = requires(Reader r, uint64_t &v) { r.readVarint(v); };
+
+  /// Writers able to emit raw bytes (binary formats)
+  template <typename Writer>
+  concept byte_writer = requires(Writer w, std::span<const std::byte> bytes) {
+    w.writeBytes(bytes);
+  };
+
+  /// Readers giving access to raw bytes (binary formats)
+  template <typename Reader>
+  concept byte_reader = requires(Reader r, size_t n, std::span<const std::byte> &bytes) {
+    r.viewBytes(n, bytes);
+  };
+
   template <typename T>
   concept custom_static_serializable =
     std::derived_from<typename T::EnkiSerial::Members, ::enki::detail::RegisterBase> &&
@@ -0,0 +1,110 @@
+#ifndef ENKI_IMPL_CONVERTED_RANGE_HPP
+#define ENKI_IMPL_CONVERTED_RANGE_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki::detail
+{
+  /// Elements converted per kernel call: large enough to amortize the call, small enough for the
+  /// stack
+  inline constexpr size_t kConvertChunkSize = 256; // NOLINT
+
+  /// Write a range as a size followed by its elements converted to `Stored`
+  /// `convert(const value_type *in, Stored *out, size_t count)` converts one chunk
+  template <typename Stored, typename Range, typename Convert, typename Writer>
+  constexpr Success writeConvertedRange(const Range &range, Convert &&convert, Writer &&w)
+  {
+    using T = typename Range::value_type;
+
+    const size_t numElements = rangeSize(range);
+    Success isGood = w.rangeBegin(numElements);
+    std::array<T, kConvertChunkSize> values{};
+    std::array<Stored, kConvertChunkSize> stored{};
+    auto it = std::begin(range);
+    for (size_t done = 0; done < numElements && isGood; done += kConvertChunkSize)
+    {
+      const size_t count = std::min(kConvertChunkSize, numElements - done);
+      for (size_t i = 0; i < count; ++i, ++it)
+      {
+        values[i] = *it;
+      }
+      convert(values.data(), stored.data(), count);
+      isGood.update(w.writeBytes(std::as_bytes(std::span<const Stored>(stored.data(), count))));
+    }
+    if (isGood)
+    {
+      isGood.update(w.rangeEnd());
+    }
+    return isGood;
+  }
+
+  /// Read a range written by `writeConvertedRange`
+  /// `convert(const Stored *in, value_type *out, size_t count)` converts one chunk
+  template <typename Stored, typename Range, typename Convert, typename Reader>
+  constexpr Success readConvertedRange(Range &range, Convert &&convert, Reader &&r)
+  {
+    using T = typename Range::value_type;
+
+    size_t numElements = 0;
+    Success isGood = r.rangeBegin(numElements);
+    if (!isGood)
+    {
+      return isGood;
+    }
+    if (
+      numElements > std::numeric_limits<size_t>::max() / sizeof(Stored) ||
+      !fitsInRemainingBytes(numElements * sizeof(Stored), r))
+    {
+      return isGood.update("Range size exceeds remaining data");
+    }
+
+    const auto readAll = [&](T *out) {
+      std::array<Stored, kConvertChunkSize> stored{};
+      for (size_t done = 0; done < numElements && isGood; done += kConvertChunkSize)
+      {
+        const size_t count = std::min(kConvertChunkSize, numElements - done);
+        std::span<const std::byte> bytes;
+        if (isGood.update(r.viewBytes(count * sizeof(Stored), bytes)))
+        {
+          std::memcpy(stored.data(), bytes.data(), bytes.size());
+          convert(stored.data(), out + done, count);
+        }
+      }
+    };
+
+    if constexpr (std::same_as<Range, std::vector<T>>)
+    {
+      range.resize(numElements);
+      readAll(range.data());
+    }
+    else
+    {
+      std::vector<T> temp(numElements);
+      readAll(temp.data());
+      if (isGood)
+      {
+        range = Range(std::begin(temp), std::end(temp));
+      }
+    }
+
+    if (isGood)
+    {
+      isGood.update(r.rangeEnd());
+    }
+    return isGood;
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_CONVERTED_RANGE_HPP
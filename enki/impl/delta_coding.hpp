@@ -0,0 +1,74 @@
+#ifndef ENKI_IMPL_DELTA_CODING_HPP
+#define ENKI_IMPL_DELTA_CODING_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/varint.hpp"
+
+namespace enki::detail
+{
+  /// Write `numElements` values from `first` as zigzag varint deltas
+  /// `toInteger` maps each element to the integer to encode
+  template <std::unsigned_integral U, typename It, typename Proj, typename Writer>
+  constexpr Success writeDeltas(It first, size_t numElements, Proj &&toInteger, Writer &&w)
+  {
+    using S = std::make_signed_t<U>;
+    Success isGood;
+    U previous{};
+    for (size_t i = 0; i < numElements && isGood; ++i, ++first)
+    {
+      const auto current = static_cast<U>(toInteger(*first));
+      isGood.update(w.writeVarint(zigzagEncode(static_cast<S>(current - previous))));
+      previous = current;
+    }
+    return isGood;
+  }
+
+  /// Read `numElements` zigzag varint deltas into `out` and rebuild the original values with a
+  /// prefix sum over the decoded buffer (kept as a separate pass so it can be vectorized)
+  template <std::unsigned_integral U, typename Reader>
+  constexpr Success readDeltas(U *out, size_t numElements, Reader &&r)
+  {
+    Success isGood;
+    for (size_t i = 0; i < numElements && isGood; ++i)
+    {
+      uint64_t zigzag = 0;
+      if (isGood.update(r.readVarint(zigzag)))
+      {
+        if (zigzag > std::numeric_limits<U>::max())
+        {
+          return isGood.update("Delta does not fit in the element type");
+        }
+        out[i] = static_cast<U>(zigzagDecode(static_cast<U>(zigzag)));
+      }
+    }
+    if (isGood)
+    {
+      std::inclusive_scan(out, out + numElements, out, [](U lhs, U rhs) {
+        return static_cast<U>(lhs + rhs);
+      });
+    }
+    return isGood;
+  }
+
+  /// Time points counting integer ticks. Binary formats store ranges of them as the ticks of
+  /// the first one since the epoch followed by the difference to the previous one, each as a
+  /// zigzag varint: events a few milliseconds apart take one or two bytes instead of eight.
+  template <typename T>
+  concept delta_coded_element = concepts::time_point<T> && concepts::integer<typename T::rep>;
+
+  template <typename T, typename Codec>
+  concept delta_coded_range =
+    concepts::range_constructible_container<T> &&
+    delta_coded_element<typename T::value_type> &&
+    (concepts::varint_writer<Codec> || concepts::varint_reader<Codec>);
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_DELTA_CODING_HPP
@@ -0,0 +1,123 @@
+#ifndef ENKI_IMPL_FIXED_SIZE_HPP
+#define ENKI_IMPL_FIXED_SIZE_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki::detail
+{
+  /// Size of the types whose values do not all take the same number of bytes
+  inline constexpr size_t kVariableSize = std::numeric_limits<size_t>::max();
+
+  template <typename T, typename Policy>
+  constexpr size_t fixedSize();
+
+  /// Total size of `count` values of the given sizes, or `kVariableSize` if one of them varies
+  template <size_t... sizes>
+  constexpr size_t sumOfFixedSizes(size_t count = 1)
+  {
+    if constexpr (((sizes == kVariableSize) || ...))
+    {
+      return kVariableSize;
+    }
+    else
+    {
+      return count * (size_t{0} + ... + sizes);
+    }
+  }
+
+  template <typename T, typename Policy, size_t... idx>
+  constexpr size_t fixedSizeOfElements(std::index_sequence<idx...>)
+  {
+    return sumOfFixedSizes<fixedSize<std::tuple_element_t<idx, T>, Policy>()...>();
+  }
+
+  template <typename T, typename Policy, size_t... idx>
+  constexpr size_t fixedSizeOfMembers(std::index_sequence<idx...>)
+  {
+    using Members = typename T::EnkiSerial::Members;
+    return sumOfFixedSizes<fixedSize<
+      std::remove_cvref_t<typename get_nth_register_t<idx, Members>::value_type>,
+      Policy>()...>();
+  }
+
+  /// Types coding themselves through `EnkiSerial`, such as the wrappers deriving from the range
+  /// they encode: their size is not the one of what they derive from
+  template <typename T>
+  concept custom_coded =
+    requires { typename T::EnkiSerial; } && !concepts::custom_static_serializable<T>;
+
+  /// Number of bytes every value of `T` takes in binary formats with `Policy`, known at compile
+  /// time, or `kVariableSize`. Values holding a length, a flag or an index vary, as do tagged
+  /// structs and values the `aligned` policy may pad.
+  template <typename T, typename Policy>
+  constexpr size_t fixedSize()
+  {
+    if constexpr (std::same_as<T, std::monostate>)
+    {
+      return 0;
+    }
+    else if constexpr (custom_coded<T>)
+    {
+      return kVariableSize;
+    }
+    else if constexpr (has_policy_v<Policy, aligned_t> && alignof(T) > 1)
+    {
+      return kVariableSize;
+    }
+    else if constexpr (concepts::arithmetic_or_enum<T>)
+    {
+      if constexpr (is_compact_enum_v<Policy, T>)
+      {
+        return sizeof(compact_enum_t<T>);
+      }
+      else
+      {
+        return sizeof(T);
+      }
+    }
+    else if constexpr (concepts::duration<T>)
+    {
+      return fixedSize<typename T::rep, Policy>();
+    }
+    else if constexpr (concepts::time_point<T>)
+    {
+      return fixedSize<typename T::duration, Policy>();
+    }
+    else if constexpr (concepts::array_like<T>)
+    {
+      using Element = std::remove_cvref_t<decltype(*std::begin(std::declval<T &>()))>;
+      return sumOfFixedSizes<fixedSize<Element, Policy>()>(sizeof(T) / sizeof(Element));
+    }
+    else if constexpr (concepts::tuple_like<T>)
+    {
+      return fixedSizeOfElements<T, Policy>(std::make_index_sequence<std::tuple_size_v<T>>());
+    }
+    else if constexpr (
+      concepts::custom_static_serializable<T> && !has_policy_v<Policy, forward_compatible_t>)
+    {
+      return fixedSizeOfMembers<T, Policy>(
+        std::make_index_sequence<T::EnkiSerial::Members::count>());
+    }
+    else
+    {
+      return kVariableSize;
+    }
+  }
+
+  /// Types whose values all take `fixedSize<T, Policy>()` bytes
+  template <typename T, typename Policy>
+  concept fixed_size = fixedSize<T, Policy>() != kVariableSize;
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_FIXED_SIZE_HPP
@@ -0,0 +1,134 @@
+#ifndef ENKI_IMPL_FLOAT16_HPP
+#define ENKI_IMPL_FLOAT16_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace enki::detail
+{
+  /// Convert to IEEE 754 binary16, rounding to nearest even.
+  /// Values too large become infinities, NaNs stay (quiet) NaNs.
+  constexpr uint16_t floatToHalf(float value)
+  {
+    const auto bits = std::bit_cast<uint32_t>(value);
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const auto exponent = static_cast<int>((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF)
+    {
+      return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0));
+    }
+
+    const int halfExponent = exponent - 127 + 15;
+    if (halfExponent >= 0x1F)
+    {
+      return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    // Normal halves keep 10 of the 23 mantissa bits, subnormal ones even fewer
+    unsigned shift = 13;
+    uint32_t half = 0;
+    if (halfExponent <= 0)
+    {
+      if (halfExponent < -10)
+      {
+        return sign;
+      }
+      mantissa |= 0x800000;
+      shift = static_cast<unsigned>(14 - halfExponent);
+    }
+    else
+    {
+      half = static_cast<uint32_t>(halfExponent) << 10;
+    }
+    half |= mantissa >> shift;
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    const uint32_t remainder = mantissa & ((uint32_t{1} << shift) - 1);
+    const uint32_t halfway = uint32_t{1} << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+    {
+      ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+  }
+
+  /// Exact conversion from IEEE 754 binary16, signaling NaNs become quiet NaNs like with F16C
+  constexpr float halfToFloat(uint16_t half)
+  {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+
+    if (exponent == 0x1F)
+    {
+      const uint32_t quiet = mantissa != 0 ? 0x400000 : 0;
+      return std::bit_cast<float>(sign | 0x7F800000 | quiet | (mantissa << 13));
+    }
+    if (exponent != 0)
+    {
+      return std::bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+    }
+    if (mantissa == 0)
+    {
+      return std::bit_cast<float>(sign);
+    }
+
+    // Subnormal half: normalize the mantissa
+    uint32_t shift = 0;
+    while ((mantissa & 0x400) == 0)
+    {
+      mantissa <<= 1;
+      ++shift;
+    }
+    return std::bit_cast<float>(sign | ((127 - 14 - shift) << 23) | ((mantissa & 0x3FF) << 13));
+  }
+
+  /// Bulk conversions used by range wrappers, using F16C instructions when the target has them
+  constexpr void floatsToHalves(const float *in, uint16_t *out, size_t size)
+  {
+    size_t i = 0;
+#if defined(__F16C__)
+    if (!std::is_constant_evaluated())
+    {
+      for (; i + 8 <= size; i += 8)
+      {
+        const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), halves);
+      }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+      out[i] = floatToHalf(in[i]);
+    }
+  }
+
+  constexpr void halvesToFloats(const uint16_t *in, float *out, size_t size)
+  {
+    size_t i = 0;
+#if defined(__F16C__)
+    if (!std::is_constant_evaluated())
+    {
+      for (; i + 8 <= size; i += 8)
+      {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(halves));
+      }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+      out[i] = halfToFloat(in[i]);
+    }
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_FLOAT16_HPP
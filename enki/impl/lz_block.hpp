@@ -0,0 +1,329 @@
+#ifndef ENKI_IMPL_LZ_BLOCK_HPP
+#define ENKI_IMPL_LZ_BLOCK_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace enki::detail
+{
+  /// LZ77 block format (same layout as LZ4 blocks), a sequence of:
+  ///   token:    literal length (high nibble) and match length - 4 (low nibble), 15 meaning
+  ///             that the length continues in the next bytes (255 while it goes on)
+  ///   literals: bytes copied as they are
+  ///   offset:   2 bytes little endian, distance back to the start of the match
+  /// The last sequence only has literals, which end the block.
+  inline constexpr size_t kLzMinMatch = 4;
+  inline constexpr size_t kLzMaxOffset = 65535;
+  inline constexpr size_t kLzHashBits = 14;
+  inline constexpr size_t kLzLastLiterals = 5;    ///< Matches stop this far from the end
+  inline constexpr size_t kLzMatchSearchEnd = 12; ///< No match starts this close to the end
+
+  /// Largest compressed size of `size` bytes
+  constexpr size_t lzMaxCompressedSize(size_t size)
+  {
+    return size + size / 255 + 16;
+  }
+
+  /// Largest decompressed size of `size` compressed bytes: each byte adds at most 255 to a length
+  constexpr size_t lzMaxDecompressedSize(size_t size)
+  {
+    return size * 255 + 15;
+  }
+
+  inline uint32_t lzLoad32(const std::byte *pos)
+  {
+    uint32_t value = 0;
+    std::memcpy(&value, pos, sizeof(value));
+    return value;
+  }
+
+  inline uint32_t lzHash(uint32_t sequence)
+  {
+    return (sequence * 2654435761U) >> (32 - kLzHashBits);
+  }
+
+  /// Number of equal bytes at `a` and `b`, up to `limit`
+  inline size_t lzMatchLength(const std::byte *a, const std::byte *b, size_t limit)
+  {
+    size_t length = 0;
+    if constexpr (std::endian::native == std::endian::little)
+    {
+      while (length + sizeof(uint64_t) <= limit)
+      {
+        uint64_t wordA = 0;
+        uint64_t wordB = 0;
+        std::memcpy(&wordA, a + length, sizeof(uint64_t));
+        std::memcpy(&wordB, b + length, sizeof(uint64_t));
+        if (wordA != wordB)
+        {
+          return length + static_cast<size_t>(std::countr_zero(wordA ^ wordB)) / 8;
+        }
+        length += sizeof(uint64_t);
+      }
+    }
+    while (length < limit && a[length] == b[length])
+    {
+      ++length;
+    }
+    return length;
+  }
+
+  inline void writeLzLength(std::byte *&out, size_t length)
+  {
+    for (length -= 15; length >= 255; length -= 255)
+    {
+      *out++ = std::byte{255};
+    }
+    *out++ = static_cast<std::byte>(length);
+  }
+
+  inline void writeLzLiterals(
+    std::byte *&out,
+    const std::byte *literals,
+    size_t numLiterals,
+    uint8_t matchNibble)
+  {
+    *out++ = static_cast<std::byte>((std::min<size_t>(numLiterals, 15) << 4) | matchNibble);
+    if (numLiterals >= 15)
+    {
+      writeLzLength(out, numLiterals);
+    }
+    std::memcpy(out, literals, numLiterals);
+    out += numLiterals;
+  }
+
+  /// Compress `in` into `out`, which must hold `lzMaxCompressedSize(in.size())` bytes
+  /// `table` is reused from block to block and needs no clearing: candidates are checked.
+  /// Returns the compressed size.
+  inline size_t
+  compressLzBlock(std::span<const std::byte> in, std::byte *out, std::vector<uint32_t> &table)
+  {
+    table.resize(size_t{1} << kLzHashBits);
+    const std::byte *const base = in.data();
+    std::byte *pos = out;
+    size_t anchor = 0;
+    if (in.size() > kLzMatchSearchEnd)
+    {
+      const size_t matchEnd = in.size() - kLzLastLiterals;
+      const size_t searchEnd = in.size() - kLzMatchSearchEnd;
+      size_t current = 0;
+      size_t numMisses = 0;
+      while (current < searchEnd)
+      {
+        const uint32_t sequence = lzLoad32(base + current);
+        uint32_t &entry = table[lzHash(sequence)];
+        size_t candidate = entry;
+        entry = static_cast<uint32_t>(current);
+        if (
+          candidate >= current || current - candidate > kLzMaxOffset ||
+          lzLoad32(base + candidate) != sequence)
+        {
+          // Incompressible data is crossed faster and faster
+          current += 1 + (numMisses++ >> 6);
+          continue;
+        }
+        while (current > anchor && candidate > 0 && base[current - 1] == base[candidate - 1])
+        {
+          --current;
+          --candidate;
+        }
+        const size_t maxLength = matchEnd - current;
+        const size_t length =
+          kLzMinMatch + lzMatchLength(base + current + kLzMinMatch,
+                                      base + candidate + kLzMinMatch,
+                                      maxLength - kLzMinMatch);
+        const size_t lengthCode = length - kLzMinMatch;
+        writeLzLiterals(
+          pos,
+          base + anchor,
+          current - anchor,
+          static_cast<uint8_t>(std::min<size_t>(lengthCode, 15)));
+        const size_t offset = current - candidate;
+        *pos++ = static_cast<std::byte>(offset & 0xFF);
+        *pos++ = static_cast<std::byte>(offset >> 8);
+        if (lengthCode >= 15)
+        {
+          writeLzLength(pos, lengthCode);
+        }
+        current += length;
+        anchor = current;
+        numMisses = 0;
+      }
+    }
+    writeLzLiterals(pos, base + anchor, in.size() - anchor, 0);
+    return static_cast<size_t>(pos - out);
+  }
+
+  /// Read the continuation of a length, false if it runs past `end` or above `max`
+  inline bool
+  readLzLength(const std::byte *&pos, const std::byte *end, size_t &length, size_t max)
+  {
+    std::byte next{255};
+    while (next == std::byte{255})
+    {
+      if (pos == end)
+      {
+        return false;
+      }
+      next = *pos++;
+      length += static_cast<size_t>(next);
+      if (length > max)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Decompress `in` into `out`, which must be exactly the uncompressed size
+  /// Returns false on malformed input, without reading or writing out of bounds.
+  inline bool decompressLzBlock(std::span<const std::byte> in, std::span<std::byte> out)
+  {
+    const std::byte *pos = in.data();
+    const std::byte *const end = pos + in.size();
+    std::byte *outPos = out.data();
+    std::byte *const outEnd = outPos + out.size();
+    while (pos != end)
+    {
+      const auto token = static_cast<size_t>(*pos++);
+      size_t numLiterals = token >> 4;
+      if (numLiterals == 15 && !readLzLength(pos, end, numLiterals, out.size()))
+      {
+        return false;
+      }
+      if (
+        numLiterals > static_cast<size_t>(end - pos) ||
+        numLiterals > static_cast<size_t>(outEnd - outPos))
+      {
+        return false;
+      }
+      std::memcpy(outPos, pos, numLiterals);
+      pos += numLiterals;
+      outPos += numLiterals;
+      if (pos == end)
+      {
+        return outPos == outEnd;
+      }
+
+      if (end - pos < 2)
+      {
+        return false;
+      }
+      const size_t offset = static_cast<size_t>(pos[0]) | (static_cast<size_t>(pos[1]) << 8);
+      pos += 2;
+      size_t length = token & 15;
+      if (length == 15 && !readLzLength(pos, end, length, out.size()))
+      {
+        return false;
+      }
+      length += kLzMinMatch;
+      if (
+        offset == 0 || offset > static_cast<size_t>(outPos - out.data()) ||
+        length > static_cast<size_t>(outEnd - outPos))
+      {
+        return false;
+      }
+      const std::byte *match = outPos - offset;
+      if (offset >= length)
+      {
+        std::memcpy(outPos, match, length);
+        outPos += length;
+      }
+      else
+      {
+        // Overlapping match repeating the last `offset` bytes: copied in chunks whose size
+        // doubles, each a whole number of periods away from `match`
+        size_t numCopied = 0;
+        while (numCopied < length)
+        {
+          const size_t chunk = std::min(length - numCopied, offset + numCopied);
+          std::memcpy(outPos + numCopied, match, chunk);
+          numCopied += chunk;
+        }
+        outPos += length;
+      }
+    }
+    return false;
+  }
+
+  template <size_t elementSize>
+  void shuffleElements(const std::byte *in, std::byte *out, size_t numElements)
+  {
+    for (size_t i = 0; i < numElements; ++i)
+    {
+      for (size_t b = 0; b < elementSize; ++b)
+      {
+        out[b * numElements + i] = in[i * elementSize + b];
+      }
+    }
+  }
+
+  template <size_t elementSize>
+  void unshuffleElements(const std::byte *in, std::byte *out, size_t numElements)
+  {
+    for (size_t i = 0; i < numElements; ++i)
+    {
+      for (size_t b = 0; b < elementSize; ++b)
+      {
+        out[i * elementSize + b] = in[b * numElements + i];
+      }
+    }
+  }
+
+  /// Byte shuffle prefilter: the first bytes of all the elements, then the second bytes...
+  /// Neighbouring numbers differ in their low bytes, grouping bytes exposes longer repeats.
+  inline void
+  shuffleBytes(std::span<std::byte> bytes, size_t elementSize, std::vector<std::byte> &scratch)
+  {
+    const size_t numElements = bytes.size() / elementSize;
+    scratch.assign(bytes.begin(), bytes.end());
+    switch (elementSize)
+    {
+    case 2:
+      return shuffleElements<2>(scratch.data(), bytes.data(), numElements);
+    case 4:
+      return shuffleElements<4>(scratch.data(), bytes.data(), numElements);
+    case 8:
+      return shuffleElements<8>(scratch.data(), bytes.data(), numElements);
+    default:
+      for (size_t i = 0; i < numElements; ++i)
+      {
+        for (size_t b = 0; b < elementSize; ++b)
+        {
+          bytes[b * numElements + i] = scratch[i * elementSize + b];
+        }
+      }
+    }
+  }
+
+  inline void
+  unshuffleBytes(std::span<std::byte> bytes, size_t elementSize, std::vector<std::byte> &scratch)
+  {
+    const size_t numElements = bytes.size() / elementSize;
+    scratch.assign(bytes.begin(), bytes.end());
+    switch (elementSize)
+    {
+    case 2:
+      return unshuffleElements<2>(scratch.data(), bytes.data(), numElements);
+    case 4:
+      return unshuffleElements<4>(scratch.data(), bytes.data(), numElements);
+    case 8:
+      return unshuffleElements<8>(scratch.data(), bytes.data(), numElements);
+    default:
+      for (size_t i = 0; i < numElements; ++i)
+      {
+        for (size_t b = 0; b < elementSize; ++b)
+        {
+          bytes[i * elementSize + b] = scratch[b * numElements + i];
+        }
+      }
+    }
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_LZ_BLOCK_HPP
@@ -2,6 +2,7 @@
 #define ENKI_POLICIES_HPP
 
 #include <concepts>
+#include <type_traits>
 
 namespace enki
 {
@@ -24,6 +25,7 @@ namespace enki
   inline constexpr strict_t strict{}; // NOLINT
 
   /// Forward compatibility policy - skip unknown variants, set to monostate
+  /// Binary formats also tag struct members: unknown fields are skipped, missing ones defaulted
   /// Usage: enki::BinWriter writer(enki::forward_compatible);
   /// See docs/forward-compatibility.md for details
   struct forward_compatible_t : detail::PolicyTag // NOLINT
@@ -32,6 +34,112 @@ namespace enki
 
   inline constexpr forward_compatible_t forward_compatible{}; // NOLINT
 
+  /// Compact policy - binary formats store variant indices and enums declaring
+  /// `enki::EnumTraits` on the fewest bytes their compile-time range allows
+  /// Usage: enki::BinWriter writer(enki::compact);
+  struct compact_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr compact_t compact{}; // NOLINT
+
+  /// Dictionary policy - binary formats write each distinct string once and refer to repeats by
+  /// a varint id. Readers rebuild the table and can hand out `std::string_view`s into their input.
+  /// Usage: enki::BinWriter writer(enki::dictionary);
+  struct dictionary_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr dictionary_t dictionary{}; // NOLINT
+
+  /// Presence bitmap policy - binary formats gather the has-value flags of all the optional
+  /// members of a registered struct into one leading bitmap, absent members take no bytes.
+  /// Usage: enki::BinWriter writer(enki::presence_bitmap);
+  struct presence_bitmap_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr presence_bitmap_t presence_bitmap{}; // NOLINT
+
+  /// Aligned policy - binary formats place arithmetic values, raw element ranges and plain
+  /// registered structs at their natural alignment (relative to the start of the data), so that
+  /// `BinSpanReader` can hand out `std::span<const T>` and `const T *` pointing into its input.
+  /// Usage: enki::BinSpanWriter writer(enki::aligned, buffer);
+  struct aligned_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr aligned_t aligned{}; // NOLINT
+
+  /// Chunked policy - binary formats write range lengths as varints (one byte up to 63 elements)
+  /// with no 4 GB limit, and split ranges of more than 2^20 elements into chunks that readers
+  /// consume one at a time (see `enki::deserializeChunks`).
+  /// Usage: enki::BinWriter writer(enki::chunked);
+  struct chunked_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr chunked_t chunked{}; // NOLINT
+
+  /// Canonical policy - writers emit the elements of unordered containers sorted by key, so
+  /// that equal values always give identical bytes (hashable as cache keys). The encoding is
+  /// unchanged and readers need no policy to decode it.
+  /// Usage: enki::BinWriter writer(enki::canonical);
+  struct canonical_t : detail::PolicyTag // NOLINT
+  {
+  };
+
+  inline constexpr canonical_t canonical{}; // NOLINT
+
+  /// Combination of several policies
+  /// Usage: enki::BinWriter writer(enki::forward_compatible | enki::compact);
+  template <policy... Policies>
+  struct policy_set : detail::PolicyTag // NOLINT
+  {
+  };
+
+  namespace detail
+  {
+    template <typename Policy, typename Flag>
+    struct HasPolicy : std::is_same<Policy, Flag>
+    {
+    };
+
+    template <typename... Policies, typename Flag>
+    struct HasPolicy<policy_set<Policies...>, Flag> :
+      std::disjunction<HasPolicy<Policies, Flag>...>
+    {
+    };
+
+    template <policy P>
+    struct AsPolicySet
+    {
+      using type = policy_set<P>; // NOLINT
+    };
+
+    template <policy... Policies>
+    struct AsPolicySet<policy_set<Policies...>>
+    {
+      using type = policy_set<Policies...>; // NOLINT
+    };
+
+    template <policy... Lhs, policy... Rhs>
+    constexpr policy_set<Lhs..., Rhs...> joinPolicies(policy_set<Lhs...>, policy_set<Rhs...>)
+    {
+      return {};
+    }
+  } // namespace detail
+
+  /// True if `Policy` is `Flag` or a `policy_set` containing `Flag`
+  template <typename Policy, typename Flag>
+  inline constexpr bool has_policy_v = detail::HasPolicy<Policy, Flag>::value; // NOLINT
+
+  template <policy Lhs, policy Rhs>
+  constexpr auto operator|(Lhs, Rhs)
+  {
+    return detail::joinPolicies(
+      typename detail::AsPolicySet<Lhs>::type{}, typename detail::AsPolicySet<Rhs>::type{});
+  }
 } // namespace enki
 
 #endif // ENKI_POLICIES_HPP
@@ -0,0 +1,92 @@
+#ifndef ENKI_IMPL_PRESENCE_BITMAP_HPP
+#define ENKI_IMPL_PRESENCE_BITMAP_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki::detail
+{
+  template <typename Reg>
+  concept optional_member = concepts::optional_like<std::remove_cvref_t<typename Reg::value_type>>;
+
+  template <typename Members, size_t... idx>
+  constexpr size_t countOptionalMembers(std::index_sequence<idx...>)
+  {
+    return (size_t{optional_member<get_nth_register_t<idx, Members>>} + ... + 0);
+  }
+
+  template <typename T>
+  inline constexpr size_t optional_member_count_v = // NOLINT
+    countOptionalMembers<typename T::EnkiSerial::Members>(
+      std::make_index_sequence<T::EnkiSerial::Members::count>());
+
+  /// Position of the has-value flag of member `idx` of `T` in its presence bitmap
+  template <typename T, size_t idx>
+  inline constexpr size_t presence_bit_v = // NOLINT
+    countOptionalMembers<typename T::EnkiSerial::Members>(std::make_index_sequence<idx>());
+
+  /// One flag per member of a struct (optional members holding a value, members differing from
+  /// their default...), written as ceil(NumBits / 8) bytes
+  template <size_t NumBits>
+  class PresenceBitmap
+  {
+  public:
+    constexpr void set(size_t bit) noexcept
+    {
+      mBytes[bit / 8] |= std::byte{1} << (bit % 8);
+    }
+
+    constexpr bool test(size_t bit) const noexcept
+    {
+      return (mBytes[bit / 8] & (std::byte{1} << (bit % 8))) != std::byte{};
+    }
+
+    constexpr std::span<std::byte> bytes() noexcept
+    {
+      return mBytes;
+    }
+
+    constexpr std::span<const std::byte> bytes() const noexcept
+    {
+      return mBytes;
+    }
+
+  private:
+    std::array<std::byte, (NumBits + 7) / 8> mBytes{};
+  };
+
+  template <size_t NumBits, typename Reader>
+  constexpr Success readPresenceBitmap(PresenceBitmap<NumBits> &bitmap, Reader &&r)
+  {
+    std::span<const std::byte> bytes;
+    Success isGood = r.viewBytes(bitmap.bytes().size(), bytes);
+    std::copy(std::begin(bytes), std::end(bytes), std::begin(bitmap.bytes()));
+    return isGood;
+  }
+
+  /// Stands for the bitmap when the optional members carry their own flag
+  struct NoPresenceBitmap
+  {
+  };
+
+  template <typename T, typename Writer>
+  concept presence_bitmap_writer =
+    has_policy_v<typename std::remove_cvref_t<Writer>::policy_type, presence_bitmap_t> &&
+    concepts::byte_writer<Writer> && (optional_member_count_v<T> > 0);
+
+  template <typename T, typename Reader>
+  concept presence_bitmap_reader =
+    has_policy_v<typename std::remove_cvref_t<Reader>::policy_type, presence_bitmap_t> &&
+    concepts::byte_reader<Reader> && (optional_member_count_v<T> > 0);
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_PRESENCE_BITMAP_HPP
@@ -0,0 +1,728 @@
+#ifndef ENKI_IMPL_SCHEMA_DESCRIPTOR_HPP
+#define ENKI_IMPL_SCHEMA_DESCRIPTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "enki/bin_probe.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/tagged_struct.hpp"
+#include "enki/impl/utilities.hpp"
+#include "enki/impl/varint.hpp"
+
+namespace enki
+{
+  /// Kinds of values in a schema descriptor. Each kind is one byte, followed by:
+  ///   bytes:     varint number of bytes
+  ///   array:     varint number of elements, element type
+  ///   range:     element type (the data holds a `size_type` number of elements)
+  ///   delta_range: integer element type (the data holds a `size_type` number of elements,
+  ///              then the zigzag varint difference of each element to the previous one)
+  ///   tuple:     varint number of elements, element types
+  ///   optional:  value type (also `std::unique_ptr`)
+  ///   shared:    value type (the data holds a varint tag, see impl/shared_objects.hpp)
+  ///   variant:   index kind, varint number of alternatives, alternative types
+  ///   structure: varint number of members, then the name (varint length + characters) and the
+  ///              type of each member
+  ///   recursive: varint number of bytes back to the enclosing structure node it stands for, in
+  ///              self-referential types
+  /// Enums are described by the integer they are stored as, durations and time points by the
+  /// integer or floating point number of ticks they are stored as.
+  enum class SchemaKind : uint8_t
+  {
+    none = 0, ///< std::monostate, no bytes
+    boolean = 1,
+    uint8 = 2,
+    uint16 = 3,
+    uint32 = 4,
+    uint64 = 5,
+    int8 = 6,
+    int16 = 7,
+    int32 = 8,
+    int64 = 9,
+    float32 = 10,
+    float64 = 11,
+    bytes = 12, ///< Fixed number of raw bytes (long double...)
+    string = 13,
+    array = 14,
+    range = 15,
+    tuple = 16,
+    optional = 17,
+    variant = 18,
+    structure = 19,
+    opaque = 20, ///< Custom `EnkiSerial::serialize` encoding, cannot be walked
+    delta_range = 21, ///< Range of time points
+    shared = 22, ///< `std::shared_ptr`, each object written once
+    recursive = 23, ///< Enclosing struct, for types referring to themselves
+  };
+
+  namespace detail
+  {
+    inline constexpr std::byte kSchemaVersion{1};
+
+    /// Descriptor header: version, size of `size_type` and the policies of the writer
+    inline constexpr size_t kSchemaHeaderSize = 3;
+
+    /// Maximum nesting of types accepted by readers
+    inline constexpr size_t kMaxSchemaDepth = 64;
+
+    /// Descriptors written in a session: `(id << 1) | 1` for one already written, or
+    /// `size << 1` followed by the descriptor, which gets the next id
+    constexpr uint64_t sessionSchemaReferenceTag(uint64_t id)
+    {
+      return (id << 1) | 1;
+    }
+
+    constexpr uint64_t sessionSchemaLiteralTag(size_t size)
+    {
+      return uint64_t{size} << 1;
+    }
+
+    constexpr bool isSessionSchemaReference(uint64_t tag)
+    {
+      return (tag & 1) != 0;
+    }
+
+    template <typename Policy>
+    constexpr std::byte schemaPolicyFlags()
+    {
+      return static_cast<std::byte>(
+        (has_policy_v<Policy, forward_compatible_t> ? 1U : 0U) |
+        (has_policy_v<Policy, compact_t> ? 2U : 0U) |
+        (has_policy_v<Policy, dictionary_t> ? 4U : 0U) |
+        (has_policy_v<Policy, presence_bitmap_t> ? 8U : 0U) |
+        (has_policy_v<Policy, chunked_t> ? 16U : 0U));
+    }
+
+    /// Appends descriptor bytes, or only counts them when it has no output
+    struct SchemaBuilder
+    {
+      std::byte *out = nullptr;
+      size_t size = 0;
+      std::array<size_t, kMaxSchemaDepth> structStarts{}; ///< Structs being described
+      size_t numStructs = 0;
+
+      constexpr void put(std::byte b)
+      {
+        if (out != nullptr)
+        {
+          out[size] = b;
+        }
+        ++size;
+      }
+
+      constexpr void kind(SchemaKind k)
+      {
+        put(static_cast<std::byte>(k));
+      }
+
+      constexpr void varint(uint64_t v)
+      {
+        std::array<std::byte, kMaxVarintSize> bytes{};
+        const size_t numBytes = encodeVarint(v, bytes.data());
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+          put(bytes[i]);
+        }
+      }
+
+      constexpr void text(std::string_view str)
+      {
+        varint(str.size());
+        for (const char c : str)
+        {
+          put(static_cast<std::byte>(c));
+        }
+      }
+    };
+
+    template <typename T>
+    constexpr SchemaKind scalarKind()
+    {
+      if constexpr (std::same_as<T, bool>)
+      {
+        return SchemaKind::boolean;
+      }
+      else if constexpr (std::integral<T>)
+      {
+        constexpr std::array<SchemaKind, 4> unsignedKinds{
+          SchemaKind::uint8, SchemaKind::uint16, SchemaKind::uint32, SchemaKind::uint64};
+        constexpr std::array<SchemaKind, 4> signedKinds{
+          SchemaKind::int8, SchemaKind::int16, SchemaKind::int32, SchemaKind::int64};
+        constexpr size_t log2Size = std::bit_width(sizeof(T)) - 1;
+        return std::is_signed_v<T> ? signedKinds[log2Size] : unsignedKinds[log2Size];
+      }
+      else if constexpr (std::same_as<T, float> && sizeof(T) == 4)
+      {
+        return SchemaKind::float32;
+      }
+      else if constexpr (std::same_as<T, double> && sizeof(T) == 8)
+      {
+        return SchemaKind::float64;
+      }
+      else
+      {
+        return SchemaKind::bytes;
+      }
+    }
+
+    /// `Structs` are the structs being described, outermost first
+    template <typename T, typename Policy, typename SizeType, typename... Structs>
+    constexpr void describeSchema(SchemaBuilder &b);
+
+    template <typename T, typename... Structs>
+    constexpr size_t structIndex()
+    {
+      constexpr std::array<bool, sizeof...(Structs)> matches{std::same_as<T, Structs>...};
+      return static_cast<size_t>(std::ranges::find(matches, true) - matches.begin());
+    }
+
+    template <typename T, typename Policy, typename SizeType, typename... Structs, size_t... idx>
+    constexpr void describeTuple(SchemaBuilder &b, std::index_sequence<idx...>)
+    {
+      b.kind(SchemaKind::tuple);
+      b.varint(sizeof...(idx));
+      (describeSchema<std::remove_cv_t<std::tuple_element_t<idx, T>>, Policy, SizeType, Structs...>(
+         b),
+       ...);
+    }
+
+    template <typename T, typename Policy, typename SizeType, typename... Structs, size_t... idx>
+    constexpr void describeVariant(SchemaBuilder &b, std::index_sequence<idx...>)
+    {
+      b.kind(SchemaKind::variant);
+      b.kind(scalarKind<variant_index_t<T, Policy, SizeType>>());
+      b.varint(sizeof...(idx));
+      (describeSchema<std::variant_alternative_t<idx, T>, Policy, SizeType, Structs...>(b), ...);
+    }
+
+    template <typename T, typename Policy, typename SizeType, typename... Structs, size_t... idx>
+    constexpr void describeStruct(SchemaBuilder &b, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      b.structStarts[b.numStructs++] = b.size;
+      b.kind(SchemaKind::structure);
+      b.varint(sizeof...(idx));
+      const auto describeOne = [&b]<typename Reg>() {
+        b.text(Reg::name);
+        describeSchema<std::remove_cvref_t<typename Reg::value_type>, Policy, SizeType, Structs...>(
+          b);
+      };
+      (describeOne.template operator()<get_nth_register_t<idx, Members>>(), ...);
+      --b.numStructs;
+    }
+
+    /// Describe `T` as the binary writers with `Policy` encode it, following `serialize`
+    template <typename T, typename Policy, typename SizeType, typename... Structs>
+    constexpr void describeSchema(SchemaBuilder &b)
+    {
+      using Probe = BinProbe<Policy, SizeType>;
+      if constexpr (std::same_as<T, std::monostate>)
+      {
+        b.kind(SchemaKind::none);
+      }
+      else if constexpr (concepts::arithmetic_or_enum<T>)
+      {
+        using Stored = decltype([] {
+          if constexpr (is_compact_enum_v<Policy, T>)
+          {
+            return compact_enum_t<T>();
+          }
+          else if constexpr (std::is_enum_v<T>)
+          {
+            return std::underlying_type_t<T>();
+          }
+          else
+          {
+            return T();
+          }
+        }());
+        constexpr SchemaKind kind = scalarKind<Stored>();
+        b.kind(kind);
+        if constexpr (kind == SchemaKind::bytes)
+        {
+          b.varint(sizeof(Stored));
+        }
+      }
+      else if constexpr (concepts::duration<T>)
+      {
+        describeSchema<typename T::rep, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::time_point<T>)
+      {
+        describeSchema<typename T::duration, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::string_like<T>)
+      {
+        b.kind(SchemaKind::string);
+      }
+      else if constexpr (custom_serializable<T, Probe &>)
+      {
+        b.kind(SchemaKind::opaque);
+      }
+      else if constexpr (concepts::array_like<T>)
+      {
+        b.kind(SchemaKind::array);
+        if constexpr (std::is_array_v<T>)
+        {
+          b.varint(std::extent_v<T>);
+        }
+        else
+        {
+          b.varint(std::tuple_size_v<T>);
+        }
+        describeSchema<std::remove_cvref_t<decltype(*std::begin(std::declval<T &>()))>,
+                       Policy,
+                       SizeType,
+                       Structs...>(b);
+      }
+      else if constexpr (delta_coded_range<T, Probe &>)
+      {
+        b.kind(SchemaKind::delta_range);
+        describeSchema<typename T::value_type, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::range_constructible_container<T>)
+      {
+        b.kind(SchemaKind::range);
+        describeSchema<std::remove_cv_t<std::ranges::range_value_t<T>>,
+                       Policy,
+                       SizeType,
+                       Structs...>(b);
+      }
+      else if constexpr (concepts::tuple_like<T>)
+      {
+        describeTuple<T, Policy, SizeType, Structs...>(
+          b, std::make_index_sequence<std::tuple_size_v<T>>());
+      }
+      else if constexpr (concepts::optional_like<T>)
+      {
+        b.kind(SchemaKind::optional);
+        describeSchema<typename T::value_type, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::unique_pointer<T>)
+      {
+        b.kind(SchemaKind::optional);
+        describeSchema<std::remove_cv_t<typename T::element_type>, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::shared_pointer<T>)
+      {
+        b.kind(SchemaKind::shared);
+        describeSchema<std::remove_cv_t<typename T::element_type>, Policy, SizeType, Structs...>(b);
+      }
+      else if constexpr (concepts::variant_like<T>)
+      {
+        describeVariant<T, Policy, SizeType, Structs...>(
+          b, std::make_index_sequence<std::variant_size_v<T>>());
+      }
+      else if constexpr (
+        concepts::custom_static_serializable<T> && (std::same_as<T, Structs> || ...))
+      {
+        // Self-referential type: refers back to the enclosing description of `T`
+        const size_t distance = b.size - b.structStarts[structIndex<T, Structs...>()];
+        b.kind(SchemaKind::recursive);
+        b.varint(distance);
+      }
+      else if constexpr (concepts::custom_static_serializable<T>)
+      {
+        describeStruct<T, Policy, SizeType, Structs..., T>(
+          b, std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+      else
+      {
+        static_assert(!sizeof(T), "Cannot describe value");
+      }
+    }
+
+    template <typename T, typename Policy, typename SizeType>
+    constexpr void describeSchemaWithHeader(SchemaBuilder &b)
+    {
+      b.put(kSchemaVersion);
+      b.put(static_cast<std::byte>(sizeof(SizeType)));
+      b.put(schemaPolicyFlags<Policy>());
+      describeSchema<T, Policy, SizeType>(b);
+    }
+
+    template <typename T, typename Policy, typename SizeType>
+    constexpr auto makeSchema()
+    {
+      constexpr size_t size = [] {
+        SchemaBuilder counter;
+        describeSchemaWithHeader<T, Policy, SizeType>(counter);
+        return counter.size;
+      }();
+      std::array<std::byte, size> bytes{};
+      SchemaBuilder builder{bytes.data()};
+      describeSchemaWithHeader<T, Policy, SizeType>(builder);
+      return bytes;
+    }
+
+    /// Read a varint from a descriptor already checked by `validateSchemaNode`
+    inline uint64_t readSchemaVarint(const std::byte *&pos)
+    {
+      uint64_t value = 0;
+      size_t numBytes = 0;
+      decodeVarint(pos, kMaxVarintSize, value, numBytes);
+      pos += numBytes;
+      return value;
+    }
+
+    inline bool isSchemaScalar(SchemaKind kind)
+    {
+      return kind >= SchemaKind::boolean && kind <= SchemaKind::float64;
+    }
+
+    inline bool isSchemaInteger(SchemaKind kind)
+    {
+      return kind >= SchemaKind::uint8 && kind <= SchemaKind::int64;
+    }
+
+    /// Size of the scalar kinds, 0 for the others
+    inline size_t schemaScalarSize(SchemaKind kind)
+    {
+      switch (kind)
+      {
+      case SchemaKind::boolean:
+      case SchemaKind::uint8:
+      case SchemaKind::int8:
+        return 1;
+      case SchemaKind::uint16:
+      case SchemaKind::int16:
+        return 2;
+      case SchemaKind::uint32:
+      case SchemaKind::int32:
+      case SchemaKind::float32:
+        return 4;
+      case SchemaKind::uint64:
+      case SchemaKind::int64:
+      case SchemaKind::float64:
+        return 8;
+      default:
+        return 0;
+      }
+    }
+
+    /// Nodes enclosing the one being validated, by depth
+    using SchemaAncestors = std::array<const std::byte *, kMaxSchemaDepth + 1>;
+
+    /// End of the type descriptor starting at `pos`, or nullptr if it is malformed
+    /// Recursive nodes must refer to an enclosing structure node in `ancestors`, through a range,
+    /// an optional, a shared object or a variant.
+    inline const std::byte *validateSchemaNode(
+      const std::byte *pos,
+      const std::byte *end,
+      size_t depth,
+      SchemaAncestors &ancestors)
+    {
+      const auto readVarint = [&](uint64_t &value) {
+        size_t numBytes = 0;
+        if (
+          decodeVarint(pos, static_cast<size_t>(end - pos), value, numBytes) !=
+          VarintStatus::ok)
+        {
+          return false;
+        }
+        pos += numBytes;
+        return true;
+      };
+      const auto validateChildren = [&](uint64_t numChildren) {
+        for (uint64_t i = 0; i < numChildren && pos != nullptr; ++i)
+        {
+          pos = validateSchemaNode(pos, end, depth + 1, ancestors);
+        }
+        return pos != nullptr;
+      };
+
+      if (pos == end || depth > kMaxSchemaDepth)
+      {
+        return nullptr;
+      }
+      ancestors[depth] = pos;
+      const auto kind = static_cast<SchemaKind>(*pos++);
+      uint64_t count = 0;
+      switch (kind)
+      {
+      case SchemaKind::none:
+      case SchemaKind::string:
+      case SchemaKind::opaque:
+        return pos;
+      case SchemaKind::bytes:
+        return readVarint(count) ? pos : nullptr;
+      case SchemaKind::array:
+        return readVarint(count) && validateChildren(1) ? pos : nullptr;
+      case SchemaKind::range:
+      case SchemaKind::optional:
+      case SchemaKind::shared:
+        return validateChildren(1) ? pos : nullptr;
+      case SchemaKind::delta_range:
+        if (pos == end || !isSchemaInteger(static_cast<SchemaKind>(*pos)))
+        {
+          return nullptr;
+        }
+        return pos + 1;
+      case SchemaKind::tuple:
+        return readVarint(count) && validateChildren(count) ? pos : nullptr;
+      case SchemaKind::variant:
+        if (pos == end || schemaScalarSize(static_cast<SchemaKind>(*pos)) == 0 ||
+            static_cast<SchemaKind>(*pos) == SchemaKind::boolean)
+        {
+          return nullptr;
+        }
+        ++pos;
+        return readVarint(count) && validateChildren(count) ? pos : nullptr;
+      case SchemaKind::structure:
+        if (!readVarint(count))
+        {
+          return nullptr;
+        }
+        for (uint64_t i = 0; i < count; ++i)
+        {
+          uint64_t nameSize = 0;
+          if (!readVarint(nameSize) || nameSize > static_cast<uint64_t>(end - pos))
+          {
+            return nullptr;
+          }
+          pos += nameSize;
+          if (!validateChildren(1))
+          {
+            return nullptr;
+          }
+        }
+        return pos;
+      case SchemaKind::recursive:
+      {
+        // The enclosing struct, with a node reading at least a byte in between so that walks
+        // always move forward in the data
+        const std::byte *const node = ancestors[depth];
+        if (!readVarint(count))
+        {
+          return nullptr;
+        }
+        bool isIndirect = false;
+        for (size_t i = depth; i-- > 0;)
+        {
+          const auto ancestorKind = static_cast<SchemaKind>(*ancestors[i]);
+          if (static_cast<uint64_t>(node - ancestors[i]) == count)
+          {
+            return ancestorKind == SchemaKind::structure && isIndirect ? pos : nullptr;
+          }
+          isIndirect = isIndirect || ancestorKind == SchemaKind::range ||
+                       ancestorKind == SchemaKind::optional || ancestorKind == SchemaKind::shared ||
+                       ancestorKind == SchemaKind::variant;
+        }
+        return nullptr;
+      }
+      default:
+        return isSchemaScalar(kind) ? pos : nullptr;
+      }
+    }
+
+    inline const std::byte *
+    validateSchemaNode(const std::byte *pos, const std::byte *end, size_t depth)
+    {
+      SchemaAncestors ancestors{};
+      return validateSchemaNode(pos, end, depth, ancestors);
+    }
+
+    /// End of a type descriptor already validated
+    inline const std::byte *skipSchemaNode(const std::byte *pos);
+
+    inline const std::byte *skipSchemaChildren(const std::byte *pos, uint64_t numChildren)
+    {
+      for (uint64_t i = 0; i < numChildren; ++i)
+      {
+        pos = skipSchemaNode(pos);
+      }
+      return pos;
+    }
+
+    inline const std::byte *skipSchemaNode(const std::byte *pos)
+    {
+      const auto kind = static_cast<SchemaKind>(*pos++);
+      switch (kind)
+      {
+      case SchemaKind::bytes:
+      case SchemaKind::recursive:
+        readSchemaVarint(pos);
+        return pos;
+      case SchemaKind::array:
+        readSchemaVarint(pos);
+        return skipSchemaNode(pos);
+      case SchemaKind::range:
+      case SchemaKind::delta_range:
+      case SchemaKind::optional:
+      case SchemaKind::shared:
+        return skipSchemaNode(pos);
+      case SchemaKind::tuple:
+        return skipSchemaChildren(pos, readSchemaVarint(pos));
+      case SchemaKind::variant:
+        ++pos;
+        return skipSchemaChildren(pos, readSchemaVarint(pos));
+      case SchemaKind::structure:
+      {
+        const uint64_t numMembers = readSchemaVarint(pos);
+        for (uint64_t i = 0; i < numMembers; ++i)
+        {
+          pos += readSchemaVarint(pos);
+          pos = skipSchemaNode(pos);
+        }
+        return pos;
+      }
+      default:
+        return pos;
+      }
+    }
+
+    /// Structure node a recursive node refers to, or `pos` itself for other kinds
+    inline const std::byte *resolveSchemaNode(const std::byte *pos)
+    {
+      if (static_cast<SchemaKind>(*pos) != SchemaKind::recursive)
+      {
+        return pos;
+      }
+      const std::byte *distance = pos + 1;
+      return pos - readSchemaVarint(distance);
+    }
+  } // namespace detail
+
+  /// Descriptor of `T` as binary writers with `Policy` and `SizeType` encode it, computed at
+  /// compile time. Member names come from `Register`.
+  template <typename T, policy Policy = strict_t, typename SizeType = uint32_t>
+    requires(!has_policy_v<Policy, aligned_t>)
+  inline constexpr auto schema_v = detail::makeSchema<T, Policy, SizeType>(); // NOLINT
+
+  /// View of one type inside a validated schema descriptor
+  class SchemaNode
+  {
+  public:
+    explicit SchemaNode(const std::byte *pos) :
+      mPos(pos)
+    {
+    }
+
+    SchemaKind kind() const
+    {
+      return static_cast<SchemaKind>(*mPos);
+    }
+
+    /// Number of elements of an array, elements of a tuple, alternatives of a variant, members
+    /// of a struct or bytes of a `bytes` value
+    size_t size() const
+    {
+      switch (kind())
+      {
+      case SchemaKind::bytes:
+      case SchemaKind::array:
+      case SchemaKind::tuple:
+      case SchemaKind::structure:
+      {
+        const std::byte *pos = mPos + 1;
+        return detail::readSchemaVarint(pos);
+      }
+      case SchemaKind::variant:
+      {
+        const std::byte *pos = mPos + 2;
+        return detail::readSchemaVarint(pos);
+      }
+      case SchemaKind::range:
+      case SchemaKind::delta_range:
+      case SchemaKind::optional:
+      case SchemaKind::shared:
+        return 1;
+      default:
+        return 0;
+      }
+    }
+
+    /// Element type of an array or a range, value type of an optional, `i`-th element of a
+    /// tuple, alternative of a variant or member of a struct. Types referring to themselves
+    /// give the node of the enclosing struct again.
+    SchemaNode child(size_t i = 0) const
+    {
+      return SchemaNode(detail::resolveSchemaNode(childAt(i)));
+    }
+
+    /// Name of the `i`-th member of a struct
+    std::string_view memberName(size_t i) const
+    {
+      const std::byte *pos = memberAt(i);
+      const size_t nameSize = detail::readSchemaVarint(pos);
+      return {reinterpret_cast<const char *>(pos), nameSize};
+    }
+
+    /// Position of the member called `name` in a struct
+    std::optional<size_t> memberIndex(std::string_view name) const
+    {
+      for (size_t i = 0; i < size(); ++i)
+      {
+        if (memberName(i) == name)
+        {
+          return i;
+        }
+      }
+      return std::nullopt;
+    }
+
+    /// Kind of the index of a variant
+    SchemaKind indexKind() const
+    {
+      return static_cast<SchemaKind>(mPos[1]);
+    }
+
+  private:
+    const std::byte *childAt(size_t i) const
+    {
+      const std::byte *pos = mPos + 1;
+      switch (kind())
+      {
+      case SchemaKind::array:
+        detail::readSchemaVarint(pos);
+        return pos;
+      case SchemaKind::tuple:
+        detail::readSchemaVarint(pos);
+        return detail::skipSchemaChildren(pos, i);
+      case SchemaKind::variant:
+        ++pos;
+        detail::readSchemaVarint(pos);
+        return detail::skipSchemaChildren(pos, i);
+      case SchemaKind::structure:
+        pos = memberAt(i);
+        pos += detail::readSchemaVarint(pos);
+        return pos;
+      default:
+        return pos;
+      }
+    }
+
+    const std::byte *memberAt(size_t i) const
+    {
+      const std::byte *pos = mPos + 1;
+      detail::readSchemaVarint(pos);
+      for (size_t j = 0; j < i; ++j)
+      {
+        pos += detail::readSchemaVarint(pos);
+        pos = detail::skipSchemaNode(pos);
+      }
+      return pos;
+    }
+
+    const std::byte *mPos;
+  };
+} // namespace enki
+
+#endif // ENKI_IMPL_SCHEMA_DESCRIPTOR_HPP
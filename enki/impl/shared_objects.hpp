@@ -0,0 +1,222 @@
+#ifndef ENKI_IMPL_SHARED_OBJECTS_HPP
+#define ENKI_IMPL_SHARED_OBJECTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "enki/impl/policies.hpp"
+
+namespace enki::detail
+{
+  /// Binary formats write every `std::shared_ptr` as one varint tag:
+  ///   (id << 1) | 1       the object was already written with this id
+  ///   0                   null pointer
+  ///   2                   the object is new: its value follows and it gets the next id
+  ///   4                   same, but the object does not get an id
+  /// With the `forward_compatible` policy the value of a new object is preceded by its size, so
+  /// that readers skipping the object still give it its id. Objects first written inside other
+  /// skippable content (sized struct members and variants) only keep their id until the end of
+  /// that content, like dictionary strings.
+  inline constexpr uint64_t kNullObjectTag = 0;
+
+  constexpr uint64_t objectReferenceTag(uint64_t id)
+  {
+    return (id << 1) | 1;
+  }
+
+  constexpr uint64_t objectLiteralTag(bool isInserted)
+  {
+    return isInserted ? 2 : 4;
+  }
+
+  constexpr bool isObjectReference(uint64_t tag)
+  {
+    return (tag & 1) != 0;
+  }
+
+  /// Identifies the type of shared objects without RTTI: an object and its first member have
+  /// the same address, but not the same type
+  template <typename T>
+  inline constexpr char kObjectTypeTag = 0; // NOLINT
+
+  template <typename T>
+  constexpr const void *objectTypeOf()
+  {
+    return &kObjectTypeTag<std::remove_cv_t<T>>;
+  }
+
+  /// Writer side: ids of the objects written so far, by address
+  /// The objects are kept alive so that their addresses cannot be reused by new objects.
+  /// Only formats with skippable content (`IsScoped`) track the objects inserted inside it.
+  template <bool IsScoped>
+  class ObjectIds
+  {
+  public:
+    /// Returns true and sets `id` if `object` was already inserted
+    template <typename T>
+    bool find(const std::shared_ptr<T> &object, uint64_t &id) const
+    {
+      const auto it = mIds.find(object.get());
+      if (it == mIds.end() || it->second.type != objectTypeOf<T>())
+      {
+        return false;
+      }
+      id = it->second.id;
+      return true;
+    }
+
+    /// Give `object` the next id, unless another object of a different type has the same
+    /// address
+    /// Returns whether `object` got an id
+    template <typename T>
+    bool insert(const std::shared_ptr<T> &object)
+    {
+      const bool isInserted =
+        mIds.try_emplace(object.get(), Entry{object, objectTypeOf<T>(), mIds.size()}).second;
+      if constexpr (IsScoped)
+      {
+        if (isInserted && !mScopes.empty())
+        {
+          mScoped.push_back(object.get());
+        }
+      }
+      return isInserted;
+    }
+
+    /// Objects inserted until the matching `endSkippable` lose their id there
+    void beginSkippable()
+      requires IsScoped
+    {
+      mScopes.push_back(mIds.size());
+    }
+
+    void endSkippable()
+      requires IsScoped
+    {
+      const size_t numIds = mScopes.back();
+      mScopes.pop_back();
+      while (mIds.size() > numIds)
+      {
+        mIds.erase(mScoped.back());
+        mScoped.pop_back();
+      }
+    }
+
+    /// Objects inserted until the matching `endIsolated` are numbered from 0 and cannot refer
+    /// to the objects inserted before, so that the content can be decoded on its own
+    void beginIsolated()
+    {
+      mIsolated.push_back({std::move(mIds), std::move(mScopes), std::move(mScoped)});
+      mIds.clear();
+      mScopes.clear();
+      mScoped.clear();
+    }
+
+    void endIsolated()
+    {
+      State &state = mIsolated.back();
+      mIds = std::move(state.ids);
+      mScopes = std::move(state.scopes);
+      mScoped = std::move(state.scoped);
+      mIsolated.pop_back();
+    }
+
+    size_t size() const noexcept
+    {
+      return mIds.size();
+    }
+
+    void clear() noexcept
+    {
+      mIds.clear();
+      mScopes.clear();
+      mScoped.clear();
+      mIsolated.clear();
+    }
+
+  private:
+    struct Entry
+    {
+      std::shared_ptr<const void> object;
+      const void *type;
+      uint64_t id;
+    };
+
+    using Ids = std::unordered_map<const void *, Entry>;
+
+    struct State
+    {
+      Ids ids;
+      std::vector<size_t> scopes;
+      std::vector<const void *> scoped;
+    };
+
+    Ids mIds;
+    std::vector<size_t> mScopes;       // Number of ids when each skippable content began
+    std::vector<const void *> mScoped; // Objects inserted inside skippable content, in order
+    std::vector<State> mIsolated;      // Ids set aside while isolated content is written
+  };
+
+  template <typename Policy>
+  using object_ids_t = ObjectIds<has_policy_v<Policy, forward_compatible_t>>; // NOLINT
+
+  /// Reader side: objects read so far, shared again by the references to them
+  class ObjectTable
+  {
+  public:
+    template <typename T>
+    void add(const std::shared_ptr<T> &object)
+    {
+      mEntries.push_back({object, objectTypeOf<T>()});
+    }
+
+    /// Give the next id to an object that was skipped: references to it cannot be read
+    void addSkipped()
+    {
+      mEntries.push_back({nullptr, nullptr});
+    }
+
+    /// Returns false if `id` was never added, was skipped or is an object of another type
+    template <typename T>
+    bool get(uint64_t id, std::shared_ptr<T> &object) const
+    {
+      if (id >= mEntries.size() || mEntries[id].type != objectTypeOf<T>())
+      {
+        return false;
+      }
+      object = std::static_pointer_cast<T>(mEntries[id].object);
+      return true;
+    }
+
+    size_t size() const noexcept
+    {
+      return mEntries.size();
+    }
+
+    /// Forget the objects added after the first `size` ones
+    void truncate(size_t size)
+    {
+      mEntries.resize(size);
+    }
+
+    void clear() noexcept
+    {
+      mEntries.clear();
+    }
+
+  private:
+    struct Entry
+    {
+      std::shared_ptr<void> object;
+      const void *type;
+    };
+
+    std::vector<Entry> mEntries;
+  };
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_SHARED_OBJECTS_HPP
@@ -0,0 +1,275 @@
+#ifndef ENKI_IMPL_SKIP_HPP
+#define ENKI_IMPL_SKIP_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
+#include "enki/impl/fixed_size.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/presence_bitmap.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/tagged_struct.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki::detail
+{
+  template <typename T, typename Reader>
+  constexpr Success skipTyped(Reader &r);
+
+  /// Types whose `EnkiSerial` provides its own `skip(reader)`, moving past a value without
+  /// decoding it
+  template <typename T, typename Reader>
+  concept custom_skippable = requires(Reader r) {
+    { T::EnkiSerial::skip(r) } -> std::same_as<enki::Success>;
+  };
+
+  template <typename Reader>
+  constexpr Success skipBytes(size_t numBytes, Reader &r)
+  {
+    std::span<const std::byte> bytes;
+    return r.viewBytes(numBytes, bytes);
+  }
+
+  /// `numElements` elements of a range, in one jump when they have a fixed size
+  template <typename E, typename Reader>
+  constexpr Success skipElements(size_t numElements, Reader &r)
+  {
+    using Policy = typename Reader::policy_type;
+    if constexpr (fixed_size<E, Policy>)
+    {
+      if (fixedSize<E, Policy>() > 0 && !fitsInRemainingBytes(numElements, r))
+      {
+        return "Range size exceeds remaining data";
+      }
+      return skipBytes(numElements * fixedSize<E, Policy>(), r);
+    }
+    else
+    {
+      Success isGood;
+      for (size_t i = 0; i < numElements && isGood; ++i)
+      {
+        isGood.update(skipTyped<E>(r));
+      }
+      return isGood;
+    }
+  }
+
+  template <typename T, typename Reader>
+  constexpr Success skipRange(Reader &r)
+  {
+    using E = assignable_value_t<T>;
+    size_t numElements = 0;
+    bool isLast = true;
+    Success isGood;
+    if constexpr (chunked_range_reader<Reader>)
+    {
+      isGood = r.rangeChunk(numElements, isLast);
+    }
+    else
+    {
+      isGood = r.rangeBegin(numElements);
+    }
+    if (!isGood || !isGood.update(alignFor<typename T::value_type>(r)))
+    {
+      return isGood;
+    }
+    while (isGood.update(skipElements<E>(numElements, r)) && !isLast)
+    {
+      if constexpr (chunked_range_reader<Reader>)
+      {
+        isGood.update(r.rangeChunk(numElements, isLast));
+      }
+    }
+    return isGood;
+  }
+
+  template <typename T, typename Reader, size_t... idx>
+  constexpr Success skipElementsOf(Reader &r, std::index_sequence<idx...>)
+  {
+    Success isGood;
+    static_cast<void>(
+      (isGood.update(skipTyped<std::remove_cvref_t<std::tuple_element_t<idx, T>>>(r)) && ...));
+    return isGood;
+  }
+
+  template <typename T, typename Reader, size_t... idx>
+  constexpr Success skipMembersOf(Reader &r, std::index_sequence<idx...>)
+  {
+    using Members = typename T::EnkiSerial::Members;
+    Success isGood = alignFor<T>(r);
+    auto presence = [] {
+      if constexpr (presence_bitmap_reader<T, Reader>)
+      {
+        return PresenceBitmap<optional_member_count_v<T>>();
+      }
+      else
+      {
+        return NoPresenceBitmap{};
+      }
+    }();
+    if constexpr (presence_bitmap_reader<T, Reader>)
+    {
+      isGood.update(readPresenceBitmap(presence, r));
+    }
+    if (!isGood)
+    {
+      return isGood;
+    }
+    static_cast<void>(
+      (isGood.update(
+         skipOneCustom<get_nth_register_t<idx, Members>, presence_bit_v<T, idx>>(r, presence)) &&
+       ...));
+    return isGood ? isGood.update(alignFor<T>(r)) : isGood;
+  }
+
+  /// Forward compatible binary formats: every field of a tagged struct carries its size
+  template <typename Reader>
+  constexpr Success skipTaggedFields(Reader &r)
+  {
+    uint64_t numFields = 0;
+    Success isGood = r.readVarint(numFields);
+    for (uint64_t i = 0; i < numFields && isGood; ++i)
+    {
+      uint64_t tag = 0;
+      if (isGood.update(r.readVarint(tag)))
+      {
+        isGood.update(skipTaggedField(tag, r));
+      }
+    }
+    return isGood;
+  }
+
+  template <typename T, typename Reader, size_t... idx>
+  constexpr Success skipAlternative(size_t index, Reader &r, std::index_sequence<idx...>)
+  {
+    Success isGood;
+    const auto skipOne = [&]<typename Alternative>() {
+      isGood = skipTyped<Alternative>(r);
+      return true;
+    };
+    static_cast<void>(
+      ((idx == index && skipOne.template operator()<std::variant_alternative_t<idx, T>>()) ||
+       ...));
+    return isGood;
+  }
+
+  template <typename T, typename Reader>
+  constexpr Success skipVariant(Reader &r)
+  {
+    using Policy = typename Reader::policy_type;
+    variant_index_t<T, Policy, typename Reader::size_type> index{};
+    Success isGood = r.readVariantIndex(index);
+    if (!isGood)
+    {
+      return isGood;
+    }
+    if constexpr (has_policy_v<Policy, forward_compatible_t>)
+    {
+      // The value is prefixed by its size, whether its alternative is known or not
+      return isGood.update(r.skipHintAndValue());
+    }
+    else
+    {
+      if (index >= std::variant_size_v<T>)
+      {
+        return isGood.update("Deserialized variant index is out of range");
+      }
+      return isGood.update(
+        skipAlternative<T>(index, r, std::make_index_sequence<std::variant_size_v<T>>()));
+    }
+  }
+
+  /// Move reader `r` past a value of type `T` without decoding it when possible. Binary
+  /// values of fixed size and ranges of them are jumped over, strings and other ranges only have
+  /// their length read, variants and structs are walked through. Values whose decoding has side
+  /// effects on the reader (dictionary strings, shared objects) or depends on the previous ones
+  /// (delta coded ranges) are deserialized into a temporary, as are types decoding themselves
+  /// through `EnkiSerial` unless they provide `skip`. JSON values are skipped by their structure.
+  template <typename T, typename Reader>
+  constexpr Success skipTyped(Reader &r)
+  {
+    using Policy = typename Reader::policy_type;
+    if constexpr (!concepts::byte_reader<Reader>)
+    {
+      return r.skipHintAndValue();
+    }
+    else if constexpr (custom_skippable<T, Reader>)
+    {
+      return T::EnkiSerial::skip(r);
+    }
+    else if constexpr (custom_deserializable<T, Reader>)
+    {
+      // Wrappers deriving from their range have an encoding of their own
+      T value{};
+      return deserialize(value, r);
+    }
+    else if constexpr (fixed_size<T, Policy>)
+    {
+      return skipBytes(fixedSize<T, Policy>(), r);
+    }
+    else if constexpr (concepts::string_like<T> && !has_policy_v<Policy, dictionary_t>)
+    {
+      return skipRange<T>(r);
+    }
+    else if constexpr (concepts::optional_like<T> || concepts::unique_pointer<T>)
+    {
+      using V = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<T &>())>>;
+      bool hasValue = false;
+      Success isGood = r.readOptionalHasValue(hasValue);
+      if (isGood && hasValue)
+      {
+        isGood.update(skipTyped<V>(r));
+      }
+      return isGood;
+    }
+    else if constexpr (concepts::array_like<T>)
+    {
+      using E = std::remove_cvref_t<decltype(*std::begin(std::declval<T &>()))>;
+      return skipElements<E>(sizeof(T) / sizeof(E), r);
+    }
+    else if constexpr (
+      concepts::range_constructible_container<T> && !delta_coded_range<T, Reader> &&
+      !concepts::string_like<T>)
+    {
+      return skipRange<T>(r);
+    }
+    else if constexpr (concepts::tuple_like<T>)
+    {
+      return skipElementsOf<T>(r, std::make_index_sequence<std::tuple_size_v<T>>());
+    }
+    else if constexpr (concepts::variant_like<T>)
+    {
+      return skipVariant<T>(r);
+    }
+    else if constexpr (concepts::custom_static_serializable<T>)
+    {
+      if constexpr (tagged_struct_reader<Reader>)
+      {
+        return skipTaggedFields(r);
+      }
+      else
+      {
+        return skipMembersOf<T>(r, std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+    }
+    else
+    {
+      T value{};
+      return deserialize(value, r);
+    }
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_SKIP_HPP
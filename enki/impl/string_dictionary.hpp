@@ -0,0 +1,204 @@
+#ifndef ENKI_IMPL_STRING_DICTIONARY_HPP
+#define ENKI_IMPL_STRING_DICTIONARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "enki/impl/policies.hpp"
+
+namespace enki::detail
+{
+  /// With the `dictionary` policy every string is written as one varint tag:
+  ///   (id << 1) | 1       the string was already written with this id
+  ///   (size << 2)         the string is new: its `size` bytes follow and it gets the next id
+  ///   (size << 2) | 2     same, but the string does not get an id
+  /// Strings inside skippable content (forward compatible struct members and variants) only
+  /// keep their id until the end of that content: readers skipping it number the following
+  /// strings like the writer, readers decoding it drop the strings it added at its end.
+  constexpr uint64_t dictionaryReferenceTag(uint64_t id)
+  {
+    return (id << 1) | 1;
+  }
+
+  constexpr uint64_t dictionaryLiteralTag(size_t size, bool isInserted)
+  {
+    return (uint64_t{size} << 2) | (isInserted ? 0 : 2);
+  }
+
+  constexpr bool isDictionaryReference(uint64_t tag)
+  {
+    return (tag & 1) != 0;
+  }
+
+  constexpr bool isInsertedDictionaryLiteral(uint64_t tag)
+  {
+    return (tag & 2) == 0;
+  }
+
+  /// Writer side: ids of the strings written so far
+  class StringIds
+  {
+  public:
+    /// Returns true and sets `id` if `str` was already inserted
+    bool find(std::string_view str, uint64_t &id) const
+    {
+      const auto it = mIds.find(str);
+      if (it == mIds.end())
+      {
+        return false;
+      }
+      id = it->second;
+      return true;
+    }
+
+    /// Give `str` the next id
+    void insert(std::string_view str)
+    {
+      const auto it = mIds.emplace(str, mIds.size()).first;
+      if (!mScopes.empty())
+      {
+        mScoped.emplace_back(it->first);
+      }
+    }
+
+    /// Strings inserted until the matching `endSkippable` lose their id there
+    void beginSkippable()
+    {
+      mScopes.push_back(mIds.size());
+    }
+
+    void endSkippable()
+    {
+      const size_t numIds = mScopes.back();
+      mScopes.pop_back();
+      while (mIds.size() > numIds)
+      {
+        mIds.erase(mIds.find(mScoped.back()));
+        mScoped.pop_back();
+      }
+    }
+
+    /// Strings inserted until the matching `endIsolated` are numbered from 0 and cannot refer
+    /// to the strings inserted before, so that the content can be decoded on its own
+    void beginIsolated()
+    {
+      mIsolated.push_back({std::move(mIds), std::move(mScopes), std::move(mScoped)});
+      mIds.clear();
+      mScopes.clear();
+      mScoped.clear();
+    }
+
+    void endIsolated()
+    {
+      State &state = mIsolated.back();
+      mIds = std::move(state.ids);
+      mScopes = std::move(state.scopes);
+      mScoped = std::move(state.scoped);
+      mIsolated.pop_back();
+    }
+
+    size_t size() const noexcept
+    {
+      return mIds.size();
+    }
+
+    void clear() noexcept
+    {
+      mIds.clear();
+      mScopes.clear();
+      mScoped.clear();
+      mIsolated.clear();
+    }
+
+  private:
+    struct Hash
+    {
+      using is_transparent = void; // NOLINT
+
+      size_t operator()(std::string_view str) const noexcept
+      {
+        return std::hash<std::string_view>{}(str);
+      }
+    };
+
+    using Ids = std::unordered_map<std::string, uint64_t, Hash, std::equal_to<>>;
+
+    struct State
+    {
+      Ids ids;
+      std::vector<size_t> scopes;
+      std::vector<std::string_view> scoped;
+    };
+
+    Ids mIds;
+    std::vector<size_t> mScopes;           // Number of ids when each skippable content began
+    std::vector<std::string_view> mScoped; // Strings inserted inside skippable content, in order
+    std::vector<State> mIsolated;          // Ids set aside while isolated content is written
+  };
+
+  /// Reader side: strings read so far, viewing the reader's input buffer
+  class StringTable
+  {
+  public:
+    void add(std::string_view str)
+    {
+      mEntries.push_back(str);
+    }
+
+    /// Returns false if `id` was never added
+    bool get(uint64_t id, std::string_view &str) const noexcept
+    {
+      if (id >= mEntries.size())
+      {
+        return false;
+      }
+      str = mEntries[id];
+      return true;
+    }
+
+    std::span<const std::string_view> entries() const noexcept
+    {
+      return mEntries;
+    }
+
+    size_t size() const noexcept
+    {
+      return mEntries.size();
+    }
+
+    /// Forget the strings added after the first `size` ones
+    void truncate(size_t size)
+    {
+      mEntries.resize(size);
+    }
+
+    void clear() noexcept
+    {
+      mEntries.clear();
+    }
+
+  private:
+    std::vector<std::string_view> mEntries;
+  };
+
+  struct NoStringDictionary
+  {
+  };
+
+  template <typename Policy>
+  using string_ids_t = // NOLINT
+    std::conditional_t<has_policy_v<Policy, dictionary_t>, StringIds, NoStringDictionary>;
+
+  template <typename Policy>
+  using string_table_t = // NOLINT
+    std::conditional_t<has_policy_v<Policy, dictionary_t>, StringTable, NoStringDictionary>;
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_STRING_DICTIONARY_HPP
@@ -0,0 +1,143 @@
+#ifndef ENKI_IMPL_TAGGED_STRUCT_HPP
+#define ENKI_IMPL_TAGGED_STRUCT_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/success.hpp"
+
+namespace enki::detail
+{
+  /// With the `forward_compatible` policy binary formats write registered structs as a varint
+  /// number of fields followed by, for each member in declaration order, a varint tag
+  ///   (field number << 3) | wire type
+  /// and the member itself. The field number is the position of the member in `Register<...>`.
+  /// Members with a fixed binary size (arithmetic types and enums) are written as they are, the
+  /// others are preceded by their size in bytes (as a varint). Readers can then skip the
+  /// fields appended by newer writers and default the ones older writers did not know about.
+  /// With the `dictionary` policy, string members are written as dictionary strings without a
+  /// size prefix: readers skipping them still read their tag, so that strings keep their ids
+  /// across structs. `std::shared_ptr` members are written as shared objects, whose values
+  /// already carry their size, for the same reason.
+  enum class WireType : uint8_t
+  {
+    fixed8 = 0,
+    fixed16 = 1,
+    fixed32 = 2,
+    fixed64 = 3,
+    sized = 4,
+    string = 5,
+    object = 6,
+  };
+
+  inline constexpr uint64_t kWireTypeBits = 3;
+
+  constexpr uint64_t taggedFieldTag(size_t fieldNumber, WireType wireType)
+  {
+    return (uint64_t{fieldNumber} << kWireTypeBits) | static_cast<uint64_t>(wireType);
+  }
+
+  constexpr uint64_t taggedFieldNumber(uint64_t tag)
+  {
+    return tag >> kWireTypeBits;
+  }
+
+  constexpr WireType taggedWireType(uint64_t tag)
+  {
+    return static_cast<WireType>(tag & ((1U << kWireTypeBits) - 1));
+  }
+
+  /// Number of bytes of a fixed wire type, 0 for the other wire types
+  constexpr size_t fixedWireSize(WireType wireType)
+  {
+    switch (wireType)
+    {
+    case WireType::fixed8:
+      return 1;
+    case WireType::fixed16:
+      return 2;
+    case WireType::fixed32:
+      return 4;
+    case WireType::fixed64:
+      return 8;
+    default:
+      return 0;
+    }
+  }
+
+  template <typename T, typename Policy>
+  constexpr WireType wireTypeOf()
+  {
+    if constexpr (concepts::arithmetic_or_enum<T>)
+    {
+      constexpr size_t size = [] {
+        if constexpr (is_compact_enum_v<Policy, T>)
+        {
+          return sizeof(compact_enum_t<T>);
+        }
+        else
+        {
+          return sizeof(T);
+        }
+      }();
+      switch (size)
+      {
+      case 1:
+        return WireType::fixed8;
+      case 2:
+        return WireType::fixed16;
+      case 4:
+        return WireType::fixed32;
+      case 8:
+        return WireType::fixed64;
+      default:
+        return WireType::sized;
+      }
+    }
+    else if constexpr (concepts::string_like<T> && has_policy_v<Policy, dictionary_t>)
+    {
+      return WireType::string;
+    }
+    else if constexpr (concepts::shared_pointer<T>)
+    {
+      return WireType::object;
+    }
+    else if constexpr (concepts::duration<T>)
+    {
+      return wireTypeOf<typename T::rep, Policy>();
+    }
+    else if constexpr (concepts::time_point<T>)
+    {
+      return wireTypeOf<typename T::duration, Policy>();
+    }
+    else
+    {
+      return WireType::sized;
+    }
+  }
+
+  /// The `aligned` policy keeps untagged structs: their layout is the one of the type
+  template <typename Writer>
+  concept tagged_struct_writer =
+    has_policy_v<typename std::remove_cvref_t<Writer>::policy_type, forward_compatible_t> &&
+    !has_policy_v<typename std::remove_cvref_t<Writer>::policy_type, aligned_t> &&
+    concepts::varint_writer<Writer> && requires(Writer w) {
+      w.writeSized([](auto &) { return Success(); });
+    };
+
+  template <typename Reader>
+  concept tagged_struct_reader =
+    has_policy_v<typename std::remove_cvref_t<Reader>::policy_type, forward_compatible_t> &&
+    !has_policy_v<typename std::remove_cvref_t<Reader>::policy_type, aligned_t> &&
+    concepts::varint_reader<Reader> && concepts::byte_reader<Reader> &&
+    requires(Reader r) {
+      { r.remainingBytes() } -> std::convertible_to<size_t>;
+    };
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_TAGGED_STRUCT_HPP
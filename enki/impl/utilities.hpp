@@ -2,8 +2,11 @@
 #define ENKI_UTILITIES_HPP
 
 #include <bit>
+#include <concepts>
 #include <cstddef>
+#include <iterator>
 #include <type_traits>
+#include <utility>
 
 #include "enki/impl/concepts.hpp"
 #include "enki/impl/cstr.hpp"
@@ -28,6 +31,48 @@ namespace enki
     template <concepts::range_constructible_container T>
     using assignable_value_t = typename AssignableValue<T>::type; // NOLINT
 
+    template <typename T>
+    constexpr size_t rangeSize(const T &range)
+    {
+      if constexpr (requires { std::size(range); })
+      {
+        return std::size(range);
+      }
+      else
+      {
+        return static_cast<size_t>(std::distance(std::begin(range), std::end(range)));
+      }
+    }
+
+    /// Reject encodings needing at least `numBytes` bytes when fewer remain to be read
+    template <typename Reader>
+    constexpr bool fitsInRemainingBytes(size_t numBytes, const Reader &r)
+    {
+      if constexpr (requires { r.remainingBytes(); })
+      {
+        return numBytes <= r.remainingBytes();
+      }
+      else
+      {
+        return true;
+      }
+    }
+
+    /// Read skippable content with `readContent`, dropping the dictionary strings and shared
+    /// objects it adds at its end with binary readers
+    template <typename Reader, typename ReadFunc>
+    constexpr auto readScoped(Reader &r, ReadFunc &&readContent)
+    {
+      if constexpr (requires { r.readScoped(readContent); })
+      {
+        return r.readScoped(readContent);
+      }
+      else
+      {
+        return readContent();
+      }
+    }
+
     struct WrapperBase
     {
     };
@@ -69,17 +114,18 @@ namespace enki
     using value_type = typename concepts::detail::MemberPointer<member>::value_type; // NOLINT
 
     static constexpr std::string_view name = getMemberName<member>(); // NOLINT
+    static constexpr auto member_pointer = member;                    // NOLINT
 
-    static constexpr value_type
+    static constexpr const value_type &
     getter(const typename concepts::detail::MemberPointer<member>::class_type &inst)
     {
       return inst.*member;
     }
 
     static constexpr void
-    setter(typename concepts::detail::MemberPointer<member>::class_type &inst, const auto &val)
+    setter(typename concepts::detail::MemberPointer<member>::class_type &inst, auto &&val)
     {
-      inst.*member = val;
+      inst.*member = std::forward<decltype(val)>(val);
     }
 
     static constexpr size_t n = 0;     // NOLINT
@@ -96,17 +142,18 @@ namespace enki
     using value_type = typename concepts::detail::MemberPointer<member>::value_type; // NOLINT
 
     static constexpr std::string_view name = getMemberName<member>(); // NOLINT
+    static constexpr auto member_pointer = member;                    // NOLINT
 
-    static constexpr value_type
+    static constexpr const value_type &
     getter(const typename concepts::detail::MemberPointer<member>::class_type &inst)
     {
       return inst.*member;
     }
 
     static constexpr void
-    setter(typename concepts::detail::MemberPointer<member>::class_type &inst, const auto &val)
+    setter(typename concepts::detail::MemberPointer<member>::class_type &inst, auto &&val)
     {
-      inst.*member = val;
+      inst.*member = std::forward<decltype(val)>(val);
     }
 
     static constexpr size_t n = sizeof...(members);         // NOLINT
@@ -165,6 +212,44 @@ namespace enki
 
     template <size_t i, typename T>
     using get_nth_register_t = typename nth<T::count - 1 - i, T>::type; // NOLINT
+
+    template <typename T, size_t... idx>
+    constexpr bool hasComparableMembers(std::index_sequence<idx...>)
+    {
+      return (
+        std::equality_comparable<std::remove_cvref_t<
+          typename get_nth_register_t<idx, typename T::EnkiSerial::Members>::value_type>> &&
+        ...);
+    }
+
+    /// Index of the member registered as `member` in `T::EnkiSerial::Members`, or the number of
+    /// members if it is not registered
+    template <typename T, auto member, size_t... idx>
+    constexpr size_t registeredIndex(std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      size_t index = sizeof...(idx);
+      const auto matchOne = [&index]<typename Reg, size_t i>() {
+        if constexpr (requires { Reg::member_pointer; })
+        {
+          if constexpr (std::same_as<
+                          std::remove_cv_t<decltype(Reg::member_pointer)>,
+                          decltype(member)>)
+          {
+            if (Reg::member_pointer == member && i < index)
+            {
+              index = i;
+            }
+          }
+        }
+      };
+      (matchOne.template operator()<get_nth_register_t<idx, Members>, idx>(), ...);
+      return index;
+    }
+
+    template <typename T, auto member>
+    inline constexpr size_t registered_index_v = // NOLINT
+      registeredIndex<T, member>(std::make_index_sequence<T::EnkiSerial::Members::count>());
   } // namespace detail
 } // namespace enki
 
@@ -0,0 +1,93 @@
+#ifndef ENKI_IMPL_VARINT_HPP
+#define ENKI_IMPL_VARINT_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace enki::detail
+{
+  /// LEB128: 7 bits per byte, high bit set on every byte but the last
+  inline constexpr size_t kMaxVarintSize = 10; // NOLINT
+
+  constexpr size_t varintSize(uint64_t value)
+  {
+    size_t size = 1;
+    while (value >= 0x80)
+    {
+      value >>= 7;
+      ++size;
+    }
+    return size;
+  }
+
+  /// Encode `value` into `out` which must hold at least `kMaxVarintSize` bytes
+  /// Returns the number of bytes written
+  constexpr size_t encodeVarint(uint64_t value, std::byte *out)
+  {
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+      out[size++] = static_cast<std::byte>((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out[size++] = static_cast<std::byte>(value);
+    return size;
+  }
+
+  enum class VarintStatus
+  {
+    ok,
+    truncated,
+    malformed
+  };
+
+  /// Decode a varint from the `size` bytes available at `data`
+  /// On success `consumed` holds the number of bytes read
+  constexpr VarintStatus
+  decodeVarint(const std::byte *data, size_t size, uint64_t &value, size_t &consumed)
+  {
+    uint64_t result = 0;
+    for (size_t i = 0; i < kMaxVarintSize; ++i)
+    {
+      if (i == size)
+      {
+        return VarintStatus::truncated;
+      }
+      const auto byte = static_cast<uint64_t>(data[i]);
+      if (i == kMaxVarintSize - 1 && byte > 1)
+      {
+        return VarintStatus::malformed; // Would overflow 64 bits
+      }
+      result |= (byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0)
+      {
+        value = result;
+        consumed = i + 1;
+        return VarintStatus::ok;
+      }
+    }
+    return VarintStatus::malformed;
+  }
+
+  /// Map signed integers to unsigned ones so that small magnitudes give small varints:
+  /// 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3...
+  template <std::signed_integral S>
+  constexpr std::make_unsigned_t<S> zigzagEncode(S value)
+  {
+    using U = std::make_unsigned_t<S>;
+    return static_cast<U>(
+      static_cast<U>(static_cast<U>(value) << 1) ^
+      static_cast<U>(value >> (sizeof(S) * 8 - 1)));
+  }
+
+  template <std::unsigned_integral U>
+  constexpr std::make_signed_t<U> zigzagDecode(U value)
+  {
+    return static_cast<std::make_signed_t<U>>(
+      static_cast<U>(value >> 1) ^ static_cast<U>(U{} - static_cast<U>(value & 1)));
+  }
+} // namespace enki::detail
+
+#endif // ENKI_IMPL_VARINT_HPP
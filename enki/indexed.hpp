@@ -0,0 +1,407 @@
+#ifndef ENKI_INDEXED_HPP
+#define ENKI_INDEXED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "enki/bin_reader.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/skip.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  /// Ranges followed by the offset of each of their elements, so that `enki::RangeView` can
+  /// decode any element without reading the ones before it.
+  /// Binary formats write the number of elements, a flag telling whether the offsets follow and
+  /// a size prefix. The elements come next, then, for ranges of at least `MinIndexedSize`
+  /// elements, one `size_type` offset per element from the start of the elements. Smaller ranges
+  /// only pay for the flag and the size prefix. Only binary formats are affected, JSON keeps
+  /// writing the plain container.
+  /// Each element is decodable on its own: dictionary strings and shared objects are only
+  /// written once per element.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Log, entries, enki::Indexed<std::vector<Entry>>)>
+  template <typename Container, size_t MinIndexedSize = 1024>
+    requires concepts::range_constructible_container<Container>
+  class Indexed : public Container
+  {
+  public:
+    using Container::Container;
+
+    Indexed() = default;
+
+    Indexed(Container container) :
+      Container(std::move(container))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  template <typename Container, size_t MinIndexedSize>
+    requires concepts::range_constructible_container<Container>
+  struct Indexed<Container, MinIndexedSize>::EnkiSerial
+  {
+    template <typename Writer>
+    static constexpr Success serialize(const Indexed &value, Writer &&w)
+    {
+      const auto &container = static_cast<const Container &>(value);
+      if constexpr (!concepts::byte_writer<Writer>)
+      {
+        return ::enki::serialize(container, w);
+      }
+      else
+      {
+        using size_type = typename std::remove_cvref_t<Writer>::size_type; // NOLINT
+        const size_t numElements = detail::rangeSize(container);
+        const bool isIndexed = numElements >= MinIndexedSize;
+        Success isGood = w.rangeBegin(numElements);
+        if (!isGood || !isGood.update(w.write(isIndexed)))
+        {
+          return isGood;
+        }
+        isGood.update(w.writeSkippable([&](auto &child) {
+          Success content;
+          std::vector<size_t> offsets;
+          if (isIndexed)
+          {
+            offsets.reserve(numElements);
+          }
+          for (const auto &el : container)
+          {
+            if (isIndexed)
+            {
+              offsets.push_back(content.size());
+            }
+            const auto writeElement = [&](auto &elementWriter) {
+              return ::enki::serialize(el, elementWriter);
+            };
+            if (!content.update(child.writeIsolated(writeElement)))
+            {
+              return content;
+            }
+          }
+          // Offsets too large for `size_type` are reported by `writeSkippable` on the total size
+          for (size_t offset : offsets)
+          {
+            if (!content.update(child.write(static_cast<size_type>(offset))))
+            {
+              break;
+            }
+          }
+          return content;
+        }));
+        if (isGood)
+        {
+          isGood.update(w.rangeEnd());
+        }
+        return isGood;
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Indexed &value, Reader &&r)
+    {
+      auto &container = static_cast<Container &>(value);
+      if constexpr (!concepts::byte_reader<Reader>)
+      {
+        return ::enki::deserialize(container, r);
+      }
+      else
+      {
+        using size_type = typename std::remove_cvref_t<Reader>::size_type; // NOLINT
+        size_t numElements = 0;
+        bool isIndexed = false;
+        size_type blockSize{};
+        Success isGood = r.rangeBegin(numElements);
+        if (!isGood || !isGood.update(r.read(isIndexed)) || !isGood.update(r.read(blockSize)))
+        {
+          return isGood;
+        }
+        if (!detail::fitsInRemainingBytes(blockSize, r))
+        {
+          return isGood.update("Range size exceeds remaining data");
+        }
+        if (isIndexed && numElements > blockSize / sizeof(size_type))
+        {
+          return isGood.update("Range offsets exceed their block");
+        }
+
+        // Grown element by element: the number of elements is only bounded by the block when the
+        // offsets follow
+        std::vector<detail::assignable_value_t<Container>> temp;
+        temp.reserve(isIndexed ? numElements : 0);
+        Success elements;
+        while (temp.size() < numElements)
+        {
+          auto &el = temp.emplace_back();
+          if (!elements.update(r.readIsolated([&] { return ::enki::deserialize(el, r); })))
+          {
+            return isGood.update(elements);
+          }
+          if (elements.size() > blockSize)
+          {
+            return isGood.update("Range elements exceed their block");
+          }
+        }
+        // The offsets are only needed by views
+        if (!elements.update(detail::skipBytes(blockSize - elements.size(), r)))
+        {
+          return isGood.update(elements);
+        }
+        container = {
+          std::make_move_iterator(std::begin(temp)), std::make_move_iterator(std::end(temp))};
+        isGood.update(elements);
+        return isGood.update(r.rangeEnd());
+      }
+    }
+
+    /// Binary formats jump over the elements and their offsets at once
+    template <typename Reader>
+      requires concepts::byte_reader<Reader>
+    static constexpr Success skip(Reader &&r)
+    {
+      using size_type = typename std::remove_cvref_t<Reader>::size_type; // NOLINT
+      size_t numElements = 0;
+      bool isIndexed = false;
+      size_type blockSize{};
+      Success isGood = r.rangeBegin(numElements);
+      if (
+        !isGood || !isGood.update(r.read(isIndexed)) || !isGood.update(r.read(blockSize)) ||
+        !isGood.update(detail::skipBytes(blockSize, r)))
+      {
+        return isGood;
+      }
+      return isGood.update(r.rangeEnd());
+    }
+  };
+
+  /// Read-only view of a range written by `enki::Indexed` in `data`, decoding elements of type
+  /// `T` only when they are accessed. Elements of ranges written with their offsets are found in
+  /// constant time, the other ones by skipping the elements before them.
+  ///
+  /// Views are cheap to copy. Dictionary strings and shared objects are supported, each element
+  /// numbering its own:
+  ///   enki::RangeView<Entry> entries(bytes);
+  ///   const Entry last = entries[entries.size() - 1];
+  template <typename T, policy Policy = strict_t, typename SizeType = uint32_t>
+  class RangeView
+  {
+    using Reader = BinSpanReader<Policy, SizeType>;
+
+  public:
+    using policy_type = Policy; // NOLINT
+    using size_type = SizeType; // NOLINT
+    using value_type = T;       // NOLINT
+
+    /// View of the range starting at `offset` in `data`: padding follows the position in the
+    /// whole buffer, as when `data` is read from its start
+    RangeView(std::span<const std::byte> data, size_t offset = 0) :
+      mData(data)
+    {
+      readHeader(offset);
+    }
+
+    explicit RangeView(Policy, std::span<const std::byte> data, size_t offset = 0) :
+      mData(data)
+    {
+      readHeader(offset);
+    }
+
+    /// Result of reading the range header, the number of elements is 0 when it failed
+    Success status() const
+    {
+      return mStatus;
+    }
+
+    size_t size() const noexcept
+    {
+      return mSize;
+    }
+
+    bool empty() const noexcept
+    {
+      return mSize == 0;
+    }
+
+    /// Whether the offsets of the elements were written, making access constant time
+    bool isIndexed() const noexcept
+    {
+      return mIsIndexed;
+    }
+
+    /// Decode element `index` into `value`
+    Success get(size_t index, T &value) const
+    {
+      return get(index, std::span<T>(&value, 1));
+    }
+
+    /// Decode the `values.size()` elements starting at element `first` into `values`
+    Success get(size_t first, std::span<T> values) const
+    {
+      if (first > mSize || values.size() > mSize - first)
+      {
+        return "Element index is out of range";
+      }
+      if (values.empty())
+      {
+        return {};
+      }
+      Reader reader(mData);
+      Success isGood = moveTo(first, reader);
+      for (size_t i = 0; i < values.size() && isGood; ++i)
+      {
+        isGood.update(reader.readIsolated([&] { return deserialize(values[i], reader); }));
+      }
+      return isGood;
+    }
+
+#if __cpp_exceptions >= 199711
+    /// Decode element `index`, throwing on malformed data
+    T operator[](size_t index) const
+    {
+      T value{};
+      get(index, value).or_throw();
+      return value;
+    }
+
+    /// Elements decoded one after the other as the iterator is dereferenced
+    class Iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag; // NOLINT
+      using difference_type = std::ptrdiff_t;            // NOLINT
+      using value_type = T;                              // NOLINT
+
+      Iterator() = default;
+
+      T operator*() const
+      {
+        T value{};
+        Reader reader(mView->mData);
+        detail::skipBytes(mOffset, reader).or_throw();
+        reader.readIsolated([&] { return deserialize(value, reader); }).or_throw();
+        return value;
+      }
+
+      Iterator &operator++()
+      {
+        Reader reader(mView->mData);
+        detail::skipBytes(mOffset, reader).or_throw();
+        reader.readIsolated([&] { return detail::skipTyped<T>(reader); }).or_throw();
+        mOffset = mView->mData.size() - reader.remainingBytes();
+        ++mIndex;
+        return *this;
+      }
+
+      void operator++(int)
+      {
+        ++*this;
+      }
+
+      bool operator==(const Iterator &other) const noexcept
+      {
+        return mIndex == other.mIndex;
+      }
+
+    private:
+      friend class RangeView;
+
+      Iterator(const RangeView *view, size_t index, size_t offset) :
+        mView(view),
+        mIndex(index),
+        mOffset(offset)
+      {
+      }
+
+      const RangeView *mView = nullptr;
+      size_t mIndex = 0;
+      size_t mOffset = 0;
+    };
+
+    Iterator begin() const
+    {
+      return {this, 0, mBlockBegin};
+    }
+
+    Iterator end() const
+    {
+      return {this, mSize, mBlockEnd};
+    }
+#endif
+
+  private:
+    void readHeader(size_t offset)
+    {
+      Reader reader(mData);
+      size_t numElements = 0;
+      SizeType blockSize{};
+      if (!mStatus.update(detail::skipBytes(offset, reader)) ||
+          !mStatus.update(reader.rangeBegin(numElements)) ||
+          !mStatus.update(reader.read(mIsIndexed)) || !mStatus.update(reader.read(blockSize)))
+      {
+        return;
+      }
+      if (blockSize > reader.remainingBytes())
+      {
+        mStatus.update("Range size exceeds remaining data");
+        return;
+      }
+      if (mIsIndexed && numElements > blockSize / sizeof(SizeType))
+      {
+        mStatus.update("Range offsets exceed their block");
+        return;
+      }
+      mBlockBegin = mData.size() - reader.remainingBytes();
+      mBlockEnd = mBlockBegin + blockSize;
+      mSize = numElements;
+    }
+
+    /// Move `reader` to element `index`, reading its offset or skipping the elements before it
+    Success moveTo(size_t index, Reader &reader) const
+    {
+      if (!mIsIndexed)
+      {
+        Success isGood = detail::skipBytes(mBlockBegin, reader);
+        for (size_t i = 0; i < index && isGood; ++i)
+        {
+          isGood.update(reader.readIsolated([&] { return detail::skipTyped<T>(reader); }));
+        }
+        return isGood;
+      }
+
+      const size_t tableBegin = mBlockEnd - mSize * sizeof(SizeType);
+      Reader tableReader(mData);
+      SizeType offset{};
+      Success isGood = detail::skipBytes(tableBegin + index * sizeof(SizeType), tableReader);
+      if (!isGood || !isGood.update(tableReader.read(offset)))
+      {
+        return isGood;
+      }
+      if (offset > tableBegin - mBlockBegin)
+      {
+        return "Element offset exceeds its block";
+      }
+      return detail::skipBytes(mBlockBegin + offset, reader);
+    }
+
+    std::span<const std::byte> mData;
+    Success mStatus;
+    size_t mSize = 0;
+    size_t mBlockBegin = 0;
+    size_t mBlockEnd = 0;
+    bool mIsIndexed = false;
+  };
+} // namespace enki
+
+#endif // ENKI_INDEXED_HPP
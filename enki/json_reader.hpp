@@ -1,8 +1,10 @@
 #ifndef ENKI_JSON_READER_HPP
 #define ENKI_JSON_READER_HPP
 
+#include <cctype>
 #include <cstdint>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -130,6 +132,164 @@ namespace enki
 
       return countCommas + 1;
     }
+
+    [[maybe_unused]] void skipJsonWhitespace(std::string_view input, size_t &pos)
+    {
+      while (pos < input.size() &&
+             (input[pos] == ' ' || input[pos] == '\t' || input[pos] == '\n' || input[pos] == '\r'))
+      {
+        ++pos;
+      }
+    }
+
+    /// Move `pos` past the string starting at `input[pos]`
+    [[maybe_unused]] Success skipJsonString(std::string_view input, size_t &pos)
+    {
+      for (++pos; pos < input.size(); ++pos)
+      {
+        if (input[pos] == '\\')
+        {
+          ++pos;
+        }
+        else if (input[pos] == '"')
+        {
+          ++pos;
+          return {};
+        }
+      }
+      return "Unterminated JSON string";
+    }
+
+    /// Move `pos` past the name and colon starting at or after `input[pos]` in a JSON object
+    [[maybe_unused]] Success skipJsonName(std::string_view input, size_t &pos)
+    {
+      skipJsonWhitespace(input, pos);
+      if (pos >= input.size() || input[pos] != '"')
+      {
+        return "Expected a name in JSON object";
+      }
+      Success isGood = skipJsonString(input, pos);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      skipJsonWhitespace(input, pos);
+      if (pos >= input.size() || input[pos++] != ':')
+      {
+        return "Expected ':' after name in JSON object";
+      }
+      return {};
+    }
+
+    /// Move `pos` past the string, literal or number starting at `input[pos]`
+    [[maybe_unused]] Success skipJsonScalar(std::string_view input, size_t &pos)
+    {
+      const char c = input[pos];
+      if (c == '"')
+      {
+        return skipJsonString(input, pos);
+      }
+      for (const std::string_view literal : {"true", "false", "null"})
+      {
+        if (input.substr(pos, literal.size()) == literal)
+        {
+          pos += literal.size();
+          return {};
+        }
+      }
+      if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
+      {
+        while (pos < input.size() &&
+               (input[pos] == '-' || input[pos] == '+' || input[pos] == '.' ||
+                input[pos] == 'e' || input[pos] == 'E' ||
+                std::isdigit(static_cast<unsigned char>(input[pos]))))
+        {
+          ++pos;
+        }
+        return {};
+      }
+      return "Invalid JSON value";
+    }
+
+    /// Move `pos` past the JSON value starting at or after `input[pos]`, checking the nesting of
+    /// objects and arrays, the separators between their elements and the literals
+    /// The objects and arrays being skipped are kept on a stack of their closing braces rather
+    /// than by recursion, so that deeply nested input cannot overflow the call stack.
+    [[maybe_unused]] Success skipJsonValue(std::string_view input, size_t &pos)
+    {
+      std::string closeBraces;
+      while (true)
+      {
+        skipJsonWhitespace(input, pos);
+        if (pos >= input.size())
+        {
+          return "Unexpected end of JSON";
+        }
+
+        const char c = input[pos];
+        if (c == '{' || c == '[')
+        {
+          const char closeBrace = (c == '{') ? '}' : ']';
+          skipJsonWhitespace(input, ++pos);
+          if (pos >= input.size() || input[pos] != closeBrace)
+          {
+            // Skip the first element next
+            closeBraces.push_back(closeBrace);
+            if (c == '{')
+            {
+              Success isGood = skipJsonName(input, pos);
+              if (!isGood)
+              {
+                return isGood;
+              }
+            }
+            continue;
+          }
+          ++pos;
+        }
+        else
+        {
+          Success isGood = skipJsonScalar(input, pos);
+          if (!isGood)
+          {
+            return isGood;
+          }
+        }
+
+        // A value ended: close the objects and arrays it ends, then move to the next element
+        while (!closeBraces.empty())
+        {
+          skipJsonWhitespace(input, pos);
+          if (pos >= input.size())
+          {
+            return "Unexpected end of JSON";
+          }
+          if (input[pos] == closeBraces.back())
+          {
+            ++pos;
+            closeBraces.pop_back();
+            continue;
+          }
+          if (input[pos++] != ',')
+          {
+            return "Expected ',' between JSON elements";
+          }
+          if (closeBraces.back() == '}')
+          {
+            Success isGood = skipJsonName(input, pos);
+            if (!isGood)
+            {
+              return isGood;
+            }
+          }
+          break;
+        }
+        if (closeBraces.empty())
+        {
+          return {};
+        }
+      }
+    }
   } // namespace
 
   template <policy Policy = strict_t>
@@ -210,108 +370,25 @@ namespace enki
       return {};
     }
 
-    /// Skip a JSON value - parses and discards current value
-    /// Used for forward compatibility when encountering unknown variant types
+    /// Skip a JSON value - checks its structure without decoding it
+    /// Used for forward compatibility when encountering unknown variant types, and to skip
+    /// values of a known type
     Success skipHintAndValue()
     {
-      // Skip whitespace
-      mStream >> std::ws;
-
-      int ch = mStream.peek();
-      if (ch == std::char_traits<char>::eof())
+      size_t end = 0;
+      Success isGood = findValueEnd(end);
+      if (isGood)
       {
-        return "Unexpected end of JSON";
-      }
-
-      char c = static_cast<char>(ch);
-
-      if (c == '{' || c == '[')
-      {
-        // Object or array - need to match braces/brackets
-        char openBrace = c;
-        char closeBrace = (c == '{') ? '}' : ']';
-        mStream.get(); // consume opening brace
-
-        int depth = 1;
-        bool inString = false;
-        bool escape = false;
-
-        while (depth > 0 && mStream.peek() != std::char_traits<char>::eof())
-        {
-          char cur = static_cast<char>(mStream.get());
-
-          if (escape)
-          {
-            escape = false;
-            continue;
-          }
-
-          if (cur == '\\' && inString)
-          {
-            escape = true;
-            continue;
-          }
-
-          if (cur == '"')
-          {
-            inString = !inString;
-            continue;
-          }
-
-          if (!inString)
-          {
-            if (cur == openBrace)
-            {
-              depth++;
-            }
-            else if (cur == closeBrace)
-            {
-              depth--;
-            }
-          }
-        }
-      }
-      else if (c == '"')
-      {
-        // String - read until closing quote
-        std::string dummy;
-        mStream >> std::quoted(dummy);
-      }
-      else if (c == 't' || c == 'f')
-      {
-        // Boolean
-        readWord(mStream);
-      }
-      else if (c == 'n')
-      {
-        // null
-        readWord(mStream);
-      }
-      else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)))
-      {
-        // Number - read until non-numeric character
-        while (mStream.peek() != std::char_traits<char>::eof())
-        {
-          int next = mStream.peek();
-          char nc = static_cast<char>(next);
-          if (
-            nc == '-' || nc == '+' || nc == '.' || nc == 'e' || nc == 'E' ||
-            std::isdigit(static_cast<unsigned char>(nc)))
-          {
-            mStream.get();
-          }
-          else
-          {
-            break;
-          }
-        }
-      }
-      else
-      {
-        return "Invalid JSON value";
+        mStream.seekg(static_cast<std::streamoff>(end));
       }
+      return isGood;
+    }
 
-      return {};
+    /// Check the structure of the next JSON value without moving past it
+    Success checkValueStructure()
+    {
+      size_t end = 0;
+      return findValueEnd(end);
     }
 
     constexpr Success arrayBegin()
@@ -403,7 +480,8 @@ namespace enki
 
     /// Read variant index from {"index": value} format
     /// Reads the opening brace, key (index), and colon
-    Success readVariantIndex(size_type &index)
+    template <std::unsigned_integral IndexType>
+    Success readVariantIndex(IndexType &index)
     {
       char brace{};
       mStream >> brace;
@@ -419,9 +497,14 @@ namespace enki
       // Parse index from string
       try
       {
+        const auto parsed = std::stoul(indexStr);
+        if (parsed > std::numeric_limits<IndexType>::max())
+        {
+          return "Invalid variant index in JSON";
+        }
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wuseless-cast"
-        index = static_cast<size_type>(std::stoul(indexStr));
+        index = static_cast<IndexType>(parsed);
 #pragma GCC diagnostic pop
       }
       catch (...)
@@ -487,13 +570,31 @@ namespace enki
     }
 
   private:
+    /// Position right after the next JSON value, whose structure is checked
+    Success findValueEnd(size_t &end)
+    {
+      mStream >> std::ws;
+      if (mStream.peek() == std::char_traits<char>::eof())
+      {
+        return "Unexpected end of JSON";
+      }
+
+#if HAS_STRINGSTREAM_VIEW
+      const std::string_view input = mStream.view();
+#else
+      const std::string input = mStream.str();
+#endif
+      end = static_cast<size_t>(mStream.tellg());
+      return skipJsonValue(input, end);
+    }
+
     std::stringstream mStream;
   };
 
   // Deduction guides for JSONReader
   JSONReader(std::string_view) -> JSONReader<strict_t>;
-  JSONReader(strict_t, std::string_view) -> JSONReader<strict_t>;
-  JSONReader(forward_compatible_t, std::string_view) -> JSONReader<forward_compatible_t>;
+  template <policy Policy>
+  JSONReader(Policy, std::string_view) -> JSONReader<Policy>;
 } // namespace enki
 
 #endif // ENKI_JSON_READER_HPP
@@ -184,8 +184,8 @@ namespace enki
 
   // Deduction guides for JSONWriter
   JSONWriter() -> JSONWriter<strict_t>;
-  JSONWriter(strict_t) -> JSONWriter<strict_t>;
-  JSONWriter(forward_compatible_t) -> JSONWriter<forward_compatible_t>;
+  template <policy Policy>
+  JSONWriter(Policy) -> JSONWriter<Policy>;
 } // namespace enki
 
 #endif // ENKI_JSON_WRITER_HPP
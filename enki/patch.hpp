@@ -0,0 +1,429 @@
+#ifndef ENKI_PATCH_HPP
+#define ENKI_PATCH_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/fixed_size.hpp"
+#include "enki/impl/presence_bitmap.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Registered structs patched member by member
+    template <typename T>
+    concept patchable_struct =
+      concepts::custom_static_serializable<T> &&
+      hasComparableMembers<T>(std::make_index_sequence<T::EnkiSerial::Members::count>());
+
+    /// Sequences (`std::vector`, `std::deque`...) patched element by element
+    template <typename T>
+    concept patchable_sequence =
+      concepts::range_constructible_container<T> && !concepts::string_like<T> &&
+      std::equality_comparable<typename T::value_type> &&
+      requires(T t, size_t i) {
+        { t[i] } -> std::same_as<typename T::value_type &>;
+        t.resize(i);
+        t.emplace_back();
+      };
+
+    /// Containers of unique keys (`std::map`, `std::unordered_set`...) patched key by key
+    template <typename T>
+    concept patchable_associative =
+      concepts::range_constructible_container<T> &&
+      std::equality_comparable<typename T::value_type> &&
+      requires(T t, const typename T::key_type &key, typename T::value_type v) {
+        t.find(key);
+        t.erase(key);
+        t.insert(std::move(v)).second;
+      };
+
+    template <typename T, typename Writer>
+    constexpr Success writeDiff(const T &oldValue, const T &newValue, Writer &w);
+
+    template <typename T, typename Reader>
+    constexpr Success applyDiff(T &value, Reader &r);
+
+    template <typename T>
+    constexpr const auto &patchKey(const typename T::value_type &entry)
+    {
+      if constexpr (concepts::map_range_constructible_container<T>)
+      {
+        return entry.first;
+      }
+      else
+      {
+        return entry;
+      }
+    }
+
+    /// A bitmap of the changed members, then the diff of each changed member
+    template <typename T, typename Writer, size_t... idx>
+    constexpr Success writeStructDiff(
+      const T &oldValue, const T &newValue, Writer &w, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      PresenceBitmap<Members::count> changed;
+      const auto markOne = [&]<typename Reg, size_t bit>() {
+        if (!(Reg::getter(oldValue) == Reg::getter(newValue)))
+        {
+          changed.set(bit);
+        }
+      };
+      (markOne.template operator()<get_nth_register_t<idx, Members>, idx>(), ...);
+
+      Success isGood = w.writeBytes(changed.bytes());
+      const auto writeOne = [&]<typename Reg, size_t bit>() {
+        return !changed.test(bit) ||
+               isGood.update(writeDiff(Reg::getter(oldValue), Reg::getter(newValue), w));
+      };
+      static_cast<void>(
+        (writeOne.template operator()<get_nth_register_t<idx, Members>, idx>() && ...));
+      return isGood;
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success applyStructDiff(T &value, Reader &r, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      PresenceBitmap<Members::count> changed;
+      Success isGood = readPresenceBitmap(changed, r);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      const auto applyOne = [&]<typename Reg, size_t bit>() {
+        if (!changed.test(bit))
+        {
+          return true;
+        }
+        if constexpr (requires { Reg::member_pointer; })
+        {
+          return static_cast<bool>(isGood.update(applyDiff(value.*Reg::member_pointer, r)));
+        }
+        else
+        {
+          // Wrapped members are only reachable through copies
+          std::remove_cvref_t<typename Reg::value_type> member = Reg::getter(value);
+          if (!isGood.update(applyDiff(member, r)))
+          {
+            return false;
+          }
+          Reg::setter(value, std::move(member));
+          return true;
+        }
+      };
+      static_cast<void>(
+        (applyOne.template operator()<get_nth_register_t<idx, Members>, idx>() && ...));
+      return isGood;
+    }
+
+    /// A splice of the elements between the common prefix and the common suffix of the two
+    /// sequences: its offset, the number of old elements it erases and the number of new ones
+    /// it inserts. The first inserted elements replace erased ones: only the changed ones are
+    /// written, each as the varint gap from the previous one followed by its diff, after their
+    /// count. The other inserted elements follow in full.
+    template <typename T, typename Writer>
+    constexpr Success writeSequenceDiff(const T &oldValue, const T &newValue, Writer &w)
+    {
+      const size_t minSize = std::min(oldValue.size(), newValue.size());
+      size_t offset = 0;
+      while (offset < minSize && oldValue[offset] == newValue[offset])
+      {
+        ++offset;
+      }
+      size_t suffix = 0;
+      while (offset + suffix < minSize &&
+             oldValue[oldValue.size() - suffix - 1] == newValue[newValue.size() - suffix - 1])
+      {
+        ++suffix;
+      }
+      const size_t numErased = oldValue.size() - offset - suffix;
+      const size_t numInserted = newValue.size() - offset - suffix;
+      const size_t numReplaced = std::min(numErased, numInserted);
+      size_t numChanged = 0;
+      for (size_t i = offset; i < offset + numReplaced; ++i)
+      {
+        numChanged += oldValue[i] == newValue[i] ? 0 : 1;
+      }
+
+      Success isGood = w.writeVarint(offset);
+      isGood.update(w.writeVarint(numErased));
+      isGood.update(w.writeVarint(numInserted));
+      isGood.update(w.writeVarint(numChanged));
+      for (size_t i = offset, next = offset; i < offset + numReplaced && isGood; ++i)
+      {
+        if (oldValue[i] == newValue[i])
+        {
+          continue;
+        }
+        if (isGood.update(w.writeVarint(i - next)))
+        {
+          isGood.update(writeDiff(oldValue[i], newValue[i], w));
+        }
+        next = i + 1;
+      }
+      for (size_t i = offset + numReplaced; i < offset + numInserted && isGood; ++i)
+      {
+        isGood.update(serialize(newValue[i], w));
+      }
+      return isGood;
+    }
+
+    template <typename T, typename Reader>
+    constexpr Success applySequenceDiff(T &value, Reader &r)
+    {
+      using E = typename T::value_type;
+      using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+
+      uint64_t offset = 0;
+      uint64_t numErased = 0;
+      uint64_t numInserted = 0;
+      uint64_t numChanged = 0;
+      Success isGood = r.readVarint(offset);
+      if (!isGood || !isGood.update(r.readVarint(numErased)) ||
+          !isGood.update(r.readVarint(numInserted)) || !isGood.update(r.readVarint(numChanged)))
+      {
+        return isGood;
+      }
+      const uint64_t numReplaced = std::min(numErased, numInserted);
+      // Inserted elements take a byte at least, unless their type has no bytes at all
+      if (offset > value.size() || numErased > value.size() - offset ||
+          numChanged > numReplaced || !fitsInRemainingBytes(numChanged, r) ||
+          (fixedSize<E, Policy>() > 0 && !fitsInRemainingBytes(numInserted - numReplaced, r)))
+      {
+        return "Patch does not match the range it is applied to";
+      }
+      for (uint64_t i = 0, next = offset; i < numChanged; ++i)
+      {
+        uint64_t gap = 0;
+        if (!isGood.update(r.readVarint(gap)))
+        {
+          return isGood;
+        }
+        if (gap >= offset + numReplaced - next)
+        {
+          return "Patch element index is out of range";
+        }
+        next += gap;
+        if (!isGood.update(applyDiff(value[next], r)))
+        {
+          return isGood;
+        }
+        ++next;
+      }
+
+      const auto splicePoint = [&] {
+        return std::next(value.begin(), static_cast<ptrdiff_t>(offset + numReplaced));
+      };
+      if (numErased > numReplaced)
+      {
+        // Erased elements are moved to the end to be dropped
+        std::rotate(
+          splicePoint(),
+          std::next(value.begin(), static_cast<ptrdiff_t>(offset + numErased)),
+          value.end());
+        value.resize(value.size() - (numErased - numReplaced));
+      }
+      else if (numInserted > numReplaced)
+      {
+        // Inserted elements are read at the end, then moved into place
+        const size_t oldSize = value.size();
+        for (uint64_t i = numReplaced; i < numInserted; ++i)
+        {
+          if (!isGood.update(deserialize(value.emplace_back(), r)))
+          {
+            return isGood;
+          }
+        }
+        std::rotate(
+          splicePoint(), std::next(value.begin(), static_cast<ptrdiff_t>(oldSize)), value.end());
+      }
+      return isGood;
+    }
+
+    /// The removed keys, then the inserted or changed entries: maps write the diff of the
+    /// values already present and the full value of the new ones
+    template <typename T, typename Writer>
+    constexpr Success writeAssociativeDiff(const T &oldValue, const T &newValue, Writer &w)
+    {
+      const auto isRemoved = [&](const auto &entry) {
+        return newValue.find(patchKey<T>(entry)) == newValue.end();
+      };
+      const auto isUpserted = [&](const auto &entry) {
+        const auto it = oldValue.find(patchKey<T>(entry));
+        return it == oldValue.end() || !(*it == entry);
+      };
+
+      Success isGood = w.writeVarint(
+        static_cast<uint64_t>(std::count_if(oldValue.begin(), oldValue.end(), isRemoved)));
+      for (auto it = oldValue.begin(); it != oldValue.end() && isGood; ++it)
+      {
+        if (isRemoved(*it))
+        {
+          isGood.update(serialize(patchKey<T>(*it), w));
+        }
+      }
+      if (!isGood.update(w.writeVarint(
+            static_cast<uint64_t>(std::count_if(newValue.begin(), newValue.end(), isUpserted)))))
+      {
+        return isGood;
+      }
+      for (auto it = newValue.begin(); it != newValue.end() && isGood; ++it)
+      {
+        if (!isUpserted(*it) || !isGood.update(serialize(patchKey<T>(*it), w)))
+        {
+          continue;
+        }
+        if constexpr (concepts::map_range_constructible_container<T>)
+        {
+          const auto oldIt = oldValue.find(it->first);
+          isGood.update(
+            oldIt == oldValue.end() ? serialize(it->second, w)
+                                    : writeDiff(oldIt->second, it->second, w));
+        }
+      }
+      return isGood;
+    }
+
+    template <typename T, typename Reader>
+    constexpr Success applyAssociativeDiff(T &value, Reader &r)
+    {
+      uint64_t numRemoved = 0;
+      Success isGood = r.readVarint(numRemoved);
+      if (isGood && !fitsInRemainingBytes(numRemoved, r))
+      {
+        return "Patch removes more keys than the data holds";
+      }
+      for (uint64_t i = 0; i < numRemoved && isGood; ++i)
+      {
+        typename T::key_type key{};
+        if (isGood.update(deserialize(key, r)) && value.erase(key) == 0)
+        {
+          return "Patch removes a missing key";
+        }
+      }
+
+      uint64_t numUpserted = 0;
+      if (!isGood || !isGood.update(r.readVarint(numUpserted)))
+      {
+        return isGood;
+      }
+      if (!fitsInRemainingBytes(numUpserted, r))
+      {
+        return "Patch inserts more keys than the data holds";
+      }
+      for (uint64_t i = 0; i < numUpserted && isGood; ++i)
+      {
+        typename T::key_type key{};
+        if (!isGood.update(deserialize(key, r)))
+        {
+          break;
+        }
+        if constexpr (concepts::map_range_constructible_container<T>)
+        {
+          if (const auto it = value.find(key); it != value.end())
+          {
+            isGood.update(applyDiff(it->second, r));
+          }
+          else
+          {
+            typename T::mapped_type mapped{};
+            if (isGood.update(deserialize(mapped, r)))
+            {
+              value.emplace(std::move(key), std::move(mapped));
+            }
+          }
+        }
+        else
+        {
+          value.insert(std::move(key));
+        }
+      }
+      return isGood;
+    }
+
+    template <typename T, typename Writer>
+    constexpr Success writeDiff(const T &oldValue, const T &newValue, Writer &w)
+    {
+      if constexpr (patchable_struct<T> && !custom_serializable<T, Writer>)
+      {
+        return writeStructDiff(
+          oldValue, newValue, w, std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+      else if constexpr (patchable_sequence<T>)
+      {
+        return writeSequenceDiff(oldValue, newValue, w);
+      }
+      else if constexpr (patchable_associative<T>)
+      {
+        return writeAssociativeDiff(oldValue, newValue, w);
+      }
+      else
+      {
+        return serialize(newValue, w);
+      }
+    }
+
+    template <typename T, typename Reader>
+    constexpr Success applyDiff(T &value, Reader &r)
+    {
+      if constexpr (patchable_struct<T> && !custom_deserializable<T, Reader>)
+      {
+        return applyStructDiff(
+          value, r, std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+      else if constexpr (patchable_sequence<T>)
+      {
+        return applySequenceDiff(value, r);
+      }
+      else if constexpr (patchable_associative<T>)
+      {
+        return applyAssociativeDiff(value, r);
+      }
+      else
+      {
+        return deserialize(value, r);
+      }
+    }
+  } // namespace detail
+
+  /// Write the changes turning `oldValue` into `newValue`, for followers holding `oldValue`.
+  /// Registered structs write a bitmap of their changed members followed by the patch of each
+  /// one, sequences a splice of the elements between their common prefix and suffix,
+  /// containers of unique keys their removed keys and their inserted or changed entries. Other
+  /// values are written in full. The size of a patch follows the size of the change, not the
+  /// one of the value.
+  ///
+  /// Binary formats only. Patches are read with the same policies:
+  ///   enki::writePatch(previous, state, writer).or_throw();
+  template <typename T, typename Writer>
+    requires concepts::byte_writer<Writer>
+  constexpr Success writePatch(const T &oldValue, const T &newValue, Writer &&w)
+  {
+    return detail::writeDiff(oldValue, newValue, w);
+  }
+
+  /// Apply to `value` a patch written by `writePatch` from an old value equal to `value`.
+  /// A patch not matching `value` fails, possibly after changing part of it.
+  ///   enki::applyPatch(state, reader).or_throw();
+  template <typename T, typename Reader>
+    requires concepts::byte_reader<Reader>
+  constexpr Success applyPatch(T &value, Reader &&r)
+  {
+    return detail::applyDiff(value, r);
+  }
+} // namespace enki
+
+#endif // ENKI_PATCH_HPP
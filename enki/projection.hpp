@@ -0,0 +1,35 @@
+#ifndef ENKI_PROJECTION_HPP
+#define ENKI_PROJECTION_HPP
+
+#include <cstddef>
+#include <utility>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/skip.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  /// Deserialize only the members of `value` registered as `members` (`&T::field`), skipping
+  /// the other ones without decoding them: they keep their current value. Binary formats jump
+  /// over members of fixed size and only read the lengths of strings and ranges, tagged structs
+  /// jump over whole fields. JSON skips the values by their structure.
+  ///
+  /// Only the members of `value` itself are selected, selected structs are read in full:
+  ///   enki::deserializeOnly<&Order::id, &Order::price>(order, reader).or_throw();
+  template <auto... members, typename T, typename Reader>
+    requires concepts::custom_static_serializable<T> &&
+             (!detail::custom_deserializable<T, Reader>)
+  constexpr Success deserializeOnly(T &value, Reader &&r)
+  {
+    static_assert(
+      ((detail::registered_index_v<T, members> < T::EnkiSerial::Members::count) && ...),
+      "Member is not registered in T::EnkiSerial::Members");
+    return detail::deserializeCustom<detail::SelectedMembers<members...>>(
+      value, r, std::make_index_sequence<T::EnkiSerial::Members::count>());
+  }
+} // namespace enki
+
+#endif // ENKI_PROJECTION_HPP
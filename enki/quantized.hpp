@@ -0,0 +1,221 @@
+#ifndef ENKI_QUANTIZED_HPP
+#define ENKI_QUANTIZED_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/converted_range.hpp"
+#include "enki/impl/success.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Linear mapping of [Min, Max] onto every value of `Storage`
+    /// Out of range values are clamped, NaN is stored as Min
+    template <double Min, double Max, std::unsigned_integral Storage>
+      requires(Min < Max && sizeof(Storage) <= sizeof(uint32_t))
+    struct Quantizer
+    {
+      static constexpr double kSteps = std::numeric_limits<Storage>::max();
+      static constexpr double kStep = (Max - Min) / kSteps;
+
+      template <std::floating_point T>
+      static constexpr Storage quantize(T value)
+      {
+        const auto v = static_cast<double>(value);
+        if (!(v > Min))
+        {
+          return 0;
+        }
+        if (!(v < Max))
+        {
+          return std::numeric_limits<Storage>::max();
+        }
+        return static_cast<Storage>((v - Min) / kStep + 0.5);
+      }
+
+      template <std::floating_point T>
+      static constexpr T dequantize(Storage stored)
+      {
+        return static_cast<T>(Min + stored * kStep);
+      }
+
+      template <std::floating_point T>
+      static constexpr void quantize(const T *in, Storage *out, size_t size)
+      {
+        std::transform(in, in + size, out, [](T v) { return quantize(v); });
+      }
+
+      template <std::floating_point T>
+      static constexpr void dequantize(const Storage *in, T *out, size_t size)
+      {
+        std::transform(in, in + size, out, [](Storage s) { return dequantize<T>(s); });
+      }
+    };
+  } // namespace detail
+
+  /// Floating point value stored as an unsigned integer spanning the compile-time range
+  /// [Min, Max]: the precision is (Max - Min) / max(Storage) and out of range values are clamped.
+  /// Only binary formats are affected, JSON keeps writing the full precision value.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST` (with an alias, macros split on commas):
+  ///   using Alpha = enki::Quantized<float, 0.0, 1.0, uint8_t>;
+  ///   enki::Register<ENKIWRAP_CAST(Pixel, alpha, Alpha)>
+  template <
+    std::floating_point T,
+    double Min,
+    double Max,
+    std::unsigned_integral Storage = uint16_t>
+    requires(Min < Max && sizeof(Storage) <= sizeof(uint32_t))
+  class Quantized
+  {
+  public:
+    using quantizer_type = detail::Quantizer<Min, Max, Storage>; // NOLINT
+
+    constexpr Quantized() = default;
+
+    constexpr Quantized(T value) :
+      mValue(value)
+    {
+    }
+
+    /// Explicit so that writers never pick an arithmetic overload through an implicit conversion
+    constexpr explicit operator T() const
+    {
+      return mValue;
+    }
+
+    constexpr T value() const
+    {
+      return mValue;
+    }
+
+    constexpr bool operator==(const Quantized &) const = default;
+
+    struct EnkiSerial;
+
+  private:
+    T mValue{};
+  };
+
+  /// Range of floating point values stored as unsigned integers spanning [Min, Max], converted
+  /// by blocks. JSON keeps writing plain arrays.
+  template <
+    concepts::range_constructible_container Range,
+    double Min,
+    double Max,
+    std::unsigned_integral Storage = uint16_t>
+    requires std::floating_point<typename Range::value_type> &&
+             (Min < Max && sizeof(Storage) <= sizeof(uint32_t))
+  class QuantizedRange : public Range
+  {
+  public:
+    using quantizer_type = detail::Quantizer<Min, Max, Storage>; // NOLINT
+
+    using Range::Range;
+
+    QuantizedRange() = default;
+
+    QuantizedRange(Range range) :
+      Range(std::move(range))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  template <std::floating_point T, double Min, double Max, std::unsigned_integral Storage>
+    requires(Min < Max && sizeof(Storage) <= sizeof(uint32_t))
+  struct Quantized<T, Min, Max, Storage>::EnkiSerial
+  {
+    template <typename Writer>
+    static constexpr Success serialize(const Quantized &value, Writer &&w)
+    {
+      if constexpr (concepts::byte_writer<Writer>)
+      {
+        return ::enki::serialize(quantizer_type::quantize(value.mValue), w);
+      }
+      else
+      {
+        return ::enki::serialize(value.mValue, w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Quantized &value, Reader &&r)
+    {
+      if constexpr (concepts::byte_reader<Reader>)
+      {
+        Storage stored = 0;
+        Success isGood = ::enki::deserialize(stored, r);
+        if (isGood)
+        {
+          value.mValue = quantizer_type::template dequantize<T>(stored);
+        }
+        return isGood;
+      }
+      else
+      {
+        return ::enki::deserialize(value.mValue, r);
+      }
+    }
+  };
+
+  template <
+    concepts::range_constructible_container Range,
+    double Min,
+    double Max,
+    std::unsigned_integral Storage>
+    requires std::floating_point<typename Range::value_type> &&
+             (Min < Max && sizeof(Storage) <= sizeof(uint32_t))
+  struct QuantizedRange<Range, Min, Max, Storage>::EnkiSerial
+  {
+    using value_type = typename Range::value_type; // NOLINT
+
+    template <typename Writer>
+    static constexpr Success serialize(const QuantizedRange &value, Writer &&w)
+    {
+      if constexpr (concepts::byte_writer<Writer>)
+      {
+        return detail::writeConvertedRange<Storage>(
+          static_cast<const Range &>(value),
+          [](const value_type *in, Storage *out, size_t size) {
+            quantizer_type::quantize(in, out, size);
+          },
+          w);
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const Range &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(QuantizedRange &value, Reader &&r)
+    {
+      if constexpr (concepts::byte_reader<Reader>)
+      {
+        return detail::readConvertedRange<Storage>(
+          static_cast<Range &>(value),
+          [](const Storage *in, value_type *out, size_t size) {
+            quantizer_type::dequantize(in, out, size);
+          },
+          r);
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<Range &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_QUANTIZED_HPP
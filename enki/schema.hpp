@@ -0,0 +1,794 @@
+#ifndef ENKI_SCHEMA_HPP
+#define ENKI_SCHEMA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "enki/bin_session.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/schema_descriptor.hpp"
+#include "enki/impl/shared_objects.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/tagged_struct.hpp"
+#include "enki/impl/utilities.hpp"
+#include "enki/impl/varint.hpp"
+
+namespace enki
+{
+  /// Schema read from a binary stream: lets generic tools walk, skip and route values written
+  /// by a type they do not know. See `writeSchema` and `readSchema`.
+  class Schema
+  {
+  public:
+    /// Type of the values of the stream, valid once a schema has been read
+    SchemaNode root() const
+    {
+      return SchemaNode(mDescriptor.data() + detail::kSchemaHeaderSize);
+    }
+
+    /// The descriptor as written in the stream, header included
+    std::span<const std::byte> descriptor() const noexcept
+    {
+      return mDescriptor;
+    }
+
+  private:
+    template <typename Reader>
+    friend Success readSchema(Schema &schema, Reader &&r);
+
+    std::vector<std::byte> mDescriptor;
+  };
+
+  /// Leaf values given to `visitValue` visitors. Integers are widened, floating point values
+  /// converted to double, strings and raw bytes point into the input of the reader. Absent
+  /// optionals and unknown variant alternatives are visited as `std::monostate`.
+  using SchemaValue = std::variant<
+    std::monostate,
+    bool,
+    int64_t,
+    uint64_t,
+    double,
+    std::string_view,
+    std::span<const std::byte>>;
+
+  /// Write the descriptor of `T` for the policies of `w`, once at the start of a stream of `T`
+  /// values: a varint size followed by `schema_v<T, ...>`.
+  /// Writers sharing a `BinWriterSession` write each descriptor once per session instead, as a
+  /// varint tag: `size << 1` followed by the descriptor, or `(id << 1) | 1` for a descriptor
+  /// already written in the session.
+  template <typename T, typename Writer>
+  constexpr Success writeSchema(Writer &&w)
+  {
+    using W = std::remove_cvref_t<Writer>;
+    constexpr auto &schema = schema_v<T, typename W::policy_type, typename W::size_type>;
+    BinWriterSession *session = nullptr;
+    if constexpr (requires { w.session(); })
+    {
+      session = w.session();
+    }
+    if (session == nullptr)
+    {
+      Success isGood = w.writeVarint(schema.size());
+      return isGood.update(w.writeBytes(schema));
+    }
+    uint64_t id = 0;
+    if (session->findSchema(schema, id))
+    {
+      return w.writeVarint(detail::sessionSchemaReferenceTag(id));
+    }
+    session->addSchema(schema);
+    Success isGood = w.writeVarint(detail::sessionSchemaLiteralTag(schema.size()));
+    return isGood.update(w.writeBytes(schema));
+  }
+
+  /// Read a descriptor written by `writeSchema` with the same policies and size type as `r`,
+  /// and the same kind of session
+  template <typename Reader>
+  Success readSchema(Schema &schema, Reader &&r)
+  {
+    using R = std::remove_cvref_t<Reader>;
+    BinReaderSession *const session = r.session();
+    uint64_t size = 0;
+    Success isGood = r.readVarint(size);
+    if (!isGood)
+    {
+      return isGood;
+    }
+    if (session != nullptr)
+    {
+      if (detail::isSessionSchemaReference(size))
+      {
+        std::span<const std::byte> known;
+        if (!session->getSchema(size >> 1, known))
+        {
+          return "Unknown session schema reference";
+        }
+        schema.mDescriptor.assign(known.begin(), known.end());
+        return isGood;
+      }
+      size >>= 1;
+    }
+    if (size < detail::kSchemaHeaderSize || !detail::fitsInRemainingBytes(size, r))
+    {
+      return "Malformed schema";
+    }
+    std::span<const std::byte> bytes;
+    if (!isGood.update(r.viewBytes(size, bytes)))
+    {
+      return isGood;
+    }
+    if (bytes[0] != detail::kSchemaVersion)
+    {
+      return "Unsupported schema version";
+    }
+    if (
+      bytes[1] != static_cast<std::byte>(sizeof(typename R::size_type)) ||
+      bytes[2] != detail::schemaPolicyFlags<typename R::policy_type>())
+    {
+      return "Schema does not match the policies of the reader";
+    }
+    const std::byte *const end = bytes.data() + bytes.size();
+    if (detail::validateSchemaNode(bytes.data() + detail::kSchemaHeaderSize, end, 0) != end)
+    {
+      return "Malformed schema";
+    }
+    schema.mDescriptor.assign(bytes.begin(), bytes.end());
+    if (session != nullptr)
+    {
+      session->addSchema(bytes);
+    }
+    return isGood;
+  }
+
+  namespace detail
+  {
+    /// Visitor of `skipValue`: nothing is decoded nor named
+    struct SchemaSkipper
+    {
+    };
+
+    template <typename Visitor>
+    inline constexpr bool is_schema_skipper_v = std::same_as<Visitor, SchemaSkipper>; // NOLINT
+
+    template <typename Visitor>
+    void visitSchemaLeaf(Visitor &visitor, const std::string &path, const SchemaValue &value)
+    {
+      if constexpr (!is_schema_skipper_v<Visitor>)
+      {
+        visitor(std::string_view(path), value);
+      }
+    }
+
+    /// Appends `.name` or `[index]` to the path of the visited value, removed when destroyed
+    template <typename Visitor>
+    class SchemaPathScope
+    {
+    public:
+      SchemaPathScope(std::string &path, std::string_view name) :
+        mPath(path),
+        mSize(path.size())
+      {
+        if constexpr (!is_schema_skipper_v<Visitor>)
+        {
+          if (!mPath.empty())
+          {
+            mPath += '.';
+          }
+          mPath += name;
+        }
+      }
+
+      SchemaPathScope(std::string &path, size_t index) :
+        mPath(path),
+        mSize(path.size())
+      {
+        if constexpr (!is_schema_skipper_v<Visitor>)
+        {
+          mPath += '[';
+          mPath += std::to_string(index);
+          mPath += ']';
+        }
+      }
+
+      SchemaPathScope(const SchemaPathScope &) = delete;
+      SchemaPathScope &operator=(const SchemaPathScope &) = delete;
+
+      ~SchemaPathScope()
+      {
+        mPath.resize(mSize);
+      }
+
+    private:
+      std::string &mPath;
+      size_t mSize;
+    };
+
+    template <typename T, typename Reader, typename Visitor>
+    Success walkSchemaScalar(Reader &r, Visitor &visitor, const std::string &path)
+    {
+      T value{};
+      Success isGood = r.read(value);
+      if (isGood)
+      {
+        if constexpr (std::same_as<T, bool>)
+        {
+          visitSchemaLeaf(visitor, path, value);
+        }
+        else if constexpr (std::floating_point<T>)
+        {
+          visitSchemaLeaf(visitor, path, static_cast<double>(value));
+        }
+        else if constexpr (std::is_signed_v<T>)
+        {
+          visitSchemaLeaf(visitor, path, static_cast<int64_t>(value));
+        }
+        else
+        {
+          visitSchemaLeaf(visitor, path, static_cast<uint64_t>(value));
+        }
+      }
+      return isGood;
+    }
+
+    template <typename Reader>
+    Success readSchemaVariantIndex(SchemaKind indexKind, Reader &r, uint64_t &index)
+    {
+      const auto readIndex = [&]<typename I>() {
+        I stored{};
+        Success isGood = r.readVariantIndex(stored);
+        index = stored;
+        return isGood;
+      };
+      switch (indexKind)
+      {
+      case SchemaKind::uint8:
+        return readIndex.template operator()<uint8_t>();
+      case SchemaKind::uint16:
+        return readIndex.template operator()<uint16_t>();
+      case SchemaKind::uint32:
+        return readIndex.template operator()<uint32_t>();
+      case SchemaKind::uint64:
+        return readIndex.template operator()<uint64_t>();
+      default:
+        return "Unsupported variant index in schema";
+      }
+    }
+
+    /// Wire type of a struct member under the `forward_compatible` policy
+    template <typename Policy>
+    WireType schemaWireType(SchemaNode node)
+    {
+      if (node.kind() == SchemaKind::string && has_policy_v<Policy, dictionary_t>)
+      {
+        return WireType::string;
+      }
+      if (node.kind() == SchemaKind::shared)
+      {
+        return WireType::object;
+      }
+      switch (schemaScalarSize(node.kind()))
+      {
+      case 1:
+        return WireType::fixed8;
+      case 2:
+        return WireType::fixed16;
+      case 4:
+        return WireType::fixed32;
+      case 8:
+        return WireType::fixed64;
+      default:
+        return WireType::sized;
+      }
+    }
+
+    inline size_t countOptionalSchemaMembers(SchemaNode node)
+    {
+      size_t count = 0;
+      for (size_t i = 0; i < node.size(); ++i)
+      {
+        count += node.child(i).kind() == SchemaKind::optional ? 1 : 0;
+      }
+      return count;
+    }
+
+    template <typename Reader>
+    constexpr bool isTaggedSchemaReader()
+    {
+      return has_policy_v<typename std::remove_cvref_t<Reader>::policy_type, forward_compatible_t>;
+    }
+
+    template <typename Reader>
+    constexpr bool hasSchemaPresenceBitmap()
+    {
+      using Policy = typename std::remove_cvref_t<Reader>::policy_type;
+      return has_policy_v<Policy, presence_bitmap_t> && !has_policy_v<Policy, forward_compatible_t>;
+    }
+
+    template <typename Reader, typename Visitor>
+    Success walkSchemaValue(SchemaNode node, Reader &r, Visitor &visitor, std::string &path);
+
+    template <typename Reader, typename Visitor>
+    Success walkSchemaTagged(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      uint64_t numFields = 0;
+      Success isGood = r.readVarint(numFields);
+      const size_t numMembers = node.size();
+      for (uint64_t i = 0; i < numFields && isGood; ++i)
+      {
+        uint64_t tag = 0;
+        if (!isGood.update(r.readVarint(tag)))
+        {
+          break;
+        }
+        const uint64_t fieldNumber = taggedFieldNumber(tag);
+        if (fieldNumber >= numMembers)
+        {
+          isGood.update(skipTaggedField(tag, r));
+          continue;
+        }
+        const SchemaNode member = node.child(fieldNumber);
+        if (taggedWireType(tag) != schemaWireType<typename Reader::policy_type>(member))
+        {
+          return "Tagged struct field has an unexpected type";
+        }
+        if (taggedWireType(tag) != WireType::sized)
+        {
+          const SchemaPathScope<Visitor> scope(path, node.memberName(fieldNumber));
+          isGood.update(walkSchemaValue(member, r, visitor, path));
+          continue;
+        }
+        uint64_t size = 0;
+        if (!isGood.update(r.readVarint(size)))
+        {
+          break;
+        }
+        if constexpr (is_schema_skipper_v<Visitor>)
+        {
+          // Sized fields are skipped without looking at their content
+          std::span<const std::byte> bytes;
+          isGood.update(r.viewBytes(size, bytes));
+        }
+        else
+        {
+          const size_t remainingBefore = r.remainingBytes();
+          const SchemaPathScope<Visitor> scope(path, node.memberName(fieldNumber));
+          if (
+            isGood.update(
+              readScoped(r, [&] { return walkSchemaValue(member, r, visitor, path); })) &&
+            remainingBefore - r.remainingBytes() != size)
+          {
+            return "Tagged struct field size does not match its content";
+          }
+        }
+      }
+      return isGood;
+    }
+
+    /// Struct members before the one of interest, with their presence flags
+    template <typename Reader>
+    class SchemaStructCursor
+    {
+    public:
+      SchemaStructCursor(SchemaNode node, Reader &r) :
+        mNode(node),
+        mReader(r)
+      {
+      }
+
+      Success begin()
+      {
+        if constexpr (hasSchemaPresenceBitmap<Reader>())
+        {
+          const size_t numOptionals = countOptionalSchemaMembers(mNode);
+          if (numOptionals > 0)
+          {
+            return mReader.viewBytes((numOptionals + 7) / 8, mBitmap);
+          }
+        }
+        return {};
+      }
+
+      /// False if member `i` is an optional flagged absent in the bitmap
+      bool isPresent(size_t i)
+      {
+        if (mBitmap.empty() || mNode.child(i).kind() != SchemaKind::optional)
+        {
+          return true;
+        }
+        const size_t bit = mNextBit++;
+        return (mBitmap[bit / 8] & (std::byte{1} << (bit % 8))) != std::byte{};
+      }
+
+      /// Type of member `i` in the data: the value type of optionals in the bitmap
+      SchemaNode member(size_t i) const
+      {
+        const SchemaNode member = mNode.child(i);
+        return mBitmap.empty() || member.kind() != SchemaKind::optional ? member : member.child();
+      }
+
+    private:
+      SchemaNode mNode;
+      Reader &mReader;
+      std::span<const std::byte> mBitmap;
+      size_t mNextBit = 0;
+    };
+
+    template <typename Reader, typename Visitor>
+    Success walkSchemaStruct(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      if constexpr (isTaggedSchemaReader<Reader>())
+      {
+        return walkSchemaTagged(node, r, visitor, path);
+      }
+      else
+      {
+        SchemaStructCursor<Reader> cursor(node, r);
+        Success isGood = cursor.begin();
+        for (size_t i = 0; i < node.size() && isGood; ++i)
+        {
+          const SchemaPathScope<Visitor> scope(path, node.memberName(i));
+          if (cursor.isPresent(i))
+          {
+            isGood.update(walkSchemaValue(cursor.member(i), r, visitor, path));
+          }
+          else
+          {
+            visitSchemaLeaf(visitor, path, std::monostate{});
+          }
+        }
+        return isGood;
+      }
+    }
+
+    template <typename Reader, typename Visitor>
+    Success walkSchemaVariant(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      uint64_t index = 0;
+      Success isGood = readSchemaVariantIndex(node.indexKind(), r, index);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (index >= node.size())
+      {
+        if constexpr (isTaggedSchemaReader<Reader>())
+        {
+          isGood.update(r.skipHintAndValue());
+          visitSchemaLeaf(visitor, path, std::monostate{});
+          return isGood;
+        }
+        return "Deserialized variant index is out of range";
+      }
+      if constexpr (isTaggedSchemaReader<Reader>())
+      {
+        if (!isGood.update(r.skipHint()))
+        {
+          return isGood;
+        }
+        return isGood.update(
+          readScoped(r, [&] { return walkSchemaValue(node.child(index), r, visitor, path); }));
+      }
+      return isGood.update(walkSchemaValue(node.child(index), r, visitor, path));
+    }
+
+    /// Ranges of time points: the deltas are summed back into ticks, which wrap around at the
+    /// width of the element type like they do when decoding
+    template <typename Reader, typename Visitor>
+    Success walkSchemaDeltaRange(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      const SchemaKind elementKind = node.child().kind();
+      const size_t shift = 64 - 8 * schemaScalarSize(elementKind);
+      const uint64_t maxZigzag = ~uint64_t{0} >> shift;
+      const bool isSigned = elementKind >= SchemaKind::int8;
+
+      size_t numElements = 0;
+      Success isGood = r.rangeBegin(numElements);
+      uint64_t ticks = 0;
+      for (size_t i = 0; i < numElements && isGood; ++i)
+      {
+        uint64_t zigzag = 0;
+        if (!isGood.update(r.readVarint(zigzag)))
+        {
+          break;
+        }
+        if (zigzag > maxZigzag)
+        {
+          return isGood.update("Delta does not fit in the element type");
+        }
+        ticks += static_cast<uint64_t>(zigzagDecode(zigzag));
+        const SchemaPathScope<Visitor> scope(path, i);
+        if (isSigned)
+        {
+          visitSchemaLeaf(visitor, path, static_cast<int64_t>(ticks << shift) >> shift);
+        }
+        else
+        {
+          visitSchemaLeaf(visitor, path, (ticks << shift) >> shift);
+        }
+      }
+      return isGood;
+    }
+
+    /// Shared objects: the value of an object is walked where it is first written, its later
+    /// references are visited as the id of the object
+    template <typename Reader, typename Visitor>
+    Success walkSchemaShared(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      uint64_t tag = 0;
+      Success isGood = r.readVarint(tag);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (isObjectReference(tag))
+      {
+        visitSchemaLeaf(visitor, path, tag >> 1);
+        return isGood;
+      }
+      if (tag == kNullObjectTag)
+      {
+        visitSchemaLeaf(visitor, path, std::monostate{});
+        return isGood;
+      }
+      if (tag != objectLiteralTag(true) && tag != objectLiteralTag(false))
+      {
+        return "Malformed shared object tag";
+      }
+      if constexpr (isTaggedSchemaReader<Reader>())
+      {
+        // Forward compatible values are preceded by their size
+        if (!isGood.update(r.skipHint()))
+        {
+          return isGood;
+        }
+        return isGood.update(
+          readScoped(r, [&] { return walkSchemaValue(node.child(), r, visitor, path); }));
+      }
+      return isGood.update(walkSchemaValue(node.child(), r, visitor, path));
+    }
+
+    template <typename Reader, typename Visitor>
+    Success walkSchemaValue(SchemaNode node, Reader &r, Visitor &visitor, std::string &path)
+    {
+      switch (node.kind())
+      {
+      case SchemaKind::none:
+        visitSchemaLeaf(visitor, path, std::monostate{});
+        return {};
+      case SchemaKind::boolean:
+        return walkSchemaScalar<bool>(r, visitor, path);
+      case SchemaKind::uint8:
+        return walkSchemaScalar<uint8_t>(r, visitor, path);
+      case SchemaKind::uint16:
+        return walkSchemaScalar<uint16_t>(r, visitor, path);
+      case SchemaKind::uint32:
+        return walkSchemaScalar<uint32_t>(r, visitor, path);
+      case SchemaKind::uint64:
+        return walkSchemaScalar<uint64_t>(r, visitor, path);
+      case SchemaKind::int8:
+        return walkSchemaScalar<int8_t>(r, visitor, path);
+      case SchemaKind::int16:
+        return walkSchemaScalar<int16_t>(r, visitor, path);
+      case SchemaKind::int32:
+        return walkSchemaScalar<int32_t>(r, visitor, path);
+      case SchemaKind::int64:
+        return walkSchemaScalar<int64_t>(r, visitor, path);
+      case SchemaKind::float32:
+        return walkSchemaScalar<float>(r, visitor, path);
+      case SchemaKind::float64:
+        return walkSchemaScalar<double>(r, visitor, path);
+      case SchemaKind::bytes:
+      {
+        std::span<const std::byte> bytes;
+        Success isGood = r.viewBytes(node.size(), bytes);
+        visitSchemaLeaf(visitor, path, bytes);
+        return isGood;
+      }
+      case SchemaKind::string:
+      {
+        std::string_view str;
+        Success isGood = r.read(str);
+        if (isGood)
+        {
+          visitSchemaLeaf(visitor, path, str);
+        }
+        return isGood;
+      }
+      case SchemaKind::array:
+      case SchemaKind::range:
+      {
+        size_t numElements = node.size();
+        bool isLast = true;
+        Success isGood;
+        if (node.kind() == SchemaKind::range)
+        {
+          if constexpr (chunked_range_reader<Reader &>)
+          {
+            isGood.update(r.rangeChunk(numElements, isLast));
+          }
+          else
+          {
+            isGood.update(r.rangeBegin(numElements));
+          }
+          if (!isGood)
+          {
+            return isGood;
+          }
+        }
+        const SchemaNode element = node.child();
+        const size_t elementSize = schemaScalarSize(element.kind());
+        const auto walkElements = [&](size_t first, size_t count) -> Success {
+          if constexpr (is_schema_skipper_v<Visitor>)
+          {
+            if (elementSize != 0)
+            {
+              // Raw elements are skipped at once
+              std::span<const std::byte> bytes;
+              if (count > r.remainingBytes() / elementSize)
+              {
+                return "Range size exceeds remaining data";
+              }
+              return r.viewBytes(count * elementSize, bytes);
+            }
+          }
+          Success isChunkGood;
+          for (size_t i = 0; i < count && isChunkGood; ++i)
+          {
+            const SchemaPathScope<Visitor> scope(path, first + i);
+            isChunkGood.update(walkSchemaValue(element, r, visitor, path));
+          }
+          return isChunkGood;
+        };
+        // Chunked policy: ranges may continue over several chunks
+        for (size_t first = 0; isGood.update(walkElements(first, numElements)) && !isLast;)
+        {
+          if constexpr (chunked_range_reader<Reader &>)
+          {
+            first += numElements;
+            if (!isGood.update(r.rangeChunk(numElements, isLast)))
+            {
+              break;
+            }
+          }
+        }
+        return isGood;
+      }
+      case SchemaKind::tuple:
+      {
+        Success isGood;
+        for (size_t i = 0; i < node.size() && isGood; ++i)
+        {
+          const SchemaPathScope<Visitor> scope(path, i);
+          isGood.update(walkSchemaValue(node.child(i), r, visitor, path));
+        }
+        return isGood;
+      }
+      case SchemaKind::optional:
+      {
+        bool hasValue = false;
+        Success isGood = r.readOptionalHasValue(hasValue);
+        if (isGood && hasValue)
+        {
+          return isGood.update(walkSchemaValue(node.child(), r, visitor, path));
+        }
+        if (isGood)
+        {
+          visitSchemaLeaf(visitor, path, std::monostate{});
+        }
+        return isGood;
+      }
+      case SchemaKind::variant:
+        return walkSchemaVariant(node, r, visitor, path);
+      case SchemaKind::structure:
+        return walkSchemaStruct(node, r, visitor, path);
+      case SchemaKind::delta_range:
+        return walkSchemaDeltaRange(node, r, visitor, path);
+      case SchemaKind::shared:
+        return walkSchemaShared(node, r, visitor, path);
+      default:
+        return "Cannot walk a value with a custom encoding";
+      }
+    }
+  } // namespace detail
+
+  /// Skip one value of type `node` in `r`, without decoding it when possible
+  template <typename Reader>
+  Success skipValue(SchemaNode node, Reader &&r)
+  {
+    detail::SchemaSkipper skipper;
+    std::string path;
+    return detail::walkSchemaValue(node, r, skipper, path);
+  }
+
+  /// Read one value of type `node` from `r`, calling `visitor(path, value)` with each leaf
+  /// `SchemaValue`. Paths name members and indices: "orders[2].price".
+  template <typename Reader, typename Visitor>
+  Success visitValue(SchemaNode node, Reader &&r, Visitor &&visitor)
+  {
+    std::string path;
+    return detail::walkSchemaValue(node, r, visitor, path);
+  }
+
+  /// Move `r` to member `name` of the struct of type `node` it is at, skipping the members
+  /// before it, and give its type in `member`. The member can then be deserialized or walked,
+  /// which allows routing on one member without knowing the whole type.
+  template <typename Reader>
+  Success findMember(SchemaNode node, std::string_view name, Reader &&r, SchemaNode &member)
+  {
+    if (node.kind() != SchemaKind::structure)
+    {
+      return "Schema node is not a struct";
+    }
+    const auto index = node.memberIndex(name);
+    if (!index)
+    {
+      return "Unknown struct member";
+    }
+
+    if constexpr (detail::isTaggedSchemaReader<Reader>())
+    {
+      uint64_t numFields = 0;
+      Success isGood = r.readVarint(numFields);
+      for (uint64_t i = 0; i < numFields && isGood; ++i)
+      {
+        uint64_t tag = 0;
+        if (!isGood.update(r.readVarint(tag)))
+        {
+          break;
+        }
+        if (detail::taggedFieldNumber(tag) > *index)
+        {
+          break;
+        }
+        if (detail::taggedFieldNumber(tag) < *index)
+        {
+          isGood.update(detail::skipTaggedField(tag, r));
+          continue;
+        }
+        member = node.child(*index);
+        if (
+          detail::taggedWireType(tag) !=
+          detail::schemaWireType<typename std::remove_cvref_t<Reader>::policy_type>(member))
+        {
+          return "Tagged struct field has an unexpected type";
+        }
+        if (detail::taggedWireType(tag) == detail::WireType::sized)
+        {
+          uint64_t size = 0;
+          isGood.update(r.readVarint(size));
+        }
+        return isGood;
+      }
+      return isGood ? Success("Struct member is missing from the data") : isGood;
+    }
+    else
+    {
+      detail::SchemaStructCursor<std::remove_reference_t<Reader>> cursor(node, r);
+      Success isGood = cursor.begin();
+      for (size_t i = 0; i < *index && isGood; ++i)
+      {
+        if (cursor.isPresent(i))
+        {
+          isGood.update(skipValue(cursor.member(i), r));
+        }
+      }
+      if (isGood && !cursor.isPresent(*index))
+      {
+        return "Struct member holds no value";
+      }
+      member = cursor.member(*index);
+      return isGood;
+    }
+  }
+} // namespace enki
+
+#endif // ENKI_SCHEMA_HPP
@@ -0,0 +1,24 @@
+#ifndef ENKI_SKIP_HPP
+#define ENKI_SKIP_HPP
+
+#include "enki/impl/skip.hpp"
+#include "enki/impl/success.hpp"
+
+namespace enki
+{
+  /// Move `r` past a value of type `T` without deserializing it. Binary readers jump over values
+  /// and ranges of fixed size at once and only read the lengths, flags and indices of the other
+  /// ones: strings and containers are not built. JSON readers check the structure of the value
+  /// without decoding it.
+  ///
+  /// Values decoded with side effects on the reader (dictionary strings, shared objects) and
+  /// delta coded ranges are still deserialized into a temporary:
+  ///   enki::skip<std::vector<std::string>>(reader).or_throw();
+  template <typename T, typename Reader>
+  constexpr Success skip(Reader &&r)
+  {
+    return detail::skipTyped<T>(r);
+  }
+} // namespace enki
+
+#endif // ENKI_SKIP_HPP
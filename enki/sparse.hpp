@@ -0,0 +1,152 @@
+#ifndef ENKI_SPARSE_HPP
+#define ENKI_SPARSE_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/presence_bitmap.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    /// Registered structs whose members can be compared to the ones of a value-initialized
+    /// instance
+    template <typename T>
+    concept sparse_struct =
+      concepts::custom_static_serializable<T> && std::default_initializable<T> &&
+      hasComparableMembers<T>(std::make_index_sequence<T::EnkiSerial::Members::count>());
+  } // namespace detail
+
+  /// Struct storing only the members differing from a value-initialized instance.
+  /// Binary formats write one flag per registered member, then the flagged members in
+  /// declaration order. Readers start from a value-initialized instance and only overwrite the
+  /// flagged members. JSON keeps writing every member.
+  ///
+  /// Use it as a member type or through `ENKIWRAP_CAST`:
+  ///   enki::Register<ENKIWRAP_CAST(Batch, records, std::vector<enki::Sparse<Telemetry>>)>
+  template <detail::sparse_struct T>
+  class Sparse : public T
+  {
+  public:
+    using T::T;
+
+    Sparse() = default;
+
+    Sparse(T value) :
+      T(std::move(value))
+    {
+    }
+
+    struct EnkiSerial;
+  };
+
+  namespace detail
+  {
+    template <typename T>
+    using sparse_mask_t = PresenceBitmap<T::EnkiSerial::Members::count>; // NOLINT
+
+    template <typename T, size_t... idx>
+    constexpr sparse_mask_t<T> nonDefaultMembers(const T &value, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      const T defaults = T();
+      sparse_mask_t<T> mask;
+      const auto markOne = [&]<typename Reg, size_t bit>() {
+        if (!(Reg::getter(value) == Reg::getter(defaults)))
+        {
+          mask.set(bit);
+        }
+      };
+      (markOne.template operator()<get_nth_register_t<idx, Members>, idx>(), ...);
+      return mask;
+    }
+
+    template <typename T, typename Writer, size_t... idx>
+    constexpr Success
+    serializeSparse(const T &value, Writer &&w, std::index_sequence<idx...> members)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      const auto mask = nonDefaultMembers(value, members);
+      Success isGood = w.writeBytes(mask.bytes());
+      const auto writeOne = [&]<typename Reg, size_t bit>() {
+        return !mask.test(bit) || isGood.update(serialize(Reg::getter(value), w));
+      };
+      static_cast<void>(
+        (writeOne.template operator()<get_nth_register_t<idx, Members>, idx>() && ...));
+      return isGood;
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success deserializeSparse(T &value, Reader &&r, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      sparse_mask_t<T> mask;
+      Success isGood = readPresenceBitmap(mask, r);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      value = T();
+      const auto readOne = [&]<typename Reg, size_t bit>() {
+        if (!mask.test(bit))
+        {
+          return true;
+        }
+        std::remove_cvref_t<typename Reg::value_type> member{};
+        if (!isGood.update(deserialize(member, r)))
+        {
+          return false;
+        }
+        Reg::setter(value, std::move(member));
+        return true;
+      };
+      static_cast<void>(
+        (readOne.template operator()<get_nth_register_t<idx, Members>, idx>() && ...));
+      return isGood;
+    }
+  } // namespace detail
+
+  template <detail::sparse_struct T>
+  struct Sparse<T>::EnkiSerial
+  {
+    template <typename Writer>
+    static constexpr Success serialize(const Sparse &value, Writer &&w)
+    {
+      if constexpr (concepts::byte_writer<Writer>)
+      {
+        return detail::serializeSparse(
+          static_cast<const T &>(value),
+          w,
+          std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+      else
+      {
+        return ::enki::serialize(static_cast<const T &>(value), w);
+      }
+    }
+
+    template <typename Reader>
+    static constexpr Success deserialize(Sparse &value, Reader &&r)
+    {
+      if constexpr (concepts::byte_reader<Reader>)
+      {
+        return detail::deserializeSparse(
+          static_cast<T &>(value), r, std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+      else
+      {
+        return ::enki::deserialize(static_cast<T &>(value), r);
+      }
+    }
+  };
+} // namespace enki
+
+#endif // ENKI_SPARSE_HPP
@@ -0,0 +1,488 @@
+#ifndef ENKI_VALIDATE_HPP
+#define ENKI_VALIDATE_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "enki/enki_deserialize.hpp"
+#include "enki/impl/aligned.hpp"
+#include "enki/impl/chunked.hpp"
+#include "enki/impl/compact.hpp"
+#include "enki/impl/concepts.hpp"
+#include "enki/impl/delta_coding.hpp"
+#include "enki/impl/fixed_size.hpp"
+#include "enki/impl/policies.hpp"
+#include "enki/impl/presence_bitmap.hpp"
+#include "enki/impl/skip.hpp"
+#include "enki/impl/success.hpp"
+#include "enki/impl/tagged_struct.hpp"
+#include "enki/impl/utilities.hpp"
+
+namespace enki
+{
+  namespace detail
+  {
+    template <typename T, typename Reader>
+    constexpr Success validateTyped(Reader &r);
+
+    template <typename T, typename Policy>
+    constexpr bool anyBytesValid();
+
+    template <typename T, typename Policy, size_t... idx>
+    constexpr bool anyBytesValidElements(std::index_sequence<idx...>)
+    {
+      return (anyBytesValid<std::remove_cvref_t<std::tuple_element_t<idx, T>>, Policy>() && ...);
+    }
+
+    template <typename T, typename Policy, size_t... idx>
+    constexpr bool anyBytesValidMembers(std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      return (
+        anyBytesValid<
+          std::remove_cvref_t<typename get_nth_register_t<idx, Members>::value_type>,
+          Policy>() &&
+        ...);
+    }
+
+    /// Types of fixed size whose values are valid whatever their bytes: the ones holding no bool
+    /// and no compact enum. Their values are checked by size only.
+    template <typename T, typename Policy>
+    constexpr bool anyBytesValid()
+    {
+      if constexpr (!fixed_size<T, Policy>)
+      {
+        return false;
+      }
+      else if constexpr (std::same_as<T, bool> || is_compact_enum_v<Policy, T>)
+      {
+        return false;
+      }
+      else if constexpr (concepts::arithmetic_or_enum<T> || std::same_as<T, std::monostate>)
+      {
+        return true;
+      }
+      else if constexpr (concepts::duration<T>)
+      {
+        return anyBytesValid<typename T::rep, Policy>();
+      }
+      else if constexpr (concepts::time_point<T>)
+      {
+        return anyBytesValid<typename T::duration, Policy>();
+      }
+      else if constexpr (concepts::array_like<T>)
+      {
+        return anyBytesValid<
+          std::remove_cvref_t<decltype(*std::begin(std::declval<T &>()))>,
+          Policy>();
+      }
+      else if constexpr (concepts::tuple_like<T>)
+      {
+        return anyBytesValidElements<T, Policy>(std::make_index_sequence<std::tuple_size_v<T>>());
+      }
+      else
+      {
+        return anyBytesValidMembers<T, Policy>(
+          std::make_index_sequence<T::EnkiSerial::Members::count>());
+      }
+    }
+
+    /// Read a bool written as one byte, rejecting the bytes other than 0 and 1
+    template <typename Reader>
+    constexpr Success validateBool(bool &value, Reader &r)
+    {
+      std::span<const std::byte> bytes;
+      Success isGood = r.viewBytes(1, bytes);
+      if (isGood && bytes[0] > std::byte{1})
+      {
+        return "Invalid bool value";
+      }
+      value = isGood && bytes[0] == std::byte{1};
+      return isGood;
+    }
+
+    template <typename E, typename Reader>
+    constexpr Success validateElements(size_t numElements, Reader &r)
+    {
+      if constexpr (anyBytesValid<E, typename Reader::policy_type>())
+      {
+        return skipElements<E>(numElements, r);
+      }
+      else
+      {
+        Success isGood;
+        for (size_t i = 0; i < numElements && isGood; ++i)
+        {
+          isGood.update(validateTyped<E>(r));
+        }
+        return isGood;
+      }
+    }
+
+    template <typename T, typename Reader>
+    constexpr Success validateRange(Reader &r)
+    {
+      using E = assignable_value_t<T>;
+      size_t numElements = 0;
+      bool isLast = true;
+      Success isGood;
+      if constexpr (chunked_range_reader<Reader>)
+      {
+        isGood = r.rangeChunk(numElements, isLast);
+      }
+      else
+      {
+        isGood = r.rangeBegin(numElements);
+      }
+      if (!isGood || !isGood.update(alignFor<typename T::value_type>(r)))
+      {
+        return isGood;
+      }
+      while (isGood.update(validateElements<E>(numElements, r)) && !isLast)
+      {
+        if constexpr (chunked_range_reader<Reader>)
+        {
+          isGood.update(r.rangeChunk(numElements, isLast));
+        }
+      }
+      return isGood;
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success validateElementsOf(Reader &r, std::index_sequence<idx...>)
+    {
+      Success isGood;
+      static_cast<void>(
+        (isGood.update(validateTyped<std::remove_cvref_t<std::tuple_element_t<idx, T>>>(r)) &&
+         ...));
+      return isGood;
+    }
+
+    /// Forward compatible formats: values prefixed by their size must fill it exactly
+    /// Variant alternatives have a `size_type` prefix, the sized fields of tagged structs a
+    /// varint one
+    template <typename T, bool IsVarintSize = false, typename Reader>
+    constexpr Success validateSized(Reader &r)
+    {
+      uint64_t size = 0;
+      Success isGood;
+      if constexpr (IsVarintSize)
+      {
+        isGood = r.readVarint(size);
+      }
+      else
+      {
+        typename Reader::size_type prefix{};
+        isGood = deserialize(prefix, r);
+        size = prefix;
+      }
+      if (!isGood)
+      {
+        return isGood;
+      }
+      const size_t remainingBefore = r.remainingBytes();
+      if (size > remainingBefore)
+      {
+        return "Size prefix exceeds remaining data";
+      }
+      if (
+        isGood.update(readScoped(r, [&] { return validateTyped<T>(r); })) &&
+        remainingBefore - r.remainingBytes() != size)
+      {
+        return "Size prefix does not match its content";
+      }
+      return isGood;
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success validateAlternative(size_t index, Reader &r, std::index_sequence<idx...>)
+    {
+      using Policy = typename Reader::policy_type;
+      Success isGood;
+      const auto validateOne = [&]<typename Alternative>() {
+        if constexpr (has_policy_v<Policy, forward_compatible_t>)
+        {
+          isGood = validateSized<Alternative>(r);
+        }
+        else
+        {
+          isGood = validateTyped<Alternative>(r);
+        }
+        return true;
+      };
+      static_cast<void>(
+        ((idx == index && validateOne.template operator()<std::variant_alternative_t<idx, T>>()) ||
+         ...));
+      return isGood;
+    }
+
+    template <typename T, typename Reader>
+    constexpr Success validateVariant(Reader &r)
+    {
+      using Policy = typename Reader::policy_type;
+      variant_index_t<T, Policy, typename Reader::size_type> index{};
+      Success isGood = r.readVariantIndex(index);
+      if (!isGood)
+      {
+        return isGood;
+      }
+      if (index >= std::variant_size_v<T>)
+      {
+        if constexpr (has_policy_v<Policy, forward_compatible_t> && has_monostate_v<T>)
+        {
+          // Alternatives added by newer writers are read as the monostate
+          return isGood.update(r.skipHintAndValue());
+        }
+        else
+        {
+          return isGood.update("Deserialized variant index is out of range");
+        }
+      }
+      return isGood.update(
+        validateAlternative<T>(index, r, std::make_index_sequence<std::variant_size_v<T>>()));
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success validateMembersOf(Reader &r, std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      Success isGood = alignFor<T>(r);
+      auto presence = [] {
+        if constexpr (presence_bitmap_reader<T, Reader>)
+        {
+          return PresenceBitmap<optional_member_count_v<T>>();
+        }
+        else
+        {
+          return NoPresenceBitmap{};
+        }
+      }();
+      if constexpr (presence_bitmap_reader<T, Reader>)
+      {
+        isGood.update(readPresenceBitmap(presence, r));
+      }
+      const auto validateOne = [&]<typename Reg, size_t presenceBit>() {
+        using M = std::remove_cvref_t<typename Reg::value_type>;
+        if constexpr (presence_bitmap_reader<T, Reader> && optional_member<Reg>)
+        {
+          if (presence.test(presenceBit))
+          {
+            isGood.update(validateTyped<typename M::value_type>(r));
+          }
+        }
+        else
+        {
+          isGood.update(validateTyped<M>(r));
+        }
+        return static_cast<bool>(isGood);
+      };
+      if (isGood)
+      {
+        static_cast<void>(
+          (validateOne.template
+           operator()<get_nth_register_t<idx, Members>, presence_bit_v<T, idx>>() &&
+           ...));
+      }
+      return isGood ? isGood.update(alignFor<T>(r)) : isGood;
+    }
+
+    template <typename T, typename Reader, size_t... idx>
+    constexpr Success validateTaggedField(
+      size_t fieldNumber,
+      uint64_t tag,
+      Reader &r,
+      std::index_sequence<idx...>)
+    {
+      using Members = typename T::EnkiSerial::Members;
+      using Policy = typename Reader::policy_type;
+      Success isGood;
+      const auto validateOne = [&]<typename Reg>() {
+        using M = std::remove_cvref_t<typename Reg::value_type>;
+        constexpr WireType wireType = wireTypeOf<M, Policy>();
+        if (taggedWireType(tag) != wireType)
+        {
+          isGood = "Tagged struct field has an unexpected type";
+        }
+        else if constexpr (wireType == WireType::sized)
+        {
+          isGood = validateSized<M, true>(r);
+        }
+        else
+        {
+          isGood = validateTyped<M>(r);
+        }
+        return true;
+      };
+      static_cast<void>(
+        ((idx == fieldNumber &&
+          validateOne.template operator()<get_nth_register_t<idx, Members>>()) ||
+         ...));
+      return isGood;
+    }
+
+    /// Known fields must come in increasing order and before the fields of newer writers
+    template <typename T, typename Reader>
+    constexpr Success validateTaggedFields(Reader &r)
+    {
+      constexpr size_t numMembers = T::EnkiSerial::Members::count;
+      uint64_t numFields = 0;
+      Success isGood = r.readVarint(numFields);
+      uint64_t nextFieldNumber = 0;
+      for (uint64_t i = 0; i < numFields && isGood; ++i)
+      {
+        uint64_t tag = 0;
+        if (!isGood.update(r.readVarint(tag)))
+        {
+          break;
+        }
+        const uint64_t fieldNumber = taggedFieldNumber(tag);
+        if (fieldNumber < nextFieldNumber)
+        {
+          return "Tagged struct fields are out of order";
+        }
+        if (fieldNumber < numMembers)
+        {
+          nextFieldNumber = fieldNumber + 1;
+          isGood.update(validateTaggedField<T>(
+            static_cast<size_t>(fieldNumber), tag, r, std::make_index_sequence<numMembers>()));
+        }
+        else
+        {
+          nextFieldNumber = numMembers;
+          isGood.update(skipTaggedField(tag, r));
+        }
+      }
+      return isGood;
+    }
+
+    /// Walk binary reader `r` through a value of type `T`, checking it the way deserializing
+    /// it would without building it. JSON values are deserialized into a temporary, which checks
+    /// their types as well as their structure.
+    template <typename T, typename Reader>
+    constexpr Success validateTyped(Reader &r)
+    {
+      using Policy = typename Reader::policy_type;
+      if constexpr (!concepts::byte_reader<Reader>)
+      {
+        // JSON readers do not check all the punctuation they read through: it is checked first
+        Success isGood = r.checkValueStructure();
+        if (!isGood)
+        {
+          return isGood;
+        }
+        T value{};
+        return deserialize(value, r);
+      }
+      else if constexpr (custom_deserializable<T, Reader>)
+      {
+        // Types decoding themselves through `EnkiSerial`, such as the wrappers deriving from
+        // the range they encode, are checked by their own decoding
+        T value{};
+        return deserialize(value, r);
+      }
+      else if constexpr (anyBytesValid<T, Policy>())
+      {
+        return skipBytes(fixedSize<T, Policy>(), r);
+      }
+      else if constexpr (std::same_as<T, bool>)
+      {
+        bool value = false;
+        return validateBool(value, r);
+      }
+      else if constexpr (concepts::string_like<T> && !has_policy_v<Policy, dictionary_t>)
+      {
+        return skipRange<T>(r);
+      }
+      else if constexpr (concepts::string_like<T>)
+      {
+        // Dictionary strings are recorded for the references following them, as views
+        std::string_view view;
+        return deserialize(view, r);
+      }
+      else if constexpr (concepts::optional_like<T> || concepts::unique_pointer<T>)
+      {
+        using V = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<T &>())>>;
+        bool hasValue = false;
+        Success isGood = validateBool(hasValue, r);
+        if (isGood && hasValue)
+        {
+          isGood.update(validateTyped<V>(r));
+        }
+        return isGood;
+      }
+      else if constexpr (concepts::array_like<T>)
+      {
+        using E = std::remove_cvref_t<decltype(*std::begin(std::declval<T &>()))>;
+        return validateElements<E>(sizeof(T) / sizeof(E), r);
+      }
+      else if constexpr (
+        concepts::range_constructible_container<T> && !delta_coded_range<T, Reader> &&
+        !concepts::string_like<T>)
+      {
+        return validateRange<T>(r);
+      }
+      else if constexpr (concepts::tuple_like<T>)
+      {
+        return validateElementsOf<T>(r, std::make_index_sequence<std::tuple_size_v<T>>());
+      }
+      else if constexpr (concepts::variant_like<T>)
+      {
+        return validateVariant<T>(r);
+      }
+      else if constexpr (concepts::custom_static_serializable<T>)
+      {
+        if constexpr (tagged_struct_reader<Reader>)
+        {
+          return validateTaggedFields<T>(r);
+        }
+        else
+        {
+          return validateMembersOf<T>(
+            r, std::make_index_sequence<T::EnkiSerial::Members::count>());
+        }
+      }
+      else
+      {
+        // Scalars read with checks (enums of compact range, varints...) and values decoded
+        // with side effects on the reader
+        T value{};
+        return deserialize(value, r);
+      }
+    }
+  } // namespace detail
+
+  /// Check that `r` holds a valid value of type `T` without deserializing it: lengths must fit
+  /// in the data, bools be 0 or 1, variant indices name an alternative, sized values fill their
+  /// size prefix exactly. Strings and containers are not built, values of fixed size valid
+  /// whatever their bytes are only checked by size. The first failure is reported, data ending
+  /// before the value included. JSON values are checked by deserializing them into a temporary.
+  ///
+  /// `r` is left after the value:
+  ///   if (!enki::validate<Order>(enki::BinSpanReader(message))) { reject(message); }
+  template <typename T, typename Reader>
+  constexpr Success validate(Reader &&r)
+  {
+#if __cpp_exceptions >= 199711
+    try
+    {
+      return detail::validateTyped<T>(r);
+    }
+    catch (const std::out_of_range &)
+    {
+      return "Data ends before the value";
+    }
+#else
+    return detail::validateTyped<T>(r);
+#endif
+  }
+} // namespace enki
+
+#endif // ENKI_VALIDATE_HPP
@@ -0,0 +1,267 @@
+/// Tests for the aligned_t policy - Binary Format
+/// Values sit at their natural alignment so readers can view them in place
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/columnar.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+
+namespace
+{
+  struct Point
+  {
+    float x;
+    float y;
+
+    bool operator==(const Point &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Point::EnkiSerial
+  {
+    using Members = enki::Register<&Point::x, &Point::y>;
+  };
+
+  struct Tick
+  {
+    uint8_t side;
+    double price;
+    int32_t quantity;
+    Point position;
+
+    bool operator==(const Tick &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Tick::EnkiSerial
+  {
+    using Members =
+      enki::Register<&Tick::side, &Tick::price, &Tick::quantity, &Tick::position>;
+  };
+
+  struct Swapped
+  {
+    int32_t first;
+    int32_t second;
+
+    struct EnkiSerial;
+  };
+
+  struct Swapped::EnkiSerial
+  {
+    using Members = enki::Register<&Swapped::second, &Swapped::first>;
+  };
+
+  struct Frame
+  {
+    std::string name;
+    std::vector<Tick> ticks;
+    std::vector<double> samples;
+    std::variant<int16_t, double> scale;
+
+    bool operator==(const Frame &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Frame::EnkiSerial
+  {
+    using Members = enki::Register<&Frame::name, &Frame::ticks, &Frame::samples, &Frame::scale>;
+  };
+
+  struct FrameView
+  {
+    std::string_view name;
+    std::span<const Tick> ticks;
+    std::span<const double> samples;
+    std::variant<int16_t, double> scale;
+
+    struct EnkiSerial;
+  };
+
+  struct FrameView::EnkiSerial
+  {
+    using Members = enki::Register<
+      &FrameView::name,
+      &FrameView::ticks,
+      &FrameView::samples,
+      &FrameView::scale>;
+  };
+
+  Frame makeFrame()
+  {
+    Frame frame{"ESZ5", {}, {}, 0.25};
+    for (int32_t i = 0; i < 20; ++i)
+    {
+      frame.ticks.push_back(
+        {static_cast<uint8_t>(i % 2), 4500.0 + i, i * 10, {static_cast<float>(i), -1.0F}});
+      frame.samples.push_back(i * 0.5);
+    }
+    return frame;
+  }
+
+  template <typename Reader>
+  concept span_reader = requires(Reader r, std::span<const double> &values, const Tick *&tick) {
+    r.read(values);
+    r.viewValue(tick);
+  };
+} // namespace
+
+TEST_CASE("Aligned structs follow their natural layout", "[regression][aligned]")
+{
+  STATIC_REQUIRE(enki::detail::aligned_struct<Tick, enki::aligned_t>);
+  STATIC_REQUIRE_FALSE(enki::detail::aligned_struct<Frame, enki::aligned_t>);
+
+  const Tick tick{1, 4510.25, 7, {1.0F, 2.0F}};
+  enki::BinWriter writer(enki::aligned);
+  enki::serialize(uint8_t{3}, writer).or_throw();
+  const auto serRes = enki::serialize(tick, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Padded to the alignment of the struct, then exactly its size
+  REQUIRE(serRes.size() == alignof(Tick) - 1 + sizeof(Tick));
+  REQUIRE(writer.data().size() == alignof(Tick) + sizeof(Tick));
+
+  enki::BinProbe probe(enki::aligned);
+  enki::serialize(uint8_t{3}, probe).or_throw();
+  REQUIRE(enki::serialize(tick, probe).size() == serRes.size());
+
+  enki::BinSpanReader reader(enki::aligned, writer.data());
+  uint8_t first = 0;
+  Tick deserialized{};
+  REQUIRE_NOTHROW(enki::deserialize(first, reader).or_throw());
+  const auto desRes = enki::deserialize(deserialized, reader);
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == tick);
+}
+
+TEST_CASE("Aligned reader views values in place", "[regression][aligned]")
+{
+  const Frame frame = makeFrame();
+
+  enki::BinWriter writer(enki::aligned);
+  const auto serRes = enki::serialize(frame, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(enki::serialize(frame, enki::BinProbe(enki::aligned)).size() == serRes.size());
+
+  // Copying deserialization reads the same data
+  Frame copied;
+  REQUIRE_NOTHROW(
+    enki::deserialize(copied, enki::BinReader(enki::aligned, writer.data())).or_throw());
+  REQUIRE(copied == frame);
+
+  // Views point into the buffer of the writer
+  FrameView view;
+  enki::BinSpanReader reader(enki::aligned, writer.data());
+  REQUIRE_NOTHROW(enki::deserialize(view, reader).or_throw());
+  REQUIRE(reader.remainingBytes() == 0);
+  REQUIRE(view.name == "ESZ5");
+  REQUIRE(view.ticks.size() == frame.ticks.size());
+  REQUIRE(view.ticks[13] == frame.ticks[13]);
+  REQUIRE(std::equal(view.samples.begin(), view.samples.end(), frame.samples.begin()));
+  REQUIRE(std::get<double>(view.scale) == 0.25);
+
+  const auto *const begin = writer.data().data();
+  const auto *const end = begin + writer.data().size();
+  const auto *const ticks = reinterpret_cast<const std::byte *>(view.ticks.data());
+  const auto *const samples = reinterpret_cast<const std::byte *>(view.samples.data());
+  REQUIRE((ticks > begin && ticks < end));
+  REQUIRE((samples > begin && samples < end));
+}
+
+TEST_CASE("Aligned reader views single values", "[regression][aligned]")
+{
+  const Tick tick{0, 12.5, -3, {0.5F, 0.25F}};
+  enki::BinWriter writer(enki::aligned);
+  enki::serialize(true, writer).or_throw();
+  enki::serialize(int64_t{-42}, writer).or_throw();
+  enki::serialize(tick, writer).or_throw();
+
+  enki::BinSpanReader reader(enki::aligned, writer.data());
+  bool flag = false;
+  const int64_t *number = nullptr;
+  const Tick *viewedTick = nullptr;
+  REQUIRE_NOTHROW(enki::deserialize(flag, reader).or_throw());
+  REQUIRE_NOTHROW(reader.viewValue(number).or_throw());
+  REQUIRE_NOTHROW(reader.viewValue(viewedTick).or_throw());
+  REQUIRE(flag);
+  REQUIRE(*number == -42);
+  REQUIRE(*viewedTick == tick);
+  REQUIRE(reinterpret_cast<uintptr_t>(viewedTick) % alignof(Tick) == 0);
+}
+
+TEST_CASE("Aligned reader rejects views it cannot honor", "[regression][aligned]")
+{
+  // BinReader owns a copy of its data, which views would outlive
+  STATIC_REQUIRE(span_reader<enki::BinSpanReader<enki::aligned_t>>);
+  STATIC_REQUIRE_FALSE(span_reader<enki::BinReader<enki::aligned_t>>);
+
+  enki::BinWriter writer(enki::aligned);
+  enki::serialize(std::vector<double>{1.0, 2.0}, writer).or_throw();
+
+  // Same bytes, one byte away from an aligned address
+  std::vector<std::byte> shifted(writer.data().size() + 1);
+  std::copy(writer.data().begin(), writer.data().end(), shifted.begin() + 1);
+  std::span<const double> values;
+  REQUIRE_FALSE(enki::BinSpanReader(enki::aligned, std::span(shifted).subspan(1)).read(values));
+
+  // Members registered out of declaration order cannot be viewed
+  STATIC_REQUIRE(enki::detail::aligned_struct<Swapped, enki::aligned_t>);
+  enki::BinWriter swappedWriter(enki::aligned);
+  enki::serialize(Swapped{1, 2}, swappedWriter).or_throw();
+  const Swapped *swapped = nullptr;
+  REQUIRE_FALSE(enki::BinSpanReader(enki::aligned, swappedWriter.data()).viewValue(swapped));
+
+  // Truncated padding
+  enki::BinWriter truncated(enki::aligned);
+  enki::serialize(uint8_t{1}, truncated).or_throw();
+  enki::serialize(uint64_t{2}, truncated).or_throw();
+  const auto bytes = std::span(truncated.data()).first(4);
+  uint8_t first = 0;
+  uint64_t second = 0;
+  enki::BinSpanReader reader(enki::aligned, bytes);
+  REQUIRE_NOTHROW(enki::deserialize(first, reader).or_throw());
+  REQUIRE_THROWS_AS(enki::deserialize(second, reader), std::out_of_range);
+}
+
+TEST_CASE("Aligned policy combines with other binary policies", "[regression][aligned]")
+{
+  const Frame frame = makeFrame();
+  const auto policies = enki::aligned | enki::forward_compatible | enki::dictionary;
+
+  enki::BinWriter writer(policies);
+  const auto serRes = enki::serialize(frame, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(enki::serialize(frame, enki::BinProbe(policies)).size() == serRes.size());
+
+  Frame deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinReader(policies, writer.data())).or_throw());
+  REQUIRE(deserialized == frame);
+
+  // Columns of a columnar range are aligned too, in both of its forms
+  const enki::Columnar<std::vector<Tick>> columns(frame.ticks);
+  enki::BinWriter columnWriter(enki::aligned);
+  REQUIRE_NOTHROW(enki::serialize(columns, columnWriter).or_throw());
+  enki::Columnar<std::vector<Tick>> readColumns;
+  REQUIRE_NOTHROW(
+    enki::deserialize(readColumns, enki::BinReader(enki::aligned, columnWriter.data()))
+      .or_throw());
+  REQUIRE(static_cast<const std::vector<Tick> &>(readColumns) == frame.ticks);
+}
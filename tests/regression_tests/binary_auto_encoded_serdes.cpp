@@ -0,0 +1,253 @@
+/// Tests for the enki::AutoEncoded range wrapper
+/// Each write picks the smallest encoding for the values and records it in a one byte tag
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/auto_encoded.hpp"
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Feed
+  {
+    std::vector<int64_t> stamps;
+    enki::AutoEncoded<std::vector<uint16_t>> sizes;
+
+    bool operator==(const Feed &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Feed::EnkiSerial
+  {
+    // NOLINTNEXTLINE
+    using Members = enki::Register<
+      ENKIWRAP_CAST(Feed, stamps, enki::AutoEncoded<std::vector<int64_t>>),
+      &Feed::sizes>;
+  };
+
+  /// Serialize `values`, check the round trip and return the encoding written
+  template <typename Range>
+  enki::RangeEncoding roundTrip(const enki::AutoEncoded<Range> &values)
+  {
+    enki::BinWriter writer;
+    const auto serRes = enki::serialize(values, writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    REQUIRE(enki::serialize(values, enki::BinProbe()).size() == serRes.size());
+
+    enki::AutoEncoded<Range> deserialized;
+    const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+    REQUIRE_NOTHROW(desRes.or_throw());
+    REQUIRE(desRes.size() == serRes.size());
+    REQUIRE(deserialized == values);
+    return static_cast<enki::RangeEncoding>(writer.data()[sizeof(uint32_t)]);
+  }
+} // namespace
+
+TEST_CASE("Auto encoding picks the smallest encoding", "[regression][auto_encoded]")
+{
+  std::mt19937 rng(7);
+
+  SECTION("uniform values stay raw")
+  {
+    enki::AutoEncoded<std::vector<uint32_t>> values;
+    for (int i = 0; i < 500; ++i)
+    {
+      values.push_back(rng());
+    }
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::raw);
+  }
+
+  SECTION("small values with outliers are varints")
+  {
+    enki::AutoEncoded<std::vector<int32_t>> values;
+    for (int i = 0; i < 500; ++i)
+    {
+      values.push_back(i % 50 == 0 ? -1'000'000'000 : static_cast<int32_t>(rng() % 64) - 32);
+    }
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::varint);
+  }
+
+  SECTION("increasing timestamps are deltas")
+  {
+    enki::AutoEncoded<std::vector<int64_t>> values;
+    int64_t stamp = 1'700'000'000'000;
+    for (int i = 0; i < 500; ++i)
+    {
+      stamp += 1 + static_cast<int64_t>(rng() % 100);
+      values.push_back(stamp);
+    }
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::delta);
+  }
+
+  SECTION("bounded values are bit packed")
+  {
+    enki::AutoEncoded<std::vector<uint32_t>> values;
+    for (int i = 0; i < 500; ++i)
+    {
+      values.push_back(1'000'000 + rng() % 16);
+    }
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::frame_of_reference);
+  }
+
+  SECTION("repeated values are run length encoded")
+  {
+    enki::AutoEncoded<std::vector<int16_t>> values;
+    for (int i = 0; i < 500; ++i)
+    {
+      values.push_back(static_cast<int16_t>(i / 50 * 1000 - 3000));
+    }
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::run_length);
+  }
+
+  SECTION("empty range")
+  {
+    const enki::AutoEncoded<std::vector<int32_t>> values;
+    REQUIRE(roundTrip(values) == enki::RangeEncoding::raw);
+  }
+}
+
+TEST_CASE("Auto encoding follows the data", "[regression][auto_encoded]")
+{
+  enki::AutoEncoded<std::vector<uint64_t>> values(100'000, uint64_t{5});
+  REQUIRE(roundTrip(values) == enki::RangeEncoding::run_length);
+
+  // Large ranges are sampled, every sample window now sees increasing values
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = i * 3;
+  }
+  REQUIRE(roundTrip(values) == enki::RangeEncoding::delta);
+
+  std::mt19937_64 rng(11);
+  for (auto &value : values)
+  {
+    value = rng();
+  }
+  REQUIRE(roundTrip(values) == enki::RangeEncoding::raw);
+}
+
+TEST_CASE("Auto encoding of non contiguous ranges", "[regression][auto_encoded]")
+{
+  enki::AutoEncoded<std::deque<int8_t>> values;
+  for (int i = 0; i < 5000; ++i)
+  {
+    values.push_back(static_cast<int8_t>(i % 7 == 0 ? -100 : i % 3));
+  }
+  roundTrip(values);
+
+  for (auto &value : values)
+  {
+    value = std::numeric_limits<int8_t>::min();
+  }
+  REQUIRE(roundTrip(values) == enki::RangeEncoding::run_length);
+}
+
+TEST_CASE("Auto encoding inside Register", "[regression][auto_encoded]")
+{
+  Feed data;
+  for (uint16_t i = 0; i < 300; ++i)
+  {
+    data.stamps.push_back(1'000'000 + i * 10);
+    data.sizes.push_back(static_cast<uint16_t>(100 * (i % 3)));
+  }
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(data, writer).or_throw());
+  REQUIRE(writer.data().size() < 300 * (sizeof(int64_t) + sizeof(uint16_t)) / 4);
+
+  Feed deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deserialized == data);
+}
+
+TEST_CASE("Auto encoding keeps plain arrays in JSON", "[regression][auto_encoded]")
+{
+  const enki::AutoEncoded<std::vector<int32_t>> values{5, 5, 5, -6};
+
+  enki::JSONWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+  REQUIRE(writer.data().str() == "[5, 5, 5, -6]");
+
+  enki::AutoEncoded<std::vector<int32_t>> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Auto encoded decoding rejects malformed input", "[regression][auto_encoded]")
+{
+  SECTION("unknown encoding tag")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    enki::serialize(uint8_t{5}, writer).or_throw();
+    writer.writeVarint(0);
+
+    enki::AutoEncoded<std::vector<int32_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("size larger than the payload")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1'000'000}, writer).or_throw();
+    enki::serialize(static_cast<uint8_t>(enki::RangeEncoding::varint), writer).or_throw();
+    writer.writeVarint(0);
+
+    enki::AutoEncoded<std::vector<int32_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("run longer than the range")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{4}, writer).or_throw();
+    enki::serialize(static_cast<uint8_t>(enki::RangeEncoding::run_length), writer).or_throw();
+    writer.writeVarint(5);
+    writer.writeVarint(0);
+
+    enki::AutoEncoded<std::vector<int32_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("runs covering fewer elements than claimed")
+  {
+    // 4 billion elements of 8 bytes from 7 bytes: the read past the data throws before the
+    // elements are allocated
+    enki::BinWriter writer;
+    enki::serialize(std::numeric_limits<uint32_t>::max(), writer).or_throw();
+    enki::serialize(static_cast<uint8_t>(enki::RangeEncoding::run_length), writer).or_throw();
+    writer.writeVarint(1);
+    writer.writeVarint(0);
+    REQUIRE(writer.data().size() == 7);
+
+    enki::AutoEncoded<std::vector<uint64_t>> deserialized;
+    REQUIRE_THROWS(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())));
+    REQUIRE(deserialized.capacity() < 1024);
+  }
+
+  SECTION("value larger than the element type")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    enki::serialize(static_cast<uint8_t>(enki::RangeEncoding::varint), writer).or_throw();
+    writer.writeVarint(uint64_t{1} << 20);
+
+    enki::AutoEncoded<std::vector<uint16_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+}
@@ -0,0 +1,245 @@
+/// Tests for the enki::BitPacked range wrapper
+/// Values are stored in frame-of-reference blocks in binary formats and as plain arrays in JSON
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/bit_packed.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Export
+  {
+    std::vector<uint32_t> ids;
+    enki::BitPacked<std::vector<int16_t>> levels;
+
+    bool operator==(const Export &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Export::EnkiSerial
+  {
+    // NOLINTNEXTLINE
+    using Members = enki::Register<
+      ENKIWRAP_CAST(Export, ids, enki::BitPacked<std::vector<uint32_t>>),
+      &Export::levels>;
+  };
+} // namespace
+
+TEST_CASE("Bit packing of bounded values", "[regression][bit_packed]")
+{
+  enki::BitPacked<std::vector<uint32_t>> ids;
+  for (uint32_t i = 0; i < 300; ++i)
+  {
+    ids.push_back(1'000'000 + (i * 7) % 16);
+  }
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(ids, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Size prefix, then 3 blocks (128, 128, 44 values) of: 3 bytes reference, 1 byte width,
+  // 4 bits per value
+  REQUIRE(serRes.size() == sizeof(uint32_t) + 3 * (3 + 1) + (128 + 128 + 44) / 2);
+
+  REQUIRE(enki::serialize(ids, enki::BinProbe()).size() == serRes.size());
+
+  enki::BitPacked<std::vector<uint32_t>> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == ids);
+}
+
+TEST_CASE("Bit packing of constant and empty ranges", "[regression][bit_packed]")
+{
+  SECTION("constant values take no bits")
+  {
+    const enki::BitPacked<std::vector<uint64_t>> values(200, uint64_t{42});
+
+    enki::BinWriter writer;
+    const auto serRes = enki::serialize(values, writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    REQUIRE(serRes.size() == sizeof(uint32_t) + 2 * (1 + 1));
+
+    enki::BitPacked<std::vector<uint64_t>> deserialized;
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+    REQUIRE(deserialized == values);
+  }
+
+  SECTION("empty range")
+  {
+    const enki::BitPacked<std::vector<int32_t>> values;
+
+    enki::BinWriter writer;
+    const auto serRes = enki::serialize(values, writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    REQUIRE(serRes.size() == sizeof(uint32_t));
+
+    enki::BitPacked<std::vector<int32_t>> deserialized{1, 2};
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+    REQUIRE(deserialized.empty());
+  }
+}
+
+TEST_CASE("Bit packing handles signed values and extremes", "[regression][bit_packed]")
+{
+  const enki::BitPacked<std::vector<int64_t>> values{
+    0,
+    -1,
+    std::numeric_limits<int64_t>::max(),
+    std::numeric_limits<int64_t>::min(),
+    42,
+    -42};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::BitPacked<std::vector<int64_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+namespace
+{
+  /// Blocks of every width from 0 to the bit size of `T`, full and partial
+  template <typename T>
+  void checkEveryWidth()
+  {
+    using U = std::make_unsigned_t<T>;
+    for (unsigned width = 0; width <= sizeof(T) * 8; ++width)
+    {
+      const uint64_t mask = width == 64 ? ~uint64_t{} : (uint64_t{1} << width) - 1;
+      enki::BitPacked<std::vector<T>> values;
+      for (uint64_t i = 0; i < 128 + 77; ++i)
+      {
+        const uint64_t offset = i % 3 == 0 ? mask : (i * 0x9E3779B97F4A7C15) & mask;
+        values.push_back(static_cast<T>(static_cast<U>(3 + offset)));
+      }
+      values[1] = 3;
+
+      enki::BinWriter writer;
+      REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+      enki::BitPacked<std::vector<T>> deserialized;
+      REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+      REQUIRE(deserialized == values);
+    }
+  }
+} // namespace
+
+TEST_CASE("Bit packing of every width", "[regression][bit_packed]")
+{
+  // Each width has its own unpacking kernel, vectorized for 32 bit values in builds with AVX2 or
+  // SSE4.1 (ENKI_ENABLE_AVX2)
+  checkEveryWidth<uint8_t>();
+  checkEveryWidth<int16_t>();
+  checkEveryWidth<uint32_t>();
+  checkEveryWidth<int32_t>();
+  checkEveryWidth<uint64_t>();
+}
+
+TEST_CASE("Bit packing of non contiguous ranges", "[regression][bit_packed]")
+{
+  enki::BitPacked<std::deque<int8_t>> values;
+  for (int i = 0; i < 130; ++i)
+  {
+    values.push_back(static_cast<int8_t>(i - 65));
+  }
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::BitPacked<std::deque<int8_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Bit packing inside Register", "[regression][bit_packed]")
+{
+  const Export data{{10, 11, 12, 13}, {{-3, -2, -1, 0, 1, 2, 3, 4}}};
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(data, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // ids: size, 1 byte reference, 1 byte width, 4 values on 2 bits
+  // levels: size, 3 bytes reference (sign bit flipped), 1 byte width, 8 values on 3 bits
+  REQUIRE(serRes.size() == sizeof(uint32_t) + 1 + 1 + 1 + sizeof(uint32_t) + 3 + 1 + 3);
+
+  Export deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deserialized == data);
+}
+
+TEST_CASE("Bit packing keeps plain arrays in JSON", "[regression][bit_packed]")
+{
+  const enki::BitPacked<std::vector<int32_t>> values{5, -6, 4};
+
+  enki::JSONWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+  REQUIRE(writer.data().str() == "[5, -6, 4]");
+
+  enki::BitPacked<std::vector<int32_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Bit packed decoding rejects malformed input", "[regression][bit_packed]")
+{
+  SECTION("size larger than the payload")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1'000'000}, writer).or_throw();
+    enki::serialize(uint8_t{1}, writer).or_throw();
+
+    enki::BitPacked<std::vector<int64_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("bit width larger than the element type")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    writer.writeVarint(0);
+    enki::serialize(uint8_t{17}, writer).or_throw();
+    enki::serialize(uint32_t{0}, writer).or_throw();
+
+    enki::BitPacked<std::vector<uint16_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("reference larger than the element type")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    writer.writeVarint(uint64_t{1} << 20);
+    enki::serialize(uint8_t{0}, writer).or_throw();
+
+    enki::BitPacked<std::vector<uint16_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("truncated packed values")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{4}, writer).or_throw();
+    writer.writeVarint(0);
+    enki::serialize(uint8_t{16}, writer).or_throw();
+    enki::serialize(uint16_t{0}, writer).or_throw();
+
+    enki::BitPacked<std::vector<uint16_t>> deserialized;
+    REQUIRE_THROWS(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  }
+}
@@ -0,0 +1,130 @@
+/// Tests for the canonical policy
+/// Unordered containers are written sorted, equal values always give identical bytes
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Index
+  {
+    std::unordered_map<std::string, std::unordered_set<int32_t>> postings;
+    std::unordered_multimap<uint16_t, std::string> aliases;
+
+    bool operator==(const Index &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Index::EnkiSerial
+  {
+    using Members = enki::Register<&Index::postings, &Index::aliases>;
+  };
+
+  /// Same content inserted in the given order into containers of `numBuckets` buckets
+  Index makeIndex(bool isReversed, size_t numBuckets)
+  {
+    Index index;
+    index.postings.reserve(numBuckets);
+    index.aliases.reserve(numBuckets);
+    for (int32_t i = 0; i < 40; ++i)
+    {
+      const int32_t key = isReversed ? 39 - i : i;
+      auto &docs = index.postings["term" + std::to_string(key % 13)];
+      docs.reserve(numBuckets);
+      docs.insert(key * 7);
+      index.aliases.emplace(static_cast<uint16_t>(key % 5), "alias" + std::to_string(key));
+    }
+    return index;
+  }
+
+  template <typename Policy>
+  std::vector<std::byte> bytesOf(const Index &index, Policy policy)
+  {
+    enki::BinWriter writer(policy);
+    enki::serialize(index, writer).or_throw();
+    return writer.data();
+  }
+} // namespace
+
+TEST_CASE("Canonical encoding gives identical bytes for equal values", "[regression][canonical]")
+{
+  const Index first = makeIndex(false, 0);
+  const Index second = makeIndex(true, 512);
+  REQUIRE(first == second);
+
+  const auto firstBytes = bytesOf(first, enki::canonical);
+  REQUIRE(bytesOf(second, enki::canonical) == firstBytes);
+  REQUIRE(bytesOf(second, enki::forward_compatible | enki::canonical) ==
+          bytesOf(first, enki::forward_compatible | enki::canonical));
+
+  // Same encoding as without the policy, only the order changes
+  REQUIRE(bytesOf(first, enki::strict).size() == firstBytes.size());
+  REQUIRE(enki::serialize(first, enki::BinProbe(enki::canonical)).size() == firstBytes.size());
+
+  Index deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(firstBytes)).or_throw());
+  REQUIRE(deserialized == first);
+}
+
+TEST_CASE("Canonical encoding sorts by key", "[regression][canonical]")
+{
+  std::unordered_map<uint8_t, std::vector<uint8_t>> groups;
+  groups[9] = {1};
+  groups[3] = {2, 2};
+  groups[200] = {};
+
+  // The bytes of the ordered map with the same content
+  enki::BinWriter writer(enki::canonical);
+  REQUIRE_NOTHROW(enki::serialize(groups, writer).or_throw());
+  enki::BinWriter orderedWriter;
+  const std::map<uint8_t, std::vector<uint8_t>> ordered(groups.begin(), groups.end());
+  REQUIRE_NOTHROW(enki::serialize(ordered, orderedWriter).or_throw());
+  REQUIRE(writer.data() == orderedWriter.data());
+
+  // JSON arrays are sorted as well
+  const std::unordered_set<std::string> tags{"b", "c", "a"};
+  enki::JSONWriter jsonWriter(enki::canonical);
+  REQUIRE_NOTHROW(enki::serialize(tags, jsonWriter).or_throw());
+  REQUIRE(jsonWriter.data().str() == R"(["a", "b", "c"])");
+
+  std::unordered_set<std::string> deserializedTags;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserializedTags, enki::JSONReader(jsonWriter.data().str())).or_throw());
+  REQUIRE(deserializedTags == tags);
+}
+
+TEST_CASE("Canonical encoding of long unordered containers", "[regression][canonical]")
+{
+  constexpr uint32_t kNumElements = (uint32_t{1} << 20) + 5;
+  std::unordered_set<uint32_t> ids;
+  ids.reserve(kNumElements);
+  for (uint32_t i = 0; i < kNumElements; ++i)
+  {
+    ids.insert(i * 2654435761U);
+  }
+
+  enki::BinWriter writer(enki::canonical | enki::chunked);
+  REQUIRE_NOTHROW(enki::serialize(ids, writer).or_throw());
+  std::vector<uint32_t> sorted;
+  REQUIRE_NOTHROW(
+    enki::deserialize(sorted, enki::BinReader(enki::chunked, writer.data())).or_throw());
+  REQUIRE(sorted.size() == ids.size());
+  REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+}
@@ -0,0 +1,228 @@
+/// Tests for std::chrono durations and time points
+/// Both are stored as their number of ticks, ranges of time points as varint deltas
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/schema.hpp"
+
+namespace
+{
+  using Millis = std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>;
+
+  struct Event
+  {
+    Millis stamp;
+    std::chrono::microseconds latency;
+    std::vector<Millis> fills;
+
+    bool operator==(const Event &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Event::EnkiSerial
+  {
+    using Members = enki::Register<&Event::stamp, &Event::latency, &Event::fills>;
+  };
+
+  Event makeEvent()
+  {
+    const Millis start{std::chrono::milliseconds(1'700'000'000'000)};
+    Event event{start, std::chrono::microseconds(-250), {}};
+    for (int i = 0; i < 100; ++i)
+    {
+      event.fills.push_back(start + std::chrono::milliseconds(i * 3 + i % 5));
+    }
+    return event;
+  }
+
+  struct Collector
+  {
+    std::map<std::string, enki::SchemaValue> values;
+
+    void operator()(std::string_view path, const enki::SchemaValue &value)
+    {
+      values.emplace(path, value);
+    }
+  };
+} // namespace
+
+TEST_CASE("Durations and time points are stored as their ticks", "[regression][chrono]")
+{
+  const std::chrono::duration<int32_t, std::milli> timeout(-1500);
+  const std::chrono::duration<double> seconds(2.5);
+  const std::chrono::sys_time<std::chrono::nanoseconds> now(
+    std::chrono::nanoseconds(1'700'000'000'123'456'789));
+
+  enki::BinWriter writer;
+  REQUIRE(enki::serialize(timeout, writer).size() == sizeof(int32_t));
+  REQUIRE(enki::serialize(seconds, writer).size() == sizeof(double));
+  REQUIRE(enki::serialize(now, writer).size() == sizeof(int64_t));
+
+  enki::BinReader reader(writer.data());
+  std::chrono::duration<int32_t, std::milli> deserializedTimeout;
+  std::chrono::duration<double> deserializedSeconds;
+  std::chrono::sys_time<std::chrono::nanoseconds> deserializedNow;
+  REQUIRE_NOTHROW(enki::deserialize(deserializedTimeout, reader).or_throw());
+  REQUIRE_NOTHROW(enki::deserialize(deserializedSeconds, reader).or_throw());
+  REQUIRE_NOTHROW(enki::deserialize(deserializedNow, reader).or_throw());
+  REQUIRE(deserializedTimeout == timeout);
+  REQUIRE(deserializedSeconds == seconds);
+  REQUIRE(deserializedNow == now);
+
+  // JSON writes plain numbers
+  enki::JSONWriter jsonWriter;
+  REQUIRE_NOTHROW(enki::serialize(timeout, jsonWriter).or_throw());
+  REQUIRE(jsonWriter.data().str() == "-1500");
+  std::chrono::duration<int32_t, std::milli> jsonTimeout;
+  REQUIRE_NOTHROW(
+    enki::deserialize(jsonTimeout, enki::JSONReader(jsonWriter.data().str())).or_throw());
+  REQUIRE(jsonTimeout == timeout);
+}
+
+TEST_CASE("Ranges of time points are delta coded", "[regression][chrono]")
+{
+  const Event event = makeEvent();
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(event, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Size, then a base of 6 bytes and one byte per delta
+  REQUIRE(serRes.size() == 8 + 8 + 4 + 6 + 99);
+  REQUIRE(enki::serialize(event, enki::BinProbe()).size() == serRes.size());
+
+  Event deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == event);
+
+  // Other containers and policies
+  const std::deque<Millis> fills(event.fills.begin(), event.fills.end());
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter policyWriter(policy);
+    REQUIRE_NOTHROW(enki::serialize(event, policyWriter).or_throw());
+    REQUIRE_NOTHROW(enki::serialize(fills, policyWriter).or_throw());
+    enki::BinReader policyReader(policy, policyWriter.data());
+    Event policyEvent;
+    std::deque<Millis> policyFills;
+    REQUIRE_NOTHROW(enki::deserialize(policyEvent, policyReader).or_throw());
+    REQUIRE_NOTHROW(enki::deserialize(policyFills, policyReader).or_throw());
+    REQUIRE(policyEvent == event);
+    REQUIRE(policyFills == fills);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+
+  // JSON keeps plain arrays
+  const std::vector<Millis> stamps(event.fills.begin(), event.fills.begin() + 2);
+  enki::JSONWriter jsonWriter;
+  REQUIRE_NOTHROW(enki::serialize(stamps, jsonWriter).or_throw());
+  REQUIRE(jsonWriter.data().str() == "[1700000000000, 1700000000004]");
+}
+
+TEST_CASE("Delta coded ticks wrap around like the element type", "[regression][chrono]")
+{
+  using Ticks = std::chrono::duration<int8_t>;
+  using Point = std::chrono::time_point<std::chrono::steady_clock, Ticks>;
+  const std::vector<Point> points{Point(Ticks(100)), Point(Ticks(-100)), Point(Ticks(127))};
+
+  enki::BinWriter writer;
+  enki::writeSchema<std::vector<Point>>(writer).or_throw();
+  enki::serialize(points, writer).or_throw();
+
+  enki::BinSpanReader reader(writer.data());
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE(schema.root().kind() == enki::SchemaKind::delta_range);
+  REQUIRE(schema.root().child().kind() == enki::SchemaKind::int8);
+
+  Collector collector;
+  const size_t valueOffset = writer.data().size() - reader.remainingBytes();
+  REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, collector).or_throw());
+  REQUIRE(std::get<int64_t>(collector.values.at("[0]")) == 100);
+  REQUIRE(std::get<int64_t>(collector.values.at("[1]")) == -100);
+  REQUIRE(std::get<int64_t>(collector.values.at("[2]")) == 127);
+
+  std::vector<Point> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(
+      deserialized, enki::BinSpanReader(std::span(writer.data()).subspan(valueOffset)))
+      .or_throw());
+  REQUIRE(deserialized == points);
+}
+
+TEST_CASE("Generic readers walk time points", "[regression][chrono]")
+{
+  const Event event = makeEvent();
+
+  enki::BinWriter writer;
+  enki::writeSchema<Event>(writer).or_throw();
+  enki::serialize(event, writer).or_throw();
+  enki::serialize(int32_t{-1}, writer).or_throw();
+
+  enki::BinSpanReader reader(writer.data());
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE(schema.root().child(0).kind() == enki::SchemaKind::int64);
+  REQUIRE(schema.root().child(2).kind() == enki::SchemaKind::delta_range);
+
+  Collector collector;
+  REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, collector).or_throw());
+  REQUIRE(std::get<int64_t>(collector.values.at("latency")) == -250);
+  REQUIRE(std::get<int64_t>(collector.values.at("fills[99]")) == 1'700'000'000'000 + 297 + 4);
+
+  enki::BinSpanReader skipReader(writer.data());
+  REQUIRE_NOTHROW(enki::readSchema(schema, skipReader).or_throw());
+  REQUIRE_NOTHROW(enki::skipValue(schema.root(), skipReader).or_throw());
+  int32_t trailer = 0;
+  REQUIRE_NOTHROW(enki::deserialize(trailer, skipReader).or_throw());
+  REQUIRE(trailer == -1);
+}
+
+TEST_CASE("Delta coded time points reject malformed input", "[regression][chrono]")
+{
+  using Point = std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>;
+
+  SECTION("size larger than the payload")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1'000'000}, writer).or_throw();
+    writer.writeVarint(0);
+
+    std::vector<Point> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("delta larger than the tick type")
+  {
+    using Small =
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::duration<int16_t>>;
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    writer.writeVarint(uint64_t{1} << 20);
+
+    std::vector<Small> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+}
@@ -0,0 +1,258 @@
+/// Tests for the chunked policy
+/// Range lengths are varints, ranges above 2^20 elements are split into chunks
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/schema.hpp"
+
+namespace
+{
+  constexpr size_t kChunk = size_t{1} << 20;
+
+  struct Snapshot
+  {
+    std::string name;
+    std::vector<uint16_t> samples;
+    int32_t checksum;
+
+    bool operator==(const Snapshot &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Snapshot::EnkiSerial
+  {
+    using Members = enki::Register<&Snapshot::name, &Snapshot::samples, &Snapshot::checksum>;
+  };
+
+  Snapshot makeSnapshot(size_t numSamples)
+  {
+    Snapshot snapshot{"depth", std::vector<uint16_t>(numSamples), 42};
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      snapshot.samples[i] = static_cast<uint16_t>(i * 7);
+    }
+    return snapshot;
+  }
+} // namespace
+
+TEST_CASE("Chunked lengths of small ranges stay small", "[regression][chunked]")
+{
+  const std::vector<uint8_t> values{1, 2, 3};
+  const std::string text = "abc";
+
+  enki::BinWriter writer(enki::chunked);
+  REQUIRE(enki::serialize(values, writer).size() == 1 + 3);
+  REQUIRE(enki::serialize(text, writer).size() == 1 + 3);
+  REQUIRE(enki::serialize(std::vector<uint8_t>(64), writer).size() == 2 + 64);
+
+  enki::BinSpanReader reader(enki::chunked, writer.data());
+  std::vector<uint8_t> deserializedValues;
+  std::string_view deserializedText;
+  REQUIRE_NOTHROW(enki::deserialize(deserializedValues, reader).or_throw());
+  REQUIRE_NOTHROW(enki::deserialize(deserializedText, reader).or_throw());
+  REQUIRE(deserializedValues == values);
+  REQUIRE(deserializedText == text);
+
+  // Encoding wrappers write their length the same way
+  const enki::Delta<std::vector<int64_t>> stamps{1000, 1001, 1003};
+  enki::BinWriter deltaWriter(enki::chunked);
+  REQUIRE(enki::serialize(stamps, deltaWriter).size() == 1 + 2 + 1 + 1);
+  enki::Delta<std::vector<int64_t>> deserializedStamps;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserializedStamps, enki::BinReader(enki::chunked, deltaWriter.data()))
+      .or_throw());
+  REQUIRE(deserializedStamps == stamps);
+}
+
+TEST_CASE("Chunked policy splits long ranges", "[regression][chunked]")
+{
+  const Snapshot snapshot = makeSnapshot(3 * kChunk + 5);
+
+  enki::BinWriter writer(enki::chunked);
+  const auto serRes = enki::serialize(snapshot, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Name, then 3 full chunks and the last one, each with a varint header
+  REQUIRE(serRes.size() == 1 + 5 + 3 * 4 + 1 + snapshot.samples.size() * 2 + 4);
+  REQUIRE(enki::serialize(snapshot, enki::BinProbe(enki::chunked)).size() == serRes.size());
+
+  Snapshot deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())).or_throw());
+  REQUIRE(deserialized == snapshot);
+
+  // Containers other than vectors and non raw elements are gathered chunk by chunk
+  std::deque<uint16_t> samples;
+  enki::BinWriter samplesWriter(enki::chunked);
+  enki::serialize(snapshot.samples, samplesWriter).or_throw();
+  REQUIRE_NOTHROW(
+    enki::deserialize(samples, enki::BinReader(enki::chunked, samplesWriter.data())).or_throw());
+  REQUIRE(std::equal(samples.begin(), samples.end(), snapshot.samples.begin()));
+
+  std::vector<std::optional<uint8_t>> optionals(kChunk + 3);
+  optionals[kChunk + 1] = 7;
+  enki::BinWriter optionalsWriter(enki::chunked);
+  enki::serialize(optionals, optionalsWriter).or_throw();
+  std::vector<std::optional<uint8_t>> deserializedOptionals;
+  REQUIRE_NOTHROW(
+    enki::deserialize(
+      deserializedOptionals, enki::BinReader(enki::chunked, optionalsWriter.data()))
+      .or_throw());
+  REQUIRE(deserializedOptionals == optionals);
+
+  // Generic schema walkers follow the chunks
+  enki::BinWriter schemaWriter(enki::chunked);
+  enki::writeSchema<Snapshot>(schemaWriter).or_throw();
+  enki::serialize(snapshot, schemaWriter).or_throw();
+  enki::serialize(int32_t{-1}, schemaWriter).or_throw();
+  enki::BinSpanReader reader(enki::chunked, schemaWriter.data());
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE_NOTHROW(enki::skipValue(schema.root(), reader).or_throw());
+  int32_t trailer = 0;
+  REQUIRE_NOTHROW(enki::deserialize(trailer, reader).or_throw());
+  REQUIRE(trailer == -1);
+
+  // Readers without the policy reject the descriptor instead of misreading lengths
+  enki::Schema strictSchema;
+  REQUIRE_FALSE(enki::readSchema(strictSchema, enki::BinSpanReader(schemaWriter.data())));
+}
+
+TEST_CASE("Long ranges are consumed chunk by chunk", "[regression][chunked]")
+{
+  const Snapshot snapshot = makeSnapshot(2 * kChunk + 10);
+
+  const auto checkChunks = [&](auto &&reader) {
+    std::string name;
+    REQUIRE_NOTHROW(enki::deserialize(name, reader).or_throw());
+    size_t numRead = 0;
+    size_t numChunks = 0;
+    bool isSame = true;
+    const auto onChunk = [&](std::span<const uint16_t> chunk) {
+      const auto expected = snapshot.samples.begin() + static_cast<ptrdiff_t>(numRead);
+      isSame = isSame && chunk.size() <= kChunk &&
+               std::equal(chunk.begin(), chunk.end(), expected);
+      numRead += chunk.size();
+      ++numChunks;
+    };
+    REQUIRE_NOTHROW(enki::deserializeChunks<uint16_t>(reader, onChunk).or_throw());
+    REQUIRE(isSame);
+    REQUIRE(numRead == snapshot.samples.size());
+    REQUIRE(numChunks == 3);
+    int32_t checksum = 0;
+    REQUIRE_NOTHROW(enki::deserialize(checksum, reader).or_throw());
+    REQUIRE(checksum == snapshot.checksum);
+  };
+
+  enki::BinWriter chunkedWriter(enki::chunked);
+  enki::serialize(snapshot, chunkedWriter).or_throw();
+  checkChunks(enki::BinSpanReader(enki::chunked, chunkedWriter.data()));
+
+  // Ranges written in one piece are cut the same way while reading
+  enki::BinWriter strictWriter;
+  enki::serialize(snapshot, strictWriter).or_throw();
+  checkChunks(enki::BinSpanReader(strictWriter.data()));
+}
+
+TEST_CASE("Range lengths are never truncated", "[regression][chunked]")
+{
+  const std::vector<uint8_t> values(300);
+
+  enki::BinWriter<enki::strict_t, uint8_t> writer;
+  REQUIRE_FALSE(enki::serialize(values, writer));
+  REQUIRE_FALSE(enki::serialize(values, enki::BinProbe<enki::strict_t, uint8_t>()));
+
+  enki::BinWriter<enki::strict_t, uint16_t> largerWriter;
+  REQUIRE_NOTHROW(enki::serialize(values, largerWriter).or_throw());
+}
+
+TEST_CASE("Chunked decoding rejects malformed input", "[regression][chunked]")
+{
+  SECTION("chunk larger than the payload")
+  {
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint((uint64_t{1} << 40) | 1);
+    writer.writeVarint(0);
+
+    std::vector<uint32_t> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())));
+  }
+
+  SECTION("chunk longer than writers make")
+  {
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint(((kChunk + 1) << 1) | 1);
+    for (size_t i = 0; i < kChunk + 1; ++i)
+    {
+      enki::serialize(std::string(), writer).or_throw();
+    }
+    writer.writeVarint(0);
+
+    std::vector<std::string> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())));
+  }
+
+  SECTION("single chunk larger than writers make")
+  {
+    // Variable size elements: the count alone is rejected, nothing is allocated for it
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint(uint64_t{1} << 41);
+    REQUIRE(writer.data().size() == 6);
+
+    std::vector<std::string> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())));
+  }
+
+  SECTION("chunk of more elements than the payload holds")
+  {
+    // Each string takes at least a byte: rejected before a million of them are allocated
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint((kChunk << 1) | 1);
+    enki::serialize(std::string("a"), writer).or_throw();
+
+    std::vector<std::string> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())));
+  }
+
+  SECTION("missing last chunk")
+  {
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint((uint64_t{2} << 1) | 1);
+    enki::serialize(uint8_t{1}, writer).or_throw();
+    enki::serialize(uint8_t{2}, writer).or_throw();
+
+    std::vector<uint8_t> deserialized;
+    REQUIRE_THROWS(enki::deserialize(deserialized, enki::BinReader(enki::chunked, writer.data())));
+  }
+
+  SECTION("chunks where a single length is expected")
+  {
+    enki::BinWriter writer(enki::chunked);
+    writer.writeVarint((uint64_t{1} << 1) | 1);
+    enki::serialize(uint8_t{'a'}, writer).or_throw();
+    writer.writeVarint(uint64_t{1} << 1);
+    enki::serialize(uint8_t{'b'}, writer).or_throw();
+
+    std::string_view view;
+    REQUIRE_FALSE(enki::deserialize(view, enki::BinSpanReader(enki::chunked, writer.data())));
+    std::string str;
+    REQUIRE_NOTHROW(
+      enki::deserialize(str, enki::BinReader(enki::chunked, writer.data())).or_throw());
+    REQUIRE(str == "ab");
+  }
+}
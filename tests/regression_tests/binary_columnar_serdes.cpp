@@ -0,0 +1,198 @@
+/// Tests for the enki::Columnar wrapper
+/// Structs are stored member by member in binary formats and as plain containers in JSON
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/columnar.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  enum class Side : uint8_t
+  {
+    buy,
+    sell
+  };
+
+  struct Trade
+  {
+    int64_t timestamp;
+    double price;
+    Side side;
+    std::string venue;
+
+    bool operator==(const Trade &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Trade::EnkiSerial
+  {
+    using Members =
+      enki::Register<&Trade::timestamp, &Trade::price, &Trade::side, &Trade::venue>;
+  };
+
+  struct TradeColumns
+  {
+    std::vector<int64_t> timestamp;
+    std::vector<double> price;
+    std::vector<Side> side;
+    std::vector<std::string> venue;
+
+    struct EnkiSerial;
+  };
+
+  struct TradeColumns::EnkiSerial
+  {
+    using Members = enki::Register<
+      &TradeColumns::timestamp,
+      &TradeColumns::price,
+      &TradeColumns::side,
+      &TradeColumns::venue>;
+  };
+
+  std::vector<Trade> makeTrades(size_t numTrades)
+  {
+    std::vector<Trade> trades;
+    for (size_t i = 0; i < numTrades; ++i)
+    {
+      trades.push_back(
+        {1'700'000'000 + static_cast<int64_t>(i),
+         100.0 + static_cast<double>(i) / 4,
+         i % 3 == 0 ? Side::sell : Side::buy,
+         i % 2 == 0 ? "XNAS" : "XNYS"});
+    }
+    return trades;
+  }
+} // namespace
+
+TEST_CASE("Columnar encoding of a range of structs", "[regression][columnar]")
+{
+  // More rows than one chunk of gathered values
+  const enki::Columnar<std::vector<Trade>> trades = makeTrades(1000);
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(trades, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Same bytes as the row layout, in a different order
+  REQUIRE(serRes.size() == enki::serialize(makeTrades(1000), enki::BinProbe()).size());
+  REQUIRE(enki::serialize(trades, enki::BinProbe()).size() == serRes.size());
+
+  // The timestamp column directly follows the number of rows
+  const auto bytes = writer.data();
+  int64_t secondTimestamp = 0;
+  std::memcpy(&secondTimestamp, bytes.data() + sizeof(uint32_t) + sizeof(int64_t), sizeof(int64_t));
+  REQUIRE(secondTimestamp == trades[1].timestamp);
+
+  enki::Columnar<std::vector<Trade>> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinSpanReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == trades);
+
+  enki::Columnar<std::deque<Trade>> deque;
+  REQUIRE_NOTHROW(enki::deserialize(deque, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deque.size() == trades.size());
+  REQUIRE(deque.back() == trades.back());
+}
+
+TEST_CASE("Columnar encoding of a struct of arrays", "[regression][columnar]")
+{
+  const auto trades = makeTrades(300);
+
+  enki::BinWriter rowWriter;
+  REQUIRE_NOTHROW(
+    enki::serialize(enki::Columnar<std::vector<Trade>>(trades), rowWriter).or_throw());
+
+  // Rows written as columns are read back as columns
+  enki::Columnar<TradeColumns> columns;
+  REQUIRE_NOTHROW(enki::deserialize(columns, enki::BinSpanReader(rowWriter.data())).or_throw());
+  REQUIRE(columns.timestamp.size() == trades.size());
+  REQUIRE(columns.venue.size() == trades.size());
+  for (size_t i = 0; i < trades.size(); ++i)
+  {
+    REQUIRE(columns.timestamp[i] == trades[i].timestamp);
+    REQUIRE(columns.price[i] == trades[i].price);
+    REQUIRE(columns.side[i] == trades[i].side);
+    REQUIRE(columns.venue[i] == trades[i].venue);
+  }
+
+  // And written back to the same bytes
+  enki::BinWriter columnWriter;
+  REQUIRE_NOTHROW(enki::serialize(columns, columnWriter).or_throw());
+  REQUIRE(columnWriter.data() == rowWriter.data());
+}
+
+TEST_CASE("Columnar struct of arrays rejects columns of different sizes", "[regression][columnar]")
+{
+  enki::Columnar<TradeColumns> columns;
+  columns.timestamp = {1, 2};
+  columns.price = {1.0, 2.0};
+  columns.side = {Side::buy};
+  columns.venue = {"A", "B"};
+
+  enki::BinWriter writer;
+  REQUIRE_FALSE(enki::serialize(columns, writer));
+}
+
+TEST_CASE("Columnar decoding of truncated data", "[regression][columnar]")
+{
+  enki::BinWriter writer;
+  enki::serialize(enki::Columnar<std::vector<Trade>>(makeTrades(10)), writer).or_throw();
+  auto bytes = std::vector<std::byte>(writer.data().begin(), writer.data().end());
+  bytes.resize(bytes.size() / 2);
+
+  enki::Columnar<std::vector<Trade>> deserialized;
+  REQUIRE_THROWS_AS(enki::deserialize(deserialized, enki::BinReader(bytes)), std::out_of_range);
+
+  // A row count larger than the data cannot be satisfied
+  enki::BinWriter lying;
+  lying.write(uint32_t{1'000'000});
+  REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(lying.data())));
+}
+
+TEST_CASE("Columnar wrapper keeps JSON as the plain container", "[regression][columnar]")
+{
+  const enki::Columnar<std::vector<Trade>> trades = makeTrades(3);
+
+  enki::JSONWriter columnarWriter;
+  enki::serialize(trades, columnarWriter).or_throw();
+  enki::JSONWriter writer;
+  enki::serialize(makeTrades(3), writer).or_throw();
+  REQUIRE(columnarWriter.data().str() == writer.data().str());
+
+  enki::Columnar<std::vector<Trade>> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == trades);
+}
+
+TEST_CASE("Contiguous ranges of raw values are copied in bulk", "[regression][columnar]")
+{
+  // The bulk path keeps the element by element wire format
+  const std::vector<int32_t> values{1, -2, 3, -4};
+  enki::BinWriter writer;
+  REQUIRE(enki::serialize(values, writer).size() == sizeof(uint32_t) + 4 * sizeof(int32_t));
+  int32_t third = 0;
+  std::memcpy(
+    &third, writer.data().data() + sizeof(uint32_t) + 2 * sizeof(int32_t), sizeof(int32_t));
+  REQUIRE(third == 3);
+
+  std::deque<int32_t> deque;
+  REQUIRE_NOTHROW(enki::deserialize(deque, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deque == std::deque<int32_t>{1, -2, 3, -4});
+}
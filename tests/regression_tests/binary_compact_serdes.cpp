@@ -0,0 +1,205 @@
+/// Tests for the compact_t policy - Binary Format
+/// Variant indices and enums declaring `enki::EnumTraits` are stored on the smallest width
+/// their compile-time range allows
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  enum class Side : int
+  {
+    Buy,
+    Sell
+  };
+
+  enum class Temperature : int16_t
+  {
+    Freezing = -300,
+    Boiling = 300
+  };
+
+  enum class Unbounded : uint32_t
+  {
+    A,
+    B
+  };
+
+  struct Order
+  {
+    Side side;
+    std::variant<int32_t, double, std::string> price;
+    uint16_t quantity;
+
+    bool operator==(const Order &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Order::EnkiSerial
+  {
+    using Members = enki::Register<&Order::side, &Order::price, &Order::quantity>;
+  };
+} // namespace
+
+template <>
+struct enki::EnumTraits<Side>
+{
+  static constexpr Side max = Side::Sell;
+};
+
+template <>
+struct enki::EnumTraits<Temperature>
+{
+  static constexpr Temperature min = Temperature::Freezing;
+  static constexpr Temperature max = Temperature::Boiling;
+};
+
+TEST_CASE("Compact enum uses a single byte", "[regression][compact]")
+{
+  enki::BinWriter writer(enki::compact);
+
+  const auto serRes = enki::serialize(Side::Sell, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == 1);
+  REQUIRE(writer.data().size() == 1);
+
+  Side deserialized = Side::Buy;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(enki::compact, writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == 1);
+  REQUIRE(deserialized == Side::Sell);
+}
+
+TEST_CASE("Compact enum with a negative minimum", "[regression][compact]")
+{
+  for (const auto value : {Temperature::Freezing, Temperature::Boiling})
+  {
+    enki::BinWriter writer(enki::compact);
+    const auto serRes = enki::serialize(value, writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    // 600 values do not fit in a byte
+    REQUIRE(serRes.size() == sizeof(uint16_t));
+
+    Temperature deserialized{};
+    REQUIRE_NOTHROW(
+      enki::deserialize(deserialized, enki::BinReader(enki::compact, writer.data())).or_throw());
+    REQUIRE(deserialized == value);
+  }
+}
+
+TEST_CASE("Compact policy keeps full width for enums without traits", "[regression][compact]")
+{
+  enki::BinWriter writer(enki::compact);
+  const auto serRes = enki::serialize(Unbounded::B, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(Unbounded));
+}
+
+TEST_CASE("Strict policy ignores enum traits", "[regression][compact]")
+{
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(Side::Sell, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(Side));
+}
+
+TEST_CASE("Compact enum out of declared range is rejected", "[regression][compact]")
+{
+  enki::BinWriter writer;
+  enki::serialize(uint8_t{2}, writer).or_throw();
+
+  Side deserialized{};
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(enki::compact, writer.data()));
+  REQUIRE_FALSE(desRes);
+}
+
+TEST_CASE("Compact variant index uses a single byte", "[regression][compact]")
+{
+  using Variant = std::variant<int32_t, double, std::string>;
+
+  enki::BinWriter writer(enki::compact);
+  const Variant value = 2.5;
+  const auto serRes = enki::serialize(value, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == 1 + sizeof(double));
+
+  Variant deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(enki::compact, writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == 1 + sizeof(double));
+  REQUIRE(deserialized == value);
+}
+
+TEST_CASE("Compact variant index with forward compatibility", "[regression][compact]")
+{
+  using NewVariant = std::variant<std::monostate, int32_t, std::string>;
+  using OldVariant = std::variant<std::monostate, int32_t>;
+
+  enki::BinWriter writer(enki::forward_compatible | enki::compact);
+  const auto serRes = enki::serialize(NewVariant{std::string("new")}, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // index (1) + size (4) + string
+  REQUIRE(serRes.size() == 1 + sizeof(uint32_t) + sizeof(uint32_t) + 3);
+
+  OldVariant deserialized = 42;
+  const auto desRes = enki::deserialize(
+    deserialized, enki::BinReader(enki::forward_compatible | enki::compact, writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(std::holds_alternative<std::monostate>(deserialized));
+}
+
+TEST_CASE("Compact struct roundtrip and probe agree", "[regression][compact]")
+{
+  const std::vector<Order> orders{
+    {Side::Buy, int32_t{100}, 5},
+    {Side::Sell, 99.5, 7},
+    {Side::Sell, std::string("market"), 1},
+  };
+
+  enki::BinWriter writer(enki::compact);
+  const auto serRes = enki::serialize(orders, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+
+  const auto probeRes = enki::serialize(orders, enki::BinProbe(enki::compact));
+  REQUIRE(probeRes.size() == serRes.size());
+
+  enki::BinWriter fullWriter;
+  const auto fullRes = enki::serialize(orders, fullWriter);
+  // Each order saves 3 bytes on the enum and 3 bytes on the variant index
+  REQUIRE(fullRes.size() - serRes.size() == orders.size() * 6);
+
+  std::vector<Order> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinSpanReader(enki::compact, writer.data())).or_throw());
+  REQUIRE(deserialized == orders);
+}
+
+TEST_CASE("Compact policy does not change JSON output", "[regression][compact]")
+{
+  const Order order{Side::Sell, 1.5, 3};
+
+  enki::JSONWriter compactWriter(enki::compact);
+  enki::serialize(order, compactWriter).or_throw();
+  enki::JSONWriter writer;
+  enki::serialize(order, writer).or_throw();
+  REQUIRE(compactWriter.data().str() == writer.data().str());
+
+  Order deserialized{};
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(enki::compact, compactWriter.data().str()))
+      .or_throw());
+  REQUIRE(deserialized == order);
+}
@@ -0,0 +1,210 @@
+/// Tests for block compressed binary output
+/// Writers compress blocks as they go, readers decompress them into the span they read
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_compressed.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+
+namespace
+{
+  struct Snapshot
+  {
+    std::string source;
+    std::vector<double> prices;
+    std::vector<int64_t> timestamps;
+    std::vector<std::variant<int32_t, std::string>> events;
+
+    bool operator==(const Snapshot &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Snapshot::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Snapshot::source,
+      &Snapshot::prices,
+      &Snapshot::timestamps,
+      &Snapshot::events>;
+  };
+
+  Snapshot makeSnapshot(size_t numSamples)
+  {
+    Snapshot snapshot{"feed-a", {}, {}, {}};
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      const double wave = std::sin(static_cast<double>(i) / 50);
+      snapshot.prices.push_back(4500.0 + std::round(wave * 40) / 4);
+      snapshot.timestamps.push_back(1'700'000'000'000 + static_cast<int64_t>(i) * 250);
+      if (i % 8 == 0)
+      {
+        snapshot.events.emplace_back(std::string(40, static_cast<char>('a' + i % 26)));
+      }
+      else
+      {
+        snapshot.events.emplace_back(static_cast<int32_t>(i));
+      }
+    }
+    return snapshot;
+  }
+
+  template <typename Policy>
+  void checkMatchesPlainWriter(Policy policy, const Snapshot &snapshot)
+  {
+    enki::BinWriter plain(policy);
+    enki::serialize(snapshot, plain).or_throw();
+
+    enki::BinCompressedWriter writer(policy);
+    enki::serialize(snapshot, writer).or_throw();
+    writer.flush();
+    REQUIRE(writer.uncompressedSize() == plain.data().size());
+    REQUIRE(writer.data().size() < plain.data().size() / 2);
+
+    std::vector<std::byte> decompressed;
+    REQUIRE_NOTHROW(enki::decompress(writer.data(), decompressed).or_throw());
+    REQUIRE(decompressed == plain.data());
+
+    Snapshot deserialized;
+    REQUIRE_NOTHROW(
+      enki::deserialize(deserialized, enki::BinSpanReader(policy, decompressed)).or_throw());
+    REQUIRE(deserialized == snapshot);
+  }
+} // namespace
+
+TEST_CASE("Compressed writer output decompresses to the plain output", "[regression][compressed]")
+{
+  const Snapshot small = makeSnapshot(200);
+  const Snapshot large = makeSnapshot(20'000); // Several blocks
+
+  checkMatchesPlainWriter(enki::strict, small);
+  checkMatchesPlainWriter(enki::strict, large);
+  checkMatchesPlainWriter(enki::dictionary, large);
+  checkMatchesPlainWriter(enki::aligned, large);
+  // Size prefixes of variants are patched before their block is compressed
+  checkMatchesPlainWriter(enki::forward_compatible, large);
+}
+
+TEST_CASE("Compressed writer hands complete blocks to a sink", "[regression][compressed]")
+{
+  const Snapshot snapshot = makeSnapshot(20'000);
+  std::vector<std::byte> frame;
+  size_t numBlocks = 0;
+  enki::BinCompressedWriter writer(enki::strict, [&](std::span<const std::byte> block) {
+    frame.insert(frame.end(), block.begin(), block.end());
+    ++numBlocks;
+  });
+  enki::serialize(snapshot, writer).or_throw();
+  const size_t numBlocksBeforeFlush = numBlocks;
+  writer.flush();
+  REQUIRE(numBlocksBeforeFlush > 1);
+  REQUIRE(numBlocks == numBlocksBeforeFlush + 1);
+  REQUIRE(writer.data().empty());
+
+  size_t size = 0;
+  REQUIRE_NOTHROW(enki::decompressedSize(frame, size).or_throw());
+  REQUIRE(size == writer.uncompressedSize());
+
+  // Decompression into a caller buffer read in place
+  std::vector<std::byte> buffer(size);
+  REQUIRE_NOTHROW(enki::decompress(frame, std::span<std::byte>(buffer)).or_throw());
+  Snapshot deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(buffer)).or_throw());
+  REQUIRE(deserialized == snapshot);
+}
+
+TEST_CASE("Compressed writer streams skippable content in blocks", "[regression][compressed]")
+{
+  // With forward_compatible, the long ranges are sized fields whose size is patched last
+  const Snapshot snapshot = makeSnapshot(20'000);
+  std::vector<std::byte> frame;
+  size_t numBlocks = 0;
+  enki::BinCompressedWriter writer(enki::forward_compatible, [&](std::span<const std::byte> block) {
+    frame.insert(frame.end(), block.begin(), block.end());
+    ++numBlocks;
+  });
+  enki::serialize(snapshot, writer).or_throw();
+  writer.flush();
+  REQUIRE(writer.uncompressedSize() > 4 * enki::detail::kCompressionBlockSize);
+  REQUIRE(numBlocks > writer.uncompressedSize() / enki::detail::kCompressionBlockSize);
+
+  enki::BinWriter plain(enki::forward_compatible);
+  enki::serialize(snapshot, plain).or_throw();
+  std::vector<std::byte> decompressed;
+  REQUIRE_NOTHROW(enki::decompress(frame, decompressed).or_throw());
+  REQUIRE(decompressed == plain.data());
+}
+
+TEST_CASE("Compressed writer stores incompressible blocks", "[regression][compressed]")
+{
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> noise(30'000);
+  for (auto &value : noise)
+  {
+    value = rng();
+  }
+
+  enki::BinCompressedWriter writer;
+  enki::serialize(noise, writer).or_throw();
+  writer.flush();
+  REQUIRE(writer.data().size() < writer.uncompressedSize() + 64);
+
+  std::vector<std::byte> decompressed;
+  REQUIRE_NOTHROW(enki::decompress(writer.data(), decompressed).or_throw());
+  std::vector<uint64_t> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(decompressed)).or_throw());
+  REQUIRE(deserialized == noise);
+}
+
+TEST_CASE("Decompression rejects malformed frames", "[regression][compressed]")
+{
+  enki::BinCompressedWriter writer;
+  enki::serialize(makeSnapshot(2'000), writer).or_throw();
+  writer.flush();
+  const std::vector<std::byte> frame = writer.data();
+  size_t size = 0;
+  enki::decompressedSize(frame, size).or_throw();
+
+  std::vector<std::byte> out;
+  REQUIRE_FALSE(enki::decompress(std::span(frame).first(frame.size() - 1), out));
+
+  std::vector<std::byte> tooSmall(size - 1);
+  REQUIRE_FALSE(enki::decompress(frame, std::span<std::byte>(tooSmall)));
+
+  // Sizes out of reach of the stored bytes are rejected before anything is allocated
+  const std::vector<std::byte> huge{std::byte{0x80},
+                                    std::byte{0x80},
+                                    std::byte{0x80},
+                                    std::byte{0x80},
+                                    std::byte{0x80},
+                                    std::byte{0x20}, // 2^40 uncompressed bytes
+                                    std::byte{0},    // No shuffled runs
+                                    std::byte{0}};   // Nothing stored
+  REQUIRE_FALSE(enki::decompressedSize(huge, size));
+  REQUIRE_FALSE(enki::decompress(huge, out));
+  std::vector<std::byte> lz = huge;
+  lz.back() = std::byte{(1 << 1) | 1}; // One LZ compressed byte
+  lz.push_back(std::byte{0});
+  REQUIRE_FALSE(enki::decompress(lz, out));
+
+  // Corrupted bytes never read or write out of bounds
+  for (size_t i = 0; i < frame.size(); i += 7)
+  {
+    std::vector<std::byte> corrupted = frame;
+    corrupted[i] ^= std::byte{0x5A};
+    std::vector<std::byte> buffer(size);
+    (void)enki::decompress(corrupted, std::span<std::byte>(buffer));
+  }
+}
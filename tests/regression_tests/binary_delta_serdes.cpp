@@ -0,0 +1,163 @@
+/// Tests for the enki::Delta range wrapper
+/// Values are stored as zigzag varint deltas in binary formats and as plain arrays in JSON
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Trades
+  {
+    std::vector<int64_t> timestamps;
+    enki::Delta<std::vector<uint32_t>> sequenceNumbers;
+
+    bool operator==(const Trades &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Trades::EnkiSerial
+  {
+    // NOLINTNEXTLINE
+    using Members = enki::Register<
+      ENKIWRAP_CAST(Trades, timestamps, enki::Delta<std::vector<int64_t>>),
+      &Trades::sequenceNumbers>;
+  };
+} // namespace
+
+TEST_CASE("Delta encoding of monotonic timestamps", "[regression][delta]")
+{
+  enki::Delta<std::vector<int64_t>> timestamps;
+  int64_t current = 1'700'000'000'000'000'000;
+  for (int i = 0; i < 1000; ++i)
+  {
+    timestamps.push_back(current);
+    current += 1 + (i % 100);
+  }
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(timestamps, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Size prefix + 9 bytes for the first value + at most 2 bytes per delta
+  REQUIRE(serRes.size() <= sizeof(uint32_t) + 9 + 999 * 2);
+  REQUIRE(serRes.size() * 4 < timestamps.size() * sizeof(int64_t));
+
+  REQUIRE(enki::serialize(timestamps, enki::BinProbe()).size() == serRes.size());
+
+  enki::Delta<std::vector<int64_t>> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == timestamps);
+}
+
+TEST_CASE("Delta encoding handles decreasing values and extremes", "[regression][delta]")
+{
+  const enki::Delta<std::vector<int32_t>> values{
+    0,
+    -1,
+    std::numeric_limits<int32_t>::max(),
+    std::numeric_limits<int32_t>::min(),
+    42,
+    41,
+    std::numeric_limits<int32_t>::min()};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::Delta<std::vector<int32_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Delta encoding of non contiguous ranges", "[regression][delta]")
+{
+  const enki::Delta<std::list<uint8_t>> values{10, 20, 255, 0, 3};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::Delta<std::list<uint8_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Delta encoding inside Register", "[regression][delta]")
+{
+  const Trades trades{{100, 200, 300, 450}, {{7, 8, 9, 10, 11}}};
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(trades, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Two size prefixes, 2 bytes per timestamp delta (zigzag doubles the magnitude),
+  // 1 byte per sequence number delta
+  REQUIRE(serRes.size() == 2 * sizeof(uint32_t) + 4 * 2 + 5);
+
+  Trades deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deserialized == trades);
+}
+
+TEST_CASE("Delta encoding keeps plain arrays in JSON", "[regression][delta]")
+{
+  const enki::Delta<std::vector<int64_t>> values{5, 6, 4};
+
+  enki::JSONWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+  REQUIRE(writer.data().str() == "[5, 6, 4]");
+
+  enki::Delta<std::vector<int64_t>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("Delta decoding rejects malformed input", "[regression][delta]")
+{
+  SECTION("size larger than the payload")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1'000'000}, writer).or_throw();
+    enki::serialize(uint8_t{1}, writer).or_throw();
+
+    enki::Delta<std::vector<int64_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("delta too large for the element type")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    writer.writeVarint(uint64_t{1} << 20);
+
+    enki::Delta<std::vector<uint16_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("overlong varint")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    for (int i = 0; i < 10; ++i)
+    {
+      enki::serialize(uint8_t{0xFF}, writer).or_throw();
+    }
+    enki::serialize(uint8_t{0}, writer).or_throw();
+
+    enki::Delta<std::vector<int64_t>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+}
@@ -0,0 +1,332 @@
+/// Tests for the dictionary policy - Binary Format
+/// Each distinct string is written once, repeats are written as a varint id
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/skip.hpp"
+#include "enki/validate.hpp"
+
+namespace
+{
+  struct Record
+  {
+    std::string symbol;
+    int32_t quantity;
+
+    bool operator==(const Record &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Record::EnkiSerial
+  {
+    using Members = enki::Register<&Record::symbol, &Record::quantity>;
+  };
+
+  struct RecordView
+  {
+    std::string_view symbol;
+    int32_t quantity;
+
+    struct EnkiSerial;
+  };
+
+  struct RecordView::EnkiSerial
+  {
+    using Members = enki::Register<&RecordView::symbol, &RecordView::quantity>;
+  };
+
+  struct OldDocument
+  {
+    std::string title;
+
+    struct EnkiSerial;
+  };
+
+  struct OldDocument::EnkiSerial
+  {
+    using Members = enki::Register<&OldDocument::title>;
+  };
+
+  struct Document
+  {
+    std::string title;
+    std::vector<std::string> tags;
+    std::string footer;
+
+    bool operator==(const Document &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Document::EnkiSerial
+  {
+    using Members = enki::Register<&Document::title, &Document::tags, &Document::footer>;
+  };
+
+  template <typename Reader>
+  concept string_view_reader = requires(Reader r, std::string_view &view) { r.read(view); };
+
+  std::vector<Record> makeRecords()
+  {
+    const std::array<std::string, 3> symbols{"AAPL.NASDAQ", "MSFT.NASDAQ", "ESZ5.CME"};
+    std::vector<Record> records;
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+      records.push_back({symbols[static_cast<size_t>(i) % symbols.size()], i});
+    }
+    return records;
+  }
+
+  bool isInside(std::string_view view, std::span<const std::byte> buffer)
+  {
+    const auto *begin = reinterpret_cast<const char *>(buffer.data());
+    return view.data() >= begin && view.data() + view.size() <= begin + buffer.size();
+  }
+} // namespace
+
+TEST_CASE("Dictionary encoding of repeated strings", "[regression][dictionary]")
+{
+  const std::vector<Record> records = makeRecords();
+
+  enki::BinWriter writer(enki::dictionary);
+  const auto serRes = enki::serialize(records, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+
+  // Size prefix, then per record a 1 byte id and the quantity, plus the 3 strings spelled once
+  const size_t stringBytes = std::string("AAPL.NASDAQ").size() + std::string("MSFT.NASDAQ").size() +
+                             std::string("ESZ5.CME").size();
+  REQUIRE(serRes.size() == sizeof(uint32_t) + records.size() * (1 + sizeof(int32_t)) + stringBytes);
+
+  enki::BinWriter plainWriter;
+  const auto plainRes = enki::serialize(records, plainWriter);
+  REQUIRE(serRes.size() * 2 < plainRes.size());
+
+  REQUIRE(enki::serialize(records, enki::BinProbe(enki::dictionary)).size() == serRes.size());
+
+  std::vector<Record> deserialized;
+  enki::BinSpanReader reader(enki::dictionary, writer.data());
+  const auto desRes = enki::deserialize(deserialized, reader);
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == records);
+  REQUIRE(reader.dictionary().size() == 3);
+  REQUIRE(reader.dictionary()[1] == "MSFT.NASDAQ");
+}
+
+TEST_CASE("Dictionary encoding into string views", "[regression][dictionary]")
+{
+  const std::vector<Record> records = makeRecords();
+
+  enki::BinWriter writer(enki::dictionary);
+  REQUIRE_NOTHROW(enki::serialize(records, writer).or_throw());
+
+  std::vector<RecordView> views;
+  REQUIRE_NOTHROW(
+    enki::deserialize(views, enki::BinSpanReader(enki::dictionary, writer.data())).or_throw());
+  REQUIRE(views.size() == records.size());
+  for (size_t i = 0; i < views.size(); ++i)
+  {
+    REQUIRE(views[i].symbol == records[i].symbol);
+    REQUIRE(views[i].quantity == records[i].quantity);
+    REQUIRE(isInside(views[i].symbol, writer.data()));
+  }
+  // Repeats share the storage of the first occurrence
+  REQUIRE(views[0].symbol.data() == views[3].symbol.data());
+}
+
+TEST_CASE("String views without dictionary point into the input", "[regression][dictionary]")
+{
+  const std::vector<std::string> strings{"first", "", "third"};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(strings, writer).or_throw());
+
+  std::vector<std::string_view> views;
+  const auto desRes = enki::deserialize(views, enki::BinSpanReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == writer.data().size());
+  REQUIRE(views == std::vector<std::string_view>{"first", "", "third"});
+  REQUIRE(isInside(views[0], writer.data()));
+
+  // Writing views gives the same bytes as writing strings
+  enki::BinWriter viewWriter;
+  REQUIRE_NOTHROW(enki::serialize(views, viewWriter).or_throw());
+  REQUIRE(viewWriter.data() == writer.data());
+}
+
+TEST_CASE("String views are not read from owning readers", "[regression][dictionary]")
+{
+  // BinReader owns a copy of its data, which views would outlive
+  STATIC_REQUIRE(string_view_reader<enki::BinSpanReader<>>);
+  STATIC_REQUIRE(string_view_reader<enki::BinSpanReader<enki::dictionary_t>>);
+  STATIC_REQUIRE_FALSE(string_view_reader<enki::BinReader<>>);
+  STATIC_REQUIRE_FALSE(string_view_reader<enki::BinReader<enki::dictionary_t>>);
+}
+
+TEST_CASE("Dictionary with forward compatible variants", "[regression][dictionary]")
+{
+  using NewVariant = std::variant<std::monostate, int32_t, std::string>;
+  using OldVariant = std::variant<std::monostate, int32_t>;
+  constexpr auto kPolicy = enki::forward_compatible | enki::dictionary;
+
+  // The string inside the variant loses its id at the end of the variant: old readers skip it
+  const NewVariant skipped = std::string("only in new schema");
+  const std::string after = "after";
+
+  enki::BinWriter writer(kPolicy);
+  enki::serialize(skipped, writer).or_throw();
+  enki::serialize(after, writer).or_throw();
+  enki::serialize(std::string("only in new schema"), writer).or_throw();
+  enki::serialize(after, writer).or_throw();
+
+  const auto probeSize = enki::serialize(skipped, enki::BinProbe(kPolicy)).size();
+  // Index, size prefix, literal tag, string
+  REQUIRE(probeSize == 2 * sizeof(uint32_t) + 1 + std::string("only in new schema").size());
+
+  SECTION("new reader")
+  {
+    enki::BinSpanReader reader(kPolicy, writer.data());
+    NewVariant variant;
+    std::string strings[3];
+    REQUIRE_NOTHROW(enki::deserialize(variant, reader).or_throw());
+    for (auto &str : strings)
+    {
+      REQUIRE_NOTHROW(enki::deserialize(str, reader).or_throw());
+    }
+    REQUIRE(variant == skipped);
+    REQUIRE(strings[0] == after);
+    REQUIRE(strings[1] == "only in new schema");
+    REQUIRE(strings[2] == after);
+  }
+
+  SECTION("old reader")
+  {
+    enki::BinSpanReader reader(kPolicy, writer.data());
+    OldVariant variant = 1;
+    std::string strings[3];
+    REQUIRE_NOTHROW(enki::deserialize(variant, reader).or_throw());
+    for (auto &str : strings)
+    {
+      REQUIRE_NOTHROW(enki::deserialize(str, reader).or_throw());
+    }
+    REQUIRE(std::holds_alternative<std::monostate>(variant));
+    REQUIRE(strings[0] == after);
+    REQUIRE(strings[1] == "only in new schema");
+    REQUIRE(strings[2] == after);
+  }
+}
+
+TEST_CASE("Dictionary with forward compatible structs", "[regression][dictionary]")
+{
+  constexpr auto kPolicy = enki::forward_compatible | enki::dictionary;
+  const std::vector<Record> records = makeRecords();
+
+  enki::BinWriter writer(kPolicy);
+  enki::serialize(records, writer).or_throw();
+  enki::BinWriter dictionaryWriter(enki::dictionary);
+  enki::serialize(records, dictionaryWriter).or_throw();
+
+  // String members are not sized fields: repeats across structs stay references, each record
+  // only adds its field count and two tags
+  REQUIRE(writer.data().size() == dictionaryWriter.data().size() + 3 * records.size());
+  REQUIRE(enki::serialize(records, enki::BinProbe(kPolicy)).size() == writer.data().size());
+  std::vector<Record> read;
+  enki::deserialize(read, enki::BinSpanReader(kPolicy, writer.data())).or_throw();
+  REQUIRE(read == records);
+
+  // Strings inside sized fields lose their id at the end of the field: old readers skip it
+  const Document document{"title", {"tag", "tag", "title"}, "footer"};
+  const std::vector<std::string> after{"footer", "tag", "title"};
+  enki::BinWriter docWriter(kPolicy);
+  enki::serialize(document, docWriter).or_throw();
+  enki::serialize(after, docWriter).or_throw();
+
+  SECTION("new reader")
+  {
+    enki::BinSpanReader reader(kPolicy, docWriter.data());
+    Document readDocument;
+    std::vector<std::string> readAfter;
+    REQUIRE_NOTHROW(enki::deserialize(readDocument, reader).or_throw());
+    REQUIRE_NOTHROW(enki::deserialize(readAfter, reader).or_throw());
+    REQUIRE(readDocument == document);
+    REQUIRE(readAfter == after);
+  }
+
+  SECTION("old reader")
+  {
+    enki::BinSpanReader reader(kPolicy, docWriter.data());
+    OldDocument readDocument;
+    std::vector<std::string> readAfter;
+    REQUIRE_NOTHROW(enki::deserialize(readDocument, reader).or_throw());
+    REQUIRE_NOTHROW(enki::deserialize(readAfter, reader).or_throw());
+    REQUIRE(readDocument.title == document.title);
+    REQUIRE(readAfter == after);
+  }
+
+  SECTION("validate and skip")
+  {
+    enki::BinSpanReader reader(kPolicy, docWriter.data());
+    REQUIRE_NOTHROW(enki::validate<Document>(reader).or_throw());
+    REQUIRE_NOTHROW(enki::validate<std::vector<std::string>>(reader).or_throw());
+    enki::BinSpanReader skipReader(kPolicy, docWriter.data());
+    REQUIRE_NOTHROW(enki::skip<Document>(skipReader).or_throw());
+    std::vector<std::string> readAfter;
+    REQUIRE_NOTHROW(enki::deserialize(readAfter, skipReader).or_throw());
+    REQUIRE(readAfter == after);
+  }
+}
+
+TEST_CASE("Dictionary writer clear resets the table", "[regression][dictionary]")
+{
+  enki::BinWriter writer(enki::dictionary);
+  enki::serialize(std::string("symbol"), writer).or_throw();
+  writer.clear();
+  enki::serialize(std::string("symbol"), writer).or_throw();
+
+  std::string deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinReader(enki::dictionary, writer.data())).or_throw());
+  REQUIRE(deserialized == "symbol");
+}
+
+TEST_CASE("Dictionary decoding rejects unknown references", "[regression][dictionary]")
+{
+  enki::BinWriter writer;
+  writer.writeVarint(enki::detail::dictionaryReferenceTag(0));
+
+  std::string deserialized;
+  REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(enki::dictionary, writer.data())));
+}
+
+TEST_CASE("Dictionary policy does not change JSON output", "[regression][dictionary]")
+{
+  const std::vector<Record> records{{"A", 1}, {"A", 2}};
+
+  enki::JSONWriter dictionaryWriter(enki::dictionary);
+  enki::serialize(records, dictionaryWriter).or_throw();
+  enki::JSONWriter writer;
+  enki::serialize(records, writer).or_throw();
+  REQUIRE(dictionaryWriter.data().str() == writer.data().str());
+
+  std::vector<Record> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(enki::dictionary, writer.data().str()))
+      .or_throw());
+  REQUIRE(deserialized == records);
+}
@@ -0,0 +1,227 @@
+/// Tests for the enki::FloatSeries range wrapper
+/// Values are stored XOR compressed in binary formats and as plain arrays in JSON
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/float_series.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Metric
+  {
+    std::vector<double> samples;
+    enki::FloatSeries<std::vector<float>> ratios;
+
+    bool operator==(const Metric &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Metric::EnkiSerial
+  {
+    // NOLINTNEXTLINE
+    using Members = enki::Register<
+      ENKIWRAP_CAST(Metric, samples, enki::FloatSeries<std::vector<double>>),
+      &Metric::ratios>;
+  };
+} // namespace
+
+TEST_CASE("XOR compression of a slowly moving gauge", "[regression][float_series]")
+{
+  enki::FloatSeries<std::vector<double>> gauge;
+  double current = 12.0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    gauge.push_back(current);
+    if (i % 10 == 0)
+    {
+      current += 0.5;
+    }
+  }
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(gauge, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() * 5 < gauge.size() * sizeof(double));
+
+  REQUIRE(enki::serialize(gauge, enki::BinProbe()).size() == serRes.size());
+
+  enki::FloatSeries<std::vector<double>> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinSpanReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == gauge);
+}
+
+TEST_CASE("XOR compression of repeated values", "[regression][float_series]")
+{
+  const enki::FloatSeries<std::vector<double>> values(80, 3.25);
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(values, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Size prefix, stream size, first value, then one bit per repetition
+  REQUIRE(serRes.size() == sizeof(uint32_t) + 1 + sizeof(double) + 10);
+
+  enki::FloatSeries<std::vector<double>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("XOR compression preserves every bit", "[regression][float_series]")
+{
+  const enki::FloatSeries<std::vector<double>> values{
+    0.0,
+    -0.0,
+    1.0,
+    -1.0,
+    std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::denorm_min(),
+    std::numeric_limits<double>::max(),
+    std::numeric_limits<double>::lowest(),
+    1e-300,
+    0.1,
+    0.2};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::FloatSeries<std::vector<double>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized.size() == values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    REQUIRE(std::signbit(deserialized[i]) == std::signbit(values[i]));
+    REQUIRE(deserialized[i] == values[i]);
+  }
+
+  SECTION("NaN payloads")
+  {
+    const enki::FloatSeries<std::vector<float>> nans{
+      std::numeric_limits<float>::quiet_NaN(), 2.0F, std::numeric_limits<float>::quiet_NaN()};
+
+    enki::BinWriter nanWriter;
+    REQUIRE_NOTHROW(enki::serialize(nans, nanWriter).or_throw());
+
+    enki::FloatSeries<std::vector<float>> nanDeserialized;
+    REQUIRE_NOTHROW(
+      enki::deserialize(nanDeserialized, enki::BinReader(nanWriter.data())).or_throw());
+    REQUIRE(std::isnan(nanDeserialized[0]));
+    REQUIRE(nanDeserialized[1] == 2.0F);
+    REQUIRE(std::isnan(nanDeserialized[2]));
+  }
+}
+
+TEST_CASE("XOR compression of non contiguous and empty ranges", "[regression][float_series]")
+{
+  SECTION("list")
+  {
+    const enki::FloatSeries<std::list<float>> values{1.5F, 1.75F, 1.75F, -8.0F};
+
+    enki::BinWriter writer;
+    REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+    enki::FloatSeries<std::list<float>> deserialized;
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+    REQUIRE(deserialized == values);
+  }
+
+  SECTION("empty")
+  {
+    const enki::FloatSeries<std::vector<double>> values;
+
+    enki::BinWriter writer;
+    const auto serRes = enki::serialize(values, writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    REQUIRE(serRes.size() == sizeof(uint32_t) + 1);
+
+    enki::FloatSeries<std::vector<double>> deserialized{1.0};
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+    REQUIRE(deserialized.empty());
+  }
+}
+
+TEST_CASE("XOR compression inside Register", "[regression][float_series]")
+{
+  const Metric metric{{20.5, 20.5, 20.75, 21.0}, {{0.5F, 0.5F, 0.25F}}};
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(metric, writer).or_throw());
+
+  Metric deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deserialized == metric);
+}
+
+TEST_CASE("XOR compression keeps plain arrays in JSON", "[regression][float_series]")
+{
+  const enki::FloatSeries<std::vector<double>> values{1.5, 2.25, -4.0};
+
+  enki::JSONWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(values, writer).or_throw());
+
+  enki::FloatSeries<std::vector<double>> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == values);
+}
+
+TEST_CASE("XOR compressed decoding rejects malformed input", "[regression][float_series]")
+{
+  SECTION("more elements than bits")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{100}, writer).or_throw();
+    writer.writeVarint(1);
+    enki::serialize(uint8_t{0}, writer).or_throw();
+
+    enki::FloatSeries<std::vector<double>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("stream larger than the payload")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{1}, writer).or_throw();
+    writer.writeVarint(1000);
+    enki::serialize(1.0, writer).or_throw();
+
+    enki::FloatSeries<std::vector<double>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("window reuse before any window")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{2}, writer).or_throw();
+    writer.writeVarint(sizeof(float) + 1);
+    enki::serialize(1.0F, writer).or_throw();
+    enki::serialize(uint8_t{0b01}, writer).or_throw();
+
+    enki::FloatSeries<std::vector<float>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("truncated stream")
+  {
+    enki::BinWriter writer;
+    enki::serialize(uint32_t{3}, writer).or_throw();
+    writer.writeVarint(sizeof(float));
+    enki::serialize(1.0F, writer).or_throw();
+
+    enki::FloatSeries<std::vector<float>> deserialized;
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+}
@@ -0,0 +1,296 @@
+/// Tests for indexed ranges, written with the offset of each element
+/// Range views decode any element of an indexed range without reading the ones before it
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/indexed.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Entry
+  {
+    uint64_t id;
+    std::string text;
+    std::optional<std::vector<int32_t>> values;
+    std::variant<std::monostate, double, std::string> extra;
+
+    bool operator==(const Entry &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Entry::EnkiSerial
+  {
+    using Members = enki::Register<&Entry::id, &Entry::text, &Entry::values, &Entry::extra>;
+  };
+
+  std::vector<Entry> makeEntries(size_t count)
+  {
+    std::vector<Entry> entries;
+    for (size_t i = 0; i < count; ++i)
+    {
+      Entry entry{i, std::string(i % 7, 'a') + std::to_string(i), std::nullopt, std::monostate{}};
+      if (i % 3 == 0)
+      {
+        entry.values = std::vector<int32_t>(i % 5, static_cast<int32_t>(i));
+      }
+      if (i % 4 == 1)
+      {
+        entry.extra = std::string("extra") + std::to_string(i);
+      }
+      else if (i % 4 == 2)
+      {
+        entry.extra = 0.5 * static_cast<double>(i);
+      }
+      entries.push_back(entry);
+    }
+    return entries;
+  }
+
+  using IndexedEntries = enki::Indexed<std::vector<Entry>, 8>;
+
+  struct Journal
+  {
+    std::string name;
+    IndexedEntries entries;
+    uint32_t checksum;
+
+    struct EnkiSerial;
+  };
+
+  struct Journal::EnkiSerial
+  {
+    using Members = enki::Register<&Journal::name, &Journal::entries, &Journal::checksum>;
+  };
+} // namespace
+
+TEST_CASE("Indexed ranges roundtrip", "[regression][indexed]")
+{
+  const auto checkPolicy = [](auto policy) {
+    for (const size_t count : std::vector<size_t>{0, 5, 8, 100})
+    {
+      const Journal journal{"journal", makeEntries(count), 0xBEEF};
+      enki::BinWriter writer(policy);
+      enki::serialize(journal, writer).or_throw();
+
+      Journal read{};
+      enki::BinReader reader(policy, writer.data());
+      const auto res = enki::deserialize(read, reader);
+      REQUIRE_NOTHROW(res.or_throw());
+      REQUIRE(res.size() == writer.data().size());
+      REQUIRE(read.name == journal.name);
+      REQUIRE(read.entries == journal.entries);
+      REQUIRE(read.checksum == journal.checksum);
+    }
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::presence_bitmap);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::presence_bitmap | enki::forward_compatible);
+}
+
+TEST_CASE("Range views decode elements on access", "[regression][indexed]")
+{
+  const auto checkPolicy = [](auto policy) {
+    using Policy = decltype(policy);
+    for (const size_t count : std::vector<size_t>{5, 100})
+    {
+      const std::vector<Entry> entries = makeEntries(count);
+      enki::BinWriter writer(policy);
+      enki::serialize(std::string("header"), writer).or_throw();
+      const size_t offset = writer.data().size();
+      enki::serialize(IndexedEntries(entries), writer).or_throw();
+
+      const enki::RangeView<Entry, Policy> view(policy, writer.data(), offset);
+      REQUIRE_NOTHROW(view.status().or_throw());
+      REQUIRE(view.size() == count);
+      REQUIRE(view.isIndexed() == (count >= 8));
+
+      // Random access
+      for (size_t i = count; i-- > 0;)
+      {
+        REQUIRE(view[i] == entries[i]);
+      }
+      Entry entry{};
+      REQUIRE_FALSE(view.get(count, entry));
+
+      // Sub-ranges
+      std::vector<Entry> middle(3);
+      view.get(2, std::span(middle)).or_throw();
+      REQUIRE(middle == std::vector<Entry>(entries.begin() + 2, entries.begin() + 5));
+      REQUIRE_FALSE(view.get(count - 2, std::span(middle)));
+
+      // Iteration
+      std::vector<Entry> iterated;
+      for (const Entry &el : view)
+      {
+        iterated.push_back(el);
+      }
+      REQUIRE(iterated == entries);
+    }
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::presence_bitmap);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::presence_bitmap | enki::forward_compatible);
+}
+
+TEST_CASE("Indexed ranges of fixed size elements", "[regression][indexed]")
+{
+  enki::Indexed<std::vector<uint16_t>, 4> values{1, 2, 3, 4, 5};
+  enki::BinWriter writer;
+  enki::serialize(values, writer).or_throw();
+  // Count, flag, size prefix, elements and offsets
+  REQUIRE(writer.data().size() == 4 + 1 + 4 + 5 * 2 + 5 * 4);
+
+  const enki::RangeView<uint16_t> view(writer.data());
+  REQUIRE(view.isIndexed());
+  REQUIRE(view[4] == 5);
+
+  // Ranges below the threshold have no offsets
+  enki::Indexed<std::vector<uint16_t>, 6> small{values.begin(), values.end()};
+  enki::BinWriter smallWriter;
+  enki::serialize(small, smallWriter).or_throw();
+  REQUIRE(smallWriter.data().size() == 4 + 1 + 4 + 5 * 2);
+  REQUIRE(enki::RangeView<uint16_t>(smallWriter.data())[4] == 5);
+}
+
+TEST_CASE("Indexed range elements have dictionary ids of their own", "[regression][indexed]")
+{
+  const enki::Indexed<std::vector<std::string>, 2> strings{"header", "a", "a", "header"};
+  enki::BinWriter writer(enki::dictionary);
+  enki::serialize(std::string("header"), writer).or_throw();
+  const size_t offset = writer.data().size();
+  enki::serialize(strings, writer).or_throw();
+  enki::serialize(std::string("header"), writer).or_throw();
+  REQUIRE(
+    enki::serialize(strings, enki::BinProbe(enki::dictionary)).size() ==
+    writer.data().size() - offset - 1);
+
+  // Elements do not refer to the strings written before them or to each other
+  const enki::RangeView<std::string, enki::dictionary_t> view(
+    enki::dictionary, writer.data(), offset);
+  REQUIRE(view[3] == "header");
+  REQUIRE(view[2] == "a");
+
+  enki::BinSpanReader reader(enki::dictionary, writer.data());
+  std::string before;
+  std::string after;
+  enki::Indexed<std::vector<std::string>, 2> read;
+  enki::deserialize(before, reader).or_throw();
+  enki::deserialize(read, reader).or_throw();
+  enki::deserialize(after, reader).or_throw();
+  REQUIRE(read == strings);
+  REQUIRE(after == "header");
+}
+
+TEST_CASE("Range views of wrapper elements", "[regression][indexed]")
+{
+  // Elements are skipped through their own encoding to reach the next ones
+  using Series = enki::Delta<std::vector<int32_t>>;
+  const std::vector<Series> series{
+    Series(std::vector<int32_t>{1, 5, 9}), Series(std::vector<int32_t>{}), Series({100, 90})};
+  for (const size_t minIndexedSize : std::vector<size_t>{2, 10})
+  {
+    enki::BinWriter writer;
+    if (minIndexedSize == 2)
+    {
+      enki::serialize(enki::Indexed<std::vector<Series>, 2>(series), writer).or_throw();
+    }
+    else
+    {
+      enki::serialize(enki::Indexed<std::vector<Series>, 10>(series), writer).or_throw();
+    }
+    const enki::RangeView<Series> view(writer.data());
+    REQUIRE(view[2] == series[2]);
+    std::vector<Series> iterated;
+    for (const Series &el : view)
+    {
+      iterated.push_back(el);
+    }
+    REQUIRE(iterated == series);
+  }
+}
+
+TEST_CASE("Range views report malformed data", "[regression][indexed]")
+{
+  enki::BinWriter writer;
+  enki::serialize(IndexedEntries(makeEntries(10)), writer).or_throw();
+  const std::vector<std::byte> &bytes = writer.data();
+  constexpr size_t blockSizeIndex = 4 + 1;
+
+  // Size prefix larger than the data
+  std::vector<std::byte> changed = bytes;
+  changed[blockSizeIndex + 3] = std::byte{0x7F};
+  const enki::RangeView<Entry> tooLong(changed);
+  REQUIRE_FALSE(tooLong.status());
+  REQUIRE(tooLong.size() == 0);
+  IndexedEntries read;
+  REQUIRE_FALSE(enki::deserialize(read, enki::BinSpanReader(changed)));
+
+  // More offsets than the block can hold
+  changed = bytes;
+  changed[2] = std::byte{0x10};
+  REQUIRE_FALSE(enki::RangeView<Entry>(changed).status());
+  REQUIRE_FALSE(enki::deserialize(read, enki::BinSpanReader(changed)));
+
+  // Count far larger than an empty block without offsets: the data ends before the elements
+  // are allocated
+  enki::BinWriter headerWriter;
+  enki::serialize(uint32_t{0xFFFFFFFF}, headerWriter).or_throw();
+  enki::serialize(false, headerWriter).or_throw();
+  enki::serialize(uint32_t{0}, headerWriter).or_throw();
+  REQUIRE(headerWriter.data().size() == 9);
+  enki::Indexed<std::vector<std::string>> strings;
+  REQUIRE_THROWS_AS(
+    enki::deserialize(strings, enki::BinSpanReader(headerWriter.data())), std::out_of_range);
+
+  // Offset pointing past the elements
+  changed = bytes;
+  changed[changed.size() - 2] = std::byte{0x7F};
+  const enki::RangeView<Entry> badOffset(changed);
+  REQUIRE(badOffset.status());
+  Entry entry{};
+  REQUIRE_FALSE(badOffset.get(9, entry));
+  REQUIRE(badOffset.get(8, entry));
+}
+
+TEST_CASE("Indexed ranges in JSON", "[regression][indexed][json]")
+{
+  const IndexedEntries entries(makeEntries(10));
+  enki::JSONWriter writer;
+  enki::serialize(entries, writer).or_throw();
+
+  enki::JSONWriter plainWriter;
+  enki::serialize(makeEntries(10), plainWriter).or_throw();
+  REQUIRE(writer.data().str() == plainWriter.data().str());
+
+  IndexedEntries read;
+  enki::deserialize(read, enki::JSONReader(writer.data().str())).or_throw();
+  REQUIRE(read == entries);
+}
@@ -0,0 +1,195 @@
+/// Tests for patches between two versions of a value
+/// Only the changed members, elements and entries are written
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/patch.hpp"
+
+namespace
+{
+  struct Position
+  {
+    std::string symbol;
+    int64_t quantity;
+    double price;
+
+    bool operator==(const Position &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Position::EnkiSerial
+  {
+    using Members = enki::Register<&Position::symbol, &Position::quantity, &Position::price>;
+  };
+
+  struct Account
+  {
+    uint32_t id;
+    std::string owner;
+    std::vector<Position> positions;
+    std::map<std::string, Position> orders;
+    std::unordered_set<int32_t> flags;
+    std::deque<double> history;
+    float limit;
+
+    bool operator==(const Account &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Account::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Account::id,
+      &Account::owner,
+      &Account::positions,
+      &Account::orders,
+      &Account::flags,
+      &Account::history,
+      ENKIWRAP_CAST(Account, limit, double)>;
+  };
+
+  Account makeAccount()
+  {
+    Account account{7, "treasury", {}, {}, {1, 2, 3}, {}, 1e6F};
+    for (int64_t i = 0; i < 1000; ++i)
+    {
+      account.positions.push_back({"SYM" + std::to_string(i), i * 100, 10.0 + i});
+      account.history.push_back(static_cast<double>(i));
+    }
+    for (int64_t i = 0; i < 100; ++i)
+    {
+      account.orders["ORD" + std::to_string(i)] = {"SYM" + std::to_string(i), -i, 5.0};
+    }
+    return account;
+  }
+
+  template <typename T, typename Policy>
+  T patched(T value, const T &oldValue, const T &newValue, Policy policy, size_t &patchSize)
+  {
+    enki::BinWriter writer(policy);
+    enki::writePatch(oldValue, newValue, writer).or_throw();
+    patchSize = writer.data().size();
+    REQUIRE(enki::writePatch(oldValue, newValue, enki::BinProbe(policy)).size() == patchSize);
+
+    enki::BinReader reader(policy, writer.data());
+    const auto res = enki::applyPatch(value, reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == patchSize);
+    return value;
+  }
+} // namespace
+
+TEST_CASE("Patches hold the changed members only", "[regression][patch]")
+{
+  const Account before = makeAccount();
+  Account after = before;
+  after.positions[500].quantity = -1;
+  after.positions.push_back({"NEW", 1, 1.0});
+  after.orders.erase("ORD3");
+  after.orders["ORD4"].price = 6.0;
+  after.orders["ORD200"] = {"NEW", 2, 2.0};
+  after.flags.erase(2);
+  after.flags.insert(42);
+  after.history.resize(990);
+  after.limit = 5e5F;
+
+  enki::BinWriter fullWriter;
+  enki::serialize(after, fullWriter).or_throw();
+
+  const auto checkPolicy = [&](auto policy) {
+    size_t patchSize = 0;
+    REQUIRE(patched(before, before, after, policy, patchSize) == after);
+    REQUIRE(patchSize < 150);
+    REQUIRE(patchSize * 100 < fullWriter.data().size());
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact | enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+
+  // Unchanged values cost their bitmap of changed members
+  size_t patchSize = 0;
+  REQUIRE(patched(before, before, before, enki::strict, patchSize) == before);
+  REQUIRE(patchSize == 1);
+}
+
+TEST_CASE("Patches of ranges and maps", "[regression][patch]")
+{
+  size_t patchSize = 0;
+
+  const std::vector<int32_t> numbers{1, 2, 3, 4, 5};
+  REQUIRE(patched(numbers, numbers, {1, 9, 3}, enki::strict, patchSize) ==
+          std::vector<int32_t>{1, 9, 3});
+  // Offset, numbers of erased and inserted elements, number of changes, gap and value
+  REQUIRE(patchSize == 1 + 1 + 1 + 1 + 1 + 4);
+  REQUIRE(patched(numbers, numbers, {}, enki::strict, patchSize).empty());
+  REQUIRE(patched({}, {}, numbers, enki::strict, patchSize) == numbers);
+
+  // Elements inserted or erased in the middle leave the following ones out of the patch
+  std::vector<int32_t> many(1000);
+  for (size_t i = 0; i < many.size(); ++i)
+  {
+    many[i] = static_cast<int32_t>(i);
+  }
+  std::vector<int32_t> inserted = many;
+  inserted.insert(inserted.begin() + 10, {-1, -2});
+  REQUIRE(patched(many, many, inserted, enki::strict, patchSize) == inserted);
+  REQUIRE(patchSize == 1 + 1 + 1 + 1 + 2 * 4);
+  std::vector<int32_t> erased = many;
+  erased.erase(erased.begin() + 500, erased.begin() + 600);
+  REQUIRE(patched(many, many, erased, enki::strict, patchSize) == erased);
+  REQUIRE(patchSize == 2 + 1 + 1 + 1);
+  std::deque<double> shifted(many.begin(), many.end());
+  shifted.pop_front();
+  shifted.push_back(-1.0);
+  const std::deque<double> oldShifted(many.begin(), many.end());
+  REQUIRE(patched(oldShifted, oldShifted, shifted, enki::strict, patchSize) == shifted);
+
+  // Elements without bytes are inserted without taking any
+  const std::vector<std::monostate> empties(100);
+  REQUIRE(patched(empties, empties, std::vector<std::monostate>(300), enki::strict, patchSize)
+            .size() == 300);
+  REQUIRE(patchSize == 1 + 1 + 2 + 1);
+
+  using Nested = std::unordered_map<uint16_t, std::vector<uint8_t>>;
+  const Nested oldNested{{1, {1, 2, 3}}, {2, {4}}};
+  const Nested newNested{{1, {1, 2, 3, 4}}, {3, {}}};
+  REQUIRE(patched(oldNested, oldNested, newNested, enki::strict, patchSize) == newNested);
+
+  // Other types are written in full
+  const std::string text = "unchanged prefix";
+  REQUIRE(patched(text, text, std::string("changed"), enki::strict, patchSize) == "changed");
+}
+
+TEST_CASE("Patches reject values they were not made for", "[regression][patch]")
+{
+  const std::map<int32_t, int32_t> before{{1, 1}, {2, 2}};
+  const std::map<int32_t, int32_t> after{{1, 1}};
+  enki::BinWriter writer;
+  enki::writePatch(before, after, writer).or_throw();
+
+  std::map<int32_t, int32_t> other{{3, 3}};
+  REQUIRE_FALSE(enki::applyPatch(other, enki::BinReader(writer.data())));
+
+  const std::vector<int32_t> numbers{1, 2, 3, 4, 5};
+  enki::BinWriter rangeWriter;
+  enki::writePatch(numbers, {1, 2, 3, 4, 6}, rangeWriter).or_throw();
+  std::vector<int32_t> shorter{1, 2};
+  REQUIRE_FALSE(enki::applyPatch(shorter, enki::BinReader(rangeWriter.data())));
+}
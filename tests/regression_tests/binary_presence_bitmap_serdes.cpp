@@ -0,0 +1,189 @@
+/// Tests for the presence_bitmap policy - Binary Format
+/// Has-value flags of optional members are gathered into one bitmap ahead of the struct
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+
+namespace
+{
+  struct Limits
+  {
+    std::optional<int32_t> low;
+    std::optional<int32_t> high;
+
+    bool operator==(const Limits &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Limits::EnkiSerial
+  {
+    using Members = enki::Register<&Limits::low, &Limits::high>;
+  };
+
+  struct Config
+  {
+    uint32_t version;
+    std::optional<int32_t> timeout;
+    std::optional<std::string> name;
+    std::optional<double> ratio;
+    std::optional<uint8_t> retries;
+    std::optional<int64_t> deadline;
+    std::optional<bool> verbose;
+    std::optional<uint16_t> port;
+    std::optional<std::string> host;
+    std::optional<Limits> limits;
+    std::vector<int32_t> values;
+
+    bool operator==(const Config &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Config::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Config::version,
+      &Config::timeout,
+      &Config::name,
+      &Config::ratio,
+      &Config::retries,
+      &Config::deadline,
+      &Config::verbose,
+      &Config::port,
+      &Config::host,
+      &Config::limits,
+      &Config::values>;
+  };
+
+  Config makeConfig()
+  {
+    Config config{};
+    config.version = 3;
+    config.name = "gateway";
+    config.port = 8080;
+    config.limits = Limits{std::nullopt, 10};
+    config.values = {1, 2};
+    return config;
+  }
+} // namespace
+
+TEST_CASE("Presence bitmap for optional members", "[regression][presence_bitmap]")
+{
+  const Config config = makeConfig();
+
+  enki::BinWriter writer(enki::presence_bitmap);
+  const auto serRes = enki::serialize(config, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+
+  // 9 optional members fit in 2 bytes, the nested struct has its own 1 byte bitmap
+  const size_t expected = sizeof(uint32_t) + 2 + sizeof(uint32_t) + std::string("gateway").size() +
+                          sizeof(uint16_t) + 1 + sizeof(int32_t) + sizeof(uint32_t) +
+                          2 * sizeof(int32_t);
+  REQUIRE(serRes.size() == expected);
+
+  enki::BinWriter plainWriter;
+  const auto plainRes = enki::serialize(config, plainWriter);
+  REQUIRE(serRes.size() + 8 == plainRes.size());
+
+  REQUIRE(enki::serialize(config, enki::BinProbe(enki::presence_bitmap)).size() == serRes.size());
+
+  Config deserialized{};
+  deserialized.timeout = 5; // Absent members are reset
+  const auto desRes =
+    enki::deserialize(deserialized, enki::BinReader(enki::presence_bitmap, writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == config);
+}
+
+TEST_CASE("Presence bitmap with all or no optional members set", "[regression][presence_bitmap]")
+{
+  Config full = makeConfig();
+  full.timeout = -1;
+  full.ratio = 0.5;
+  full.retries = 3;
+  full.deadline = 1'700'000'000;
+  full.verbose = false;
+  full.host = "";
+  full.limits = Limits{1, 2};
+
+  const Config empty{};
+
+  for (const Config &config : {full, empty})
+  {
+    enki::BinWriter writer(enki::presence_bitmap | enki::compact);
+    REQUIRE_NOTHROW(enki::serialize(config, writer).or_throw());
+
+    Config deserialized{};
+    REQUIRE_NOTHROW(enki::deserialize(
+                      deserialized,
+                      enki::BinSpanReader(enki::presence_bitmap | enki::compact, writer.data()))
+                      .or_throw());
+    REQUIRE(deserialized == config);
+  }
+}
+
+TEST_CASE("Presence bitmap in ranges of structs", "[regression][presence_bitmap]")
+{
+  std::vector<Limits> limits;
+  for (int32_t i = 0; i < 100; ++i)
+  {
+    limits.push_back(
+      {i % 2 == 0 ? std::optional<int32_t>(i) : std::nullopt,
+       i % 3 == 0 ? std::optional<int32_t>(-i) : std::nullopt});
+  }
+
+  enki::BinWriter writer(enki::presence_bitmap);
+  REQUIRE_NOTHROW(enki::serialize(limits, writer).or_throw());
+
+  std::vector<Limits> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinReader(enki::presence_bitmap, writer.data()))
+      .or_throw());
+  REQUIRE(deserialized == limits);
+}
+
+TEST_CASE("Presence bitmap decoding of truncated data", "[regression][presence_bitmap]")
+{
+  enki::BinWriter writer(enki::presence_bitmap);
+  enki::serialize(Limits{1, 2}, writer).or_throw();
+  auto bytes = std::vector<std::byte>(writer.data().begin(), writer.data().end());
+  bytes.pop_back();
+
+  Limits deserialized;
+  REQUIRE_THROWS_AS(
+    enki::deserialize(deserialized, enki::BinReader(enki::presence_bitmap, bytes)),
+    std::out_of_range);
+}
+
+TEST_CASE("Presence bitmap policy does not change JSON output", "[regression][presence_bitmap]")
+{
+  const Config config = makeConfig();
+
+  enki::JSONWriter bitmapWriter(enki::presence_bitmap);
+  enki::serialize(config, bitmapWriter).or_throw();
+  enki::JSONWriter writer;
+  enki::serialize(config, writer).or_throw();
+  REQUIRE(bitmapWriter.data().str() == writer.data().str());
+
+  Config deserialized{};
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(enki::presence_bitmap, writer.data().str()))
+      .or_throw());
+  REQUIRE(deserialized == config);
+}
@@ -0,0 +1,212 @@
+/// Tests for projections, deserializing the selected members of a struct
+/// The other members are skipped without being decoded and keep their value
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/auto_encoded.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/projection.hpp"
+
+namespace
+{
+  struct Leg
+  {
+    std::string venue;
+    std::array<int32_t, 4> fills;
+
+    bool operator==(const Leg &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Leg::EnkiSerial
+  {
+    using Members = enki::Register<&Leg::venue, &Leg::fills>;
+  };
+
+  struct Trade
+  {
+    uint64_t id;
+    std::string symbol;
+    std::vector<Leg> legs;
+    std::optional<std::string> comment;
+    std::map<std::string, double> fees;
+    std::variant<int32_t, std::string> account;
+    double price;
+    std::optional<uint32_t> flags;
+
+    bool operator==(const Trade &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Trade::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Trade::id,
+      &Trade::symbol,
+      &Trade::legs,
+      &Trade::comment,
+      &Trade::fees,
+      &Trade::account,
+      &Trade::price,
+      &Trade::flags>;
+  };
+
+  Trade makeTrade()
+  {
+    return {
+      7,
+      "ACME",
+      {{"XNYS", {1, 2, 3, 4}}, {"BATS", {5, 6, 7, 8}}},
+      std::nullopt,
+      {{"clearing", 0.5}, {"exchange", 1.25}},
+      std::string("house"),
+      99.5,
+      3};
+  }
+
+  struct Series
+  {
+    enki::Delta<std::vector<int32_t>> times;
+    enki::AutoEncoded<std::vector<int32_t>> counts;
+    int32_t id;
+
+    struct EnkiSerial;
+  };
+
+  struct Series::EnkiSerial
+  {
+    using Members = enki::Register<&Series::times, &Series::counts, &Series::id>;
+  };
+} // namespace
+
+TEST_CASE("Projections decode the selected members only", "[regression][projection]")
+{
+  const Trade trade = makeTrade();
+
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter writer(policy);
+    enki::serialize(trade, writer).or_throw();
+
+    Trade projected{};
+    projected.symbol = "untouched";
+    enki::BinReader reader(policy, writer.data());
+    const auto res = enki::deserializeOnly<&Trade::id, &Trade::price>(projected, reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == writer.data().size());
+    REQUIRE(projected.id == trade.id);
+    REQUIRE(projected.price == trade.price);
+    REQUIRE(projected.symbol == "untouched");
+    REQUIRE(projected.legs.empty());
+    REQUIRE(projected.fees.empty());
+
+    Trade rest{};
+    enki::BinReader restReader(policy, writer.data());
+    enki::deserializeOnly<
+      &Trade::symbol,
+      &Trade::legs,
+      &Trade::comment,
+      &Trade::fees,
+      &Trade::account,
+      &Trade::flags>(rest, restReader)
+      .or_throw();
+    rest.id = trade.id;
+    rest.price = trade.price;
+    REQUIRE(rest == trade);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::presence_bitmap);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::presence_bitmap | enki::forward_compatible);
+}
+
+TEST_CASE("Projections skip wrapper members through their encoding", "[regression][projection]")
+{
+  const Series series{
+    std::vector<int32_t>{1000, 1010, 1015, 1030}, std::vector<int32_t>(100, 3), 9};
+
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter writer(policy);
+    enki::serialize(series, writer).or_throw();
+
+    Series projected{};
+    enki::BinSpanReader reader(policy, writer.data());
+    const auto res = enki::deserializeOnly<&Series::id>(projected, reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == writer.data().size());
+    REQUIRE(projected.id == series.id);
+    REQUIRE(projected.times.empty());
+    REQUIRE(projected.counts.empty());
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::forward_compatible);
+}
+
+TEST_CASE("Projections of JSON", "[regression][projection]")
+{
+  Trade trade = makeTrade();
+  trade.comment = "quoted \"text\", {braces} and [brackets]";
+
+  enki::JSONWriter writer;
+  enki::serialize(trade, writer).or_throw();
+
+  Trade projected{};
+  enki::JSONReader reader(writer.data().str());
+  enki::deserializeOnly<&Trade::fees, &Trade::flags>(projected, reader).or_throw();
+  REQUIRE(projected.fees == trade.fees);
+  REQUIRE(projected.flags == trade.flags);
+  REQUIRE(projected.symbol.empty());
+  REQUIRE_FALSE(projected.comment.has_value());
+
+  Trade full{};
+  enki::JSONReader fullReader(writer.data().str());
+  enki::deserializeOnly<
+    &Trade::id,
+    &Trade::symbol,
+    &Trade::legs,
+    &Trade::comment,
+    &Trade::fees,
+    &Trade::account,
+    &Trade::price,
+    &Trade::flags>(full, fullReader)
+    .or_throw();
+  REQUIRE(full == trade);
+}
+
+TEST_CASE("Projections report malformed data", "[regression][projection]")
+{
+  const Trade trade = makeTrade();
+  enki::BinWriter writer;
+  enki::serialize(trade, writer).or_throw();
+
+  // Symbol length larger than the data
+  std::vector<std::byte> bytes = writer.data();
+  bytes[8 + 3] = std::byte{0x7F};
+  Trade projected{};
+  REQUIRE_FALSE(enki::deserializeOnly<&Trade::price>(projected, enki::BinSpanReader(bytes)));
+
+  // Truncated data
+  const std::vector<std::byte> truncated(writer.data().begin(), writer.data().end() - 2);
+  REQUIRE_THROWS(enki::deserializeOnly<&Trade::id>(projected, enki::BinSpanReader(truncated)));
+}
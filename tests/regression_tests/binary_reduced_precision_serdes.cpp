@@ -0,0 +1,292 @@
+/// Tests for the enki::Half and enki::Quantized wrappers and their range counterparts
+/// Values are stored with reduced precision in binary formats and unchanged in JSON
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/half.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/quantized.hpp"
+
+namespace
+{
+  using Alpha = enki::Quantized<float, 0.0, 1.0, uint8_t>;
+
+  struct Pixel
+  {
+    float alpha;
+    enki::Half<float> depth;
+    enki::Quantized<double, -90.0, 90.0, uint32_t> latitude;
+
+    struct EnkiSerial;
+  };
+
+  struct Pixel::EnkiSerial
+  {
+    // NOLINTNEXTLINE
+    using Members =
+      enki::Register<ENKIWRAP_CAST(Pixel, alpha, Alpha), &Pixel::depth, &Pixel::latitude>;
+  };
+
+  float roundTripHalf(float value)
+  {
+    return enki::detail::halfToFloat(enki::detail::floatToHalf(value));
+  }
+} // namespace
+
+TEST_CASE("Half precision conversions", "[regression][half]")
+{
+  STATIC_CHECK(enki::detail::floatToHalf(1.0F) == 0x3C00);
+  STATIC_CHECK(enki::detail::floatToHalf(-2.0F) == 0xC000);
+  STATIC_CHECK(enki::detail::floatToHalf(65504.0F) == 0x7BFF);
+  STATIC_CHECK(enki::detail::halfToFloat(0x3555) == 0.333251953125F);
+
+  REQUIRE(enki::detail::floatToHalf(0.0F) == 0x0000);
+  REQUIRE(enki::detail::floatToHalf(-0.0F) == 0x8000);
+  // Smallest subnormal half and halfway below it (ties to even gives zero)
+  REQUIRE(enki::detail::floatToHalf(std::ldexp(1.0F, -24)) == 0x0001);
+  REQUIRE(enki::detail::floatToHalf(std::ldexp(1.0F, -25)) == 0x0000);
+  REQUIRE(enki::detail::halfToFloat(0x0001) == std::ldexp(1.0F, -24));
+  REQUIRE(enki::detail::halfToFloat(0x03FF) == std::ldexp(1023.0F, -24));
+  // Overflow and rounding up to infinity
+  REQUIRE(enki::detail::floatToHalf(1e6F) == 0x7C00);
+  REQUIRE(enki::detail::floatToHalf(65520.0F) == 0x7C00);
+  REQUIRE(std::isinf(roundTripHalf(-std::numeric_limits<float>::infinity())));
+  REQUIRE(std::isnan(roundTripHalf(std::numeric_limits<float>::quiet_NaN())));
+  // Ties to even: 2049 lies between 2048 and 2050
+  REQUIRE(roundTripHalf(2049.0F) == 2048.0F);
+  REQUIRE(roundTripHalf(2051.0F) == 2052.0F);
+
+  // Every half value survives a round trip through float, bulk kernels agree with scalar ones
+  std::vector<uint16_t> halves;
+  for (uint32_t h = 0; h <= 0xFFFF; ++h)
+  {
+    const auto half = static_cast<uint16_t>(h);
+    const float value = enki::detail::halfToFloat(half);
+    if (!std::isnan(value))
+    {
+      REQUIRE(enki::detail::floatToHalf(value) == half);
+      halves.push_back(half);
+    }
+  }
+  std::vector<float> floats(halves.size());
+  enki::detail::halvesToFloats(halves.data(), floats.data(), halves.size());
+  std::vector<uint16_t> back(halves.size());
+  enki::detail::floatsToHalves(floats.data(), back.data(), floats.size());
+  REQUIRE(back == halves);
+}
+
+TEST_CASE("Bulk half precision conversions match the scalar ones", "[regression][half]")
+{
+  // Builds with F16C (ENKI_ENABLE_F16C) convert blocks of 8 values with hardware instructions
+  std::vector<uint16_t> halves(0x10000);
+  for (size_t i = 0; i < halves.size(); ++i)
+  {
+    halves[i] = static_cast<uint16_t>(i);
+  }
+  std::vector<float> floats(halves.size());
+  enki::detail::halvesToFloats(halves.data(), floats.data(), halves.size());
+  for (size_t i = 0; i < halves.size(); ++i)
+  {
+    const float expected = enki::detail::halfToFloat(halves[i]);
+    REQUIRE(std::bit_cast<uint32_t>(floats[i]) == std::bit_cast<uint32_t>(expected));
+  }
+
+  // Every half, the floats next to it and the ones around the halfway points used for rounding
+  std::vector<float> inputs;
+  for (const float f : floats)
+  {
+    const uint32_t bits = std::bit_cast<uint32_t>(f);
+    for (const uint32_t candidate :
+         {bits - 1, bits, bits + 1, bits + 0xFFF, bits + 0x1000, bits + 0x1001})
+    {
+      inputs.push_back(std::bit_cast<float>(candidate));
+    }
+  }
+  for (uint64_t bits = 0; bits <= 0xFFFFFFFF; bits += 65521)
+  {
+    inputs.push_back(std::bit_cast<float>(static_cast<uint32_t>(bits)));
+  }
+  inputs.push_back(1.0F); // Not a multiple of the block size
+
+  std::vector<uint16_t> converted(inputs.size());
+  enki::detail::floatsToHalves(inputs.data(), converted.data(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i)
+  {
+    REQUIRE(converted[i] == enki::detail::floatToHalf(inputs[i]));
+  }
+}
+
+TEST_CASE("Half precision scalar", "[regression][half]")
+{
+  const enki::Half<double> value = 3.140625;
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(value, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(uint16_t));
+
+  enki::Half<double> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == sizeof(uint16_t));
+  REQUIRE(deserialized == value);
+}
+
+TEST_CASE("Half precision ranges", "[regression][half]")
+{
+  enki::HalfRange<std::vector<float>> features;
+  for (int i = 0; i < 1000; ++i)
+  {
+    features.push_back(std::sin(static_cast<float>(i)) * 10.0F);
+  }
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(features, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(uint32_t) + features.size() * sizeof(uint16_t));
+  REQUIRE(enki::serialize(features, enki::BinProbe()).size() == serRes.size());
+
+  enki::HalfRange<std::vector<float>> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinSpanReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized.size() == features.size());
+  for (size_t i = 0; i < features.size(); ++i)
+  {
+    REQUIRE(deserialized[i] == roundTripHalf(features[i]));
+  }
+
+  SECTION("non contiguous range of doubles")
+  {
+    const enki::HalfRange<std::list<double>> values{0.5, -1.25, 1024.0};
+
+    enki::BinWriter listWriter;
+    REQUIRE_NOTHROW(enki::serialize(values, listWriter).or_throw());
+
+    enki::HalfRange<std::list<double>> listDeserialized;
+    REQUIRE_NOTHROW(
+      enki::deserialize(listDeserialized, enki::BinReader(listWriter.data())).or_throw());
+    REQUIRE(listDeserialized == values);
+  }
+}
+
+TEST_CASE("Quantized scalar", "[regression][quantized]")
+{
+  using Level = enki::Quantized<float, -1.0, 1.0>;
+  constexpr double kStep = 2.0 / 65535;
+
+  for (const float input : {-1.0F, -0.3F, 0.0F, 0.123456F, 1.0F})
+  {
+    enki::BinWriter writer;
+    const auto serRes = enki::serialize(Level(input), writer);
+    REQUIRE_NOTHROW(serRes.or_throw());
+    REQUIRE(serRes.size() == sizeof(uint16_t));
+
+    Level deserialized;
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+    REQUIRE(std::abs(deserialized.value() - input) <= kStep / 2 + 1e-7);
+  }
+
+  SECTION("out of range values are clamped")
+  {
+    using Unit = enki::Quantized<float, 0.0, 1.0, uint8_t>;
+    REQUIRE(Unit::quantizer_type::quantize(-5.0F) == 0);
+    REQUIRE(Unit::quantizer_type::quantize(5.0F) == 255);
+    REQUIRE(Unit::quantizer_type::quantize(std::numeric_limits<float>::quiet_NaN()) == 0);
+    REQUIRE(Unit::quantizer_type::quantize(0.5F) == 128);
+    REQUIRE(Unit::quantizer_type::dequantize<float>(255) == 1.0F);
+  }
+}
+
+TEST_CASE("Quantized ranges", "[regression][quantized]")
+{
+  using Temperatures = enki::QuantizedRange<std::vector<double>, -50.0, 50.0, uint16_t>;
+
+  const Temperatures values{-50.0, -12.5, 0.0, 21.7, 49.99, 50.0};
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(values, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(uint32_t) + values.size() * sizeof(uint16_t));
+
+  Temperatures deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized.size() == values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    REQUIRE(std::abs(deserialized[i] - values[i]) <= Temperatures::quantizer_type::kStep / 2);
+  }
+}
+
+TEST_CASE("Reduced precision inside Register", "[regression][quantized][half]")
+{
+  const Pixel pixel{0.5F, 2.5F, 45.0};
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(pixel, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint32_t));
+
+  Pixel deserialized{};
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(std::abs(deserialized.alpha - 0.5F) <= 1.0F / 255);
+  REQUIRE(deserialized.depth == pixel.depth);
+  REQUIRE(std::abs(deserialized.latitude.value() - 45.0) < 1e-7);
+}
+
+TEST_CASE("Reduced precision keeps full values in JSON", "[regression][quantized][half]")
+{
+  const Pixel pixel{0.3F, 0.1F, 12.345};
+
+  enki::JSONWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(pixel, writer).or_throw());
+
+  Pixel deserialized{};
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized.alpha == pixel.alpha);
+  REQUIRE(deserialized.depth == pixel.depth);
+  REQUIRE(deserialized.latitude == pixel.latitude);
+
+  const enki::HalfRange<std::vector<float>> values{0.1F, 0.2F};
+  enki::JSONWriter rangeWriter;
+  REQUIRE_NOTHROW(enki::serialize(values, rangeWriter).or_throw());
+  enki::HalfRange<std::vector<float>> rangeDeserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(rangeDeserialized, enki::JSONReader(rangeWriter.data().str())).or_throw());
+  REQUIRE(rangeDeserialized == values);
+}
+
+TEST_CASE("Reduced precision ranges reject truncated input", "[regression][quantized][half]")
+{
+  enki::BinWriter writer;
+  enki::serialize(uint32_t{1000}, writer).or_throw();
+  enki::serialize(uint16_t{0}, writer).or_throw();
+
+  enki::HalfRange<std::vector<float>> halves;
+  REQUIRE_FALSE(enki::deserialize(halves, enki::BinReader(writer.data())));
+
+  enki::QuantizedRange<std::vector<float>, 0.0, 1.0> quantized;
+  REQUIRE_FALSE(enki::deserialize(quantized, enki::BinReader(writer.data())));
+
+  // Stored size wrapping around to the 2 bytes left
+  enki::BinWriter<enki::strict_t, uint64_t> wideWriter;
+  enki::serialize((uint64_t{1} << 63) + 1, wideWriter).or_throw();
+  enki::serialize(uint16_t{0}, wideWriter).or_throw();
+  REQUIRE_FALSE(
+    enki::deserialize(halves, enki::BinReader<enki::strict_t, uint64_t>(wideWriter.data())));
+  REQUIRE_FALSE(
+    enki::deserialize(quantized, enki::BinReader<enki::strict_t, uint64_t>(wideWriter.data())));
+}
@@ -0,0 +1,399 @@
+/// Tests for self-describing binary streams
+/// A schema written once lets generic code walk, skip and route values of unknown types
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/schema.hpp"
+
+namespace
+{
+  enum class Side : uint8_t
+  {
+    Buy,
+    Sell,
+  };
+
+  struct Leg
+  {
+    Side side;
+    double price;
+
+    bool operator==(const Leg &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Leg::EnkiSerial
+  {
+    using Members = enki::Register<&Leg::side, &Leg::price>;
+  };
+
+  struct Order
+  {
+    std::string symbol;
+    int64_t id;
+    std::vector<Leg> legs;
+    std::optional<std::string> note;
+    std::variant<std::monostate, int32_t, std::string> tag;
+    std::array<uint16_t, 2> flags;
+    std::map<std::string, int32_t> attributes;
+
+    bool operator==(const Order &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Order::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Order::symbol,
+      &Order::id,
+      &Order::legs,
+      &Order::note,
+      &Order::tag,
+      &Order::flags,
+      &Order::attributes>;
+  };
+
+  struct Encoded
+  {
+    int32_t before;
+    enki::Delta<std::vector<int64_t>> series;
+    int32_t after;
+
+    struct EnkiSerial;
+  };
+
+  struct Encoded::EnkiSerial
+  {
+    using Members = enki::Register<&Encoded::before, &Encoded::series, &Encoded::after>;
+  };
+
+  struct Tree
+  {
+    int32_t value;
+    std::vector<Tree> children;
+
+    struct EnkiSerial;
+  };
+
+  struct Tree::EnkiSerial
+  {
+    using Members = enki::Register<&Tree::value, &Tree::children>;
+  };
+
+  struct Chain
+  {
+    std::string name;
+    std::shared_ptr<Chain> next;
+
+    struct EnkiSerial;
+  };
+
+  struct Chain::EnkiSerial
+  {
+    using Members = enki::Register<&Chain::name, &Chain::next>;
+  };
+
+  std::vector<Order> makeOrders()
+  {
+    return {
+      {"ESZ5",
+       1,
+       {{Side::Buy, 4500.25}, {Side::Sell, 4501.0}},
+       "first",
+       int32_t{5},
+       {{1, 2}},
+       {{"venue", 3}}},
+      {"NQZ5", 2, {}, std::nullopt, std::string("hedge"), {{3, 4}}, {}},
+      {"ESZ5", 3, {{Side::Sell, 4499.5}}, std::nullopt, std::monostate{}, {{5, 6}}, {}},
+    };
+  }
+
+  template <typename Policy>
+  std::vector<std::byte> writeStream(Policy policy, const std::vector<Order> &orders)
+  {
+    enki::BinWriter writer(policy);
+    enki::writeSchema<Order>(writer).or_throw();
+    for (const auto &order : orders)
+    {
+      enki::serialize(order, writer).or_throw();
+    }
+    return writer.data();
+  }
+
+  struct Collector
+  {
+    std::map<std::string, enki::SchemaValue> values;
+
+    void operator()(std::string_view path, const enki::SchemaValue &value)
+    {
+      values.emplace(path, value);
+    }
+  };
+} // namespace
+
+TEST_CASE("Schema descriptor is computed at compile time", "[regression][schema]")
+{
+  using enki::SchemaKind;
+  constexpr auto schema = enki::schema_v<Leg>;
+  constexpr std::array expected{
+    std::byte{1},                // version
+    std::byte{sizeof(uint32_t)}, // size type
+    std::byte{0},                // strict policy
+    static_cast<std::byte>(SchemaKind::structure),
+    std::byte{2},                // members
+    std::byte{4},
+    std::byte{'s'},
+    std::byte{'i'},
+    std::byte{'d'},
+    std::byte{'e'},
+    static_cast<std::byte>(SchemaKind::uint8), // enums are described by their storage
+    std::byte{5},
+    std::byte{'p'},
+    std::byte{'r'},
+    std::byte{'i'},
+    std::byte{'c'},
+    std::byte{'e'},
+    static_cast<std::byte>(SchemaKind::float64),
+  };
+  STATIC_REQUIRE(schema == expected);
+
+  // The compact policy changes the stored variant index
+  const auto variantSchema = enki::schema_v<std::variant<int32_t, double>, enki::compact_t>;
+  REQUIRE(variantSchema[3] == static_cast<std::byte>(SchemaKind::variant));
+  REQUIRE(variantSchema[4] == static_cast<std::byte>(SchemaKind::uint8));
+}
+
+TEST_CASE("Schema nodes describe the written type", "[regression][schema]")
+{
+  enki::BinWriter writer;
+  enki::writeSchema<Order>(writer).or_throw();
+
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, enki::BinSpanReader(writer.data())).or_throw());
+  const enki::SchemaNode root = schema.root();
+  REQUIRE(root.kind() == enki::SchemaKind::structure);
+  REQUIRE(root.size() == 7);
+  REQUIRE(root.memberName(2) == "legs");
+  REQUIRE(root.memberIndex("tag") == 4);
+  REQUIRE_FALSE(root.memberIndex("price"));
+  REQUIRE(root.child(2).kind() == enki::SchemaKind::range);
+  REQUIRE(root.child(2).child().memberName(1) == "price");
+  REQUIRE(root.child(4).kind() == enki::SchemaKind::variant);
+  REQUIRE(root.child(4).indexKind() == enki::SchemaKind::uint32);
+  REQUIRE(root.child(4).child(2).kind() == enki::SchemaKind::string);
+  REQUIRE(root.child(5).size() == 2);
+  REQUIRE(root.child(6).child().kind() == enki::SchemaKind::tuple);
+}
+
+TEST_CASE("Generic readers walk a self-describing stream", "[regression][schema]")
+{
+  const auto orders = makeOrders();
+  const auto bytes = writeStream(enki::strict, orders);
+
+  enki::BinSpanReader reader(bytes);
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+
+  Collector first;
+  REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, first).or_throw());
+  REQUIRE(std::get<std::string_view>(first.values.at("symbol")) == "ESZ5");
+  REQUIRE(std::get<int64_t>(first.values.at("id")) == 1);
+  REQUIRE(std::get<uint64_t>(first.values.at("legs[1].side")) == 1);
+  REQUIRE(std::get<double>(first.values.at("legs[1].price")) == 4501.0);
+  REQUIRE(std::get<std::string_view>(first.values.at("note")) == "first");
+  REQUIRE(std::get<int64_t>(first.values.at("tag")) == 5);
+  REQUIRE(std::get<uint64_t>(first.values.at("flags[1]")) == 2);
+  REQUIRE(std::get<std::string_view>(first.values.at("attributes[0][0]")) == "venue");
+
+  // Skip the second order, route on a member of the third
+  REQUIRE_NOTHROW(enki::skipValue(schema.root(), reader).or_throw());
+  const size_t thirdOffset = bytes.size() - reader.remainingBytes();
+  enki::SchemaNode member(nullptr);
+  REQUIRE_NOTHROW(enki::findMember(schema.root(), "id", reader, member).or_throw());
+  REQUIRE(member.kind() == enki::SchemaKind::int64);
+  int64_t id = 0;
+  REQUIRE_NOTHROW(enki::deserialize(id, reader).or_throw());
+  REQUIRE(id == 3);
+
+  // The typed reader agrees with the generic one
+  Order third;
+  REQUIRE_NOTHROW(
+    enki::deserialize(third, enki::BinSpanReader(std::span(bytes).subspan(thirdOffset)))
+      .or_throw());
+  REQUIRE(third == orders[2]);
+}
+
+TEST_CASE("Schema walks streams written with binary policies", "[regression][schema]")
+{
+  const auto orders = makeOrders();
+  const auto checkPolicies = [&](auto policy) {
+    const auto bytes = writeStream(policy, orders);
+    enki::BinSpanReader reader(policy, bytes);
+    enki::Schema schema;
+    REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+
+    Collector first;
+    REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, first).or_throw());
+    REQUIRE(std::get<std::string_view>(first.values.at("symbol")) == "ESZ5");
+    REQUIRE(std::get<double>(first.values.at("legs[0].price")) == 4500.25);
+
+    Collector second;
+    REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, second).or_throw());
+    REQUIRE(std::holds_alternative<std::monostate>(second.values.at("note")));
+    REQUIRE(std::get<std::string_view>(second.values.at("tag")) == "hedge");
+
+    enki::SchemaNode member(nullptr);
+    REQUIRE_NOTHROW(enki::findMember(schema.root(), "symbol", reader, member).or_throw());
+    std::string symbol;
+    REQUIRE_NOTHROW(enki::deserialize(symbol, reader).or_throw());
+    REQUIRE(symbol == "ESZ5"); // A dictionary reference to the first symbol
+  };
+
+  checkPolicies(enki::compact);
+  checkPolicies(enki::dictionary);
+  checkPolicies(enki::presence_bitmap);
+  checkPolicies(enki::forward_compatible);
+  checkPolicies(enki::forward_compatible | enki::dictionary | enki::compact);
+}
+
+TEST_CASE("Schema skips tagged fields without decoding them", "[regression][schema]")
+{
+  const Encoded encoded{-1, {{1, 2, 3}}, 9};
+  enki::BinWriter writer(enki::forward_compatible);
+  enki::writeSchema<Encoded>(writer).or_throw();
+  enki::serialize(encoded, writer).or_throw();
+  enki::serialize(int32_t{77}, writer).or_throw();
+
+  enki::BinSpanReader reader(enki::forward_compatible, writer.data());
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE(schema.root().child(1).kind() == enki::SchemaKind::opaque);
+  REQUIRE_NOTHROW(enki::skipValue(schema.root(), reader).or_throw());
+  int32_t next = 0;
+  REQUIRE_NOTHROW(enki::deserialize(next, reader).or_throw());
+  REQUIRE(next == 77);
+
+  // Without tags, custom encodings cannot be walked
+  enki::BinWriter strictWriter;
+  enki::writeSchema<Encoded>(strictWriter).or_throw();
+  enki::serialize(encoded, strictWriter).or_throw();
+  enki::BinSpanReader strictReader(strictWriter.data());
+  REQUIRE_NOTHROW(enki::readSchema(schema, strictReader).or_throw());
+  REQUIRE_FALSE(enki::skipValue(schema.root(), strictReader));
+}
+
+TEST_CASE("Schema describes self-referential types", "[regression][schema]")
+{
+  using enki::SchemaKind;
+  // Header, struct of 2 members: "value" int32, "children" range of the enclosing struct
+  constexpr auto schema = enki::schema_v<Tree>;
+  REQUIRE(schema.size() == 3 + 2 + 6 + 1 + 9 + 1 + 2);
+  REQUIRE(schema[3] == static_cast<std::byte>(SchemaKind::structure));
+  REQUIRE(schema[21] == static_cast<std::byte>(SchemaKind::range));
+  REQUIRE(schema[22] == static_cast<std::byte>(SchemaKind::recursive));
+  REQUIRE(schema[23] == std::byte{22 - 3});
+
+  const Tree tree{1, {{2, {{4, {}}}}, {3, {}}}};
+  enki::BinWriter writer;
+  enki::writeSchema<Tree>(writer).or_throw();
+  enki::serialize(tree, writer).or_throw();
+
+  enki::BinSpanReader reader(writer.data());
+  enki::Schema readSchema;
+  REQUIRE_NOTHROW(enki::readSchema(readSchema, reader).or_throw());
+  const enki::SchemaNode root = readSchema.root();
+  REQUIRE(root.child(1).child().kind() == SchemaKind::structure);
+  REQUIRE(root.child(1).child().memberName(1) == "children");
+
+  Collector collector;
+  REQUIRE_NOTHROW(enki::visitValue(root, reader, collector).or_throw());
+  REQUIRE(reader.remainingBytes() == 0);
+  REQUIRE(std::get<int64_t>(collector.values.at("value")) == 1);
+  REQUIRE(std::get<int64_t>(collector.values.at("children[0].children[0].value")) == 4);
+  REQUIRE(std::get<int64_t>(collector.values.at("children[1].value")) == 3);
+
+  // Through shared objects, with tagged members
+  const auto checkPolicy = [](auto policy) {
+    const Chain chain{"first", std::make_shared<Chain>(Chain{"second", nullptr})};
+    enki::BinWriter chainWriter(policy);
+    enki::writeSchema<Chain>(chainWriter).or_throw();
+    enki::serialize(chain, chainWriter).or_throw();
+
+    enki::BinSpanReader chainReader(policy, chainWriter.data());
+    enki::Schema chainSchema;
+    REQUIRE_NOTHROW(enki::readSchema(chainSchema, chainReader).or_throw());
+    REQUIRE(chainSchema.root().child(1).kind() == SchemaKind::shared);
+    Collector chainCollector;
+    REQUIRE_NOTHROW(enki::visitValue(chainSchema.root(), chainReader, chainCollector).or_throw());
+    REQUIRE(std::get<std::string_view>(chainCollector.values.at("next.name")) == "second");
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::forward_compatible);
+
+  // Back-references must point to an enclosing struct, through a node reading data
+  const auto readDescriptor = [](std::vector<std::byte> nodes) {
+    enki::BinWriter descriptorWriter;
+    descriptorWriter.writeVarint(3 + nodes.size());
+    descriptorWriter.writeBytes(std::array{std::byte{1}, std::byte{4}, std::byte{0}});
+    descriptorWriter.writeBytes(nodes);
+    enki::Schema descriptorSchema;
+    return enki::readSchema(descriptorSchema, enki::BinSpanReader(descriptorWriter.data()));
+  };
+  const auto kind = [](SchemaKind k) { return static_cast<std::byte>(k); };
+  const std::byte noName{0};
+  REQUIRE(readDescriptor({kind(SchemaKind::structure),
+                          std::byte{1},
+                          noName,
+                          kind(SchemaKind::range),
+                          kind(SchemaKind::recursive),
+                          std::byte{4}}));
+  REQUIRE_FALSE(readDescriptor({kind(SchemaKind::structure),
+                                std::byte{1},
+                                noName,
+                                kind(SchemaKind::range),
+                                kind(SchemaKind::recursive),
+                                std::byte{1}}));
+  REQUIRE_FALSE(readDescriptor({kind(SchemaKind::structure),
+                                std::byte{1},
+                                noName,
+                                kind(SchemaKind::recursive),
+                                std::byte{3}}));
+}
+
+TEST_CASE("Schema rejects mismatching or malformed descriptors", "[regression][schema]")
+{
+  enki::BinWriter writer(enki::dictionary);
+  enki::writeSchema<Order>(writer).or_throw();
+
+  enki::Schema schema;
+  REQUIRE_FALSE(enki::readSchema(schema, enki::BinSpanReader(writer.data())));
+
+  auto bytes = writer.data();
+  bytes.pop_back();
+  bytes[0] = static_cast<std::byte>(static_cast<uint8_t>(bytes[0]) - 1);
+  REQUIRE_FALSE(enki::readSchema(schema, enki::BinSpanReader(enki::dictionary, bytes)));
+
+  enki::BinWriter badKind;
+  badKind.writeVarint(4);
+  badKind.writeBytes(std::array{std::byte{1}, std::byte{4}, std::byte{0}, std::byte{0xFF}});
+  REQUIRE_FALSE(enki::readSchema(schema, enki::BinSpanReader(badKind.data())));
+}
@@ -0,0 +1,166 @@
+/// Tests for binary sessions
+/// Writers and readers of a batch of messages share their dictionary and schemas
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_reader.hpp"
+#include "enki/bin_session.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/schema.hpp"
+
+namespace
+{
+  struct Quote
+  {
+    std::string symbol;
+    std::string venue;
+    int32_t price;
+
+    bool operator==(const Quote &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Quote::EnkiSerial
+  {
+    using Members = enki::Register<&Quote::symbol, &Quote::venue, &Quote::price>;
+  };
+
+  struct QuoteView
+  {
+    std::string_view symbol;
+    std::string_view venue;
+    int32_t price;
+
+    struct EnkiSerial;
+  };
+
+  struct QuoteView::EnkiSerial
+  {
+    using Members = enki::Register<&QuoteView::symbol, &QuoteView::venue, &QuoteView::price>;
+  };
+
+  const std::array<Quote, 3> kQuotes{{
+    {"AAPL.NASDAQ", "XNAS", 100},
+    {"AAPL.NASDAQ", "XNAS", 101},
+    {"MSFT.NASDAQ", "XNAS", 200},
+  }};
+} // namespace
+
+TEST_CASE("Session keeps the dictionary warm across messages", "[regression][session]")
+{
+  enki::BinWriterSession writerSession;
+  std::vector<std::vector<std::byte>> messages;
+  for (const auto &quote : kQuotes)
+  {
+    enki::BinWriter writer(enki::dictionary, writerSession);
+    enki::serialize(quote, writer).or_throw();
+    messages.push_back(writer.data());
+  }
+
+  // Repeated strings are references to the ones of the previous messages
+  enki::BinWriter standalone(enki::dictionary);
+  enki::serialize(kQuotes[1], standalone).or_throw();
+  REQUIRE(messages[1].size() == 2 + sizeof(int32_t));
+  REQUIRE(messages[1].size() < standalone.data().size());
+
+  enki::BinReaderSession readerSession;
+  std::vector<QuoteView> views;
+  for (const auto &message : messages)
+  {
+    QuoteView view{};
+    REQUIRE_NOTHROW(
+      enki::deserialize(view, enki::BinSpanReader(enki::dictionary, message, readerSession))
+        .or_throw());
+    views.push_back(view);
+  }
+  messages.clear();
+
+  // Views point into the session, not into the message buffers
+  for (size_t i = 0; i < kQuotes.size(); ++i)
+  {
+    REQUIRE(views[i].symbol == kQuotes[i].symbol);
+    REQUIRE(views[i].venue == kQuotes[i].venue);
+    REQUIRE(views[i].price == kQuotes[i].price);
+  }
+}
+
+TEST_CASE("Session messages need the previous messages", "[regression][session]")
+{
+  enki::BinWriterSession session;
+  enki::BinWriter writer(enki::dictionary, session);
+  enki::serialize(kQuotes[0], writer).or_throw();
+  writer.clear(); // The writer is reused, the session keeps the strings
+  enki::serialize(kQuotes[1], writer).or_throw();
+
+  Quote quote;
+  REQUIRE_FALSE(enki::deserialize(quote, enki::BinReader(enki::dictionary, writer.data())));
+
+  session.clear();
+  writer.clear();
+  enki::serialize(kQuotes[1], writer).or_throw();
+  REQUIRE_NOTHROW(
+    enki::deserialize(quote, enki::BinReader(enki::dictionary, writer.data())).or_throw());
+  REQUIRE(quote == kQuotes[1]);
+}
+
+TEST_CASE("Session span writers share the dictionary", "[regression][session]")
+{
+  enki::BinWriterSession writerSession;
+  enki::BinReaderSession readerSession;
+  std::array<std::byte, 64> buffer{};
+  for (const auto &quote : kQuotes)
+  {
+    enki::BinSpanWriter writer(enki::dictionary, buffer, writerSession);
+    enki::serialize(quote, writer).or_throw();
+
+    enki::BinSpanReader reader(enki::dictionary, writer.data(), readerSession);
+    Quote deserialized;
+    REQUIRE_NOTHROW(enki::deserialize(deserialized, reader).or_throw());
+    REQUIRE(deserialized == quote);
+    REQUIRE(reader.dictionary().size() == (&quote == &kQuotes[2] ? 3 : 2));
+  }
+}
+
+TEST_CASE("Session writes each schema once", "[regression][session]")
+{
+  enki::BinWriterSession writerSession;
+  std::vector<std::vector<std::byte>> messages;
+  for (const auto &quote : kQuotes)
+  {
+    enki::BinWriter writer(enki::dictionary, writerSession);
+    enki::writeSchema<Quote>(writer).or_throw();
+    enki::serialize(quote, writer).or_throw();
+    messages.push_back(writer.data());
+  }
+  REQUIRE(messages[1].size() == 1 + 2 + sizeof(int32_t));
+
+  enki::BinReaderSession readerSession;
+  for (size_t i = 0; i < messages.size(); ++i)
+  {
+    enki::BinSpanReader reader(enki::dictionary, messages[i], readerSession);
+    enki::Schema schema;
+    REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+    REQUIRE(schema.root().memberName(1) == "venue");
+    enki::SchemaNode member(nullptr);
+    REQUIRE_NOTHROW(enki::findMember(schema.root(), "price", reader, member).or_throw());
+    int32_t price = 0;
+    REQUIRE_NOTHROW(enki::deserialize(price, reader).or_throw());
+    REQUIRE(price == kQuotes[i].price);
+  }
+
+  // A reference to a schema the reader session never saw
+  enki::BinReaderSession freshSession;
+  enki::Schema schema;
+  REQUIRE_FALSE(
+    enki::readSchema(schema, enki::BinSpanReader(enki::dictionary, messages[1], freshSession)));
+}
@@ -0,0 +1,413 @@
+/// Tests for std::unique_ptr and std::shared_ptr
+/// Shared objects are written once, later pointers to them as back-references
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/indexed.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/schema.hpp"
+#include "enki/skip.hpp"
+#include "enki/validate.hpp"
+
+namespace
+{
+  struct Instrument
+  {
+    std::string symbol;
+    std::vector<double> curve;
+
+    bool operator==(const Instrument &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Instrument::EnkiSerial
+  {
+    using Members = enki::Register<&Instrument::symbol, &Instrument::curve>;
+  };
+
+  struct Order
+  {
+    std::shared_ptr<const Instrument> instrument;
+    int32_t quantity;
+    std::unique_ptr<std::string> note;
+
+    struct EnkiSerial;
+  };
+
+  struct Order::EnkiSerial
+  {
+    using Members = enki::Register<&Order::instrument, &Order::quantity, &Order::note>;
+  };
+
+  struct Node
+  {
+    int32_t value;
+    std::shared_ptr<Node> next;
+
+    struct EnkiSerial;
+  };
+
+  struct Node::EnkiSerial
+  {
+    using Members = enki::Register<&Node::value, &Node::next>;
+  };
+
+  std::vector<Order> makeOrders()
+  {
+    const auto bond = std::make_shared<const Instrument>(
+      Instrument{"BOND", std::vector<double>(1000, 0.5)});
+    const auto swap = std::make_shared<const Instrument>(
+      Instrument{"SWAP", std::vector<double>(1000, 1.5)});
+    std::vector<Order> orders;
+    for (int32_t i = 0; i < 10; ++i)
+    {
+      orders.push_back({i % 3 == 0 ? swap : bond, i, nullptr});
+    }
+    orders[4].instrument = nullptr;
+    orders[7].note = std::make_unique<std::string>("urgent");
+    return orders;
+  }
+
+  struct Holder
+  {
+    std::shared_ptr<Instrument> first;
+    std::shared_ptr<Instrument> second;
+
+    struct EnkiSerial;
+  };
+
+  struct Holder::EnkiSerial
+  {
+    using Members = enki::Register<&Holder::first, &Holder::second>;
+  };
+
+  struct OldHolder
+  {
+    std::shared_ptr<Instrument> first;
+
+    struct EnkiSerial;
+  };
+
+  struct OldHolder::EnkiSerial
+  {
+    using Members = enki::Register<&OldHolder::first>;
+  };
+
+  struct Root
+  {
+    std::shared_ptr<Node> head;
+    std::vector<std::shared_ptr<Node>> nodes;
+
+    struct EnkiSerial;
+  };
+
+  struct Root::EnkiSerial
+  {
+    using Members = enki::Register<&Root::head, &Root::nodes>;
+  };
+
+  struct Collector
+  {
+    std::map<std::string, enki::SchemaValue> values;
+
+    void operator()(std::string_view path, const enki::SchemaValue &value)
+    {
+      values.emplace(path, value);
+    }
+  };
+} // namespace
+
+TEST_CASE("Shared objects are written once", "[regression][shared_ptr]")
+{
+  const std::vector<Order> orders = makeOrders();
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(orders, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // Two instruments of 8000 bytes of curve, not nine
+  REQUIRE(serRes.size() < 2 * 8100);
+  REQUIRE(enki::serialize(orders, enki::BinProbe()).size() == serRes.size());
+
+  std::vector<Order> deserialized;
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized.size() == orders.size());
+  for (size_t i = 0; i < orders.size(); ++i)
+  {
+    REQUIRE(deserialized[i].quantity == orders[i].quantity);
+    REQUIRE((deserialized[i].instrument == nullptr) == (orders[i].instrument == nullptr));
+    if (orders[i].instrument)
+    {
+      REQUIRE(*deserialized[i].instrument == *orders[i].instrument);
+    }
+    REQUIRE((deserialized[i].note == nullptr) == (orders[i].note == nullptr));
+  }
+  REQUIRE(*deserialized[7].note == "urgent");
+
+  // Sharing is rebuilt
+  REQUIRE(deserialized[0].instrument == deserialized[3].instrument);
+  REQUIRE(deserialized[1].instrument == deserialized[2].instrument);
+  REQUIRE(deserialized[0].instrument != deserialized[1].instrument);
+
+  // Other policies
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter policyWriter(policy);
+    REQUIRE_NOTHROW(enki::serialize(orders, policyWriter).or_throw());
+    REQUIRE(enki::serialize(orders, enki::BinProbe(policy)).size() == policyWriter.data().size());
+    std::vector<Order> policyOrders;
+    REQUIRE_NOTHROW(
+      enki::deserialize(policyOrders, enki::BinReader(policy, policyWriter.data())).or_throw());
+    REQUIRE(policyOrders.size() == orders.size());
+    REQUIRE(*policyOrders[9].instrument == *orders[9].instrument);
+    REQUIRE(*policyOrders[7].note == "urgent");
+    REQUIRE(policyOrders[0].instrument == policyOrders[3].instrument);
+    REQUIRE(policyWriter.data().size() < 2 * 8200);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::dictionary);
+  checkPolicy(enki::presence_bitmap);
+}
+
+TEST_CASE("Shared objects may form cycles", "[regression][shared_ptr]")
+{
+  auto first = std::make_shared<Node>(Node{1, nullptr});
+  auto second = std::make_shared<Node>(Node{2, first});
+  first->next = second;
+
+  enki::BinWriter writer;
+  REQUIRE_NOTHROW(enki::serialize(first, writer).or_throw());
+  // Tag 2, value, tag 2, value, reference to id 0
+  REQUIRE(writer.data().size() == 1 + 4 + 1 + 4 + 1);
+  first->next = nullptr;
+
+  std::shared_ptr<Node> deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinReader(writer.data())).or_throw());
+  REQUIRE(deserialized->value == 1);
+  REQUIRE(deserialized->next->value == 2);
+  REQUIRE(deserialized->next->next == deserialized);
+  deserialized->next->next = nullptr;
+}
+
+TEST_CASE("Shared objects in forward compatible structs", "[regression][shared_ptr]")
+{
+  const auto checkPolicy = [](auto policy) {
+    const auto big = std::make_shared<Instrument>(
+      Instrument{"BOND", std::vector<double>(1000, 0.5)});
+    const auto other = std::make_shared<Instrument>(Instrument{"SWAP", {1.5}});
+    const auto third = std::make_shared<Instrument>(Instrument{"CASH", {}});
+
+    // Members share objects with each other and with the values written after them
+    enki::BinWriter writer(policy);
+    enki::serialize(Holder{big, big}, writer).or_throw();
+    REQUIRE(writer.data().size() < 8100);
+    enki::serialize(Holder{big, other}, writer).or_throw();
+    enki::serialize(big, writer).or_throw();
+    enki::serialize(third, writer).or_throw();
+    enki::serialize(third, writer).or_throw();
+
+    enki::BinSpanReader reader(policy, writer.data());
+    Holder same;
+    Holder different;
+    std::shared_ptr<Instrument> values[3];
+    REQUIRE_NOTHROW(enki::deserialize(same, reader).or_throw());
+    REQUIRE_NOTHROW(enki::deserialize(different, reader).or_throw());
+    for (auto &value : values)
+    {
+      REQUIRE_NOTHROW(enki::deserialize(value, reader).or_throw());
+    }
+    REQUIRE(*same.first == *big);
+    REQUIRE(same.first == same.second);
+    REQUIRE(different.first == same.first);
+    REQUIRE(*different.second == *other);
+    REQUIRE(values[0] == same.first);
+    REQUIRE(*values[1] == *third);
+    REQUIRE(values[1] == values[2]);
+
+    // Readers skipping a member still number the objects after it
+    enki::BinSpanReader oldReader(policy, writer.data());
+    OldHolder old;
+    REQUIRE_NOTHROW(enki::deserialize(old, oldReader).or_throw());
+    REQUIRE_NOTHROW(enki::deserialize(old, oldReader).or_throw());
+    for (auto &value : values)
+    {
+      REQUIRE_NOTHROW(enki::deserialize(value, oldReader).or_throw());
+    }
+    REQUIRE(values[0] == old.first);
+    REQUIRE(*values[1] == *third);
+    REQUIRE(values[1] == values[2]);
+
+    // Walked through their schema
+    enki::BinWriter schemaWriter(policy);
+    enki::writeSchema<Holder>(schemaWriter).or_throw();
+    enki::serialize(Holder{big, big}, schemaWriter).or_throw();
+    enki::BinSpanReader schemaReader(policy, schemaWriter.data());
+    enki::Schema schema;
+    REQUIRE_NOTHROW(enki::readSchema(schema, schemaReader).or_throw());
+    Collector collector;
+    REQUIRE_NOTHROW(enki::visitValue(schema.root(), schemaReader, collector).or_throw());
+    REQUIRE(std::get<std::string_view>(collector.values.at("first.symbol")) == "BOND");
+    REQUIRE(std::get<uint64_t>(collector.values.at("second")) == 0);
+    REQUIRE(schemaReader.remainingBytes() == 0);
+  };
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::forward_compatible | enki::dictionary);
+}
+
+TEST_CASE("Shared objects form cycles in forward compatible structs", "[regression][shared_ptr]")
+{
+  const auto checkPolicy = [](auto policy) {
+    auto first = std::make_shared<Node>(Node{1, nullptr});
+    auto second = std::make_shared<Node>(Node{2, first});
+    first->next = second;
+    auto third = std::make_shared<Node>(Node{3, nullptr});
+    third->next = third;
+
+    enki::BinWriter writer(policy);
+    REQUIRE_NOTHROW(enki::serialize(Root{first, {third, second}}, writer).or_throw());
+    REQUIRE(
+      enki::serialize(Root{first, {third, second}}, enki::BinProbe(policy)).size() ==
+      writer.data().size());
+    first->next = nullptr;
+    third->next = nullptr;
+
+    Root read;
+    REQUIRE_NOTHROW(enki::deserialize(read, enki::BinReader(policy, writer.data())).or_throw());
+    REQUIRE(read.head->value == 1);
+    REQUIRE(read.head->next->value == 2);
+    REQUIRE(read.head->next->next == read.head);
+    REQUIRE(read.nodes[0]->value == 3);
+    REQUIRE(read.nodes[0]->next == read.nodes[0]);
+    // Objects first written inside the value of another one are only shared inside it
+    REQUIRE(read.nodes[1]->value == 2);
+    REQUIRE(read.nodes[1]->next == read.head);
+    read.head->next = nullptr;
+    read.nodes[0]->next = nullptr;
+
+    REQUIRE_NOTHROW(enki::validate<Root>(enki::BinSpanReader(policy, writer.data())).or_throw());
+    enki::BinSpanReader skipReader(policy, writer.data());
+    REQUIRE_NOTHROW(enki::skip<Root>(skipReader).or_throw());
+    REQUIRE(skipReader.remainingBytes() == 0);
+  };
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::forward_compatible | enki::compact | enki::dictionary);
+}
+
+TEST_CASE("Shared objects in indexed ranges", "[regression][shared_ptr]")
+{
+  // Each element is decodable on its own: it writes its objects again rather than referring to
+  // the ones of other elements, with or without skippable content around them
+  using Indexed = enki::Indexed<std::vector<std::shared_ptr<const Instrument>>, 2>;
+  const auto bond = std::make_shared<const Instrument>(Instrument{"BOND", {0.5, 1.5}});
+  const auto swap = std::make_shared<const Instrument>(Instrument{"SWAP", {2.5}});
+  const std::pair<Indexed, std::shared_ptr<const Instrument>> value{Indexed{bond, bond, swap},
+                                                                    bond};
+
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter writer(policy);
+    REQUIRE_NOTHROW(enki::serialize(value, writer).or_throw());
+    REQUIRE(enki::serialize(value, enki::BinProbe(policy)).size() == writer.data().size());
+
+    std::pair<Indexed, std::shared_ptr<const Instrument>> deserialized;
+    REQUIRE_NOTHROW(
+      enki::deserialize(deserialized, enki::BinReader(policy, writer.data())).or_throw());
+    REQUIRE(deserialized.first.size() == 3);
+    REQUIRE(*deserialized.first[0] == *bond);
+    REQUIRE(*deserialized.first[1] == *bond);
+    REQUIRE(*deserialized.first[2] == *swap);
+    REQUIRE(*deserialized.second == *bond);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact | enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+}
+
+TEST_CASE("Smart pointers in JSON and generic readers", "[regression][shared_ptr]")
+{
+  const auto shared = std::make_shared<int32_t>(7);
+  const std::vector<std::shared_ptr<int32_t>> values{shared, nullptr, shared};
+
+  // JSON has no references: shared objects are written in full
+  enki::JSONWriter jsonWriter;
+  REQUIRE_NOTHROW(enki::serialize(values, jsonWriter).or_throw());
+  REQUIRE(jsonWriter.data().str() == "[7, null, 7]");
+  std::vector<std::shared_ptr<int32_t>> jsonValues;
+  REQUIRE_NOTHROW(
+    enki::deserialize(jsonValues, enki::JSONReader(jsonWriter.data().str())).or_throw());
+  REQUIRE(*jsonValues[0] == 7);
+  REQUIRE(jsonValues[1] == nullptr);
+  REQUIRE(*jsonValues[2] == 7);
+
+  const std::unique_ptr<uint8_t> unique = std::make_unique<uint8_t>(uint8_t{3});
+  enki::BinWriter writer;
+  enki::writeSchema<std::vector<std::shared_ptr<int32_t>>>(writer).or_throw();
+  enki::serialize(values, writer).or_throw();
+  enki::writeSchema<std::unique_ptr<uint8_t>>(writer).or_throw();
+  enki::serialize(unique, writer).or_throw();
+
+  enki::BinSpanReader reader(writer.data());
+  enki::Schema schema;
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE(schema.root().kind() == enki::SchemaKind::range);
+  REQUIRE(schema.root().child().kind() == enki::SchemaKind::shared);
+  Collector collector;
+  REQUIRE_NOTHROW(enki::visitValue(schema.root(), reader, collector).or_throw());
+  REQUIRE(std::get<int64_t>(collector.values.at("[0]")) == 7);
+  REQUIRE(std::holds_alternative<std::monostate>(collector.values.at("[1]")));
+  REQUIRE(std::get<uint64_t>(collector.values.at("[2]")) == 0);
+
+  REQUIRE_NOTHROW(enki::readSchema(schema, reader).or_throw());
+  REQUIRE(schema.root().kind() == enki::SchemaKind::optional);
+  std::unique_ptr<uint8_t> deserializedUnique;
+  REQUIRE_NOTHROW(enki::deserialize(deserializedUnique, reader).or_throw());
+  REQUIRE(*deserializedUnique == 3);
+}
+
+TEST_CASE("Shared object references reject malformed input", "[regression][shared_ptr]")
+{
+  std::shared_ptr<int32_t> deserialized;
+
+  SECTION("unknown reference")
+  {
+    enki::BinWriter writer;
+    writer.writeVarint(enki::detail::objectReferenceTag(3));
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+
+  SECTION("reference to an object of another type")
+  {
+    enki::BinWriter writer;
+    enki::serialize(std::make_shared<int16_t>(int16_t{1}), writer).or_throw();
+    writer.writeVarint(enki::detail::objectReferenceTag(0));
+
+    enki::BinReader reader(writer.data());
+    std::shared_ptr<int16_t> first;
+    REQUIRE_NOTHROW(enki::deserialize(first, reader).or_throw());
+    REQUIRE_FALSE(enki::deserialize(deserialized, reader));
+  }
+
+  SECTION("invalid tag")
+  {
+    enki::BinWriter writer;
+    writer.writeVarint(6);
+    REQUIRE_FALSE(enki::deserialize(deserialized, enki::BinReader(writer.data())));
+  }
+}
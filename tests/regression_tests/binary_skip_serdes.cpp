@@ -0,0 +1,219 @@
+/// Tests for skipping a value of a known type without deserializing it
+/// Binary readers only read lengths, flags and indices, JSON readers check the structure
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/auto_encoded.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/bit_packed.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/float_series.hpp"
+#include "enki/half.hpp"
+#include "enki/indexed.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/quantized.hpp"
+#include "enki/skip.hpp"
+
+namespace
+{
+  struct Point
+  {
+    float x;
+    float y;
+
+    struct EnkiSerial;
+  };
+
+  struct Point::EnkiSerial
+  {
+    using Members = enki::Register<&Point::x, &Point::y>;
+  };
+
+  struct Shape
+  {
+    std::string name;
+    std::vector<Point> points;
+    std::optional<std::string> label;
+    std::variant<std::monostate, int32_t, std::string, Point> style;
+    std::optional<uint16_t> layer;
+
+    struct EnkiSerial;
+  };
+
+  struct Shape::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Shape::name,
+      &Shape::points,
+      &Shape::label,
+      &Shape::style,
+      &Shape::layer>;
+  };
+
+  using Scene = std::tuple<
+    std::vector<Shape>,
+    std::map<std::string, std::vector<std::string>>,
+    std::array<double, 3>,
+    std::variant<int32_t, std::string>>;
+
+  Scene makeScene()
+  {
+    return {
+      {{"square", {{0, 0}, {0, 1}, {1, 1}, {1, 0}}, "unit", Point{2, 3}, std::nullopt},
+       {"dot", {{5, 5}}, std::nullopt, std::string("bold"), 4},
+       {"empty", {}, std::nullopt, std::monostate{}, std::nullopt}},
+      {{"layers", {"back", "front"}}, {"tags", {}}},
+      {1.5, 2.5, 3.5},
+      std::string("variant")};
+  }
+
+  constexpr uint32_t kMarker = 0xC0FFEE;
+
+  /// Skip a value written by `serialize`, checking that the reader ends up right after it
+  template <typename T, typename Policy>
+  void checkSkipped(const T &value, Policy policy)
+  {
+    enki::BinWriter writer(policy);
+    enki::serialize(value, writer).or_throw();
+    const size_t valueSize = writer.data().size();
+    enki::serialize(kMarker, writer).or_throw();
+
+    enki::BinSpanReader reader(policy, writer.data());
+    const auto res = enki::skip<T>(reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == valueSize);
+    uint32_t marker = 0;
+    enki::deserialize(marker, reader).or_throw();
+    REQUIRE(marker == kMarker);
+  }
+} // namespace
+
+TEST_CASE("Skipping binary values", "[regression][skip]")
+{
+  const Scene scene = makeScene();
+
+  const auto checkPolicy = [&](auto policy) {
+    enki::BinWriter writer(policy);
+    enki::serialize(scene, writer).or_throw();
+    const size_t sceneSize = writer.data().size();
+    enki::serialize(kMarker, writer).or_throw();
+
+    enki::BinReader reader(policy, writer.data());
+    const auto res = enki::skip<Scene>(reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == sceneSize);
+    uint32_t marker = 0;
+    enki::deserialize(marker, reader).or_throw();
+    REQUIRE(marker == kMarker);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::presence_bitmap);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::presence_bitmap | enki::forward_compatible);
+}
+
+TEST_CASE("Skipping wrappers deriving from their range", "[regression][skip]")
+{
+  // Their encoding is not the one of the range they derive from
+  std::vector<int32_t> integers(300);
+  std::vector<float> floats(300);
+  for (size_t i = 0; i < integers.size(); ++i)
+  {
+    integers[i] = static_cast<int32_t>(i * 3 % 17);
+    floats[i] = static_cast<float>(i) * 0.25f;
+  }
+  const auto checkPolicy = [&](auto policy) {
+    checkSkipped(enki::Delta<std::vector<int32_t>>(integers), policy);
+    checkSkipped(enki::BitPacked<std::vector<int32_t>>(integers), policy);
+    checkSkipped(enki::AutoEncoded<std::vector<int32_t>>(integers), policy);
+    checkSkipped(enki::FloatSeries<std::vector<float>>(floats), policy);
+    checkSkipped(enki::HalfRange<std::vector<float>>(floats), policy);
+    checkSkipped(enki::QuantizedRange<std::vector<float>, 0.0, 100.0>(floats), policy);
+    checkSkipped(enki::Indexed<std::vector<std::string>, 2>{"a", "bc", "def"}, policy);
+    checkSkipped(std::vector<enki::Delta<std::vector<int32_t>>>(3, integers), policy);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+}
+
+TEST_CASE("Skipping ranges of fixed size elements jumps over them", "[regression][skip]")
+{
+  // Elements are not looked at: only their count is read
+  std::vector<std::byte> bytes(4 + 1'000'000 * sizeof(Point), std::byte{0xFF});
+  bytes[0] = std::byte{0x40};
+  bytes[1] = std::byte{0x42};
+  bytes[2] = std::byte{0x0F};
+  bytes[3] = std::byte{0x00};
+  enki::BinSpanReader reader(bytes);
+  REQUIRE(enki::skip<std::vector<Point>>(reader));
+  REQUIRE(reader.remainingBytes() == 0);
+
+  // Counts larger than the data are rejected before skipping
+  const std::span<const std::byte> shortBytes = std::span(bytes).first(1000);
+  enki::BinSpanReader shortReader(shortBytes);
+  REQUIRE_FALSE(enki::skip<std::vector<Point>>(shortReader));
+}
+
+TEST_CASE("Skipping malformed binary values", "[regression][skip]")
+{
+  enki::BinWriter writer;
+  enki::serialize(std::variant<int32_t, std::string>(std::string("text")), writer).or_throw();
+  std::vector<std::byte> bytes = writer.data();
+  bytes[0] = std::byte{5};
+  REQUIRE_FALSE(enki::skip<std::variant<int32_t, std::string>>(enki::BinSpanReader(bytes)));
+
+  enki::BinWriter stringWriter;
+  enki::serialize(std::string("text"), stringWriter).or_throw();
+  std::vector<std::byte> stringBytes = stringWriter.data();
+  stringBytes[3] = std::byte{0x7F};
+  REQUIRE_FALSE(enki::skip<std::string>(enki::BinSpanReader(stringBytes)));
+}
+
+TEST_CASE("Skipping JSON values", "[regression][skip][json]")
+{
+  enki::JSONWriter writer;
+  enki::serialize(makeScene(), writer).or_throw();
+  const std::string json = writer.data().str() + ", 42";
+
+  enki::JSONReader reader(json);
+  REQUIRE(enki::skip<Scene>(reader));
+  reader.nextArrayElement().or_throw();
+  int32_t value = 0;
+  reader.read(value).or_throw();
+  REQUIRE(value == 42);
+
+  const auto skipJson = [](const char *text) {
+    enki::JSONReader jsonReader(text);
+    return static_cast<bool>(jsonReader.skipHintAndValue());
+  };
+  REQUIRE(skipJson(R"({"a": [1, {"b": "]}"}], "c": {}})"));
+  REQUIRE(skipJson(R"([true, false, null, -1.5e+3, "\"quoted\""])"));
+  REQUIRE_FALSE(skipJson(R"({"a": [1, 2})"));
+  REQUIRE_FALSE(skipJson(R"([1, 2)"));
+  REQUIRE_FALSE(skipJson(R"({"a" 1})"));
+  REQUIRE_FALSE(skipJson(R"([1 2])"));
+  REQUIRE_FALSE(skipJson(R"(["unterminated])"));
+  REQUIRE_FALSE(skipJson("nul"));
+}
@@ -0,0 +1,151 @@
+/// Tests for the enki::Sparse struct wrapper
+/// Only members differing from a value-initialized instance are stored in binary formats
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/sparse.hpp"
+
+namespace
+{
+  struct Telemetry
+  {
+    uint64_t timestamp;
+    int32_t temperature;
+    int32_t pressure;
+    uint16_t errors;
+    uint16_t warnings;
+    double voltage;
+    double current;
+    uint8_t level = 3;
+    bool alarm;
+    std::string label;
+
+    bool operator==(const Telemetry &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Telemetry::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Telemetry::timestamp,
+      &Telemetry::temperature,
+      &Telemetry::pressure,
+      &Telemetry::errors,
+      &Telemetry::warnings,
+      &Telemetry::voltage,
+      &Telemetry::current,
+      &Telemetry::level,
+      &Telemetry::alarm,
+      &Telemetry::label>;
+  };
+} // namespace
+
+TEST_CASE("Sparse encoding skips default members", "[regression][sparse]")
+{
+  enki::Sparse<Telemetry> telemetry{};
+  telemetry.timestamp = 1'700'000'000;
+  telemetry.errors = 2;
+
+  enki::BinWriter writer;
+  const auto serRes = enki::serialize(telemetry, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  // 10 members fit in a 2 bytes mask
+  REQUIRE(serRes.size() == 2 + sizeof(uint64_t) + sizeof(uint16_t));
+
+  const auto plainSize =
+    enki::serialize(static_cast<const Telemetry &>(telemetry), enki::BinProbe()).size();
+  REQUIRE(serRes.size() * 3 < plainSize);
+
+  REQUIRE(enki::serialize(telemetry, enki::BinProbe()).size() == serRes.size());
+
+  enki::Sparse<Telemetry> deserialized{};
+  deserialized.pressure = 12; // Reset to its default
+  const auto desRes = enki::deserialize(deserialized, enki::BinReader(writer.data()));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == telemetry);
+}
+
+TEST_CASE("Sparse encoding compares with default member initializers", "[regression][sparse]")
+{
+  enki::Sparse<Telemetry> telemetry{};
+  telemetry.level = 0; // Differs from its initializer, must be written
+  telemetry.label = "probe";
+
+  enki::BinWriter writer;
+  REQUIRE(
+    enki::serialize(telemetry, writer).size() ==
+    2 + sizeof(uint8_t) + sizeof(uint32_t) + std::string("probe").size());
+
+  enki::Sparse<Telemetry> deserialized{};
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, enki::BinSpanReader(writer.data())).or_throw());
+  REQUIRE(deserialized.level == 0);
+  REQUIRE(deserialized == telemetry);
+}
+
+TEST_CASE("Sparse encoding of a range of structs", "[regression][sparse]")
+{
+  std::vector<enki::Sparse<Telemetry>> records(100);
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    records[i].timestamp = i;
+    if (i % 10 == 0)
+    {
+      records[i].alarm = true;
+      records[i].voltage = 0.5;
+    }
+  }
+
+  enki::BinWriter writer(enki::compact);
+  REQUIRE_NOTHROW(enki::serialize(records, writer).or_throw());
+
+  std::vector<enki::Sparse<Telemetry>> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinReader(enki::compact, writer.data())).or_throw());
+  REQUIRE(deserialized == records);
+}
+
+TEST_CASE("Sparse decoding of truncated data", "[regression][sparse]")
+{
+  enki::Sparse<Telemetry> telemetry{};
+  telemetry.current = 1.5;
+
+  enki::BinWriter writer;
+  enki::serialize(telemetry, writer).or_throw();
+  auto bytes = std::vector<std::byte>(writer.data().begin(), writer.data().end());
+  bytes.pop_back();
+
+  enki::Sparse<Telemetry> deserialized{};
+  REQUIRE_THROWS_AS(enki::deserialize(deserialized, enki::BinReader(bytes)), std::out_of_range);
+}
+
+TEST_CASE("Sparse wrapper keeps JSON as the plain struct", "[regression][sparse]")
+{
+  enki::Sparse<Telemetry> telemetry{};
+  telemetry.temperature = -4;
+
+  enki::JSONWriter sparseWriter;
+  enki::serialize(telemetry, sparseWriter).or_throw();
+  enki::JSONWriter writer;
+  enki::serialize(static_cast<const Telemetry &>(telemetry), writer).or_throw();
+  REQUIRE(sparseWriter.data().str() == writer.data().str());
+
+  enki::Sparse<Telemetry> deserialized{};
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::JSONReader(writer.data().str())).or_throw());
+  REQUIRE(deserialized == telemetry);
+}
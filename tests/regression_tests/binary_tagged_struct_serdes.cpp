@@ -0,0 +1,245 @@
+/// Tests for tagged structs with the forward_compatible_t policy - Binary Format
+/// Members carry their field number so readers skip unknown fields and default missing ones
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_probe.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+
+namespace
+{
+  struct OrderV1
+  {
+    int32_t id;
+    std::string symbol;
+
+    bool operator==(const OrderV1 &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct OrderV1::EnkiSerial
+  {
+    using Members = enki::Register<&OrderV1::id, &OrderV1::symbol>;
+  };
+
+  struct OrderV2
+  {
+    int32_t id;
+    std::string symbol;
+    double price = 1.5;
+    std::vector<std::string> tags;
+    std::variant<std::monostate, int32_t> extra;
+
+    bool operator==(const OrderV2 &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct OrderV2::EnkiSerial
+  {
+    using Members = enki::Register<
+      &OrderV2::id,
+      &OrderV2::symbol,
+      &OrderV2::price,
+      &OrderV2::tags,
+      &OrderV2::extra>;
+  };
+
+  struct ChangedOrder
+  {
+    int64_t id;
+    std::string symbol;
+
+    struct EnkiSerial;
+  };
+
+  struct ChangedOrder::EnkiSerial
+  {
+    using Members = enki::Register<&ChangedOrder::id, &ChangedOrder::symbol>;
+  };
+
+  template <typename T>
+  struct Book
+  {
+    std::vector<T> orders;
+    uint16_t depth;
+
+    struct EnkiSerial;
+  };
+
+  template <typename T>
+  struct Book<T>::EnkiSerial
+  {
+    using Members = enki::Register<&Book::orders, &Book::depth>;
+  };
+} // namespace
+
+TEST_CASE("Tagged struct wire format", "[regression][forward_compat][tagged]")
+{
+  const OrderV1 order{7, "ESZ5"};
+
+  enki::BinWriter writer(enki::forward_compatible);
+  const auto serRes = enki::serialize(order, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+
+  // Number of fields, then the fixed size int with its tag, then the sized string
+  const auto bytes = writer.data();
+  REQUIRE(bytes[0] == std::byte{2});
+  REQUIRE(bytes[1] == std::byte{enki::detail::taggedFieldTag(0, enki::detail::WireType::fixed32)});
+  REQUIRE(bytes[6] == std::byte{enki::detail::taggedFieldTag(1, enki::detail::WireType::sized)});
+  REQUIRE(bytes[7] == std::byte{sizeof(uint32_t) + 4});
+  REQUIRE(serRes.size() == 1 + 1 + sizeof(int32_t) + 1 + 1 + sizeof(uint32_t) + 4);
+
+  REQUIRE(
+    enki::serialize(order, enki::BinProbe(enki::forward_compatible)).size() == serRes.size());
+
+  OrderV1 deserialized;
+  const auto desRes =
+    enki::deserialize(deserialized, enki::BinSpanReader(enki::forward_compatible, bytes));
+  REQUIRE_NOTHROW(desRes.or_throw());
+  REQUIRE(desRes.size() == serRes.size());
+  REQUIRE(deserialized == order);
+}
+
+TEST_CASE("Tagged struct sizes longer than one byte", "[regression][forward_compat][tagged]")
+{
+  // Sizes from 128 bytes take more varint bytes, inserted after the content is written
+  Book<OrderV1> book{{}, 3};
+  for (int32_t i = 0; i < 100; ++i)
+  {
+    book.orders.push_back({i, std::string(static_cast<size_t>(i) * 5, 'x')});
+  }
+
+  enki::BinWriter writer(enki::forward_compatible);
+  const auto serRes = enki::serialize(book, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(serRes.size() == writer.data().size());
+  REQUIRE(
+    enki::serialize(book, enki::BinProbe(enki::forward_compatible)).size() == serRes.size());
+
+  // Number of fields, the tag of the orders, then their size over 3 bytes
+  const auto bytes = writer.data();
+  const size_t ordersSize = serRes.size() - 2 - 3 - 1 - sizeof(uint16_t);
+  REQUIRE(ordersSize >= size_t{1} << 14);
+  REQUIRE(bytes[2] == std::byte{static_cast<uint8_t>((ordersSize & 0x7F) | 0x80)});
+  REQUIRE(bytes[4] == std::byte{static_cast<uint8_t>(ordersSize >> 14)});
+
+  std::vector<std::byte> buffer(serRes.size());
+  enki::BinSpanWriter spanWriter(enki::forward_compatible, buffer);
+  REQUIRE_NOTHROW(enki::serialize(book, spanWriter).or_throw());
+  REQUIRE(buffer == writer.data());
+
+  Book<OrderV1> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(deserialized, enki::BinSpanReader(enki::forward_compatible, bytes))
+      .or_throw());
+  REQUIRE(deserialized.orders == book.orders);
+  REQUIRE(deserialized.depth == book.depth);
+}
+
+TEST_CASE("Old readers skip fields added to a struct", "[regression][forward_compat][tagged]")
+{
+  const OrderV2 order{7, "ESZ5", 4510.25, {"ioc", "hidden"}, int32_t{3}};
+  const int32_t after = 42;
+
+  enki::BinWriter writer(enki::forward_compatible);
+  enki::serialize(order, writer).or_throw();
+  enki::serialize(after, writer).or_throw();
+
+  enki::BinSpanReader reader(enki::forward_compatible, writer.data());
+  OrderV1 deserialized;
+  REQUIRE_NOTHROW(enki::deserialize(deserialized, reader).or_throw());
+  REQUIRE(deserialized == OrderV1{7, "ESZ5"});
+
+  int32_t deserializedAfter = 0;
+  REQUIRE_NOTHROW(enki::deserialize(deserializedAfter, reader).or_throw());
+  REQUIRE(deserializedAfter == after);
+  REQUIRE(reader.remainingBytes() == 0);
+}
+
+TEST_CASE("New readers default missing struct fields", "[regression][forward_compat][tagged]")
+{
+  const Book<OrderV1> book{{{1, "A"}, {2, "B"}}, 10};
+
+  enki::BinWriter writer(enki::forward_compatible | enki::dictionary);
+  enki::serialize(book, writer).or_throw();
+
+  Book<OrderV2> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(
+      deserialized, enki::BinReader(enki::forward_compatible | enki::dictionary, writer.data()))
+      .or_throw());
+  REQUIRE(deserialized.depth == 10);
+  REQUIRE(deserialized.orders.size() == 2);
+  REQUIRE(deserialized.orders[1].id == 2);
+  REQUIRE(deserialized.orders[1].symbol == "B");
+  // Default member initializers are honored
+  REQUIRE(deserialized.orders[1].price == 1.5);
+  REQUIRE(deserialized.orders[1].tags.empty());
+  REQUIRE(std::holds_alternative<std::monostate>(deserialized.orders[1].extra));
+}
+
+TEST_CASE("Tagged struct round trip with nested structs", "[regression][forward_compat][tagged]")
+{
+  Book<OrderV2> book{{}, 3};
+  for (int32_t i = 0; i < 50; ++i)
+  {
+    book.orders.push_back({i, "S" + std::to_string(i), i * 0.5, {"t"}, std::monostate{}});
+  }
+
+  enki::BinWriter writer(enki::forward_compatible | enki::compact);
+  const auto serRes = enki::serialize(book, writer);
+  REQUIRE_NOTHROW(serRes.or_throw());
+  REQUIRE(
+    enki::serialize(book, enki::BinProbe(enki::forward_compatible | enki::compact)).size() ==
+    serRes.size());
+
+  Book<OrderV2> deserialized;
+  REQUIRE_NOTHROW(
+    enki::deserialize(
+      deserialized, enki::BinReader(enki::forward_compatible | enki::compact, writer.data()))
+      .or_throw());
+  REQUIRE(deserialized.depth == book.depth);
+  REQUIRE(deserialized.orders == book.orders);
+}
+
+TEST_CASE("Tagged struct rejects mismatching fields", "[regression][forward_compat][tagged]")
+{
+  enki::BinWriter writer(enki::forward_compatible);
+  enki::serialize(OrderV1{7, "ESZ5"}, writer).or_throw();
+
+  // The type of a known member changed
+  ChangedOrder changed;
+  REQUIRE_FALSE(
+    enki::deserialize(changed, enki::BinReader(enki::forward_compatible, writer.data())));
+
+  // Fields going backwards
+  enki::BinWriter outOfOrder(enki::forward_compatible);
+  outOfOrder.writeVarint(2);
+  outOfOrder.writeVarint(enki::detail::taggedFieldTag(1, enki::detail::WireType::sized));
+  outOfOrder.writeVarint(sizeof(uint32_t) + 4);
+  enki::serialize(std::string("ESZ5"), outOfOrder).or_throw();
+  outOfOrder.writeVarint(enki::detail::taggedFieldTag(0, enki::detail::WireType::fixed32));
+  enki::serialize(int32_t{7}, outOfOrder).or_throw();
+  OrderV1 deserialized;
+  REQUIRE_FALSE(
+    enki::deserialize(deserialized, enki::BinReader(enki::forward_compatible, outOfOrder.data())));
+}
+
+TEST_CASE("Strict policy keeps untagged structs", "[regression][forward_compat][tagged]")
+{
+  const OrderV1 order{7, "ESZ5"};
+  enki::BinWriter writer;
+  REQUIRE(
+    enki::serialize(order, writer).size() == sizeof(int32_t) + sizeof(uint32_t) + 4);
+}
@@ -0,0 +1,212 @@
+/// Tests for validating payloads against a type without deserializing them
+/// The first failure is reported through Success, truncated data included
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/auto_encoded.hpp"
+#include "enki/bin_reader.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/json_reader.hpp"
+#include "enki/json_writer.hpp"
+#include "enki/skip.hpp"
+#include "enki/validate.hpp"
+
+namespace
+{
+  struct Sample
+  {
+    double value;
+    bool isValid;
+
+    struct EnkiSerial;
+  };
+
+  struct Sample::EnkiSerial
+  {
+    using Members = enki::Register<&Sample::value, &Sample::isValid>;
+  };
+
+  struct Reading
+  {
+    uint32_t sensor;
+    std::string unit;
+    std::vector<Sample> samples;
+    std::optional<std::string> note;
+    std::variant<std::monostate, int64_t, std::string> source;
+    std::map<std::string, double> calibration;
+
+    struct EnkiSerial;
+  };
+
+  struct Reading::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Reading::sensor,
+      &Reading::unit,
+      &Reading::samples,
+      &Reading::note,
+      &Reading::source,
+      &Reading::calibration>;
+  };
+
+  Reading makeReading()
+  {
+    return {
+      12,
+      "kPa",
+      {{101.3, true}, {99.8, false}, {0.0, false}},
+      "after maintenance",
+      std::string("probe"),
+      {{"offset", 0.25}, {"scale", 1.01}}};
+  }
+
+  template <typename Policy>
+  std::vector<std::byte> serialized(const Reading &reading, Policy policy)
+  {
+    enki::BinWriter writer(policy);
+    enki::serialize(reading, writer).or_throw();
+    return writer.data();
+  }
+} // namespace
+
+TEST_CASE("Validating well formed payloads", "[regression][validate]")
+{
+  const Reading reading = makeReading();
+
+  const auto checkPolicy = [&](auto policy) {
+    const std::vector<std::byte> bytes = serialized(reading, policy);
+    enki::BinSpanReader reader(policy, bytes);
+    const auto res = enki::validate<Reading>(reader);
+    REQUIRE_NOTHROW(res.or_throw());
+    REQUIRE(res.size() == bytes.size());
+    REQUIRE(reader.remainingBytes() == 0);
+  };
+  checkPolicy(enki::strict);
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::presence_bitmap);
+  checkPolicy(enki::dictionary);
+  checkPolicy(enki::forward_compatible);
+  checkPolicy(enki::compact | enki::presence_bitmap | enki::forward_compatible);
+}
+
+TEST_CASE("Validating malformed payloads", "[regression][validate]")
+{
+  const std::vector<std::byte> bytes = serialized(makeReading(), enki::strict);
+  // sensor (4), unit (4 + 3), sample count (4), first sample (8 + 1)
+  constexpr size_t unitSize = 4;
+  constexpr size_t samplesBegin = 4 + 4 + 3;
+  constexpr size_t firstBool = samplesBegin + 4 + 8;
+
+  const auto validateChanged = [&](size_t index, std::byte value) {
+    std::vector<std::byte> changed = bytes;
+    changed[index] = value;
+    return enki::validate<Reading>(enki::BinSpanReader(changed));
+  };
+  REQUIRE(enki::validate<Reading>(enki::BinSpanReader(bytes)));
+
+  // Bool other than 0 and 1
+  const auto badBool = validateChanged(firstBool, std::byte{2});
+  REQUIRE_FALSE(badBool);
+  REQUIRE(std::string(badBool.error()) == "Invalid bool value");
+
+  // Lengths larger than the data
+  REQUIRE_FALSE(validateChanged(unitSize + 3, std::byte{0x10}));
+  REQUIRE_FALSE(validateChanged(samplesBegin + 2, std::byte{0x10}));
+
+  // Optional flag and variant index
+  const size_t noteFlag = firstBool + 1 + 2 * (8 + 1);
+  REQUIRE_FALSE(validateChanged(noteFlag, std::byte{7}));
+  const size_t variantIndex = noteFlag + 1 + 4 + 17;
+  REQUIRE_FALSE(validateChanged(variantIndex, std::byte{3}));
+
+  // Truncated data is reported, not thrown
+  for (size_t size = 0; size < bytes.size(); ++size)
+  {
+    const std::span<const std::byte> truncated = std::span(bytes).first(size);
+    enki::Success res;
+    REQUIRE_NOTHROW(res = enki::validate<Reading>(enki::BinSpanReader(truncated)));
+    REQUIRE_FALSE(res);
+  }
+}
+
+TEST_CASE("Validating forward compatible payloads", "[regression][validate]")
+{
+  using Value = std::variant<int32_t, std::string>;
+  enki::BinWriter writer(enki::forward_compatible);
+  enki::serialize(Value(std::string("text")), writer).or_throw();
+  REQUIRE(enki::validate<Value>(enki::BinSpanReader(enki::forward_compatible, writer.data())));
+
+  // Size prefix not matching the content
+  std::vector<std::byte> bytes = writer.data();
+  bytes[1] = std::byte{9};
+  REQUIRE_FALSE(enki::validate<Value>(enki::BinSpanReader(enki::forward_compatible, bytes)));
+
+  // Unknown alternatives need a monostate to be read into
+  bytes = writer.data();
+  bytes[0] = std::byte{5};
+  REQUIRE_FALSE(enki::validate<Value>(enki::BinSpanReader(enki::forward_compatible, bytes)));
+  using Extensible = std::variant<std::monostate, int32_t, std::string>;
+  REQUIRE(enki::validate<Extensible>(enki::BinSpanReader(enki::forward_compatible, bytes)));
+
+  // Tagged struct fields of the wrong type
+  enki::BinWriter structWriter(enki::forward_compatible);
+  enki::serialize(makeReading(), structWriter).or_throw();
+  std::vector<std::byte> structBytes = structWriter.data();
+  REQUIRE(enki::validate<Reading>(enki::BinSpanReader(enki::forward_compatible, structBytes)));
+  structBytes[1] = std::byte{0x03}; // sensor tag: field 0, fixed64
+  REQUIRE_FALSE(
+    enki::validate<Reading>(enki::BinSpanReader(enki::forward_compatible, structBytes)));
+}
+
+TEST_CASE("Validating JSON payloads", "[regression][validate][json]")
+{
+  enki::JSONWriter writer;
+  enki::serialize(makeReading(), writer).or_throw();
+  const std::string json = writer.data().str();
+  REQUIRE(enki::validate<Reading>(enki::JSONReader(json)));
+
+  REQUIRE_FALSE(enki::validate<Reading>(enki::JSONReader(json.substr(0, json.size() - 1))));
+  REQUIRE_FALSE(enki::validate<Reading>(enki::JSONReader(R"({"sensor": 12 "unit": "kPa"})")));
+
+  // Values of the wrong type
+  std::string wrongType = json;
+  wrongType.replace(wrongType.find("12"), 2, R"("12")");
+  REQUIRE(enki::skip<Reading>(enki::JSONReader(wrongType)));
+  REQUIRE_FALSE(enki::validate<Reading>(enki::JSONReader(wrongType)));
+}
+
+TEST_CASE("Validating wrappers deriving from their range", "[regression][validate]")
+{
+  std::vector<int32_t> values(200);
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = static_cast<int32_t>(i % 13) - 6;
+  }
+  const auto checkValid = [](const auto &value) {
+    enki::BinWriter writer;
+    enki::serialize(value, writer).or_throw();
+    using T = std::remove_cvref_t<decltype(value)>;
+    REQUIRE_NOTHROW(enki::validate<T>(enki::BinSpanReader(writer.data())).or_throw());
+    const std::span<const std::byte> truncated =
+      std::span(writer.data()).first(writer.data().size() - 1);
+    REQUIRE_FALSE(enki::validate<T>(enki::BinSpanReader(truncated)));
+  };
+  checkValid(enki::Delta<std::vector<int32_t>>(values));
+  checkValid(enki::AutoEncoded<std::vector<int32_t>>(values));
+  checkValid(std::vector<enki::Delta<std::vector<int32_t>>>(2, values));
+}
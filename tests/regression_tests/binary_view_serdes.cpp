@@ -0,0 +1,178 @@
+/// Tests for BinView, decoding the members of a serialized struct on access
+/// Only the member accessed and the lengths of the variable size members before it are read
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "enki/bin_reader.hpp"
+#include "enki/bin_view.hpp"
+#include "enki/bin_writer.hpp"
+#include "enki/delta.hpp"
+#include "enki/enki_deserialize.hpp"
+#include "enki/enki_serialize.hpp"
+#include "enki/half.hpp"
+
+namespace
+{
+  enum class Side : uint8_t
+  {
+    buy,
+    sell,
+  };
+
+  struct Route
+  {
+    std::string venue;
+    std::array<uint16_t, 3> hops;
+
+    bool operator==(const Route &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Route::EnkiSerial
+  {
+    using Members = enki::Register<&Route::venue, &Route::hops>;
+  };
+
+  struct Message
+  {
+    uint64_t id;
+    double price;
+    std::tuple<Side, int32_t> quantity;
+    std::string symbol;
+    std::vector<std::string> tags;
+    Route route;
+    std::optional<std::string> note;
+    uint16_t checksum;
+
+    bool operator==(const Message &) const = default;
+
+    struct EnkiSerial;
+  };
+
+  struct Message::EnkiSerial
+  {
+    using Members = enki::Register<
+      &Message::id,
+      &Message::price,
+      &Message::quantity,
+      &Message::symbol,
+      &Message::tags,
+      &Message::route,
+      &Message::note,
+      &Message::checksum>;
+  };
+
+  Message makeMessage()
+  {
+    return {
+      42,
+      101.25,
+      {Side::sell, 300},
+      "ACME",
+      {"block", "dark", "iceberg"},
+      {"XNYS", {1, 2, 3}},
+      "by phone",
+      0xBEEF};
+  }
+
+  struct Ticks
+  {
+    enki::Delta<std::vector<int32_t>> times;
+    enki::Half<float> scale;
+    int32_t id;
+
+    struct EnkiSerial;
+  };
+
+  struct Ticks::EnkiSerial
+  {
+    using Members = enki::Register<&Ticks::times, &Ticks::scale, &Ticks::id>;
+  };
+} // namespace
+
+TEST_CASE("Views decode the members they are asked for", "[regression][view]")
+{
+  const Message message = makeMessage();
+  enki::BinWriter writer;
+  enki::serialize(message, writer).or_throw();
+
+  const enki::BinView<Message> view(writer.data());
+  REQUIRE(view.get<&Message::checksum>() == message.checksum);
+  REQUIRE(view.get<&Message::id>() == message.id);
+  REQUIRE(view.get<&Message::price>() == message.price);
+  REQUIRE(view.get<&Message::quantity>() == message.quantity);
+  REQUIRE(view.get<&Message::symbol>() == message.symbol);
+  REQUIRE(view.get<&Message::tags>() == message.tags);
+  REQUIRE(view.get<&Message::route>() == message.route);
+  REQUIRE(view.get<&Message::note>() == message.note);
+
+  // Nested views
+  const auto route = view.view<&Message::route>();
+  REQUIRE(route.get<&Route::hops>() == message.route.hops);
+  REQUIRE(route.get<&Route::venue>() == "XNYS");
+
+  // Members of a fixed size prefix are read without looking at the rest of the data
+  const std::span<const std::byte> prefix = std::span(writer.data()).first(8 + 8 + 1 + 4);
+  const enki::BinView<Message> prefixView(prefix);
+  REQUIRE(prefixView.get<&Message::quantity>() == message.quantity);
+  REQUIRE_THROWS(prefixView.get<&Message::symbol>());
+}
+
+TEST_CASE("Views follow the policies of the data", "[regression][view]")
+{
+  const Message message = makeMessage();
+
+  const auto checkPolicy = [&](auto policy) {
+    using Policy = decltype(policy);
+    enki::BinWriter writer(policy);
+    enki::serialize(message, writer).or_throw();
+    const enki::BinView<Message, Policy> view(policy, writer.data());
+    REQUIRE(view.template get<&Message::checksum>() == message.checksum);
+    REQUIRE(view.template get<&Message::tags>() == message.tags);
+    const auto route = view.template view<&Message::route>();
+    REQUIRE(route.template get<&Route::hops>() == message.route.hops);
+  };
+  checkPolicy(enki::compact);
+  checkPolicy(enki::chunked);
+  checkPolicy(enki::aligned);
+  checkPolicy(enki::compact | enki::chunked);
+}
+
+TEST_CASE("Views skip wrapper members through their encoding", "[regression][view]")
+{
+  const Ticks ticks{std::vector<int32_t>{1000, 1010, 1015, 1030, 990}, 0.5f, 7};
+  enki::BinWriter writer;
+  enki::serialize(ticks, writer).or_throw();
+
+  const enki::BinView<Ticks> view(writer.data());
+  REQUIRE(view.get<&Ticks::id>() == 7);
+  REQUIRE(view.get<&Ticks::scale>() == ticks.scale);
+  REQUIRE(view.get<&Ticks::times>() == ticks.times);
+}
+
+TEST_CASE("Views report malformed data", "[regression][view]")
+{
+  Message message = makeMessage();
+  enki::BinWriter writer;
+  enki::serialize(message, writer).or_throw();
+
+  // Symbol length larger than the data
+  std::vector<std::byte> bytes = writer.data();
+  bytes[8 + 8 + 1 + 4 + 3] = std::byte{0x7F};
+  const enki::BinView<Message> view(bytes);
+  REQUIRE(view.get<&Message::price>() == message.price);
+  uint16_t checksum = 0;
+  REQUIRE_FALSE(view.get<&Message::checksum>(checksum));
+  std::vector<std::string> tags;
+  REQUIRE_FALSE(view.get<&Message::tags>(tags));
+}
@@ -269,6 +269,32 @@ TEST_CASE("JSONReader skip handles nested structures", "[error_handling][json]")
   }
 }
 
+TEST_CASE("JSONReader skip handles very deep nesting", "[error_handling][json]")
+{
+  // Nesting is tracked without recursion: no stack overflow
+  constexpr size_t kDepth = 2000000;
+  {
+    enki::JSONReader reader(std::string(kDepth, '['));
+    auto result = reader.skipHintAndValue();
+    REQUIRE_FALSE(result);
+  }
+
+  {
+    enki::JSONReader reader(std::string(kDepth, '[') + std::string(kDepth, ']') + " 7");
+    REQUIRE(reader.skipHintAndValue());
+    int32_t next = 0;
+    REQUIRE(enki::deserialize(next, reader));
+    REQUIRE(next == 7);
+  }
+
+  // Mismatched braces deep inside
+  {
+    std::string json = std::string(1000, '[') + "{\"a\": [1, {\"b\": 2]]";
+    enki::JSONReader reader(json);
+    REQUIRE_FALSE(reader.skipHintAndValue());
+  }
+}
+
 TEST_CASE("JSONReader skip handles strings with escapes", "[error_handling][json]")
 {
   // String with quotes inside
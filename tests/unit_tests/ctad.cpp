@@ -161,3 +161,26 @@ TEST_CASE("JSONReader CTAD - forward_compatible policy first", "[unit][CTAD]")
   enki::JSONReader reader(enki::forward_compatible, "{}");
   STATIC_CHECK(std::is_same_v<decltype(reader), enki::JSONReader<enki::forward_compatible_t>>);
 }
+
+TEST_CASE("BinWriter CTAD - combined policies", "[unit][CTAD]")
+{
+  enki::BinWriter writer(enki::forward_compatible | enki::compact);
+  STATIC_CHECK(
+    std::is_same_v<
+      decltype(writer),
+      enki::BinWriter<enki::policy_set<enki::forward_compatible_t, enki::compact_t>, uint32_t>>);
+  STATIC_CHECK(enki::has_policy_v<decltype(writer)::policy_type, enki::forward_compatible_t>);
+  STATIC_CHECK(enki::has_policy_v<decltype(writer)::policy_type, enki::compact_t>);
+  STATIC_CHECK(!enki::has_policy_v<decltype(writer)::policy_type, enki::strict_t>);
+}
+
+TEST_CASE("BinSpanReader CTAD - combined policies first", "[unit][CTAD]")
+{
+  const std::array<std::byte, 64> buffer{};
+  std::span span{buffer};
+  enki::BinSpanReader reader(enki::strict | enki::compact, span);
+  STATIC_CHECK(
+    std::is_same_v<
+      decltype(reader),
+      enki::BinSpanReader<enki::policy_set<enki::strict_t, enki::compact_t>, uint32_t>>);
+}